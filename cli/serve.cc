@@ -0,0 +1,314 @@
+#include "serve.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ctranslate2/utils.h>
+
+Format str_to_format(const std::string& format) {
+  if (format == "jsonl")
+    return Format::JsonLines;
+  if (format == "binary")
+    return Format::Binary;
+  throw std::invalid_argument("Invalid format: " + format);
+}
+
+enum class ReadStatus {
+  Message,
+  TooLarge,  // The message was skipped.
+  Closed,
+};
+
+// Buffered reads and writes on a file descriptor.
+class FileDescriptorStream {
+public:
+  FileDescriptorStream(int input_fd, int output_fd)
+    : _input_fd(input_fd)
+    , _output_fd(output_fd)
+  {
+  }
+
+  ReadStatus read_message(Format format, size_t max_size, std::string& message) {
+    message.clear();
+
+    if (format == Format::JsonLines) {
+      bool too_large = false;
+      while (true) {
+        if (!fill_buffer()) {
+          if (too_large)
+            return ReadStatus::TooLarge;
+          return message.empty() ? ReadStatus::Closed : ReadStatus::Message;
+        }
+        const auto end = _buffer.find('\n', _offset);
+        const size_t count = (end == std::string::npos ? _buffer.size() : end) - _offset;
+        if (!too_large && message.size() + count > max_size) {
+          too_large = true;
+          message.clear();
+        }
+        if (!too_large)
+          message.append(_buffer, _offset, count);
+        _offset += count;
+        if (end != std::string::npos) {
+          _offset += 1;
+          if (too_large)
+            return ReadStatus::TooLarge;
+          if (!message.empty() && message.back() == '\r')
+            message.pop_back();
+          return ReadStatus::Message;
+        }
+      }
+    }
+
+    std::string header;
+    if (!read_exact(4, &header))
+      return ReadStatus::Closed;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(header.data());
+    const size_t size = ((size_t(bytes[0]) << 24)
+                         | (size_t(bytes[1]) << 16)
+                         | (size_t(bytes[2]) << 8)
+                         | size_t(bytes[3]));
+    const bool too_large = size > max_size;
+    if (!read_exact(size, too_large ? nullptr : &message))
+      throw std::runtime_error("Connection closed in the middle of a message");
+    return too_large ? ReadStatus::TooLarge : ReadStatus::Message;
+  }
+
+  // Returns false when the output is closed.
+  bool write_message(Format format, const std::string& message) {
+    std::string data;
+    if (format == Format::JsonLines) {
+      data.reserve(message.size() + 1);
+      data += message;
+      data += '\n';
+    } else {
+      const auto size = static_cast<uint32_t>(message.size());
+      data.reserve(message.size() + 4);
+      data += static_cast<char>((size >> 24) & 0xff);
+      data += static_cast<char>((size >> 16) & 0xff);
+      data += static_cast<char>((size >> 8) & 0xff);
+      data += static_cast<char>(size & 0xff);
+      data += message;
+    }
+
+    for (size_t offset = 0; offset < data.size();) {
+      const ssize_t written = ::write(_output_fd, data.data() + offset, data.size() - offset);
+      if (written < 0 && errno == EINTR)
+        continue;
+      if (written <= 0)
+        return false;
+      offset += written;
+    }
+    return true;
+  }
+
+private:
+  const int _input_fd;
+  const int _output_fd;
+  std::string _buffer;
+  size_t _offset = 0;
+
+  // Returns false if no more data can be read.
+  bool fill_buffer() {
+    if (_offset < _buffer.size())
+      return true;
+
+    _buffer.resize(65536);
+    _offset = 0;
+    while (true) {
+      const ssize_t count = ::read(_input_fd, &_buffer[0], _buffer.size());
+      if (count < 0 && errno == EINTR)
+        continue;
+      _buffer.resize(std::max(count, ssize_t(0)));
+      return count > 0;
+    }
+  }
+
+  // Reads size bytes into data, or skips them if data is null.
+  bool read_exact(size_t size, std::string* data) {
+    if (data) {
+      data->clear();
+      data->reserve(size);
+    }
+    while (size > 0) {
+      if (!fill_buffer())
+        return false;
+      const size_t count = std::min(size, _buffer.size() - _offset);
+      if (data)
+        data->append(_buffer, _offset, count);
+      _offset += count;
+      size -= count;
+    }
+    return true;
+  }
+};
+
+struct PendingResponse {
+  nlohmann::json id;
+  std::future<ctranslate2::TranslationResult> result;
+  std::string error;
+};
+
+static std::vector<std::string> get_tokens(const nlohmann::json& value) {
+  if (value.is_string())
+    return ctranslate2::split_tokens(value.get<std::string>());
+  return value.get<std::vector<std::string>>();
+}
+
+static std::string get_response(PendingResponse& pending, bool with_scores) {
+  nlohmann::json response;
+  if (!pending.id.is_null())
+    response["id"] = pending.id;
+
+  if (!pending.error.empty()) {
+    response["error"] = pending.error;
+    return response.dump();
+  }
+
+  try {
+    const auto result = pending.result.get();
+    response["hypotheses"] = result.hypotheses;
+    if (with_scores)
+      response["scores"] = result.scores;
+  } catch (const std::exception& e) {
+    response["error"] = e.what();
+  }
+
+  return response.dump();
+}
+
+void serve(ctranslate2::BufferedTranslationWrapper& wrapper,
+           int input_fd,
+           int output_fd,
+           const ServeOptions& options) {
+  const Format format = options.format;
+  const size_t max_pending_requests = std::max(options.max_pending_requests, size_t(1));
+  const bool with_scores = options.with_scores;
+  FileDescriptorStream stream(input_fd, output_fd);
+
+  std::mutex mutex;
+  std::condition_variable can_push;
+  std::condition_variable can_pop;
+  std::queue<PendingResponse> pending;
+  bool end_of_input = false;
+
+  std::thread writer([&]() {
+    bool output_open = true;
+    while (true) {
+      PendingResponse response;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        can_pop.wait(lock, [&]{ return !pending.empty() || end_of_input; });
+        if (pending.empty())
+          break;
+        response = std::move(pending.front());
+        pending.pop();
+      }
+      can_push.notify_one();
+
+      // Keep consuming the results when the client is gone so that the reader is not blocked.
+      const auto message = get_response(response, with_scores);
+      if (output_open)
+        output_open = stream.write_message(format, message);
+    }
+  });
+
+  std::string message;
+  while (true) {
+    PendingResponse request;
+    bool read_error = false;
+
+    ReadStatus status = ReadStatus::Closed;
+    try {
+      status = stream.read_message(format, options.max_message_size, message);
+      if (status == ReadStatus::Closed)
+        break;
+      if (status == ReadStatus::Message && format == Format::JsonLines && message.empty())
+        continue;
+    } catch (const std::exception& e) {
+      request.error = e.what();
+      read_error = true;
+    }
+
+    if (status == ReadStatus::TooLarge) {
+      request.error = ("The message exceeds the maximum size of "
+                       + std::to_string(options.max_message_size) + " bytes");
+    } else if (!read_error) {
+      try {
+        const auto json = nlohmann::json::parse(message);
+        if (json.contains("id"))
+          request.id = json["id"];
+        auto source = get_tokens(json.at("source"));
+        auto target_prefix = (json.contains("target_prefix")
+                              ? get_tokens(json["target_prefix"])
+                              : std::vector<std::string>());
+        request.result = wrapper.translate_async(std::move(source), std::move(target_prefix));
+      } catch (const std::exception& e) {
+        request.error = std::string("Invalid request: ") + e.what();
+      }
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      can_push.wait(lock, [&]{ return pending.size() < max_pending_requests; });
+      pending.emplace(std::move(request));
+    }
+    can_pop.notify_one();
+
+    if (read_error)
+      break;
+  }
+
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    end_of_input = true;
+  }
+  can_pop.notify_one();
+  writer.join();
+}
+
+int create_socket(const std::string& path) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof (address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof (address.sun_path))
+    throw std::invalid_argument("The socket path is too long: " + path);
+  std::strncpy(address.sun_path, path.c_str(), sizeof (address.sun_path) - 1);
+
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    throw std::runtime_error("Unable to create the socket: " + std::string(std::strerror(errno)));
+
+  // Only replace a socket left by a previous server.
+  struct stat status;
+  if (::lstat(path.c_str(), &status) == 0) {
+    if (!S_ISSOCK(status.st_mode)) {
+      ::close(fd);
+      throw std::invalid_argument("Unable to listen on " + path
+                                  + ": the file exists and is not a socket");
+    }
+    ::unlink(path.c_str());
+  }
+
+  if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof (address)) < 0
+      || ::listen(fd, SOMAXCONN) < 0) {
+    const std::string error = std::strerror(errno);
+    ::close(fd);
+    throw std::runtime_error("Unable to listen on " + path + ": " + error);
+  }
+
+  return fd;
+}
+
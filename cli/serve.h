@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+#include <ctranslate2/buffered_translation_wrapper.h>
+
+// Message framing on the connections.
+enum class Format {
+  JsonLines,  // One JSON object per line.
+  Binary,     // Each JSON object is prefixed by its size as a 4-byte big-endian integer.
+};
+
+Format str_to_format(const std::string& format);
+
+struct ServeOptions {
+  Format format = Format::JsonLines;
+  // Maximum number of requests read in advance.
+  size_t max_pending_requests = 256;
+  // Messages larger than this number of bytes are skipped and answered with an error.
+  size_t max_message_size = 1 << 20;
+  // Include the translation scores in the responses.
+  bool with_scores = false;
+};
+
+// Reads the requests of a client and writes the responses in the same order. The requests
+// are translated as soon as they are read, so a client can send several requests before
+// reading the responses. The function returns when the input is closed.
+void serve(ctranslate2::BufferedTranslationWrapper& wrapper,
+           int input_fd,
+           int output_fd,
+           const ServeOptions& options);
+
+// Creates a Unix domain socket listening on path. An existing socket file at this path is
+// replaced, but other files are not removed.
+int create_socket(const std::string& path);
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+#include <ctranslate2/buffered_translation_wrapper.h>
+#include <ctranslate2/devices.h>
+#include <ctranslate2/tuning.h>
+#include <ctranslate2/utils.h>
+
+#include "serve.h"
+
+int main(int argc, char* argv[]) {
+  cxxopts::Options cmd_options("ct2-server",
+                               "Serve translation requests with dynamic batching");
+  cmd_options.custom_help("--model <directory> [OPTIONS]");
+
+  cmd_options.add_options("General")
+    ("h,help", "Display available options.")
+    ("socket", "Path to the Unix socket to listen on (read the standard input if not set).",
+     cxxopts::value<std::string>())
+    ("format", "Message format: jsonl, binary (JSON objects prefixed by their 4-byte "
+     "big-endian size).",
+     cxxopts::value<std::string>()->default_value("jsonl"))
+    ("max_pending_requests", "Maximum number of requests read in advance per connection.",
+     cxxopts::value<size_t>()->default_value("256"))
+    ("max_message_size", "Maximum size of a request in bytes (larger requests are answered "
+     "with an error).",
+     cxxopts::value<size_t>()->default_value("1048576"))
+    ;
+
+  cmd_options.add_options("Device")
+    ("inter_threads", "Maximum number of batches to run in parallel.",
+     cxxopts::value<size_t>()->default_value("1"))
+    ("intra_threads", "Number of OpenMP threads (set to 0 to use the default value).",
+     cxxopts::value<size_t>()->default_value("0"))
+    ("device", "Device to use (can be cpu, cuda, auto).",
+     cxxopts::value<std::string>()->default_value("cpu"))
+    ("device_index", "Comma-separated list of device IDs to use.",
+     cxxopts::value<std::vector<int>>()->default_value("0"))
+    ("cpu_core_offset", "Pin worker threads to CPU cores starting from this offset.",
+     cxxopts::value<int>()->default_value("-1"))
+    ("max_queued_batches", "Maximum number of batches waiting for a replica (set -1 for "
+     "unlimited, 0 for an automatic value).",
+     cxxopts::value<long>()->default_value("0"))
+    ("tuning_profile", "Path to a profile written by ct2-tuner (overrides inter_threads, "
+     "intra_threads, compute_type, and the default batch_size).",
+     cxxopts::value<std::string>())
+    ;
+
+  cmd_options.add_options("Model")
+    ("model", "Path to the CTranslate2 model directory.", cxxopts::value<std::string>())
+    ("compute_type", "The type used for computation: default, auto, float32, float16, int16, int8, or int8_float16",
+     cxxopts::value<std::string>()->default_value("default"))
+    ;
+
+  cmd_options.add_options("Batching")
+    ("batch_size", "Maximum number of examples in a batch.",
+     cxxopts::value<size_t>()->default_value("32"))
+    ("max_batch_tokens", "Maximum number of source tokens in a batch (overrides batch_size).",
+     cxxopts::value<size_t>()->default_value("0"))
+    ("max_wait_time", "Maximum time in milliseconds a request waits for other requests "
+     "before its batch is run.",
+     cxxopts::value<double>()->default_value("10"))
+    ;
+
+  cmd_options.add_options("Translation")
+    ("beam_size", "Beam search size (set 1 for greedy decoding).",
+     cxxopts::value<size_t>()->default_value("2"))
+    ("n_best", "Also output the n-best hypotheses.",
+     cxxopts::value<size_t>()->default_value("1"))
+    ("with_score", "Also output the translation scores.",
+     cxxopts::value<bool>()->default_value("false"))
+    ("length_penalty", "Exponential penalty applied to the length during beam search.",
+     cxxopts::value<float>()->default_value("1"))
+    ("repetition_penalty", "Penalty applied to the score of previously generated tokens (set > 1 to penalize)",
+     cxxopts::value<float>()->default_value("1"))
+    ("no_repeat_ngram_size", "Prevent repetitions of ngrams with this size (set 0 to disable)",
+     cxxopts::value<size_t>()->default_value("0"))
+    ("disable_unk", "Disable the generation of the unknown token",
+     cxxopts::value<bool>()->default_value("false"))
+    ("max_input_length", "Truncate inputs after this many tokens (set 0 to disable).",
+     cxxopts::value<size_t>()->default_value("1024"))
+    ("max_decoding_length", "Maximum sentence length to generate.",
+     cxxopts::value<size_t>()->default_value("256"))
+    ("min_decoding_length", "Minimum sentence length to generate.",
+     cxxopts::value<size_t>()->default_value("1"))
+    ;
+
+  auto args = cmd_options.parse(argc, argv);
+
+  if (args.count("help")) {
+    std::cerr << cmd_options.help() << std::endl;
+    return 0;
+  }
+  if (!args.count("model")) {
+    throw std::invalid_argument("Option --model is required to run the server");
+  }
+
+  ctranslate2::ReplicaPoolConfig pool_config;
+  pool_config.num_threads_per_replica = args["intra_threads"].as<size_t>();
+  pool_config.max_queued_batches = args["max_queued_batches"].as<long>();
+  pool_config.cpu_core_offset = args["cpu_core_offset"].as<int>();
+
+  ctranslate2::models::ModelLoader model_loader(args["model"].as<std::string>());
+  model_loader.device = ctranslate2::str_to_device(args["device"].as<std::string>());
+  model_loader.device_indices = args["device_index"].as<std::vector<int>>();
+  model_loader.compute_type = ctranslate2::str_to_compute_type(args["compute_type"].as<std::string>());
+  model_loader.num_replicas_per_device = args["inter_threads"].as<size_t>();
+
+  size_t max_batch_size = args["batch_size"].as<size_t>();
+  if (args.count("tuning_profile")) {
+    const auto profile = ctranslate2::TuningProfile::load(args["tuning_profile"].as<std::string>());
+    profile.apply(model_loader, pool_config);
+    if (!args.count("batch_size") && profile.max_batch_size > 0)
+      max_batch_size = profile.max_batch_size;
+  }
+
+  auto batch_type = ctranslate2::BatchType::Examples;
+  const auto max_batch_tokens = args["max_batch_tokens"].as<size_t>();
+  if (max_batch_tokens > 0) {
+    max_batch_size = max_batch_tokens;
+    batch_type = ctranslate2::BatchType::Tokens;
+  }
+
+  ctranslate2::TranslationOptions options;
+  options.beam_size = args["beam_size"].as<size_t>();
+  options.num_hypotheses = args["n_best"].as<size_t>();
+  options.return_scores = args["with_score"].as<bool>();
+  options.length_penalty = args["length_penalty"].as<float>();
+  options.repetition_penalty = args["repetition_penalty"].as<float>();
+  options.no_repeat_ngram_size = args["no_repeat_ngram_size"].as<size_t>();
+  options.disable_unk = args["disable_unk"].as<bool>();
+  options.max_input_length = args["max_input_length"].as<size_t>();
+  options.max_decoding_length = args["max_decoding_length"].as<size_t>();
+  options.min_decoding_length = args["min_decoding_length"].as<size_t>();
+
+  const auto max_wait_time_us = static_cast<size_t>(args["max_wait_time"].as<double>() * 1000);
+  ctranslate2::BufferedTranslationWrapper wrapper(
+    std::make_shared<ctranslate2::Translator>(model_loader, pool_config),
+    max_batch_size,
+    max_wait_time_us,
+    options,
+    /*max_buffer_size=*/0,
+    batch_type);
+
+  ServeOptions serve_options;
+  serve_options.format = str_to_format(args["format"].as<std::string>());
+  serve_options.max_pending_requests = std::max(args["max_pending_requests"].as<size_t>(),
+                                                size_t(1));
+  serve_options.max_message_size = args["max_message_size"].as<size_t>();
+  serve_options.with_scores = options.return_scores;
+
+  if (!args.count("socket")) {
+    serve(wrapper, STDIN_FILENO, STDOUT_FILENO, serve_options);
+    return 0;
+  }
+
+  // Writing to a closed connection should not terminate the server.
+  std::signal(SIGPIPE, SIG_IGN);
+
+  const auto socket_path = args["socket"].as<std::string>();
+  const int server_fd = create_socket(socket_path);
+  std::cerr << "Listening on " << socket_path << std::endl;
+
+  while (true) {
+    const int client_fd = ::accept(server_fd, nullptr, nullptr);
+    if (client_fd < 0) {
+      if (errno == EINTR)
+        continue;
+      throw std::runtime_error("Unable to accept a connection: "
+                               + std::string(std::strerror(errno)));
+    }
+
+    // The requests of all connections are batched together by the wrapper.
+    std::thread([&wrapper, client_fd, serve_options]() {
+      serve(wrapper, client_fd, client_fd, serve_options);
+      ::close(client_fd);
+    }).detach();
+  }
+
+  return 0;
+}
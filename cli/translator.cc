@@ -4,6 +4,7 @@
 #include <cxxopts.hpp>
 
 #include <ctranslate2/translator.h>
+#include <ctranslate2/tuning.h>
 #include <ctranslate2/utils.h>
 #include <ctranslate2/random.h>
 #include <ctranslate2/devices.h>
@@ -23,6 +24,8 @@ int main(int argc, char* argv[]) {
      cxxopts::value<bool>()->default_value("false"))
     ("log_profiling", "Log execution profiling.",
      cxxopts::value<bool>()->default_value("false"))
+    ("profiling_counters", "Also count hardware events per profiled scope (Linux only).",
+     cxxopts::value<bool>()->default_value("false"))
     ;
 
   cmd_options.add_options("Device")
@@ -36,6 +39,9 @@ int main(int argc, char* argv[]) {
      cxxopts::value<std::vector<int>>()->default_value("0"))
     ("cpu_core_offset", "Pin worker threads to CPU cores starting from this offset.",
      cxxopts::value<int>()->default_value("-1"))
+    ("tuning_profile", "Path to a profile written by ct2-tuner (overrides inter_threads, "
+     "intra_threads, compute_type, and the default batch_size).",
+     cxxopts::value<std::string>())
     ;
 
   cmd_options.add_options("Model")
@@ -150,6 +156,14 @@ int main(int argc, char* argv[]) {
   model_loader.compute_type = compute_type;
   model_loader.num_replicas_per_device = inter_threads;
 
+  size_t max_batch_size = args["batch_size"].as<size_t>();
+  if (args.count("tuning_profile")) {
+    const auto profile = ctranslate2::TuningProfile::load(args["tuning_profile"].as<std::string>());
+    profile.apply(model_loader, pool_config);
+    if (!args.count("batch_size") && profile.max_batch_size > 0)
+      max_batch_size = profile.max_batch_size;
+  }
+
   ctranslate2::Translator translator_pool(model_loader, pool_config);
 
   std::istream* source = &std::cin;
@@ -175,10 +189,11 @@ int main(int argc, char* argv[]) {
 
   auto log_profiling = args["log_profiling"].as<bool>();
   if (log_profiling)
-    ctranslate2::init_profiling(device, translator_pool.num_replicas());
+    ctranslate2::init_profiling(device,
+                                translator_pool.num_replicas(),
+                                args["profiling_counters"].as<bool>());
 
   const auto task = args["task"].as<std::string>();
-  const auto max_batch_size = args["batch_size"].as<size_t>();
   const auto read_batch_size = args["read_batch_size"].as<size_t>();
   const auto batch_type = ctranslate2::str_to_batch_type(args["batch_type"].as<std::string>());
   ctranslate2::ExecutionStats stats;
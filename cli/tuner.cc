@@ -0,0 +1,142 @@
+#include <fstream>
+#include <iostream>
+
+#include <cxxopts.hpp>
+
+#include <ctranslate2/tuning.h>
+#include <ctranslate2/utils.h>
+#include <ctranslate2/devices.h>
+
+static std::vector<std::vector<std::string>> read_inputs(const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open())
+    throw std::runtime_error("Unable to open input file " + path);
+
+  std::vector<std::vector<std::string>> inputs;
+  std::string line;
+  while (std::getline(file, line))
+    inputs.emplace_back(ctranslate2::split_tokens(line));
+  return inputs;
+}
+
+int main(int argc, char* argv[]) {
+  cxxopts::Options cmd_options("ct2-tuner",
+                               "Search the deployment settings with the best throughput");
+  cmd_options.custom_help("--model <directory> [OPTIONS]");
+
+  cmd_options.add_options("General")
+    ("h,help", "Display available options.")
+    ("task", "Task to tune: translate, generate.",
+     cxxopts::value<std::string>()->default_value("translate"))
+    ("out", "Path to the tuning profile to write.",
+     cxxopts::value<std::string>()->default_value("tuning_profile.json"))
+    ;
+
+  cmd_options.add_options("Model")
+    ("model", "Path to the CTranslate2 model directory.", cxxopts::value<std::string>())
+    ("device", "Device to use (can be cpu, cuda, auto).",
+     cxxopts::value<std::string>()->default_value("cpu"))
+    ("device_index", "Comma-separated list of device IDs to use.",
+     cxxopts::value<std::vector<int>>()->default_value("0"))
+    ("compute_type", "Comma-separated list of compute types to try.",
+     cxxopts::value<std::vector<std::string>>()->default_value("default"))
+    ;
+
+  cmd_options.add_options("Search space")
+    ("inter_threads", "Comma-separated list of numbers of replicas per device "
+     "(split the CPU cores if not set).",
+     cxxopts::value<std::vector<size_t>>())
+    ("intra_threads", "Comma-separated list of numbers of threads per replica "
+     "(split the CPU cores if not set).",
+     cxxopts::value<std::vector<size_t>>())
+    ("batch_size", "Comma-separated list of batch sizes to try.",
+     cxxopts::value<std::vector<size_t>>()->default_value("1,4,16,32"))
+    ;
+
+  cmd_options.add_options("Workload")
+    ("src", "Path to a file of tokenized inputs (random tokens are used if not set).",
+     cxxopts::value<std::string>())
+    ("synthetic_length", "Length of the random inputs.",
+     cxxopts::value<size_t>()->default_value("32"))
+    ("concurrency", "Number of clients sending requests at the same time.",
+     cxxopts::value<size_t>()->default_value("4"))
+    ("num_requests", "Number of requests measured for each configuration.",
+     cxxopts::value<size_t>()->default_value("32"))
+    ("max_latency_p99", "Maximum p99 latency in milliseconds (set 0 to disable).",
+     cxxopts::value<double>()->default_value("0"))
+    ("beam_size", "Beam size of the requests.",
+     cxxopts::value<size_t>()->default_value("2"))
+    ("max_decoding_length", "Maximum number of tokens to generate per request.",
+     cxxopts::value<size_t>()->default_value("128"))
+    ;
+
+  auto args = cmd_options.parse(argc, argv);
+
+  if (args.count("help")) {
+    std::cerr << cmd_options.help() << std::endl;
+    return 0;
+  }
+  if (!args.count("model")) {
+    throw std::invalid_argument("Option --model is required to run the tuning");
+  }
+
+  ctranslate2::models::ModelLoader model_loader(args["model"].as<std::string>());
+  model_loader.device = ctranslate2::str_to_device(args["device"].as<std::string>());
+  model_loader.device_indices = args["device_index"].as<std::vector<int>>();
+
+  ctranslate2::TuningOptions tuning_options;
+  if (args.count("inter_threads"))
+    tuning_options.inter_threads = args["inter_threads"].as<std::vector<size_t>>();
+  if (args.count("intra_threads"))
+    tuning_options.intra_threads = args["intra_threads"].as<std::vector<size_t>>();
+  tuning_options.max_batch_sizes = args["batch_size"].as<std::vector<size_t>>();
+  for (const auto& compute_type : args["compute_type"].as<std::vector<std::string>>())
+    tuning_options.compute_types.emplace_back(ctranslate2::str_to_compute_type(compute_type));
+  tuning_options.concurrency = args["concurrency"].as<size_t>();
+  tuning_options.num_requests = args["num_requests"].as<size_t>();
+  tuning_options.max_latency_p99_ms = args["max_latency_p99"].as<double>();
+  tuning_options.synthetic_length = args["synthetic_length"].as<size_t>();
+
+  std::vector<std::vector<std::string>> inputs;
+  if (args.count("src"))
+    inputs = read_inputs(args["src"].as<std::string>());
+
+  const auto task = args["task"].as<std::string>();
+  const auto beam_size = args["beam_size"].as<size_t>();
+  const auto max_decoding_length = args["max_decoding_length"].as<size_t>();
+  ctranslate2::TuningResult result;
+
+  if (task == "translate") {
+    ctranslate2::TranslationOptions options;
+    options.beam_size = beam_size;
+    options.max_decoding_length = max_decoding_length;
+    result = ctranslate2::tune_translator(model_loader, options, tuning_options, inputs);
+  } else if (task == "generate") {
+    ctranslate2::GenerationOptions options;
+    options.beam_size = beam_size;
+    options.max_length = max_decoding_length;
+    result = ctranslate2::tune_generator(model_loader, options, tuning_options, inputs);
+  } else {
+    throw std::invalid_argument("Invalid task: " + task);
+  }
+
+  std::cout << "inter_threads\tintra_threads\tbatch_size\tcompute_type"
+            << "\ttokens/s\texamples/s\tp50 (ms)\tp99 (ms)" << std::endl;
+  for (const auto& candidate : result.candidates) {
+    std::cout << candidate.inter_threads
+              << '\t' << candidate.intra_threads
+              << '\t' << candidate.max_batch_size
+              << '\t' << ctranslate2::compute_type_to_str(candidate.compute_type)
+              << '\t' << candidate.tokens_per_second
+              << '\t' << candidate.examples_per_second
+              << '\t' << candidate.latency_p50_ms
+              << '\t' << candidate.latency_p99_ms
+              << std::endl;
+  }
+
+  const auto output_path = args["out"].as<std::string>();
+  result.best.save(output_path);
+  std::cerr << "Saved the best configuration in " << output_path << std::endl;
+
+  return 0;
+}
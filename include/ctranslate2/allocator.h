@@ -25,4 +25,26 @@ namespace ctranslate2 {
   Allocator& get_allocator();
   Allocator& get_allocator(Device device);
 
+  // Returns a CPU allocator backing large buffers with huge pages. Small buffers and
+  // systems without huge pages use the default CPU allocator.
+  Allocator& get_huge_page_allocator();
+
+  // Returns true if large and long-lived CPU buffers (e.g. the model weights) should be
+  // allocated in huge pages.
+  bool use_huge_pages();
+
+  // Allocates the CPU buffers of the current thread in huge pages within this scope,
+  // if enabled for this device.
+  class ScopedHugePageAllocation {
+  public:
+    ScopedHugePageAllocation(Device device);
+    ~ScopedHugePageAllocation();
+
+    ScopedHugePageAllocation(const ScopedHugePageAllocation&) = delete;
+    ScopedHugePageAllocation& operator=(const ScopedHugePageAllocation&) = delete;
+
+  private:
+    const bool _previous_state;
+  };
+
 }
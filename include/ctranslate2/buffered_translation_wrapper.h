@@ -12,13 +12,16 @@ namespace ctranslate2 {
   //
   // By default, max_buffer_size is set to max_batch_size, but it can be set to a larger value
   // in which case the buffer content is sorted by length and rebatched according to max_batch_size.
+  //
+  // With BatchType::Tokens, max_batch_size and max_buffer_size are numbers of source tokens.
   class BufferedTranslationWrapper {
   public:
     BufferedTranslationWrapper(std::shared_ptr<Translator> translator,
                                size_t max_batch_size,
                                size_t buffer_timeout_in_micros,
                                TranslationOptions options = TranslationOptions(),
-                               size_t max_buffer_size = 0);
+                               size_t max_buffer_size = 0,
+                               BatchType batch_type = BatchType::Examples);
     ~BufferedTranslationWrapper();
 
     std::future<TranslationResult>
@@ -33,6 +36,7 @@ namespace ctranslate2 {
     const TranslationOptions _options;
     const size_t _max_batch_size;
     const size_t _max_buffer_size;
+    const BatchType _batch_type;
     const std::chrono::microseconds _buffer_timeout;
     std::unique_ptr<std::thread> _background_thread;
     bool _stop = false;
@@ -41,7 +45,9 @@ namespace ctranslate2 {
     std::condition_variable _cv;
     std::queue<Example> _examples;
     std::queue<std::promise<TranslationResult>> _promises;
+    size_t _buffer_size = 0;  // In examples or tokens, depending on _batch_type.
 
+    size_t get_buffer_size_increment(const Example& example) const;
     void buffer_loop();
   };
 
@@ -13,6 +13,13 @@ namespace ctranslate2 {
     std::vector<float> scores;
     std::vector<std::vector<float>> token_scores;
     std::vector<std::vector<std::vector<float>>> attention;
+    // Best token ids and their log probabilities at each decoding step.
+    std::vector<std::vector<std::vector<size_t>>> topk_ids;
+    std::vector<std::vector<std::vector<float>>> topk_logprobs;
+    // Source position with the highest attention at each decoding step.
+    std::vector<std::vector<size_t>> attention_argmax;
+    // Average number of decoder layers run by the decoding steps of the batch.
+    float average_exit_depth = 0;
   };
 
 
@@ -33,7 +40,10 @@ namespace ctranslate2 {
            const size_t num_hypotheses = 1,
            const bool include_eos_in_hypotheses = true,
            const std::vector<std::shared_ptr<LogitsProcessor>>& logits_processors = {},
-           const std::vector<std::vector<size_t>>* prefix_ids = nullptr) const = 0;
+           const std::vector<std::vector<size_t>>* prefix_ids = nullptr,
+           const size_t return_topk_logprobs = 0,
+           const StopSequences* stop_sequences = nullptr,
+           const std::vector<std::pair<dim_t, dim_t>>* attention_argmax_ranges = nullptr) const = 0;
   };
 
   class BeamSearch : public SearchStrategy {
@@ -42,7 +52,10 @@ namespace ctranslate2 {
                const float length_penalty = 0,
                const float coverage_penalty = 0,
                const float prefix_bias_beta = 0,
-               const float patience = 1);
+               const float patience = 1,
+               const float pruning_absolute_threshold = 0,
+               const float pruning_relative_threshold = 0,
+               const bool stop_on_score_bound = false);
 
     std::vector<DecodingResult>
     search(layers::Decoder& decoder,
@@ -58,7 +71,10 @@ namespace ctranslate2 {
            const size_t num_hypotheses = 1,
            const bool include_eos_in_hypotheses = true,
            const std::vector<std::shared_ptr<LogitsProcessor>>& logits_processors = {},
-           const std::vector<std::vector<size_t>>* prefix_ids = nullptr) const override;
+           const std::vector<std::vector<size_t>>* prefix_ids = nullptr,
+           const size_t return_topk_logprobs = 0,
+           const StopSequences* stop_sequences = nullptr,
+           const std::vector<std::pair<dim_t, dim_t>>* attention_argmax_ranges = nullptr) const override;
 
   private:
     const dim_t _beam_size;
@@ -66,6 +82,9 @@ namespace ctranslate2 {
     const float _coverage_penalty;
     const float _prefix_bias_beta;
     const size_t _max_candidates;
+    const float _pruning_absolute_threshold;
+    const float _pruning_relative_threshold;
+    const bool _stop_on_score_bound;
   };
 
   class BiasedDecoder {
@@ -106,7 +125,10 @@ namespace ctranslate2 {
            const size_t num_hypotheses = 1,
            const bool include_eos_in_hypotheses = true,
            const std::vector<std::shared_ptr<LogitsProcessor>>& logits_processors = {},
-           const std::vector<std::vector<size_t>>* prefix_ids = nullptr) const override;
+           const std::vector<std::vector<size_t>>* prefix_ids = nullptr,
+           const size_t return_topk_logprobs = 0,
+           const StopSequences* stop_sequences = nullptr,
+           const std::vector<std::pair<dim_t, dim_t>>* attention_argmax_ranges = nullptr) const override;
 
   private:
     const float _length_penalty;
@@ -117,6 +139,9 @@ namespace ctranslate2 {
   struct DecodingOptions {
     size_t beam_size = 1;
     float patience = 1;
+    float beam_pruning_absolute_threshold = 0;
+    float beam_pruning_relative_threshold = 0;
+    bool beam_score_bound = false;
     float length_penalty = 0;
     float coverage_penalty = 0;
     float repetition_penalty = 1;
@@ -131,11 +156,27 @@ namespace ctranslate2 {
     bool include_eos_in_hypotheses = true;
     bool return_scores = false;
     bool return_attention = false;
+    size_t return_topk_logprobs = 0;
+    // Exit the decoder layers when the next token probability is above this threshold
+    // (set 0 to disable). The exit is tested every early_exit_interval layers.
+    float early_exit_threshold = 0;
+    size_t early_exit_interval = 2;
+    // Compute the logits of the incremental steps with an INT8 copy of the output layer and
+    // recompute exactly the two_stage_candidates best tokens (set 0 to disable). With
+    // two_stage_exact_log_probs, the other tokens are excluded from the softmax.
+    size_t two_stage_candidates = 0;
+    bool two_stage_exact_log_probs = false;
+    // Return the source position with the highest attention at each step, without keeping
+    // the attention vectors. The position is searched in the [begin, end) range of each batch
+    // (defaults to all positions) and is relative to the range begin.
+    bool return_attention_argmax = false;
+    std::vector<std::pair<dim_t, dim_t>> attention_argmax_ranges;
     bool return_alternatives = false;
     float min_alternative_expansion_prob = 0;
     std::vector<size_t> disable_ids;
     std::vector<size_t> disable_ids_begin;
     std::vector<std::vector<size_t>> disable_sequences;
+    std::vector<std::vector<size_t>> stop_sequences;
     std::vector<std::shared_ptr<LogitsProcessor>> logits_processors;
   };
 
@@ -2,9 +2,11 @@
 
 #include <algorithm>
 #include <limits>
+#include <unordered_map>
 
 #include "ops/tile.h"
 #include "storage_view.h"
+#include "vocabulary.h"
 
 namespace ctranslate2 {
 
@@ -174,4 +176,32 @@ namespace ctranslate2 {
     const std::vector<size_t> _ids;
   };
 
+  // Automaton matching stop sequences in the generated tokens (Aho-Corasick).
+  //
+  // Each hypothesis keeps a state that is updated with every generated token. The hypothesis
+  // can be finished as soon as its state matches one of the stop sequences.
+  class StopSequences {
+  public:
+    StopSequences(const std::vector<std::vector<size_t>>& sequences);
+
+    static constexpr int32_t initial_state = 0;
+
+    int32_t next_state(int32_t state, size_t id) const;
+
+    bool is_match(int32_t state) const {
+      return _is_match[state];
+    }
+
+  private:
+    std::vector<std::unordered_map<size_t, int32_t>> _transitions;
+    std::vector<int32_t> _fallback;
+    std::vector<bool> _is_match;
+  };
+
+  // Converts the stop sequences to ids. The tokens should be in the vocabulary: an unknown
+  // token would otherwise be mapped to the unknown token id and match any unknown token.
+  std::vector<std::vector<size_t>>
+  stop_sequences_to_ids(const Vocabulary& vocabulary,
+                        const std::vector<std::vector<std::string>>& stop_sequences);
+
 }
@@ -10,6 +10,7 @@ namespace ctranslate2 {
   class Generator : public ReplicaPool<models::SequenceGeneratorReplica> {
   public:
     using ReplicaPool::ReplicaPool;
+    ~Generator();
 
     std::vector<std::future<GenerationResult>>
     generate_batch_async(const std::vector<std::vector<std::string>>& start_tokens,
@@ -23,6 +24,24 @@ namespace ctranslate2 {
                       const size_t max_batch_size = 0,
                       const BatchType batch_type = BatchType::Examples);
 
+    // Generates from a stream of start tokens and returns the results in the input order.
+    // See ResultIterator for the batching and prefetching behavior.
+    std::unique_ptr<ResultIterator<GenerationResult>>
+    generate_iterable(std::unique_ptr<BatchReader> reader,
+                      const GenerationOptions& options = GenerationOptions(),
+                      size_t max_batch_size = 32,
+                      size_t read_batch_size = 0,
+                      BatchType batch_type = BatchType::Examples,
+                      size_t max_batches_per_replica = 0);
+
+    std::unique_ptr<ResultIterator<ScoringResult>>
+    score_iterable(std::unique_ptr<BatchReader> reader,
+                   const ScoringOptions& options = ScoringOptions(),
+                   size_t max_batch_size = 64,
+                   size_t read_batch_size = 0,
+                   BatchType batch_type = BatchType::Examples,
+                   size_t max_batches_per_replica = 0);
+
     std::future<StorageView>
     forward_batch_async(std::vector<std::vector<std::string>> tokens,
                         const bool return_log_probs);
@@ -35,6 +54,57 @@ namespace ctranslate2 {
     forward_batch_async(StorageView ids,
                         StorageView lengths,
                         const bool return_log_probs);
+
+    // Creates a session keeping the decoder state between generation calls. Each session is
+    // owned by a replica which runs all the generation calls of this session.
+    // When the session is not used for longer than idle_timeout (0 to disable), its decoder
+    // state is released and the conversation history is forwarded again on the next call.
+    // The decoder state is always released by the owning replica: when the session is
+    // destroyed, or when the generator is destroyed if the session is still alive.
+    std::shared_ptr<models::GenerationSession>
+    create_session(std::chrono::milliseconds idle_timeout = std::chrono::milliseconds(0));
+
+    // Appends tokens to the session and continues the generation.
+    // Generation sessions only support greedy search or random sampling.
+    std::future<GenerationResult>
+    generate_in_session_async(const std::shared_ptr<models::GenerationSession>& session,
+                              std::vector<std::string> tokens,
+                              const GenerationOptions& options = GenerationOptions());
+
+    // Copies the decoder state of the session to the host memory and releases the device
+    // buffers. This is a blocking .to(Device::CPU) copy run by the owning replica: the state
+    // is copied back to the device on the next call of the session.
+    void offload_session(const std::shared_ptr<models::GenerationSession>& session);
+
+    // Releases the decoder state of the sessions that exceeded their idle timeout.
+    // This method is called when a session is created or used, and returns the number
+    // of sessions that were scheduled for eviction.
+    size_t evict_idle_sessions();
+
+  private:
+    MemoryEstimateFunc get_generation_memory_estimator(const GenerationOptions& options) const;
+
+    // Releases the decoder state of a destroyed session on the replica owning it.
+    // The state is released in place once the generator is destroyed.
+    struct SessionReleaser {
+      SessionReleaser(Generator* generator_)
+        : generator(generator_)
+      {
+      }
+
+      std::mutex mutex;
+      std::condition_variable released;
+      Generator* generator;
+      size_t num_pending_releases = 0;
+    };
+
+    void release_session(models::GenerationSession* session);
+
+    std::mutex _sessions_mutex;
+    std::vector<std::weak_ptr<models::GenerationSession>> _sessions;
+    size_t _next_session_replica = 0;
+    std::shared_ptr<SessionReleaser> _session_releaser
+      = std::make_shared<SessionReleaser>(this);
   };
 
 }
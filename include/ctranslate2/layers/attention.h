@@ -12,6 +12,56 @@ namespace ctranslate2 {
     StorageView reduce_multi_head_attention(const StorageView& attention,
                                             dim_t num_heads_to_average);
 
+    // The self-attention caches can be read through a table of cache rows with shape
+    // [batch_size, rows_time]: timestep t of batch b is then stored in the cache row
+    // cache_rows[b][t]. Timesteps after the end of the table are stored in the row b.
+    //
+    // This function copies the cache of shape [num_rows, num_heads, time, head_dim] into
+    // a contiguous cache of shape [batch_size, num_heads, time, head_dim].
+    void gather_cache_rows(const StorageView& cache,
+                           const StorageView& cache_rows,
+                           StorageView& output);
+
+    // Caches the relative position tensors of an attention layer so that they are not
+    // rebuilt on the host and copied to the device on every call.
+    class RelativePositionCache {
+    public:
+      // Returns the relative positions used to index the relative position keys and values.
+      const StorageView& positions(dim_t length,
+                                   dim_t max_position,
+                                   bool with_cache,
+                                   Device device);
+
+      // Returns the relative attention bias with shape [num_heads, query_length, key_length].
+      // When a single query is passed (incremental decoding), only this row is computed.
+      const StorageView& bias(const StorageView& relative_attention_bias,
+                              dim_t query_length,
+                              dim_t key_length,
+                              dim_t max_distance,
+                              bool bidirectional,
+                              dim_t query_offset = 0);
+
+    private:
+      void update_bias_table(const StorageView& relative_attention_bias,
+                             dim_t max_time,
+                             dim_t max_distance,
+                             bool bidirectional);
+
+      StorageView _positions;
+      StorageView _positions_view;
+      dim_t _positions_length = 0;
+      bool _positions_with_cache = false;
+
+      // Bias of each relative position in [-(max_time - 1), max_time - 1].
+      StorageView _bias_table;  // Shape: [2 * max_time - 1, num_heads]
+      dim_t _bias_table_max_time = 0;
+
+      StorageView _bias;
+      dim_t _bias_query_length = 0;
+      dim_t _bias_key_length = 0;
+      dim_t _bias_query_offset = 0;
+    };
+
     class MultiHeadAttention : public Layer
     {
     public:
@@ -31,7 +81,14 @@ namespace ctranslate2 {
                       StorageView* cached_values = nullptr,
                       StorageView* attention = nullptr,
                       const Padder* queries_padder = nullptr,
-                      const Padder* values_padder = nullptr) const;
+                      const Padder* values_padder = nullptr,
+                      const StorageView* cache_rows = nullptr) const;
+
+      // Appends the keys and values projected from the queries to the self-attention cache
+      // without computing the attention.
+      void append_to_cache(const StorageView& queries,
+                           StorageView& cached_keys,
+                           StorageView& cached_values) const;
 
       bool has_relative_position() const {
         return _relative_position_keys || _relative_attention_bias;
@@ -55,6 +112,7 @@ namespace ctranslate2 {
       const StorageView* _relative_position_values;
       dim_t _maximum_relative_position;
       const float _queries_scale;
+      mutable RelativePositionCache _relative_position_cache;
     };
 
   }
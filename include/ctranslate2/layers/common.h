@@ -132,7 +132,32 @@ namespace ctranslate2 {
       dim_t output_size() const override;
       void operator()(const StorageView& input, StorageView& output) const;
       void select_weights(const StorageView* index, const StorageView* extra_bias = nullptr);
+
+      // Returns true if compute_two_stage can be used: the weight should be a float weight
+      // that is not pre-packed, and the device should support INT8 GEMM.
+      bool supports_two_stage() const;
+      // Computes the output in two stages. Approximate outputs are first computed with an
+      // INT8 copy of the weight, then the num_candidates largest approximate outputs of each
+      // row are recomputed with the float weight. The other outputs keep their approximate
+      // value, or are set to the lowest value if exact_only is set. The INT8 copy is created
+      // on the first call and kept with the layer until release_two_stage is called or the
+      // weights are selected again.
+      void compute_two_stage(const StorageView& input,
+                             StorageView& output,
+                             dim_t num_candidates,
+                             bool exact_only);
+      // Second stage of compute_two_stage: recomputes with the float weight the
+      // num_candidates largest values of each row of output, which holds approximate
+      // outputs for input.
+      void rescore_candidates(const StorageView& input,
+                              StorageView& output,
+                              dim_t num_candidates,
+                              bool exact_only) const;
+      // Releases the INT8 copy created by compute_two_stage.
+      void release_two_stage();
     private:
+      void quantize_approximate_weight();
+
       bool _packed_weight;
       const StorageView& _weight;
       const StorageView* _bias;
@@ -147,6 +172,10 @@ namespace ctranslate2 {
       const ops::Gemm _gemm_op;
       const ops::Quantize _quantize_op;
       const ops::Dequantize _dequantize_op;
+      const bool _round_before_cast;
+      StorageView _approximate_weight;
+      StorageView _approximate_qscale;
+      StorageView _approximate_u8_shift_compensation;
     };
 
     class LayerNorm : public Layer
@@ -167,15 +196,28 @@ namespace ctranslate2 {
              const std::string& scope,
              dim_t stride = 1,
              dim_t padding = 0,
-             dim_t dilation = 1);
+             dim_t dilation = 1,
+             const ops::ActivationType* activation_type = nullptr);
       DataType output_type() const override;
       dim_t output_size() const override;
       dim_t input_size() const;
       void operator()(const StorageView& input, StorageView& output) const;
     private:
+      // With an int8 weight, the convolution runs as a quantized GEMM over the input
+      // windows and the bias and activation are applied when dequantizing the output.
+      void compute_quantized(const StorageView& input, StorageView& output) const;
+
+      const dim_t _stride;
+      const dim_t _padding;
       const ops::Conv1D _conv_op;
       const StorageView& _weight;
       const StorageView* _bias;
+      const StorageView* _qscale;
+      const StorageView* _u8_shift_compensation;
+      const DataType _output_type;
+      const ops::Gemm _gemm_op;
+      const ops::Quantize _quantize_op;
+      const ops::Dequantize _dequantize_op;
     };
 
   }
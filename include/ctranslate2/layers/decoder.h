@@ -11,6 +11,10 @@ namespace ctranslate2 {
 
     using DecoderState = std::unordered_map<std::string, StorageView>;
 
+    // State entry recording the cache row of each timestep when the self-attention caches
+    // are reordered lazily in beam search (see gather_cache_rows).
+    constexpr const char* cache_rows_state = "cache_rows";
+
     void zero_first_timestep(StorageView& x, dim_t step);
 
     // Base class for decoders.
@@ -48,6 +52,10 @@ namespace ctranslate2 {
       // Returns true if the state must be replicated beam_size times.
       virtual bool replicate_state(const std::string& name) const;
 
+      // Returns true if the state is a self-attention cache that can be read through
+      // the cache rows instead of being gathered after each beam search step.
+      virtual bool is_self_attention_cache(const std::string& name) const;
+
       // Restrict the output layer to a set of ids and/or resize it to a preferred size multiple.
       // Elements in restrict_ids must be unique and sorted.
       void update_output_layer(const dim_t size_multiple = 1,
@@ -73,6 +81,25 @@ namespace ctranslate2 {
         return _device;
       }
 
+      // Exits the layer stack of the incremental decoding steps when an intermediate layer
+      // predicts the next token with a probability of at least threshold in all batches,
+      // as described in https://arxiv.org/abs/2207.07061. The exit is tested every interval
+      // layers. A threshold of 0 disables the early exit. The exit statistics are reset.
+      virtual void set_early_exit(float threshold, dim_t interval = 1);
+
+      // Average number of layers run by the incremental decoding steps since the last call
+      // to set_early_exit, or 0 if no steps were recorded.
+      virtual float average_exit_depth() const;
+
+      // Computes the logits of the incremental decoding steps in two stages when the output
+      // layer supports it (see Dense::compute_two_stage): approximate logits with an INT8
+      // copy of the output projection, then exact logits for the num_candidates tokens with
+      // the best approximate logits. With exact_log_probs, the other tokens are excluded
+      // so that the log probabilities are computed from exact logits only. Otherwise their
+      // approximate logits are included in the softmax normalizer. Set 0 to disable. The
+      // INT8 copy is kept when the option is disabled so that the next decodings reuse it.
+      virtual void set_two_stage_output(dim_t num_candidates, bool exact_log_probs = false);
+
       DataType output_type() const override {
         return const_cast<Decoder&>(*this).output_layer().output_type();
       }
@@ -86,10 +113,28 @@ namespace ctranslate2 {
       virtual dim_t batch_size(const DecoderState& state) const;
       // Returns the output linear layer.
       virtual Dense& output_layer() = 0;
+      // Restricts the output layer to the selected weights (or resets it if index is null).
+      virtual void select_output_weights(const StorageView* index, const StorageView* extra_bias);
+
+      // Records the number of layers run by an incremental decoding step.
+      void record_exit_depth(dim_t depth);
 
       const Device _device;
+      float _early_exit_threshold = 0;
+      dim_t _early_exit_interval = 1;
+      dim_t _two_stage_candidates = 0;
+      bool _two_stage_exact_log_probs = false;
 
     private:
+      friend class EnsembleDecoder;
+
+      bool update_cache_rows(DecoderState& state,
+                             const StorageView& beam_indices,
+                             const bool compact) const;
+
+      const bool _reorder_caches_lazily;
+      size_t _num_exit_steps = 0;
+      size_t _total_exit_depth = 0;
       std::vector<size_t> _to_original_word_id;
       std::unordered_map<size_t, size_t> _to_output_word_id;
       dim_t _vocabulary_size = 0;
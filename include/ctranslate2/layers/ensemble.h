@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "ctranslate2/layers/decoder.h"
+#include "ctranslate2/layers/encoder.h"
+
+namespace ctranslate2 {
+  namespace layers {
+
+    // Runs the encoders of an ensemble. The outputs of the members are concatenated
+    // on the depth dimension and split again by the EnsembleDecoder.
+    class EnsembleEncoder : public Encoder {
+    public:
+      EnsembleEncoder(std::vector<std::unique_ptr<Encoder>> members);
+
+      size_t num_input_features() const override;
+      DataType output_type() const override;
+      dim_t output_size() const override;
+
+      // Output size of each member.
+      std::vector<dim_t> output_sizes() const;
+
+    protected:
+      void operator()(const std::vector<StorageView>& ids,
+                      const StorageView* lengths,
+                      StorageView& output) override;
+
+    private:
+      const std::vector<std::unique_ptr<Encoder>> _members;
+    };
+
+
+    // Runs the decoders of an ensemble and returns the average of their log probabilities
+    // in place of the logits. The decoders should have the same output vocabulary.
+    //
+    // The state of each member is stored in the ensemble state with the prefix "member_<i>/".
+    // The other entries (e.g. the memory lengths) are shared by all members.
+    class EnsembleDecoder : public Decoder {
+    public:
+      // memory_sizes is the depth of the memory of each member, if the memory is the
+      // output of an EnsembleEncoder.
+      EnsembleDecoder(std::vector<std::unique_ptr<Decoder>> members,
+                      std::vector<dim_t> memory_sizes = {});
+
+      DecoderState initial_state(bool iterative_decoding = true) const override;
+
+      void operator()(dim_t step,
+                      const StorageView& ids,
+                      DecoderState& state,
+                      StorageView* logits = nullptr,
+                      StorageView* attention = nullptr) override;
+
+      void operator()(const StorageView& ids,
+                      const StorageView& lengths,
+                      DecoderState& state,
+                      StorageView& logits) override;
+
+      bool replicate_state(const std::string& name) const override;
+      bool is_self_attention_cache(const std::string& name) const override;
+
+      // The early exit and the two-stage output are applied by each member.
+      // The average exit depth is averaged over the members.
+      void set_early_exit(float threshold, dim_t interval = 1) override;
+      float average_exit_depth() const override;
+      void set_two_stage_output(dim_t num_candidates, bool exact_log_probs = false) override;
+
+      size_t num_members() const {
+        return _members.size();
+      }
+
+    protected:
+      Dense& output_layer() override;
+      void select_output_weights(const StorageView* index,
+                                 const StorageView* extra_bias) override;
+
+    private:
+      template <typename Func>
+      void forward_members(DecoderState& state, StorageView* logits, const Func& func);
+
+      // Returns the member owning the state and the state name in the member,
+      // or (nullptr, name) if the state is shared by all members.
+      std::pair<const Decoder*, std::string> resolve_state(const std::string& name) const;
+
+      const std::vector<std::unique_ptr<Decoder>> _members;
+      const std::vector<dim_t> _memory_sizes;
+      const std::vector<std::string> _prefixes;
+    };
+
+  }
+}
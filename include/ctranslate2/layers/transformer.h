@@ -4,6 +4,7 @@
 #include "ctranslate2/layers/common.h"
 #include "ctranslate2/layers/decoder.h"
 #include "ctranslate2/layers/encoder.h"
+#include "ctranslate2/memory_planner.h"
 #include "ctranslate2/padder.h"
 
 namespace ctranslate2 {
@@ -87,7 +88,8 @@ namespace ctranslate2 {
                       StorageView& output,
                       StorageView* attention = nullptr,
                       const Padder* input_padder = nullptr,
-                      const Padder* memory_padder = nullptr) const;
+                      const Padder* memory_padder = nullptr,
+                      const StorageView* cache_rows = nullptr) const;
 
       DataType output_type() const override {
         return _ff.output_type();
@@ -97,6 +99,14 @@ namespace ctranslate2 {
         return _ff.output_size();
       }
 
+      // Fills the self-attention cache of a layer that was skipped by an early exit, using
+      // the output of the exit layer as input.
+      void propagate_state(const StorageView& input,
+                           StorageView& cached_self_attn_keys,
+                           StorageView& cached_self_attn_values) const {
+        _self_attention.append_to_cache(input, cached_self_attn_keys, cached_self_attn_values);
+      }
+
       bool has_cross_attention() const {
         return bool(_encoder_attention);
       }
@@ -150,6 +160,7 @@ namespace ctranslate2 {
 
       DecoderState initial_state(bool iterative_decoding = true) const override;
       bool replicate_state(const std::string& name) const override;
+      bool is_self_attention_cache(const std::string& name) const override;
 
       void operator()(dim_t step,
                       const StorageView& ids,
@@ -174,6 +185,17 @@ namespace ctranslate2 {
                   StorageView* attention = nullptr,
                   bool return_logits = true);
 
+      // Applies the output normalization and projection to the hidden states.
+      void compute_logits(const StorageView& hidden, StorageView& logits);
+
+      // Returns true if the output projection of this decoding step should be computed in
+      // two stages (see Decoder::set_two_stage_output).
+      bool use_two_stage_output(dim_t step, bool is_sequence) const;
+
+      // Returns true if the logits of all batches have a maximum probability greater than
+      // the early exit threshold.
+      bool is_confident(const StorageView& logits) const;
+
       const dim_t _num_heads;
       const ComputeType _compute_type;
       const Embeddings _embeddings;
@@ -190,6 +212,7 @@ namespace ctranslate2 {
       dim_t _alignment_layer;
       dim_t _alignment_heads;
       Dense _proj;
+      MemoryPlannerPtr _memory_planner;
     };
 
   }
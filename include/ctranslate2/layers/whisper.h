@@ -19,10 +19,18 @@ namespace ctranslate2 {
         return _output_norm.output_size();
       }
 
+      dim_t input_size() const {
+        return _conv1.input_size();
+      }
+
+      dim_t input_time() const {
+        return _position_embedding.num_positions() * 2;
+      }
+
     private:
+      const ops::ActivationType _conv_activation_type;
       const Conv1D _conv1;
       const Conv1D _conv2;
-      const ops::GELU _gelu;
       const ops::Transpose _transpose;
       PositionEmbedding _position_embedding;
       const dim_t _num_heads;
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "models/model.h"
+
+namespace ctranslate2 {
+
+  // Estimated memory usage of a decoding job, in bytes. The model weights are not included,
+  // but the weight copies created for the decoding are.
+  struct MemoryEstimate {
+    // Keys and values cached by the decoder at the maximum decoding length.
+    size_t cache_bytes = 0;
+    // Largest set of temporary buffers alive during a forward pass: the encoder output,
+    // the intermediate layer outputs, the attention scores, and the output logits.
+    size_t activation_bytes = 0;
+    // Weight copies alive during the decoding: the INT8 output projection of the
+    // two-stage output (see DecodingOptions::two_stage_candidates).
+    size_t weight_bytes = 0;
+
+    size_t total_bytes() const {
+      return cache_bytes + activation_bytes + weight_bytes;
+    }
+  };
+
+  // Estimates the peak memory used to decode a batch with a Transformer model, from the
+  // model dimensions. The estimate is an upper bound: all hypotheses are assumed to reach
+  // max_length, and the buffers cached by the allocators are not counted.
+  //
+  // For encoder-decoder models, input_length is the source length and max_length is the
+  // maximum target length. For decoder-only models, input_length is the prompt length and
+  // the hypotheses are extended by max_length tokens.
+  //
+  // The dimensions of each layer are read separately, so the estimate follows models with
+  // pruned attention heads or feed-forward channels. For an ensemble, the estimates of the
+  // members are summed.
+  MemoryEstimate estimate_decoding_memory(const models::Model& model,
+                                          dim_t batch_size,
+                                          dim_t beam_size,
+                                          dim_t input_length,
+                                          dim_t max_length,
+                                          dim_t two_stage_candidates = 0);
+
+}
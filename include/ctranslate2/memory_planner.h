@@ -0,0 +1,184 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "allocator.h"
+
+namespace ctranslate2 {
+
+  // Allocator serving the temporary buffers of a decoding step from a single arena.
+  //
+  // The first step of a shape class is run with the device allocator while the size and
+  // lifetime of each allocation are recorded. The allocations released before the end of
+  // the step are then assigned an offset in the arena so that buffers with disjoint
+  // lifetimes share the same memory. The following steps of the same shape class are
+  // served from these offsets without calling the device allocator. Allocations that
+  // outlive the step (e.g. the decoder outputs or the attention cache) are forwarded to
+  // the device allocator.
+  //
+  // The plan is recorded again when a step no longer matches it, for example when a buffer
+  // grows with the decoding length. Buffers that grew are then planned with some headroom.
+  //
+  // The planned allocations and releases only update tables that are sized when the plan
+  // is built, so a replayed step does not allocate host memory. A step that starts while
+  // buffers of a previous step are still using the arena is not served from the arena.
+  //
+  // Buffers that are known to outlive the step should be allocated in a
+  // ScopedDeviceAllocation so that they do not reference the planner. The other buffers
+  // can be freed from any thread. A planner created with make_memory_planner is deleted
+  // only when all the buffers it allocated are freed.
+  class MemoryPlanner : public Allocator {
+  public:
+    MemoryPlanner(Device device);
+    ~MemoryPlanner();
+
+    MemoryPlanner(const MemoryPlanner&) = delete;
+    MemoryPlanner& operator=(const MemoryPlanner&) = delete;
+
+    Device device() const {
+      return _device;
+    }
+
+    // Marks the beginning and the end of a step. Steps with the same shape class are
+    // expected to make the same sequence of allocations.
+    void begin_step(size_t shape_class);
+    void end_step();
+
+    void* allocate(size_t size, int device_index) override;
+    void free(void* ptr, int device_index) override;
+    void clear_cache() override;
+
+    // Size of the arena in bytes.
+    size_t arena_size() const {
+      return _arena_size;
+    }
+
+    // Number of allocations that were served from the arena.
+    size_t num_planned_allocations() const {
+      return _num_planned_allocations;
+    }
+
+  private:
+    friend struct MemoryPlannerDeleter;
+
+    // Marks the planner as released by its owner. Returns true if it can be deleted now.
+    bool release();
+
+    struct Block {
+      size_t size = 0;      // Size of the recorded allocation.
+      size_t capacity = 0;  // Size reserved in the arena.
+      size_t offset = 0;
+      size_t slot = 0;      // Index of the offset in Plan::slot_offsets.
+      bool in_arena = false;
+    };
+
+    struct Plan {
+      std::vector<Block> blocks;
+      // The arena blocks that should be freed before block i is allocated are
+      // due_blocks[due_offsets[i]] to due_blocks[due_offsets[i + 1] - 1].
+      std::vector<size_t> due_offsets;
+      std::vector<size_t> due_blocks;
+      // Sorted offsets of the arena blocks, to find a block from its address.
+      std::vector<size_t> slot_offsets;
+      size_t arena_size = 0;
+      bool stale = false;
+    };
+
+    enum class BlockState : unsigned char {
+      Free,
+      Live,
+      Overdue,  // Still live after the allocation that should follow its release.
+    };
+
+    struct Record {
+      size_t size;
+      size_t alloc_time;
+      size_t free_time;
+    };
+
+    enum class Mode {
+      Idle,
+      Record,
+      Replay,
+      Direct,  // All allocations are forwarded to the device allocator.
+    };
+
+    Plan build_plan(const Plan* previous_plan) const;
+    bool reserve_arena(size_t size, int device_index);
+
+    const Device _device;
+    Allocator& _allocator;
+
+    Mode _mode = Mode::Idle;
+    std::unordered_map<size_t, Plan> _plans;
+    Plan* _plan = nullptr;
+    size_t _next_block = 0;
+    size_t _time = 0;
+
+    std::vector<Record> _records;
+    std::unordered_map<void*, size_t> _recorded_ptrs;
+
+    void* _arena = nullptr;
+    size_t _arena_size = 0;
+    int _arena_device_index = -1;
+    size_t _num_planned_allocations = 0;
+
+    // State of the arena buffers, which all belong to the steps of _arena_plan.
+    const Plan* _arena_plan = nullptr;
+    std::vector<BlockState> _block_states;  // Indexed by block.
+    std::vector<size_t> _slot_blocks;       // Live block at each offset, indexed by slot.
+    size_t _num_live_arena_buffers = 0;
+    size_t _num_overdue_blocks = 0;
+
+    std::mutex _mutex;
+    size_t _num_live_buffers = 0;  // Buffers allocated through the planner and not yet freed.
+    bool _released = false;
+  };
+
+  struct MemoryPlannerDeleter {
+    void operator()(MemoryPlanner* planner) const;
+  };
+
+  using MemoryPlannerPtr = std::unique_ptr<MemoryPlanner, MemoryPlannerDeleter>;
+
+  // Creates a planner that is deleted when the returned pointer is reset and the buffers
+  // it allocated are freed.
+  MemoryPlannerPtr make_memory_planner(Device device);
+
+  // Binds a memory planner to the current thread for the duration of a step: in this scope,
+  // get_allocator(device) returns the planner for the planner device.
+  class ScopedMemoryPlan {
+  public:
+    ScopedMemoryPlan(MemoryPlanner& planner, size_t shape_class);
+    ~ScopedMemoryPlan();
+
+    ScopedMemoryPlan(const ScopedMemoryPlan&) = delete;
+    ScopedMemoryPlan& operator=(const ScopedMemoryPlan&) = delete;
+
+  private:
+    MemoryPlanner& _planner;
+    MemoryPlanner* _previous_planner;
+  };
+
+  // Allocates the buffers of the current thread with the device allocator within this scope,
+  // even if a memory plan is active or started in a nested scope. This should be used for
+  // the buffers that outlive the step, e.g. the attention cache or the decoder outputs.
+  class ScopedDeviceAllocation {
+  public:
+    ScopedDeviceAllocation();
+    ~ScopedDeviceAllocation();
+
+    ScopedDeviceAllocation(const ScopedDeviceAllocation&) = delete;
+    ScopedDeviceAllocation& operator=(const ScopedDeviceAllocation&) = delete;
+  };
+
+  // Returns the memory planner bound to the current thread for this device, if any.
+  MemoryPlanner* get_thread_memory_planner(Device device);
+
+  // Returns true if the decoding steps should use a memory planner (opt-in).
+  bool use_memory_planner();
+
+}
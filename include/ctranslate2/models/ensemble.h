@@ -0,0 +1,33 @@
+#pragma once
+
+#include "model.h"
+
+namespace ctranslate2 {
+  namespace models {
+
+    // An ensemble of models sharing the same vocabularies. The replicas created from this
+    // model run all members in the same search and average their log probabilities.
+    //
+    // The members are currently expected to be Transformer models.
+    class EnsembleModel : public Model {
+    public:
+      EnsembleModel(std::vector<std::shared_ptr<const Model>> members);
+
+      const std::vector<std::shared_ptr<const Model>>& members() const {
+        return _members;
+      }
+
+      std::unique_ptr<SequenceToSequenceReplica> as_sequence_to_sequence() const override;
+      std::unique_ptr<SequenceGeneratorReplica> as_sequence_generator() const override;
+
+      std::shared_ptr<const Model> copy_to(Device device, int device_index = 0) const override;
+
+    protected:
+      std::unique_ptr<Model> clone() const override;
+
+    private:
+      std::vector<std::shared_ptr<const Model>> _members;
+    };
+
+  }
+}
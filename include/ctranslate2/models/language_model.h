@@ -1,5 +1,8 @@
 #pragma once
 
+#include <chrono>
+#include <mutex>
+
 #include "ctranslate2/layers/decoder.h"
 #include "ctranslate2/models/model.h"
 #include "ctranslate2/generation.h"
@@ -22,6 +25,54 @@ namespace ctranslate2 {
     };
 
 
+    // State of a multi-turn generation. The decoder state is kept on the replica owning the
+    // session so that the next turns do not forward the conversation history again.
+    // The decoder state is only accessed by the owning replica.
+    class GenerationSession {
+    public:
+      GenerationSession(size_t replica_index,
+                        std::chrono::milliseconds idle_timeout = std::chrono::milliseconds(0));
+
+      // Index of the replica owning the decoder state.
+      size_t replica_index() const {
+        return _replica_index;
+      }
+
+      // Duration after which the decoder state of an unused session can be released
+      // (0 to keep the state until the session is destroyed).
+      std::chrono::milliseconds idle_timeout() const {
+        return _idle_timeout;
+      }
+
+      // Token ids of the conversation, including the generated tokens.
+      std::vector<size_t> ids() const;
+
+      // Number of leading ids that are cached in the decoder state.
+      size_t num_cached_ids() const;
+
+      // Whether the decoder state was copied to the host memory with offload_session.
+      bool is_offloaded() const;
+
+      // Whether the session was not used for longer than its idle timeout.
+      bool is_idle(std::chrono::steady_clock::time_point now
+                   = std::chrono::steady_clock::now()) const;
+
+    private:
+      friend class SequenceGeneratorReplica;
+      friend class DecoderReplica;
+
+      const size_t _replica_index;
+      const std::chrono::milliseconds _idle_timeout;
+
+      mutable std::mutex _mutex;
+      std::vector<size_t> _ids;
+      size_t _num_cached_ids = 0;
+      bool _offloaded = false;
+      std::chrono::steady_clock::time_point _last_use;
+      layers::DecoderState _state;
+    };
+
+
     // Base class for generative language models.
     class SequenceGeneratorReplica : public ModelReplica {
     public:
@@ -31,6 +82,15 @@ namespace ctranslate2 {
       {
       }
 
+      // The replica runs replica_model (e.g. an ensemble) but reads the vocabulary and
+      // options from model.
+      SequenceGeneratorReplica(const std::shared_ptr<const Model>& replica_model,
+                               const std::shared_ptr<const LanguageModel>& model)
+        : ModelReplica(replica_model)
+        , _model(model)
+      {
+      }
+
       static std::unique_ptr<SequenceGeneratorReplica> create_from_model(const Model& model) {
         return model.as_sequence_generator();
       }
@@ -43,6 +103,21 @@ namespace ctranslate2 {
       generate(const std::vector<std::vector<std::string>>& start_tokens,
                const GenerationOptions& options = GenerationOptions());
 
+      // Appends tokens to the session and continues the generation from the cached
+      // decoder state. The result contains the appended and generated tokens.
+      GenerationResult
+      generate_in_session(GenerationSession& session,
+                          const std::vector<std::string>& tokens,
+                          const GenerationOptions& options = GenerationOptions());
+
+      // Moves the cached decoder state to the host memory. The state is moved back to the
+      // model device on the next generation.
+      void offload_session(GenerationSession& session);
+
+      // Releases the cached decoder state. The conversation history is forwarded again
+      // on the next generation.
+      void evict_session(GenerationSession& session);
+
       StorageView forward(const std::vector<std::vector<std::string>>& tokens,
                           const bool return_log_probs);
       StorageView forward(const std::vector<std::vector<size_t>>& ids,
@@ -69,6 +144,11 @@ namespace ctranslate2 {
       run_generation(const std::vector<std::vector<std::string>>& start_tokens,
                      const GenerationOptions& options) = 0;
 
+      virtual GenerationResult
+      run_generation_in_session(GenerationSession& session,
+                                const std::vector<size_t>& ids,
+                                const GenerationOptions& options);
+
       virtual StorageView forward(const StorageView& ids, const StorageView& lengths) = 0;
 
     private:
@@ -81,6 +161,9 @@ namespace ctranslate2 {
     public:
       DecoderReplica(const std::shared_ptr<const LanguageModel>& model,
                      std::unique_ptr<layers::Decoder> decoder);
+      DecoderReplica(const std::shared_ptr<const Model>& replica_model,
+                     const std::shared_ptr<const LanguageModel>& model,
+                     std::unique_ptr<layers::Decoder> decoder);
 
     protected:
       bool skip_scoring(const std::vector<std::string>& tokens,
@@ -95,8 +178,15 @@ namespace ctranslate2 {
       run_generation(const std::vector<std::vector<std::string>>& start_tokens,
                      const GenerationOptions& options) override;
 
+      GenerationResult
+      run_generation_in_session(GenerationSession& session,
+                                const std::vector<size_t>& ids,
+                                const GenerationOptions& options) override;
+
       StorageView forward(const StorageView& ids, const StorageView& lengths) override;
 
+      void run_warmup(size_t batch_size, size_t length, size_t beam_size) override;
+
     private:
       const std::shared_ptr<const LanguageModel> _model;
       const std::unique_ptr<layers::Decoder> _decoder;
@@ -22,14 +22,18 @@ namespace ctranslate2 {
     // Base class for models.
     class Model : public std::enable_shared_from_this<Model> {
     public:
+      // num_threads is the number of threads running the model on CPU. It is used to tune
+      // the GEMM backends with CT2_AUTOTUNE_GEMM=1 (0 for the current number of threads).
       static std::shared_ptr<const Model> load(const std::string& path,
                                                Device device = Device::CPU,
                                                int device_index = 0,
-                                               ComputeType compute_type = ComputeType::DEFAULT);
+                                               ComputeType compute_type = ComputeType::DEFAULT,
+                                               size_t num_threads = 0);
       static std::shared_ptr<const Model> load(ModelReader& model_reader,
                                                Device device = Device::CPU,
                                                int device_index = 0,
-                                               ComputeType compute_type = ComputeType::DEFAULT);
+                                               ComputeType compute_type = ComputeType::DEFAULT,
+                                               size_t num_threads = 0);
 
       virtual std::unique_ptr<SequenceToSequenceReplica> as_sequence_to_sequence() const;
       virtual std::unique_ptr<SequenceGeneratorReplica> as_sequence_generator() const;
@@ -88,7 +92,7 @@ namespace ctranslate2 {
       void set_device(const Device device, const int index = 0);
 
       // Copy the model to another device.
-      std::shared_ptr<const Model> copy_to(Device device, int device_index = 0) const;
+      virtual std::shared_ptr<const Model> copy_to(Device device, int device_index = 0) const;
 
       const StorageView* get_variable_if_exists(const std::string& name) const;
       const StorageView& get_variable(const std::string& name) const;
@@ -115,6 +119,12 @@ namespace ctranslate2 {
       // A flag is a boolean attribute.
       bool get_flag_with_default(const std::string& name, bool default_value) const;
 
+      // Number of attention heads of older model specifications that do not save it,
+      // or 0 if unknown.
+      virtual dim_t default_num_heads() const {
+        return 0;
+      }
+
       template <typename Enum>
       Enum get_enum_value(const std::string& name) const {
         return static_cast<Enum>(get_attribute_with_default<int32_t>(name, 0));
@@ -145,13 +155,28 @@ namespace ctranslate2 {
       virtual std::unique_ptr<Model> clone() const = 0;
 
     private:
-      void process_linear_weights();
+      void process_linear_weights(size_t num_threads);
       void set_compute_type(ComputeType type, Device device, int device_index);
       void ensure_dtype(const std::string& name,
                         StorageView& variable,
                         const DataType target_dtype);
       ComputeType infer_compute_type() const;
 
+      // Structured pruning, applied at load time from the manifest pruning.json.
+      void apply_pruning(const nlohmann::json& manifest);
+      dim_t prune_attention_heads(const std::string& scope, const nlohmann::json& removed);
+      dim_t prune_ffn_channels(const std::string& scope, const nlohmann::json& removed);
+      dim_t prune_linear_outputs(const std::string& scope,
+                                 dim_t block_size,
+                                 const std::vector<dim_t>& blocks);
+      dim_t prune_linear_inputs(const std::string& scope,
+                                dim_t block_size,
+                                const std::vector<dim_t>& blocks);
+      dim_t prune_variable(const std::string& name,
+                           dim_t axis,
+                           dim_t block_size,
+                           const std::vector<dim_t>& blocks);
+
       Device _device = Device::CPU;
       int _device_index = 0;
       size_t _binary_version = 0;
@@ -179,16 +204,31 @@ namespace ctranslate2 {
     public:
       ModelLoader(const std::string& model_path);
       ModelLoader(const std::shared_ptr<ModelReader>& model_reader);
+      // Loads an ensemble of the models (see EnsembleModel).
+      ModelLoader(const std::vector<std::string>& model_paths);
 
       // Load a model replica on each device ID configured in device_indices.
       // Replicas on the same device ID will reference the same model instance.
       std::vector<std::shared_ptr<const Model>> load() const;
 
       std::shared_ptr<ModelReader> model_reader;
+      // Additional models to ensemble with the model of model_reader.
+      std::vector<std::shared_ptr<ModelReader>> ensemble_model_readers;
       Device device = Device::CPU;
       std::vector<int> device_indices = {0};
       size_t num_replicas_per_device = 1;
       ComputeType compute_type = ComputeType::DEFAULT;
+      // Number of threads of each CPU replica (0 for the current number of threads).
+      size_t num_threads_per_replica = 0;
+    };
+
+    struct WarmupOptions {
+      // Shapes of the synthetic batches as (batch size, sequence length) pairs.
+      std::vector<std::pair<size_t, size_t>> batch_shapes = {{1, 16}};
+      // Beam size used to decode the synthetic batches.
+      size_t beam_size = 1;
+      // Read each memory page of the model weights before running the batches.
+      bool touch_weights = true;
     };
 
     // Base class for replicas.
@@ -206,6 +246,19 @@ namespace ctranslate2 {
         return _model;
       }
 
+      // Runs synthetic batches so that the first real requests do not pay for one-time
+      // initializations such as page faults on the weights or allocator cache misses.
+      void warmup(const WarmupOptions& options = WarmupOptions());
+
+    protected:
+      // Runs a synthetic batch with the given shape. Replicas that do not implement
+      // this method are only warmed up by touching the model weights.
+      virtual void run_warmup(size_t batch_size, size_t length, size_t beam_size) {
+        (void)batch_size;
+        (void)length;
+        (void)beam_size;
+      }
+
     private:
       const std::shared_ptr<const Model> _model;
     };
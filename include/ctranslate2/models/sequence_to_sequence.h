@@ -105,6 +105,13 @@ namespace ctranslate2 {
                             std::unique_ptr<layers::Encoder> encoder,
                             std::unique_ptr<layers::Decoder> decoder);
 
+      // The replica runs replica_model (e.g. an ensemble) but reads the vocabularies and
+      // options from model.
+      EncoderDecoderReplica(const std::shared_ptr<const Model>& replica_model,
+                            const std::shared_ptr<const SequenceToSequenceModel>& model,
+                            std::unique_ptr<layers::Encoder> encoder,
+                            std::unique_ptr<layers::Decoder> decoder);
+
       layers::Encoder& encoder() {
         return *_encoder;
       }
@@ -134,6 +141,8 @@ namespace ctranslate2 {
                       const std::vector<std::vector<std::string>>& target_prefix,
                       const TranslationOptions& options) override;
 
+      void run_warmup(size_t batch_size, size_t length, size_t beam_size) override;
+
     private:
       std::vector<std::vector<std::vector<size_t>>>
       make_source_ids(const std::vector<std::vector<std::vector<std::string>>>& source_features,
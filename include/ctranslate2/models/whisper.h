@@ -9,6 +9,59 @@
 namespace ctranslate2 {
   namespace models {
 
+    // Options of the voice activity detection run on the log-Mel spectrogram.
+    struct WhisperVadOptions {
+      // Minimum energy above the noise floor (in dB) for a frame to be detected as speech.
+      // The noise floor is the 10th percentile of the frame energies.
+      float energy_threshold = 15;
+
+      // Minimum spectral flux (in dB) for a frame to be detected as a speech onset when
+      // its energy is above half the energy threshold.
+      float flux_threshold = 8;
+
+      // Speech regions shorter than this number of frames are dropped.
+      size_t min_speech_frames = 10;
+
+      // Silences shorter than this number of frames are kept.
+      size_t min_silence_frames = 50;
+
+      // Number of frames kept before and after each speech region.
+      size_t speech_pad_frames = 20;
+
+      // When the energy of every frame is above this level (in dB), the features are
+      // continuous speech and are kept entirely.
+      float absolute_energy_threshold = 0;
+    };
+
+    // Speech region of the input features, as a [start, end) range of frames.
+    using SpeechRegion = std::pair<dim_t, dim_t>;
+
+    // Detects the speech regions of a log-Mel spectrogram with shape [n_mels, n_frames]
+    // from the frame energy and the spectral flux.
+    std::vector<SpeechRegion> detect_speech(const StorageView& features,
+                                            const WhisperVadOptions& options = {});
+
+    struct WhisperSpeechWindows {
+      // Windows of speech with shape [num_windows, n_mels, window_frames].
+      StorageView features;
+
+      // Speech regions of the input features packed in each window, in order.
+      std::vector<std::vector<SpeechRegion>> regions;
+
+      // Maps a time in seconds relative to the start of a window to the time in the
+      // input features. A time between two regions is mapped to the end of the first
+      // region if is_end is set (e.g. for the end of a segment), and to the start of the
+      // second region otherwise.
+      float to_input_time(size_t window, float time, bool is_end = false) const;
+    };
+
+    // Concatenates the speech regions of a log-Mel spectrogram with shape
+    // [n_mels, n_frames] into windows of window_frames frames, so that the silences are
+    // not encoded. Regions longer than a window are split.
+    WhisperSpeechWindows pack_speech(const StorageView& features,
+                                     const WhisperVadOptions& options = {},
+                                     dim_t window_frames = 3000);
+
     struct WhisperOptions {
       // Beam size to use for beam search (set 1 to run greedy search).
       size_t beam_size = 5;
@@ -57,6 +110,13 @@ namespace ctranslate2 {
       // List of token IDs to suppress.
       // -1 will suppress a default set of symbols as defined in the model config.json file.
       std::vector<int> suppress_tokens = {-1};
+
+      // Skip the windows without speech and move the silences of the other windows to
+      // the end before encoding. The timestamps are mapped back to the input features.
+      bool vad_filter = false;
+
+      // Options of the voice activity detection used by vad_filter.
+      WhisperVadOptions vad_options;
     };
 
     struct WhisperGenerationResult {
@@ -101,6 +161,8 @@ namespace ctranslate2 {
       void initialize(ModelReader& model_reader) override;
 
     private:
+      void quantize_conv_weight(const std::string& name);
+
       std::shared_ptr<const Vocabulary> _vocabulary;
     };
 
@@ -127,6 +189,9 @@ namespace ctranslate2 {
       std::vector<std::vector<std::pair<std::string, float>>>
       detect_language(const StorageView& features);
 
+    protected:
+      void run_warmup(size_t batch_size, size_t length, size_t beam_size) override;
+
     private:
       const std::shared_ptr<const WhisperModel> _model;
       const std::unique_ptr<layers::WhisperEncoder> _encoder;
@@ -139,6 +204,11 @@ namespace ctranslate2 {
       bool _is_multilingual;
 
       StorageView encode(const StorageView& features);
+
+      std::vector<WhisperGenerationResult>
+      generate_with_vad(const StorageView& features,
+                        const std::vector<std::vector<size_t>>& prompts,
+                        const WhisperOptions& options);
     };
 
     class Whisper : public ReplicaPool<WhisperReplica> {
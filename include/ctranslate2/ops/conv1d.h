@@ -8,7 +8,10 @@ namespace ctranslate2 {
 
     class Conv1D : public Op {
     public:
-      Conv1D(dim_t stride = 1, dim_t padding = 0, dim_t dilation = 1);
+      Conv1D(dim_t stride = 1,
+             dim_t padding = 0,
+             dim_t dilation = 1,
+             const ActivationType* activation_type = nullptr);
 
       void operator()(const StorageView& input,
                       const StorageView& weight,
@@ -23,6 +26,7 @@ namespace ctranslate2 {
       dim_t _stride;
       dim_t _padding;
       dim_t _dilation;
+      const ActivationType* _activation_type;
 
       void operator()(const StorageView& input,
                       const StorageView& weight,
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <ostream>
 #include <string>
 
@@ -11,6 +13,10 @@ namespace ctranslate2 {
 #ifdef CT2_ENABLE_PROFILING
 #  define PROFILE(NAME) ctranslate2::ScopeProfiler scope_profiler(NAME)
 
+  // Values of the hardware counters: cycles, instructions, LLC misses, dTLB misses,
+  // and branch misses.
+  using HardwareCounterValues = std::array<uint64_t, 5>;
+
   // Times of profilers created in different threads with the same name are accumulated.
   class ScopeProfiler {
   public:
@@ -21,6 +27,8 @@ namespace ctranslate2 {
     ScopeProfiler* _parent = nullptr;
     std::string _name;
     std::chrono::high_resolution_clock::time_point _start;
+    HardwareCounterValues _start_counters;
+    bool _count_hardware_events = false;
   };
 
 #else
@@ -29,7 +37,15 @@ namespace ctranslate2 {
 
 #define PROFILE_FUN PROFILE(std::string(__FILE__) + ":" + std::string(__func__))
 
-  void init_profiling(Device device, size_t num_threads = 1);  // Not thread-safe.
+  // When hardware_counters is enabled, the Linux perf events (cycles, instructions,
+  // LLC misses, dTLB misses, and branch misses) are also counted in each scope and thread.
+  // The events are counted in the thread that runs the scope, so the work of other threads
+  // (e.g. the OpenMP threads) is not included. Counters that cannot be opened (e.g. when
+  // perf_event_paranoid is too restrictive) are skipped with a warning, and are reported
+  // as "-" for the threads where they could not be opened.
+  void init_profiling(Device device,
+                      size_t num_threads = 1,
+                      bool hardware_counters = false);  // Not thread-safe.
   void dump_profiling(std::ostream& os);  // Not thread-safe.
 
 }
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <future>
+#include <mutex>
 
 #include "batch_reader.h"
+#include "memory_estimator.h"
 #include "models/model.h"
+#include "result_iterator.h"
 #include "thread_pool.h"
 #include "utils.h"
 
@@ -14,6 +20,13 @@ namespace ctranslate2 {
     size_t num_threads_per_replica = 0;
     long max_queued_batches = 0;
     int cpu_core_offset = -1;
+    // Maximum batch size used when a request does not set one (0 for no limit).
+    size_t max_batch_size = 0;
+    // Memory budget of a decoding batch in bytes, as predicted by estimate_decoding_memory
+    // (0 for no limit). Larger batches are split, and an example that does not fit alone
+    // is rejected with an error. Since a replica runs one batch at a time, the other batches
+    // wait in the queue.
+    size_t max_memory_per_replica = 0;
   };
 
   template <typename Replica>
@@ -94,6 +107,28 @@ namespace ctranslate2 {
       post_func(std::move(wrapped_func), std::move(promises));
     }
 
+    // Posts a function and return its result as a future.
+    // The function will be run with the replica at the given index, for example because
+    // the replica owns some state used by the function.
+    // The function must have the signature: Result(Replica&)
+    template <typename Result, typename Func>
+    std::future<Result> post_to_replica(size_t replica_index, Func func) {
+      if (replica_index >= num_replicas())
+        throw std::invalid_argument("Invalid replica index " + std::to_string(replica_index));
+
+      auto wrapped_func = [func = std::move(func)]() {
+        std::vector<Result> results;
+        results.reserve(1);
+        results.emplace_back(func(get_thread_replica()));
+        return results;
+      };
+
+      std::vector<std::promise<Result>> promises(1);
+      auto future = promises[0].get_future();
+      post_func(std::move(wrapped_func), std::move(promises), replica_index);
+      return future;
+    }
+
     // Number of batches in the work queue.
     size_t num_queued_batches() const {
       return _thread_pool->num_queued_jobs();
@@ -134,6 +169,53 @@ namespace ctranslate2 {
       }
     }
 
+    // Runs synthetic batches on all replicas in parallel and returns the warmup time
+    // of each replica in milliseconds.
+    // This method should be called before submitting other requests to the pool.
+    std::vector<double> warmup(const models::WarmupOptions& options = models::WarmupOptions()) {
+      struct Barrier {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t remaining;
+      };
+
+      const size_t num_workers = num_replicas();
+      auto barrier = std::make_shared<Barrier>();
+      barrier->remaining = num_workers;
+
+      // The workers wait for each other before running the warmup, so that each worker
+      // takes exactly one job from the shared queue.
+      auto func = [this, barrier, options](Replica& replica) {
+        {
+          std::unique_lock<std::mutex> lock(barrier->mutex);
+          if (--barrier->remaining == 0)
+            barrier->cv.notify_all();
+          else
+            barrier->cv.wait(lock, [&barrier]{ return barrier->remaining == 0; });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        replica.warmup(options);
+        const auto end = std::chrono::steady_clock::now();
+
+        const double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        return std::make_pair(get_replica_index(replica), elapsed);
+      };
+
+      std::vector<std::future<std::pair<size_t, double>>> futures;
+      futures.reserve(num_workers);
+      for (size_t i = 0; i < num_workers; ++i)
+        futures.emplace_back(post<std::pair<size_t, double>>(func));
+
+      std::vector<double> times(num_workers, 0);
+      for (auto& future : futures) {
+        const auto result = future.get();
+        times[result.first] = result.second;
+      }
+
+      return times;
+    }
+
     // Clears the cache of each worker.
     // This method is not thread-safe.
     void clear_cache() const {
@@ -145,25 +227,81 @@ namespace ctranslate2 {
       }
     }
 
+    // Estimates the memory used to decode a batch on one replica (see memory_estimator.h).
+    MemoryEstimate estimate_decoding_memory(size_t batch_size,
+                                            size_t beam_size,
+                                            size_t input_length,
+                                            size_t max_length,
+                                            size_t two_stage_candidates = 0) const {
+      return ctranslate2::estimate_decoding_memory(*get_first_replica().model(),
+                                                   batch_size,
+                                                   beam_size,
+                                                   input_length,
+                                                   max_length,
+                                                   two_stage_candidates);
+    }
+
   protected:
+    // Returns the estimated memory usage of a batch in bytes.
+    using MemoryEstimateFunc = std::function<size_t(const Batch&)>;
+
+    // Returns true if the current thread runs the replica at this index.
+    bool is_replica_thread(size_t replica_index) const {
+      return _thread_pool->is_local_worker(replica_index);
+    }
+
     const Replica& get_first_replica() const {
       auto& worker = static_cast<ReplicaWorker<Replica>&>(_thread_pool->get_worker(0));
       return worker.replica();
     }
 
+    // Returns a function estimating the memory usage of decoding a batch, or an empty
+    // function if no memory budget is configured. The second stream of the examples,
+    // if any, is a target prefix.
+    MemoryEstimateFunc get_decoding_memory_estimator(size_t beam_size,
+                                                     size_t max_length,
+                                                     size_t max_input_length = 0,
+                                                     size_t two_stage_candidates = 0) const {
+      if (_max_memory_per_replica == 0)
+        return nullptr;
+
+      return [model = get_first_replica().model(),
+              beam_size,
+              max_length,
+              max_input_length,
+              two_stage_candidates](const Batch& batch) {
+        size_t input_length = 0;
+        size_t prefix_length = 0;
+        for (const auto& example : batch.examples) {
+          input_length = std::max(input_length, example.length(0));
+          prefix_length = std::max(prefix_length, example.length(1));
+        }
+        if (max_input_length > 0)
+          input_length = std::min(input_length, max_input_length);
+
+        return ctranslate2::estimate_decoding_memory(*model,
+                                                     batch.num_examples(),
+                                                     beam_size,
+                                                     input_length,
+                                                     prefix_length + max_length,
+                                                     two_stage_candidates).total_bytes();
+      };
+    }
+
     template <typename Result, typename Func>
     std::vector<std::future<Result>>
     post_examples(const std::vector<Example>& examples,
                   size_t max_batch_size,
                   BatchType batch_type,
-                  const Func& func) {
+                  const Func& func,
+                  const MemoryEstimateFunc& estimate_memory = nullptr) {
       std::vector<std::promise<Result>> promises(examples.size());
       std::vector<std::future<Result>> futures;
       futures.reserve(promises.size());
       for (auto& promise : promises)
         futures.emplace_back(promise.get_future());
 
-      post_examples(examples, max_batch_size, batch_type, std::move(promises), func);
+      post_examples(examples, max_batch_size, batch_type, std::move(promises), func, estimate_memory);
 
       return futures;
     }
@@ -173,16 +311,28 @@ namespace ctranslate2 {
                        size_t max_batch_size,
                        BatchType batch_type,
                        std::vector<std::promise<Result>> promises,
-                       const Func& func) {
+                       const Func& func,
+                       const MemoryEstimateFunc& estimate_memory = nullptr) {
+      if (max_batch_size == 0)
+        max_batch_size = _default_max_batch_size;
+
       for (auto& batch : rebatch_input(examples, max_batch_size, batch_type)) {
-        std::vector<std::promise<Result>> batch_promises;
-        batch_promises.reserve(batch.num_examples());
-        for (const size_t index : batch.example_index)
-          batch_promises.emplace_back(std::move(promises[index]));
-
-        post_batch<Result>(
-          [batch = std::move(batch), func](Replica& replica) { return func(replica, batch); },
-          std::move(batch_promises));
+        for (auto& part : split_to_memory_budget(std::move(batch), estimate_memory)) {
+          std::vector<std::promise<Result>> batch_promises;
+          batch_promises.reserve(part.batch.num_examples());
+          for (const size_t index : part.batch.example_index)
+            batch_promises.emplace_back(std::move(promises[index]));
+
+          if (part.error) {
+            for (auto& promise : batch_promises)
+              promise.set_exception(part.error);
+            continue;
+          }
+
+          post_batch<Result>(
+            [batch = std::move(part.batch), func](Replica& replica) { return func(replica, batch); },
+            std::move(batch_promises));
+        }
       }
     }
 
@@ -192,7 +342,8 @@ namespace ctranslate2 {
                          const Func& func,
                          size_t max_batch_size,
                          size_t read_batch_size,
-                         BatchType batch_type) {
+                         BatchType batch_type,
+                         const MemoryEstimateFunc& estimate_memory = nullptr) {
       std::queue<std::future<Result>> results;
 
       auto pop_results = [&results, &result_writer](bool blocking) {
@@ -205,6 +356,8 @@ namespace ctranslate2 {
         }
       };
 
+      if (max_batch_size == 0)
+        max_batch_size = _default_max_batch_size;
       if (read_batch_size == 0)
         read_batch_size = (max_batch_size == 1 ? max_batch_size : max_batch_size * 16);
 
@@ -213,7 +366,11 @@ namespace ctranslate2 {
         if (examples.empty())
           break;
 
-        auto futures = post_examples<Result>(examples, max_batch_size, batch_type, func);
+        auto futures = post_examples<Result>(examples,
+                                             max_batch_size,
+                                             batch_type,
+                                             func,
+                                             estimate_memory);
         for (auto& future : futures)
           results.emplace(std::move(future));
 
@@ -223,8 +380,151 @@ namespace ctranslate2 {
       pop_results(/*blocking=*/true);
     }
 
+    template <typename Result, typename Func>
+    std::unique_ptr<ResultIterator<Result>>
+    post_stream(std::unique_ptr<BatchReader> batch_reader,
+                const Func& func,
+                size_t max_batch_size,
+                size_t read_batch_size,
+                BatchType batch_type,
+                size_t max_batches_per_replica,
+                const MemoryEstimateFunc& estimate_memory = nullptr) {
+      if (max_batch_size == 0)
+        max_batch_size = _default_max_batch_size;
+      if (max_batch_size == 0)
+        throw std::invalid_argument("max_batch_size must be set when processing a stream "
+                                    "of examples");
+      if (read_batch_size == 0)
+        read_batch_size = (max_batch_size == 1 ? max_batch_size : max_batch_size * 16);
+      if (max_batches_per_replica == 0)
+        max_batches_per_replica = 4;
+
+      auto submit_batch = [this, func, estimate_memory](Batch batch,
+                                                        std::vector<std::promise<Result>> promises,
+                                                        std::function<void()> on_finished) {
+        auto parts = split_to_memory_budget(std::move(batch), estimate_memory);
+
+        // on_finished is called when the last part is finished.
+        auto num_unfinished_parts = std::make_shared<std::atomic<size_t>>(parts.size());
+        auto on_part_finished = [num_unfinished_parts, on_finished = std::move(on_finished)]() {
+          if (num_unfinished_parts->fetch_sub(1) == 1)
+            on_finished();
+        };
+
+        // The parts are contiguous ranges of the batch examples.
+        size_t offset = 0;
+
+        for (auto& part : parts) {
+          // The promises are fulfilled by the job itself so that on_finished is called
+          // after the results are available.
+          auto part_promises = std::make_shared<std::vector<std::promise<Result>>>();
+          part_promises->reserve(part.batch.num_examples());
+          for (size_t i = 0; i < part.batch.num_examples(); ++i)
+            part_promises->emplace_back(std::move(promises[offset + i]));
+          offset += part.batch.num_examples();
+
+          if (part.error) {
+            for (auto& promise : *part_promises)
+              promise.set_exception(part.error);
+            on_part_finished();
+            continue;
+          }
+
+          auto job = [batch = std::move(part.batch),
+                      promises = std::move(part_promises),
+                      on_part_finished,
+                      func](Replica& replica) {
+            try {
+              auto results = func(replica, batch);
+              for (size_t i = 0; i < promises->size(); ++i)
+                (*promises)[i].set_value(std::move(results[i]));
+            } catch (...) {
+              const auto exception = std::current_exception();
+              for (auto& promise : *promises)
+                promise.set_exception(exception);
+            }
+
+            on_part_finished();
+            return std::vector<Result>();
+          };
+
+          post_batch<Result>(std::move(job), std::vector<std::promise<Result>>());
+        }
+      };
+
+      return std::make_unique<ResultIterator<Result>>(std::move(batch_reader),
+                                                      std::move(submit_batch),
+                                                      max_batch_size,
+                                                      read_batch_size,
+                                                      batch_type,
+                                                      max_batches_per_replica * num_replicas());
+    }
+
   private:
     std::unique_ptr<ThreadPool> _thread_pool;
+    size_t _default_max_batch_size = 0;
+    size_t _max_memory_per_replica = 0;
+
+    struct BatchPart {
+      Batch batch;
+      std::exception_ptr error;  // Set if the part does not fit in the memory budget.
+    };
+
+    // Splits the batch in halves until the estimated memory usage of each part fits the
+    // memory budget. The parts are contiguous ranges of the batch examples.
+    std::vector<BatchPart> split_to_memory_budget(Batch batch,
+                                                  const MemoryEstimateFunc& estimate_memory) const {
+      std::vector<BatchPart> parts;
+
+      const size_t estimated_bytes = (estimate_memory && _max_memory_per_replica > 0
+                                      ? estimate_memory(batch)
+                                      : 0);
+
+      if (estimated_bytes <= _max_memory_per_replica) {
+        parts.push_back({std::move(batch), nullptr});
+        return parts;
+      }
+
+      const size_t batch_size = batch.num_examples();
+
+      if (batch_size == 1) {
+        constexpr size_t mb = 1024 * 1024;
+        const auto error = std::make_exception_ptr(std::runtime_error(
+          "The example requires an estimated " + std::to_string(estimated_bytes / mb)
+          + "MB of memory, which exceeds the memory budget of "
+          + std::to_string(_max_memory_per_replica / mb)
+          + "MB per replica. Reduce the maximum decoding length or the beam size, "
+          "or increase max_memory_per_replica."));
+        parts.push_back({std::move(batch), error});
+        return parts;
+      }
+
+      const size_t half = batch_size / 2;
+
+      Batch first;
+      Batch second;
+      for (size_t i = 0; i < batch_size; ++i) {
+        Batch& target = i < half ? first : second;
+        target.examples.emplace_back(std::move(batch.examples[i]));
+        target.example_index.emplace_back(batch.example_index[i]);
+      }
+
+      for (Batch* part_batch : {&first, &second}) {
+        for (auto& part : split_to_memory_budget(std::move(*part_batch), estimate_memory))
+          parts.emplace_back(std::move(part));
+      }
+
+      return parts;
+    }
+
+    size_t get_replica_index(const Replica& replica) const {
+      for (size_t i = 0; i < num_replicas(); ++i) {
+        auto& worker = static_cast<ReplicaWorker<Replica>&>(_thread_pool->get_worker(i));
+        if (&worker.replica() == &replica)
+          return i;
+      }
+      throw std::runtime_error("The replica does not belong to this pool");
+    }
 
     static Replica& get_thread_replica() {
       auto& worker = static_cast<ReplicaWorker<Replica>&>(ThreadPool::get_local_worker());
@@ -234,8 +534,14 @@ namespace ctranslate2 {
     void initialize_pool(const models::ModelLoader& model_loader,
                          const ReplicaPoolConfig& config) {
       // The same number of OpenMP threads should be used for loading and running model.
-      set_num_threads(model_loader.device == Device::CUDA ? 1 : config.num_threads_per_replica);
-      initialize_pool(model_loader.load(), config);
+      const size_t num_threads = (model_loader.device == Device::CUDA
+                                  ? 1
+                                  : config.num_threads_per_replica);
+      set_num_threads(num_threads);
+
+      models::ModelLoader replica_loader = model_loader;
+      replica_loader.num_threads_per_replica = num_threads;
+      initialize_pool(replica_loader.load(), config);
     }
 
     void initialize_pool(const std::vector<std::shared_ptr<const models::Model>>& models,
@@ -256,6 +562,8 @@ namespace ctranslate2 {
       _thread_pool = std::make_unique<ThreadPool>(std::move(workers),
                                                   max_queue_size,
                                                   config.cpu_core_offset);
+      _default_max_batch_size = config.max_batch_size;
+      _max_memory_per_replica = config.max_memory_per_replica;
     }
 
     template <typename Result, typename Func>
@@ -264,6 +572,13 @@ namespace ctranslate2 {
                                                                   std::move(func)));
     }
 
+    template <typename Result, typename Func>
+    void post_func(Func func, std::vector<std::promise<Result>> promises, size_t replica_index) {
+      _thread_pool->post(std::make_unique<BatchJob<Result, Func>>(std::move(promises),
+                                                                  std::move(func)),
+                         replica_index);
+    }
+
     template <typename Result, typename Func>
     class BatchJob : public Job {
     public:
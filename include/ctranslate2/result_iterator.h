@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "batch_reader.h"
+
+namespace ctranslate2 {
+
+  // Iterator over the results of a stream of examples, returned in the input order.
+  //
+  // A background thread reads the examples by chunks of read_batch_size, sorts each chunk
+  // by length, and splits it into batches of max_batch_size. The batches are posted as long
+  // as the number of unfinished batches is lower than max_batches_in_flight, so the workers
+  // are refilled even when the caller is slow to consume the results. A new chunk is only
+  // read when fewer than read_batch_size results are waiting to be consumed, so a slow
+  // caller does not accumulate the results of the whole stream.
+  //
+  // The iterator should not outlive the replica pool that created it.
+  template <typename Result>
+  class ResultIterator {
+  public:
+    // Posts a batch and calls the last argument once the promises are fulfilled.
+    using PostBatchFunc = std::function<void(Batch,
+                                             std::vector<std::promise<Result>>,
+                                             std::function<void()>)>;
+
+    ResultIterator(std::unique_ptr<BatchReader> reader,
+                   PostBatchFunc post_batch,
+                   size_t max_batch_size,
+                   size_t read_batch_size,
+                   BatchType batch_type,
+                   size_t max_batches_in_flight)
+      : _reader(std::move(reader))
+      , _post_batch(std::move(post_batch))
+      , _max_batch_size(max_batch_size)
+      , _read_batch_size(read_batch_size)
+      , _batch_type(batch_type)
+      , _max_batches_in_flight(std::max(max_batches_in_flight, size_t(1)))
+      , _state(std::make_shared<State>())
+    {
+      _thread = std::thread(&ResultIterator::run, this);
+    }
+
+    ~ResultIterator() {
+      {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        _state->stop = true;
+      }
+      _state->can_post.notify_all();
+      _thread.join();
+    }
+
+    ResultIterator(const ResultIterator&) = delete;
+    ResultIterator& operator=(const ResultIterator&) = delete;
+
+    // Blocks until the next result is available and returns it, or returns std::nullopt
+    // when all examples were processed. Errors raised when reading the examples are
+    // rethrown after the results of the previous examples.
+    std::optional<Result> next() {
+      std::future<Result> future;
+
+      {
+        std::unique_lock<std::mutex> lock(_state->mutex);
+        _results_available.wait(lock, [this]{ return !_results.empty() || _end_of_stream; });
+
+        if (_results.empty()) {
+          if (_exception)
+            std::rethrow_exception(std::exchange(_exception, nullptr));
+          return std::nullopt;
+        }
+
+        future = std::move(_results.front());
+        _results.pop_front();
+      }
+
+      _state->can_post.notify_all();
+      return future.get();
+    }
+
+  private:
+    struct State {
+      std::mutex mutex;
+      std::condition_variable can_post;
+      size_t num_batches_in_flight = 0;
+      bool stop = false;
+    };
+
+    struct PendingBatch {
+      Batch batch;
+      std::vector<std::promise<Result>> promises;
+    };
+
+    const std::unique_ptr<BatchReader> _reader;
+    const PostBatchFunc _post_batch;
+    const size_t _max_batch_size;
+    const size_t _read_batch_size;
+    const BatchType _batch_type;
+    const size_t _max_batches_in_flight;
+
+    // The state is shared with the posted batches which can finish after the iterator
+    // is destroyed.
+    const std::shared_ptr<State> _state;
+    std::condition_variable _results_available;
+    std::deque<std::future<Result>> _results;
+    std::exception_ptr _exception;
+    bool _end_of_stream = false;
+
+    std::deque<PendingBatch> _pending_batches;
+    std::thread _thread;
+
+    void run() {
+      while (true) {
+        {
+          std::unique_lock<std::mutex> lock(_state->mutex);
+          _state->can_post.wait(lock, [this] {
+            return _state->stop || _state->num_batches_in_flight < _max_batches_in_flight;
+          });
+          if (_state->stop)
+            return;
+        }
+
+        if (_pending_batches.empty()) {
+          {
+            std::unique_lock<std::mutex> lock(_state->mutex);
+            _state->can_post.wait(lock, [this] {
+              return _state->stop || _results.size() < _read_batch_size;
+            });
+            if (_state->stop)
+              return;
+          }
+
+          if (!read_examples())
+            return;
+        }
+
+        PendingBatch pending = std::move(_pending_batches.front());
+        _pending_batches.pop_front();
+
+        {
+          std::lock_guard<std::mutex> lock(_state->mutex);
+          ++_state->num_batches_in_flight;
+        }
+
+        auto on_finished = [state = _state]() {
+          {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            --state->num_batches_in_flight;
+          }
+          state->can_post.notify_all();
+        };
+
+        try {
+          _post_batch(std::move(pending.batch), std::move(pending.promises), on_finished);
+        } catch (...) {
+          // The promises are released so the caller gets a broken promise error.
+          on_finished();
+        }
+      }
+    }
+
+    // Reads the next chunk of examples into the pending batches. Returns false at the end
+    // of the stream.
+    bool read_examples() {
+      std::vector<Example> examples;
+      std::exception_ptr exception;
+
+      try {
+        examples = _reader->get_next(_read_batch_size, _batch_type);
+      } catch (...) {
+        exception = std::current_exception();
+      }
+
+      std::vector<std::promise<Result>> promises(examples.size());
+
+      {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        for (auto& promise : promises)
+          _results.emplace_back(promise.get_future());
+        if (examples.empty()) {
+          _exception = exception;
+          _end_of_stream = true;
+        }
+      }
+
+      _results_available.notify_all();
+
+      if (examples.empty())
+        return false;
+
+      for (auto& batch : rebatch_input(examples, _max_batch_size, _batch_type)) {
+        PendingBatch pending;
+        pending.promises.reserve(batch.num_examples());
+        for (const size_t index : batch.example_index)
+          pending.promises.emplace_back(std::move(promises[index]));
+        pending.batch = std::move(batch);
+        _pending_batches.emplace_back(std::move(pending));
+      }
+
+      return true;
+    }
+  };
+
+}
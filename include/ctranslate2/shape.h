@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "types.h"
+
+namespace ctranslate2 {
+
+  // Shape of a StorageView.
+  //
+  // The dimensions are stored inline with a fixed capacity so that creating and updating
+  // shapes (e.g. in reshape, expand_dims, or squeeze) does not allocate memory. The interface
+  // is a subset of std::vector<dim_t> and shapes can be converted from and to vectors.
+  class Shape {
+  public:
+    static constexpr size_t max_rank = 8;
+
+    using value_type = dim_t;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = dim_t&;
+    using const_reference = const dim_t&;
+    using pointer = dim_t*;
+    using const_pointer = const dim_t*;
+    using iterator = dim_t*;
+    using const_iterator = const dim_t*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    Shape() = default;
+
+    explicit Shape(size_t rank, dim_t value = 0) {
+      resize(rank, value);
+    }
+
+    Shape(std::initializer_list<dim_t> dims)
+      : Shape(dims.begin(), dims.end())
+    {
+    }
+
+    Shape(const std::vector<dim_t>& dims)
+      : Shape(dims.begin(), dims.end())
+    {
+    }
+
+    template <typename InputIt,
+              typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+    Shape(InputIt first, InputIt last) {
+      for (; first != last; ++first)
+        push_back(static_cast<dim_t>(*first));
+    }
+
+    operator std::vector<dim_t>() const {
+      return std::vector<dim_t>(begin(), end());
+    }
+
+    size_t size() const {
+      return _rank;
+    }
+
+    bool empty() const {
+      return _rank == 0;
+    }
+
+    static constexpr size_t capacity() {
+      return max_rank;
+    }
+
+    dim_t* data() {
+      return _dims;
+    }
+
+    const dim_t* data() const {
+      return _dims;
+    }
+
+    dim_t& operator[](size_t i) {
+      return _dims[i];
+    }
+
+    const dim_t& operator[](size_t i) const {
+      return _dims[i];
+    }
+
+    dim_t& at(size_t i) {
+      check_index(i);
+      return _dims[i];
+    }
+
+    const dim_t& at(size_t i) const {
+      check_index(i);
+      return _dims[i];
+    }
+
+    dim_t& front() {
+      return _dims[0];
+    }
+
+    const dim_t& front() const {
+      return _dims[0];
+    }
+
+    dim_t& back() {
+      return _dims[_rank - 1];
+    }
+
+    const dim_t& back() const {
+      return _dims[_rank - 1];
+    }
+
+    iterator begin() {
+      return _dims;
+    }
+
+    const_iterator begin() const {
+      return _dims;
+    }
+
+    const_iterator cbegin() const {
+      return _dims;
+    }
+
+    iterator end() {
+      return _dims + _rank;
+    }
+
+    const_iterator end() const {
+      return _dims + _rank;
+    }
+
+    const_iterator cend() const {
+      return _dims + _rank;
+    }
+
+    reverse_iterator rbegin() {
+      return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const {
+      return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator crbegin() const {
+      return rbegin();
+    }
+
+    reverse_iterator rend() {
+      return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const {
+      return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crend() const {
+      return rend();
+    }
+
+    void clear() {
+      _rank = 0;
+    }
+
+    void resize(size_t rank, dim_t value = 0) {
+      check_rank(rank);
+      for (size_t i = _rank; i < rank; ++i)
+        _dims[i] = value;
+      _rank = rank;
+    }
+
+    void push_back(dim_t dim) {
+      check_rank(_rank + 1);
+      _dims[_rank++] = dim;
+    }
+
+    void emplace_back(dim_t dim) {
+      push_back(dim);
+    }
+
+    void pop_back() {
+      --_rank;
+    }
+
+    iterator insert(const_iterator pos, dim_t dim) {
+      check_rank(_rank + 1);
+      dim_t* it = _dims + (pos - _dims);
+      std::move_backward(it, end(), end() + 1);
+      *it = dim;
+      ++_rank;
+      return it;
+    }
+
+    iterator erase(const_iterator pos) {
+      return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+      dim_t* it = _dims + (first - _dims);
+      std::move(_dims + (last - _dims), end(), it);
+      _rank -= last - first;
+      return it;
+    }
+
+    friend bool operator==(const Shape& a, const Shape& b) {
+      return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    friend bool operator!=(const Shape& a, const Shape& b) {
+      return !(a == b);
+    }
+
+  private:
+    static void check_rank(size_t rank) {
+      if (rank > max_rank)
+        throw std::invalid_argument("Shape supports at most "
+                                    + std::to_string(max_rank)
+                                    + " dimensions, but got "
+                                    + std::to_string(rank));
+    }
+
+    void check_index(size_t i) const {
+      if (i >= _rank)
+        throw std::out_of_range("Shape index " + std::to_string(i)
+                                + " is out of range for rank " + std::to_string(_rank));
+    }
+
+    dim_t _dims[max_rank] = {};
+    size_t _rank = 0;
+  };
+
+}
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "allocator.h"
+#include "shape.h"
 #include "types.h"
 #include "utils.h"
 
@@ -26,8 +27,6 @@ namespace ctranslate2 {
                              + std::to_string(RANK));                   \
   } while (false)
 
-  using Shape = std::vector<dim_t>;
-
   inline dim_t compute_size(const Shape& shape) {
     dim_t size = 1;
     for (const dim_t dim : shape)
@@ -5,6 +5,7 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <deque>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -12,6 +13,8 @@
 
 namespace ctranslate2 {
 
+  class Worker;
+
   // Base class for asynchronous jobs.
   class Job {
   public:
@@ -21,8 +24,13 @@ namespace ctranslate2 {
     // The job counter is used to track the number of active jobs (queued and currently processed).
     void set_job_counter(std::atomic<size_t>& counter);
 
+    // Restricts the job to a specific worker (by default, any worker can run the job).
+    void set_worker(const Worker* worker);
+    const Worker* worker() const;
+
   private:
     std::atomic<size_t>* _counter = nullptr;
+    const Worker* _worker = nullptr;
   };
 
   // A thread-safe queue of jobs.
@@ -36,17 +44,18 @@ namespace ctranslate2 {
     // Puts a job in the queue. The method blocks until a free slot is available.
     void put(std::unique_ptr<Job> job);
 
-    // Gets a job from the queue. The method blocks until a job is available.
+    // Gets a job that can run in the given worker. The method blocks until a job is available.
     // If the queue is closed, the method returns a null pointer.
-    std::unique_ptr<Job> get(const std::function<void()>& before_wait = nullptr);
+    std::unique_ptr<Job> get(const std::function<void()>& before_wait = nullptr,
+                             const Worker* worker = nullptr);
 
     void close();
 
   private:
-    bool can_get_job() const;
+    std::deque<std::unique_ptr<Job>>::iterator find_job(const Worker* worker);
 
     mutable std::mutex _mutex;
-    std::queue<std::unique_ptr<Job>> _queue;
+    std::deque<std::unique_ptr<Job>> _queue;
     std::condition_variable _can_put_job;
     std::condition_variable _can_get_job;
     size_t _maximum_size;
@@ -95,6 +104,9 @@ namespace ctranslate2 {
     // Posts a new job. The method blocks if the job queue is full.
     void post(std::unique_ptr<Job> job);
 
+    // Posts a new job that should be run by the worker at the given index.
+    void post(std::unique_ptr<Job> job, size_t worker_index);
+
     size_t num_threads() const;
 
     // Number of jobs in the queue.
@@ -106,6 +118,9 @@ namespace ctranslate2 {
     Worker& get_worker(size_t index);
     static Worker& get_local_worker();
 
+    // Returns true if the current thread is run by the worker at the given index.
+    bool is_local_worker(size_t index) const;
+
   private:
     void start_workers(int core_offset);
 
@@ -12,6 +12,30 @@ namespace ctranslate2 {
     // Beam search patience factor, as described in https://arxiv.org/abs/2204.05424.
     // The decoding will continue until beam_size*patience hypotheses are finished.
     float patience = 1;
+    // Prune the beams whose log probability is lower than the best beam log probability
+    // minus this value (set 0 to disable).
+    float beam_pruning_absolute_threshold = 0;
+    // Prune the beams whose log probability is lower than the best beam log probability
+    // by more than this fraction (set 0 to disable).
+    float beam_pruning_relative_threshold = 0;
+    // Finish a batch when its best beam can no longer beat the num_hypotheses-th finished
+    // hypothesis under the length penalty (not used with a coverage penalty). This assumes
+    // that the token log probabilities are non-positive.
+    bool beam_score_bound = false;
+    // Stop running the decoder layers of a step when an intermediate layer predicts the
+    // next token with a probability above this threshold in all batches (set 0 to disable).
+    float early_exit_threshold = 0;
+    // Number of decoder layers between two early exit tests.
+    size_t early_exit_interval = 2;
+    // Compute the logits of the decoding steps in two stages: approximate logits with an
+    // INT8 copy of the output layer, then exact logits for this number of candidates with
+    // the best approximate logits (set 0 to disable). This option is ignored when the output
+    // layer is already quantized or when the device does not support INT8.
+    size_t two_stage_candidates = 0;
+    // Exclude the tokens that are not candidates from the softmax so that the log
+    // probabilities only use exact logits. Otherwise the approximate logits of these tokens
+    // are included in the softmax normalizer.
+    bool two_stage_exact_log_probs = false;
     // Exponential penalty applied to the length during beam search.
     // The scores are normalized with:
     //   hypothesis_score /= (hypothesis_length ** length_penalty)
@@ -37,6 +61,9 @@ namespace ctranslate2 {
 
     // Stop the decoding on this token (defaults to the model EOS token).
     std::string end_token;
+    // Also stop the decoding when one of these sequences of tokens is generated.
+    // The stop sequence is included in the result.
+    std::vector<std::vector<std::string>> stop_sequences;
 
     // Truncate the inputs after this many tokens (set 0 to disable truncation).
     size_t max_input_length = 1024;
@@ -60,6 +87,9 @@ namespace ctranslate2 {
     bool return_scores = false;
     // Store attention vectors in the TranslationResult class.
     bool return_attention = false;
+    // Store the K best token ids and log probabilities at each decoding step in the
+    // TranslationResult class (set 0 to disable).
+    size_t return_topk_logprobs = 0;
 
     // Return alternatives at the first unconstrained decoding position. This is typically
     // used with a target prefix to provide alternatives at a specifc location in the
@@ -76,6 +106,11 @@ namespace ctranslate2 {
     std::vector<std::vector<std::string>> hypotheses;
     std::vector<float> scores;
     std::vector<std::vector<std::vector<float>>> attention;
+    std::vector<std::vector<std::vector<size_t>>> topk_ids;
+    std::vector<std::vector<std::vector<float>>> topk_logprobs;
+    // Average number of decoder layers run per decoding step in the batch
+    // (0 if early_exit_threshold is not set).
+    float average_exit_depth = 0;
 
     TranslationResult(std::vector<std::vector<std::string>> hypotheses_)
       : hypotheses(std::move(hypotheses_))
@@ -127,6 +162,10 @@ namespace ctranslate2 {
     bool has_attention() const {
       return !attention.empty();
     }
+
+    bool has_topk_logprobs() const {
+      return !topk_logprobs.empty();
+    }
   };
 
 }
@@ -65,6 +65,26 @@ namespace ctranslate2 {
                 const size_t max_batch_size = 0,
                 const BatchType batch_type = BatchType::Examples);
 
+    // Translates a stream of examples and returns the results in the input order.
+    // The reader should produce the source tokens and optionally the target prefix as a
+    // second stream. See ResultIterator for the batching and prefetching behavior.
+    std::unique_ptr<ResultIterator<TranslationResult>>
+    translate_iterable(std::unique_ptr<BatchReader> reader,
+                       const TranslationOptions& options = TranslationOptions(),
+                       size_t max_batch_size = 32,
+                       size_t read_batch_size = 0,
+                       BatchType batch_type = BatchType::Examples,
+                       size_t max_batches_per_replica = 0);
+
+    // Same as above for scoring. The reader should produce the source and target tokens.
+    std::unique_ptr<ResultIterator<ScoringResult>>
+    score_iterable(std::unique_ptr<BatchReader> reader,
+                   const ScoringOptions& options = ScoringOptions(),
+                   size_t max_batch_size = 64,
+                   size_t read_batch_size = 0,
+                   BatchType batch_type = BatchType::Examples,
+                   size_t max_batches_per_replica = 0);
+
     // Translate a file.
     ExecutionStats translate_text_file(const std::string& source_file,
                                        const std::string& output_file,
@@ -202,7 +222,8 @@ namespace ctranslate2 {
         batch_type,
         [options](models::SequenceToSequenceReplica& model, const Batch& batch) {
           return run_translation(model, batch, options);
-        });
+        },
+        get_translation_memory_estimator(options));
 
       const auto t2 = std::chrono::high_resolution_clock::now();
       stats.total_time_in_ms = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
@@ -307,6 +328,8 @@ namespace ctranslate2 {
   private:
     friend class BufferedTranslationWrapper;
 
+    MemoryEstimateFunc get_translation_memory_estimator(const TranslationOptions& options) const;
+
     template <typename Result,
               typename SourceTokenizer,
               typename TargetTokenizer,
@@ -321,7 +344,8 @@ namespace ctranslate2 {
                         size_t max_batch_size,
                         size_t read_batch_size,
                         BatchType batch_type,
-                        const Func& func) {
+                        const Func& func,
+                        const MemoryEstimateFunc& estimate_memory = nullptr) {
       std::unique_ptr<BatchReader> batch_reader;
       if (target) {
         auto parallel_reader = std::make_unique<ParallelBatchReader>();
@@ -339,7 +363,8 @@ namespace ctranslate2 {
                               func,
                               max_batch_size,
                               read_batch_size,
-                              batch_type);
+                              batch_type,
+                              estimate_memory);
 
       output.flush();
     }
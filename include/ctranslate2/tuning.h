@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "generator.h"
+#include "translator.h"
+
+namespace ctranslate2 {
+
+  // Deployment settings selected by the tuner and the performance measured with them.
+  struct TuningProfile {
+    Device device = Device::CPU;
+    size_t inter_threads = 1;
+    size_t intra_threads = 0;
+    size_t max_batch_size = 0;
+    ComputeType compute_type = ComputeType::DEFAULT;
+
+    // Measurements, for information only.
+    size_t concurrency = 0;
+    double examples_per_second = 0;
+    double tokens_per_second = 0;
+    double latency_p50_ms = 0;
+    double latency_p99_ms = 0;
+
+    // Profiles are saved in JSON.
+    static TuningProfile load(const std::string& path);
+    void save(const std::string& path) const;
+
+    // Sets the number of replicas, the number of threads per replica, the compute type,
+    // and the default batch size.
+    void apply(models::ModelLoader& model_loader, ReplicaPoolConfig& config) const;
+  };
+
+  struct TuningOptions {
+    // Candidate values of each setting. When a list is empty:
+    //  * inter_threads and intra_threads are split between the available CPU cores
+    //    (or 1 and 2 replicas per device on GPU),
+    //  * max_batch_sizes is {1, 4, 16, 32},
+    //  * compute_types is the compute type of the model loader.
+    std::vector<size_t> inter_threads;
+    std::vector<size_t> intra_threads;
+    std::vector<size_t> max_batch_sizes;
+    std::vector<ComputeType> compute_types;
+
+    // Number of clients sending requests at the same time. Each request contains
+    // max_batch_size examples.
+    size_t concurrency = 4;
+    // Number of requests measured for each configuration.
+    size_t num_requests = 32;
+    // Configurations with a higher p99 latency are not selected (0 to disable).
+    double max_latency_p99_ms = 0;
+
+    // Synthetic workload used when no inputs are passed: sequences of random tokens
+    // sampled from the model vocabulary.
+    size_t num_synthetic_examples = 256;
+    size_t synthetic_length = 32;
+    unsigned int seed = 0;
+  };
+
+  struct TuningResult {
+    // Configuration with the highest throughput satisfying the latency constraint.
+    TuningProfile best;
+    // All measured configurations.
+    std::vector<TuningProfile> candidates;
+  };
+
+  // Measures the translation throughput and latency of the model for each configuration.
+  // The pools are created from model_loader with the settings of the configuration.
+  TuningResult tune_translator(const models::ModelLoader& model_loader,
+                               const TranslationOptions& options = TranslationOptions(),
+                               const TuningOptions& tuning_options = TuningOptions(),
+                               std::vector<std::vector<std::string>> inputs = {});
+
+  // Same as above for generation. The inputs are the start tokens.
+  TuningResult tune_generator(const models::ModelLoader& model_loader,
+                              const GenerationOptions& options = GenerationOptions(),
+                              const TuningOptions& tuning_options = TuningOptions(),
+                              std::vector<std::vector<std::string>> inputs = {});
+
+}
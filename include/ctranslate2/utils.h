@@ -10,8 +10,15 @@ namespace ctranslate2 {
   bool string_to_bool(const std::string& str);
 
   void log_system_config();
+  // Returns the names of the instruction set extensions supported by the CPU,
+  // e.g. "AVX2", "AVX512_VNNI", or "AMX_INT8".
+  std::vector<std::string> get_cpu_features();
   int get_gpu_count();
   void set_num_threads(size_t num_threads);
+  // Enables faster but less accurate approximations of exp, log, and GELU in the CPU
+  // kernels (softmax, log softmax, GELU, SiLU). This can also be enabled with the environment variable CT2_CPU_FAST_MATH=1.
+  void set_cpu_fast_math(bool enable);
+  bool get_cpu_fast_math();
 
   bool ends_with(const std::string& str, const std::string& suffix);
   bool starts_with(const std::string& str, const std::string& prefix);
@@ -16,6 +16,15 @@ namespace ctranslate2 {
                       "Generated sequences of token IDs.")
         .def_readonly("scores", &GenerationResult::scores,
                       "Score of each sequence (empty if :obj:`return_scores` was disabled).")
+        .def_readonly("topk_ids", &GenerationResult::topk_ids,
+                      "Best token IDs at each decoding step of each sequence "
+                      "(empty if :obj:`return_topk_logprobs` was disabled).")
+        .def_readonly("topk_logprobs", &GenerationResult::topk_logprobs,
+                      "Log probabilities of the best tokens at each decoding step of each "
+                      "sequence (empty if :obj:`return_topk_logprobs` was disabled).")
+        .def_readonly("average_exit_depth", &GenerationResult::average_exit_depth,
+                      "Average number of decoder layers run per decoding step in the batch "
+                      "(0 if :obj:`early_exit_threshold` was not set).")
 
         .def("__repr__", [](const GenerationResult& result) {
           return "GenerationResult(sequences=" + std::string(py::repr(py::cast(result.sequences)))
@@ -26,6 +35,7 @@ namespace ctranslate2 {
         ;
 
       declare_async_wrapper<GenerationResult>(m, "AsyncGenerationResult");
+      declare_iterator_wrapper<GenerationResult>(m, "GenerationIterator");
     }
 
   }
@@ -8,6 +8,64 @@
 namespace ctranslate2 {
   namespace python {
 
+    static GenerationOptions
+    make_generation_options(size_t beam_size,
+                            float patience,
+                            float beam_pruning_absolute_threshold,
+                            float beam_pruning_relative_threshold,
+                            bool beam_score_bound,
+                            float early_exit_threshold,
+                            size_t early_exit_interval,
+                            size_t two_stage_candidates,
+                            bool two_stage_exact_log_probs,
+                            size_t num_hypotheses,
+                            float length_penalty,
+                            float repetition_penalty,
+                            size_t no_repeat_ngram_size,
+                            bool disable_unk,
+                            const std::optional<std::vector<std::vector<std::string>>>& suppress_sequences,
+                            const std::optional<std::string>& end_token,
+                            const std::optional<std::vector<std::vector<std::string>>>& stop_sequences,
+                            size_t max_length,
+                            size_t min_length,
+                            bool return_scores,
+                            size_t return_topk_logprobs,
+                            bool return_alternatives,
+                            float min_alternative_expansion_prob,
+                            size_t sampling_topk,
+                            float sampling_temperature) {
+      GenerationOptions options;
+      options.beam_size = beam_size;
+      options.patience = patience;
+      options.beam_pruning_absolute_threshold = beam_pruning_absolute_threshold;
+      options.beam_pruning_relative_threshold = beam_pruning_relative_threshold;
+      options.beam_score_bound = beam_score_bound;
+      options.early_exit_threshold = early_exit_threshold;
+      options.early_exit_interval = early_exit_interval;
+      options.two_stage_candidates = two_stage_candidates;
+      options.two_stage_exact_log_probs = two_stage_exact_log_probs;
+      options.length_penalty = length_penalty;
+      options.repetition_penalty = repetition_penalty;
+      options.no_repeat_ngram_size = no_repeat_ngram_size;
+      options.disable_unk = disable_unk;
+      options.sampling_topk = sampling_topk;
+      options.sampling_temperature = sampling_temperature;
+      options.max_length = max_length;
+      options.min_length = min_length;
+      options.num_hypotheses = num_hypotheses;
+      options.return_scores = return_scores;
+      options.return_topk_logprobs = return_topk_logprobs;
+      options.return_alternatives = return_alternatives;
+      options.min_alternative_expansion_prob = min_alternative_expansion_prob;
+      if (suppress_sequences)
+        options.suppress_sequences = suppress_sequences.value();
+      if (end_token)
+        options.end_token = end_token.value();
+      if (stop_sequences)
+        options.stop_sequences = stop_sequences.value();
+      return options;
+    }
+
     class GeneratorWrapper : public ReplicaPoolHelper<Generator> {
     public:
       using ReplicaPoolHelper::ReplicaPoolHelper;
@@ -20,6 +78,13 @@ namespace ctranslate2 {
                      bool asynchronous,
                      size_t beam_size,
                      float patience,
+                     float beam_pruning_absolute_threshold,
+                     float beam_pruning_relative_threshold,
+                     bool beam_score_bound,
+                     float early_exit_threshold,
+                     size_t early_exit_interval,
+                     size_t two_stage_candidates,
+                     bool two_stage_exact_log_probs,
                      size_t num_hypotheses,
                      float length_penalty,
                      float repetition_penalty,
@@ -27,9 +92,11 @@ namespace ctranslate2 {
                      bool disable_unk,
                      const std::optional<std::vector<std::vector<std::string>>>& suppress_sequences,
                      const std::optional<std::string>& end_token,
+                     const std::optional<std::vector<std::vector<std::string>>>& stop_sequences,
                      size_t max_length,
                      size_t min_length,
                      bool return_scores,
+                     size_t return_topk_logprobs,
                      bool return_alternatives,
                      float min_alternative_expansion_prob,
                      size_t sampling_topk,
@@ -38,30 +105,103 @@ namespace ctranslate2 {
           return {};
 
         BatchType batch_type = str_to_batch_type(batch_type_str);
-        GenerationOptions options;
-        options.beam_size = beam_size;
-        options.patience = patience;
-        options.length_penalty = length_penalty;
-        options.repetition_penalty = repetition_penalty;
-        options.no_repeat_ngram_size = no_repeat_ngram_size;
-        options.disable_unk = disable_unk;
-        options.sampling_topk = sampling_topk;
-        options.sampling_temperature = sampling_temperature;
-        options.max_length = max_length;
-        options.min_length = min_length;
-        options.num_hypotheses = num_hypotheses;
-        options.return_scores = return_scores;
-        options.return_alternatives = return_alternatives;
-        options.min_alternative_expansion_prob = min_alternative_expansion_prob;
-        if (suppress_sequences)
-          options.suppress_sequences = suppress_sequences.value();
-        if (end_token)
-          options.end_token = end_token.value();
+        const auto options = make_generation_options(beam_size,
+                                                     patience,
+                                                     beam_pruning_absolute_threshold,
+                                                     beam_pruning_relative_threshold,
+                                                     beam_score_bound,
+                                                     early_exit_threshold,
+                                                     early_exit_interval,
+                                                     two_stage_candidates,
+                                                     two_stage_exact_log_probs,
+                                                     num_hypotheses,
+                                                     length_penalty,
+                                                     repetition_penalty,
+                                                     no_repeat_ngram_size,
+                                                     disable_unk,
+                                                     suppress_sequences,
+                                                     end_token,
+                                                     stop_sequences,
+                                                     max_length,
+                                                     min_length,
+                                                     return_scores,
+                                                     return_topk_logprobs,
+                                                     return_alternatives,
+                                                     min_alternative_expansion_prob,
+                                                     sampling_topk,
+                                                     sampling_temperature);
 
         auto futures = _pool->generate_batch_async(tokens, options, max_batch_size, batch_type);
         return maybe_wait_on_futures(std::move(futures), asynchronous);
       }
 
+      ResultIteratorWrapper<GenerationResult>
+      generate_iterable(const py::object& start_tokens,
+                        size_t max_batch_size,
+                        const std::string& batch_type_str,
+                        size_t read_batch_size,
+                        size_t max_batches_per_replica,
+                        size_t beam_size,
+                        float patience,
+                        float beam_pruning_absolute_threshold,
+                        float beam_pruning_relative_threshold,
+                        bool beam_score_bound,
+                        float early_exit_threshold,
+                        size_t early_exit_interval,
+                        size_t two_stage_candidates,
+                        bool two_stage_exact_log_probs,
+                        size_t num_hypotheses,
+                        float length_penalty,
+                        float repetition_penalty,
+                        size_t no_repeat_ngram_size,
+                        bool disable_unk,
+                        const std::optional<std::vector<std::vector<std::string>>>& suppress_sequences,
+                        const std::optional<std::string>& end_token,
+                        const std::optional<std::vector<std::vector<std::string>>>& stop_sequences,
+                        size_t max_length,
+                        size_t min_length,
+                        bool return_scores,
+                        size_t return_topk_logprobs,
+                        bool return_alternatives,
+                        float min_alternative_expansion_prob,
+                        size_t sampling_topk,
+                        float sampling_temperature) {
+        const auto batch_type = str_to_batch_type(batch_type_str);
+        const auto options = make_generation_options(beam_size,
+                                                     patience,
+                                                     beam_pruning_absolute_threshold,
+                                                     beam_pruning_relative_threshold,
+                                                     beam_score_bound,
+                                                     early_exit_threshold,
+                                                     early_exit_interval,
+                                                     two_stage_candidates,
+                                                     two_stage_exact_log_probs,
+                                                     num_hypotheses,
+                                                     length_penalty,
+                                                     repetition_penalty,
+                                                     no_repeat_ngram_size,
+                                                     disable_unk,
+                                                     suppress_sequences,
+                                                     end_token,
+                                                     stop_sequences,
+                                                     max_length,
+                                                     min_length,
+                                                     return_scores,
+                                                     return_topk_logprobs,
+                                                     return_alternatives,
+                                                     min_alternative_expansion_prob,
+                                                     sampling_topk,
+                                                     sampling_temperature);
+
+        return _pool->generate_iterable(
+          std::make_unique<PyIterableReader>(std::vector<py::object>{start_tokens}),
+          options,
+          max_batch_size,
+          read_batch_size,
+          batch_type,
+          max_batches_per_replica);
+      }
+
       std::variant<std::vector<ScoringResult>,
                    std::vector<AsyncResult<ScoringResult>>>
       score_batch(const BatchTokens& tokens,
@@ -77,6 +217,73 @@ namespace ctranslate2 {
         return maybe_wait_on_futures(std::move(futures), asynchronous);
       }
 
+      ResultIteratorWrapper<ScoringResult>
+      score_iterable(const py::object& tokens,
+                     size_t max_batch_size,
+                     const std::string& batch_type_str,
+                     size_t read_batch_size,
+                     size_t max_batches_per_replica,
+                     size_t max_input_length) {
+        const auto batch_type = str_to_batch_type(batch_type_str);
+        ScoringOptions options;
+        options.max_input_length = max_input_length;
+
+        return _pool->score_iterable(
+          std::make_unique<PyIterableReader>(std::vector<py::object>{tokens}),
+          options,
+          max_batch_size,
+          read_batch_size,
+          batch_type,
+          max_batches_per_replica);
+      }
+
+      std::shared_ptr<models::GenerationSession> create_session(size_t idle_timeout) {
+        return _pool->create_session(std::chrono::milliseconds(idle_timeout));
+      }
+
+      GenerationResult
+      generate_in_session(const std::shared_ptr<models::GenerationSession>& session,
+                          const std::vector<std::string>& tokens,
+                          float repetition_penalty,
+                          size_t no_repeat_ngram_size,
+                          bool disable_unk,
+                          const std::optional<std::vector<std::vector<std::string>>>& suppress_sequences,
+                          const std::optional<std::string>& end_token,
+                          const std::optional<std::vector<std::vector<std::string>>>& stop_sequences,
+                          size_t max_length,
+                          size_t min_length,
+                          bool return_scores,
+                          size_t return_topk_logprobs,
+                          size_t sampling_topk,
+                          float sampling_temperature) {
+        GenerationOptions options;
+        options.repetition_penalty = repetition_penalty;
+        options.no_repeat_ngram_size = no_repeat_ngram_size;
+        options.disable_unk = disable_unk;
+        options.sampling_topk = sampling_topk;
+        options.sampling_temperature = sampling_temperature;
+        options.max_length = max_length;
+        options.min_length = min_length;
+        options.return_scores = return_scores;
+        options.return_topk_logprobs = return_topk_logprobs;
+        if (suppress_sequences)
+          options.suppress_sequences = suppress_sequences.value();
+        if (end_token)
+          options.end_token = end_token.value();
+        if (stop_sequences)
+          options.stop_sequences = stop_sequences.value();
+
+        return _pool->generate_in_session_async(session, tokens, options).get();
+      }
+
+      void offload_session(const std::shared_ptr<models::GenerationSession>& session) {
+        _pool->offload_session(session);
+      }
+
+      size_t evict_idle_sessions() {
+        return _pool->evict_idle_sessions();
+      }
+
       StorageViewWrapper
       forward_batch(const std::variant<BatchTokens, BatchIds, StorageViewWrapper>& inputs,
                     const std::optional<StorageViewWrapper>& lengths,
@@ -105,6 +312,24 @@ namespace ctranslate2 {
 
 
     void register_generator(py::module& m) {
+      py::class_<models::GenerationSession, std::shared_ptr<models::GenerationSession>>(
+        m, "GenerationSession",
+        R"pbdoc(
+            A multi-turn generation keeping the decoder state between calls.
+
+            Sessions are created with :meth:`Generator.create_session`.
+        )pbdoc")
+
+        .def_property_readonly("replica_index", &models::GenerationSession::replica_index,
+                               "Index of the generator owning the session state.")
+        .def_property_readonly("ids", &models::GenerationSession::ids,
+                               "Token IDs of the conversation, including the generated tokens.")
+        .def_property_readonly("num_cached_ids", &models::GenerationSession::num_cached_ids,
+                               "Number of token IDs that are cached in the decoder state.")
+        .def_property_readonly("is_offloaded", &models::GenerationSession::is_offloaded,
+                               "Whether the decoder state was copied to the host memory.")
+        ;
+
       py::class_<GeneratorWrapper>(
         m, "Generator",
         R"pbdoc(
@@ -116,7 +341,7 @@ namespace ctranslate2 {
                 >>> generator.generate_batch([["<s>"]], max_length=50, sampling_topk=20)
         )pbdoc")
 
-        .def(py::init<const std::string&, const std::string&, const std::variant<int, std::vector<int>>&, const StringOrMap&, size_t, size_t, long, py::object>(),
+        .def(py::init<const std::string&, const std::string&, const std::variant<int, std::vector<int>>&, const StringOrMap&, size_t, size_t, long, py::object, const std::vector<std::string>&, const std::optional<std::string>&, size_t>(),
              py::arg("model_path"),
              py::arg("device")="cpu",
              py::kw_only(),
@@ -126,6 +351,9 @@ namespace ctranslate2 {
              py::arg("intra_threads")=0,
              py::arg("max_queued_batches")=0,
              py::arg("files")=py::none(),
+             py::arg("ensemble_model_paths")=std::vector<std::string>(),
+             py::arg("tuning_profile")=py::none(),
+             py::arg("max_memory_per_replica")=0,
              R"pbdoc(
                  Initializes the generator.
 
@@ -144,6 +372,15 @@ namespace ctranslate2 {
                    files: Load model files from the memory. This argument is a dictionary mapping
                      file names to file contents as file-like or bytes objects. If this is set,
                      :obj:`model_path` acts as an identifier for this model.
+                  ensemble_model_paths: Paths to additional models to ensemble with the
+                    model. The models should have the same vocabularies and their log
+                    probabilities are averaged at each decoding step.
+                  tuning_profile: Path to a profile written by ``ct2-tuner``. The profile
+                    overrides :obj:`inter_threads`, :obj:`intra_threads`, :obj:`compute_type`,
+                    and sets the default :obj:`max_batch_size`.
+                  max_memory_per_replica: Memory budget of a decoding batch in bytes, as
+                    predicted by :meth:`estimate_decoding_memory` (0 for no limit). Larger
+                    batches are split, and an example that does not fit alone raises an error.
              )pbdoc")
 
         .def_property_readonly("device", &GeneratorWrapper::device,
@@ -157,6 +394,143 @@ namespace ctranslate2 {
         .def_property_readonly("num_active_batches", &GeneratorWrapper::num_active_batches,
                                "Number of batches waiting to be processed or currently processed.")
 
+        .def("estimate_decoding_memory", &GeneratorWrapper::estimate_decoding_memory,
+             py::arg("batch_size"),
+             py::arg("beam_size")=1,
+             py::kw_only(),
+             py::arg("input_length"),
+             py::arg("max_length"),
+             py::arg("two_stage_candidates")=0,
+             R"pbdoc(
+                 Estimates the peak memory used to decode a batch on one generator, excluding
+                 the model weights. The estimate assumes that all hypotheses reach
+                 :obj:`max_length`.
+
+                 Arguments:
+                   batch_size: Number of examples in the batch.
+                   beam_size: Beam size (or number of hypotheses when sampling).
+                   input_length: Maximum prompt length in the batch.
+                   max_length: Maximum decoding length.
+                   two_stage_candidates: Number of candidates of the two-stage output
+                     projection, which adds the INT8 copy of the projection to the estimate.
+
+                 Returns:
+                   The estimated memory usage in bytes.
+             )pbdoc")
+
+        .def("warmup", &GeneratorWrapper::warmup,
+             py::kw_only(),
+             py::arg("batch_shapes")=std::vector<std::pair<size_t, size_t>>{{1, 16}},
+             py::arg("beam_size")=1,
+             py::arg("touch_weights")=true,
+             py::call_guard<py::gil_scoped_release>(),
+             R"pbdoc(
+                 Runs synthetic batches on all model replicas in parallel so that the first
+                 requests are not slowed down by one-time initializations.
+
+                 This method should be called before submitting other requests.
+
+                 Arguments:
+                   batch_shapes: List of (batch size, length) pairs defining the synthetic
+                     batches to run on each replica.
+                   beam_size: Beam size used to decode the synthetic batches.
+                   touch_weights: Read each memory page of the model weights before running
+                     the batches.
+
+                 Returns:
+                   The warmup time of each replica in milliseconds.
+             )pbdoc")
+
+        .def("create_session", &GeneratorWrapper::create_session,
+             py::kw_only(),
+             py::arg("idle_timeout")=0,
+             R"pbdoc(
+                 Creates a session keeping the decoder state between generation calls.
+
+                 The next calls only forward the new tokens instead of the full conversation.
+                 All calls of a session are run by the same generator.
+
+                 Arguments:
+                   idle_timeout: Release the decoder state when the session is not used for
+                     this duration in milliseconds (0 to disable). The conversation history
+                     is then forwarded again on the next call.
+
+                 Returns:
+                   A :class:`ctranslate2.GenerationSession` instance.
+             )pbdoc")
+
+        .def("generate_in_session", &GeneratorWrapper::generate_in_session,
+             py::arg("session"),
+             py::arg("tokens"),
+             py::kw_only(),
+             py::arg("repetition_penalty")=1,
+             py::arg("no_repeat_ngram_size")=0,
+             py::arg("disable_unk")=false,
+             py::arg("suppress_sequences")=py::none(),
+             py::arg("end_token")=py::none(),
+             py::arg("stop_sequences")=py::none(),
+             py::arg("max_length")=512,
+             py::arg("min_length")=0,
+             py::arg("return_scores")=false,
+             py::arg("return_topk_logprobs")=0,
+             py::arg("sampling_topk")=1,
+             py::arg("sampling_temperature")=1,
+             py::call_guard<py::gil_scoped_release>(),
+             R"pbdoc(
+                 Appends tokens to a session and continues the generation.
+
+                 Sessions only support greedy search or random sampling.
+
+                 Arguments:
+                   session: A session created with :meth:`create_session`.
+                   tokens: Tokens to append to the conversation. The first call should include
+                     the special start token like ``<s>`` if the decoder expects it.
+                   repetition_penalty: Penalty applied to the score of previously generated tokens
+                     (set > 1 to penalize).
+                   no_repeat_ngram_size: Prevent repetitions of ngrams with this size
+                     (set 0 to disable).
+                   disable_unk: Disable the generation of the unknown token.
+                   suppress_sequences: Disable the generation of some sequences of tokens.
+                   end_token: Stop the decoding on this token (defaults to the model EOS token).
+                   stop_sequences: Also stop the decoding when one of these sequences of tokens
+                     is generated. The stop sequence is included in the output.
+                   max_length: Maximum generation length in this call, including the
+                     appended tokens.
+                   min_length: Minimum generation length in this call.
+                   return_scores: Include the scores in the output.
+                   return_topk_logprobs: Include the K best token IDs and log probabilities
+                     at each decoding step in the output (set 0 to disable).
+                   sampling_topk: Randomly sample predictions from the top K candidates.
+                   sampling_temperature: Sampling temperature to generate more random samples.
+
+                 Returns:
+                   A :class:`ctranslate2.GenerationResult` instance with the appended and
+                   generated tokens.
+             )pbdoc")
+
+        .def("offload_session", &GeneratorWrapper::offload_session,
+             py::arg("session"),
+             py::call_guard<py::gil_scoped_release>(),
+             R"pbdoc(
+                 Copies the decoder state of a session to the host memory and releases the
+                 device buffers. This is a blocking copy run by the replica owning the session:
+                 the state is copied back to the model device on the next call.
+
+                 Arguments:
+                   session: A session created with :meth:`create_session`.
+             )pbdoc")
+
+        .def("evict_idle_sessions", &GeneratorWrapper::evict_idle_sessions,
+             py::call_guard<py::gil_scoped_release>(),
+             R"pbdoc(
+                 Releases the decoder state of the sessions that exceeded their idle timeout.
+
+                 This method is also called when a session is created or used.
+
+                 Returns:
+                   The number of sessions that were scheduled for eviction.
+             )pbdoc")
+
         .def("generate_batch", &GeneratorWrapper::generate_batch,
              py::arg("start_tokens"),
              py::kw_only(),
@@ -165,6 +539,13 @@ namespace ctranslate2 {
              py::arg("asynchronous")=false,
              py::arg("beam_size")=1,
              py::arg("patience")=1,
+             py::arg("beam_pruning_absolute_threshold")=0,
+             py::arg("beam_pruning_relative_threshold")=0,
+             py::arg("beam_score_bound")=false,
+             py::arg("early_exit_threshold")=0,
+             py::arg("early_exit_interval")=2,
+             py::arg("two_stage_candidates")=0,
+             py::arg("two_stage_exact_log_probs")=false,
              py::arg("num_hypotheses")=1,
              py::arg("length_penalty")=1,
              py::arg("repetition_penalty")=1,
@@ -172,9 +553,11 @@ namespace ctranslate2 {
              py::arg("disable_unk")=false,
              py::arg("suppress_sequences")=py::none(),
              py::arg("end_token")=py::none(),
+             py::arg("stop_sequences")=py::none(),
              py::arg("max_length")=512,
              py::arg("min_length")=0,
              py::arg("return_scores")=false,
+             py::arg("return_topk_logprobs")=0,
              py::arg("return_alternatives")=false,
              py::arg("min_alternative_expansion_prob")=0,
              py::arg("sampling_topk")=1,
@@ -196,6 +579,21 @@ namespace ctranslate2 {
                    patience: Beam search patience factor, as described in
                      https://arxiv.org/abs/2204.05424. The decoding will continue until
                      beam_size*patience hypotheses are finished.
+                   beam_pruning_absolute_threshold: Prune the beams whose log probability is lower
+                     than the best beam log probability minus this value (set 0 to disable).
+                   beam_pruning_relative_threshold: Prune the beams whose log probability is lower
+                     than the best beam log probability by more than this fraction (set 0 to disable).
+                   beam_score_bound: Finish a batch when its best beam can no longer beat the
+                     :obj:`num_hypotheses`-th finished hypothesis under the length penalty.
+                   early_exit_threshold: Stop running the decoder layers of a step when an
+                     intermediate layer predicts the next token with a probability above this
+                     threshold in all batches (set 0 to disable).
+                   early_exit_interval: Number of decoder layers between two early exit tests.
+                   two_stage_candidates: Compute the logits with an INT8 copy of the output layer,
+                     then recompute exactly the logits of this number of candidates with the
+                     best approximate logits (set 0 to disable).
+                   two_stage_exact_log_probs: Exclude the tokens that are not candidates from
+                     the softmax so that the log probabilities only use exact logits.
                    num_hypotheses: Number of hypotheses to return.
                    length_penalty: Exponential penalty applied to the length during beam search.
                    repetition_penalty: Penalty applied to the score of previously generated tokens
@@ -205,9 +603,13 @@ namespace ctranslate2 {
                    disable_unk: Disable the generation of the unknown token.
                    suppress_sequences: Disable the generation of some sequences of tokens.
                    end_token: Stop the decoding on this token (defaults to the model EOS token).
+                   stop_sequences: Also stop the decoding when one of these sequences of tokens
+                     is generated. The stop sequence is included in the output.
                    max_length: Maximum generation length.
                    min_length: Minimum generation length.
                    return_scores: Include the scores in the output.
+                   return_topk_logprobs: Include the K best token IDs and log probabilities
+                     at each decoding step in the output (set 0 to disable).
                    return_alternatives: Return alternatives at the first unconstrained decoding position.
                    min_alternative_expansion_prob: Minimum initial probability to expand an alternative.
                    sampling_topk: Randomly sample predictions from the top K candidates.
@@ -220,6 +622,41 @@ namespace ctranslate2 {
                    `GenerationOptions <https://github.com/OpenNMT/CTranslate2/blob/master/include/ctranslate2/generation.h>`_ structure in the C++ library.
              )pbdoc")
 
+        .def("_generate_iterable", &GeneratorWrapper::generate_iterable,
+             py::arg("start_tokens"),
+             py::kw_only(),
+             py::arg("max_batch_size")=32,
+             py::arg("batch_type")="examples",
+             py::arg("read_batch_size")=0,
+             py::arg("max_batches_per_replica")=0,
+             py::arg("beam_size")=1,
+             py::arg("patience")=1,
+             py::arg("beam_pruning_absolute_threshold")=0,
+             py::arg("beam_pruning_relative_threshold")=0,
+             py::arg("beam_score_bound")=false,
+             py::arg("early_exit_threshold")=0,
+             py::arg("early_exit_interval")=2,
+             py::arg("two_stage_candidates")=0,
+             py::arg("two_stage_exact_log_probs")=false,
+             py::arg("num_hypotheses")=1,
+             py::arg("length_penalty")=1,
+             py::arg("repetition_penalty")=1,
+             py::arg("no_repeat_ngram_size")=0,
+             py::arg("disable_unk")=false,
+             py::arg("suppress_sequences")=py::none(),
+             py::arg("end_token")=py::none(),
+             py::arg("stop_sequences")=py::none(),
+             py::arg("max_length")=512,
+             py::arg("min_length")=0,
+             py::arg("return_scores")=false,
+             py::arg("return_topk_logprobs")=0,
+             py::arg("return_alternatives")=false,
+             py::arg("min_alternative_expansion_prob")=0,
+             py::arg("sampling_topk")=1,
+             py::arg("sampling_temperature")=1,
+             py::keep_alive<0, 1>(),
+             "Implementation of :meth:`generate_iterable`.")
+
         .def("score_batch", &GeneratorWrapper::score_batch,
              py::arg("tokens"),
              py::kw_only(),
@@ -246,6 +683,17 @@ namespace ctranslate2 {
                    A list of scoring results.
              )pbdoc")
 
+        .def("_score_iterable", &GeneratorWrapper::score_iterable,
+             py::arg("tokens"),
+             py::kw_only(),
+             py::arg("max_batch_size")=64,
+             py::arg("batch_type")="examples",
+             py::arg("read_batch_size")=0,
+             py::arg("max_batches_per_replica")=0,
+             py::arg("max_input_length")=1024,
+             py::keep_alive<0, 1>(),
+             "Implementation of :meth:`score_iterable`.")
+
         .def("forward_batch", &GeneratorWrapper::forward_batch,
              py::arg("inputs"),
              py::arg("lengths")=py::none(),
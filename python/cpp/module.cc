@@ -40,6 +40,12 @@ PYBIND11_MODULE(_ext, m)
   m.def("get_cuda_device_count", &ctranslate2::get_gpu_count,
         "Returns the number of visible GPU devices.");
 
+  m.def("get_cpu_features", &ctranslate2::get_cpu_features,
+        R"pbdoc(
+            Returns the instruction set extensions detected on the CPU, for example
+            ``["SSE4.1", "AVX", "AVX2", "AVX512", "AVX512_VNNI"]``.
+        )pbdoc");
+
   m.def("get_supported_compute_types", &get_supported_compute_types,
         py::arg("device"),
         py::arg("device_index")=0,
@@ -60,6 +66,18 @@ PYBIND11_MODULE(_ext, m)
   m.def("set_random_seed", &ctranslate2::set_random_seed, py::arg("seed"),
         "Sets the seed of random generators.");
 
+  m.def("set_cpu_fast_math", &ctranslate2::set_cpu_fast_math, py::arg("enable"),
+        R"pbdoc(
+            Enables faster but less accurate approximations of exp, log, and GELU in the
+            CPU kernels (softmax, log softmax, GELU, SiLU). The setting applies to all
+            models.
+
+            This can also be enabled with the environment variable ``CT2_CPU_FAST_MATH=1``.
+        )pbdoc");
+
+  m.def("get_cpu_fast_math", &ctranslate2::get_cpu_fast_math,
+        "Returns True if the CPU kernels use the fast math approximations.");
+
   ctranslate2::python::register_logging(m);
   ctranslate2::python::register_storage_view(m);
   ctranslate2::python::register_translation_stats(m);
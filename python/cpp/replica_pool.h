@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ctranslate2/replica_pool.h>
+#include <ctranslate2/tuning.h>
 
 #include "utils.h"
 
@@ -44,9 +45,16 @@ namespace ctranslate2 {
                         size_t inter_threads,
                         size_t intra_threads,
                         long max_queued_batches,
-                        py::object files)
+                        py::object files,
+                        const std::vector<std::string>& ensemble_model_paths = {},
+                        const std::optional<std::string>& tuning_profile = std::nullopt,
+                        size_t max_memory_per_replica = 0)
         : _model_loader(create_model_reader(model_path, files))
       {
+        for (const auto& ensemble_model_path : ensemble_model_paths)
+          _model_loader.ensemble_model_readers.emplace_back(
+            std::make_shared<models::ModelFileReader>(ensemble_model_path));
+
         _model_loader.device = str_to_device(device);
         _model_loader.device_indices = std::visit(DeviceIndexResolver(), device_index);
         _model_loader.compute_type = std::visit(ComputeTypeResolver(device), compute_type);
@@ -54,6 +62,10 @@ namespace ctranslate2 {
 
         _pool_config.num_threads_per_replica = intra_threads;
         _pool_config.max_queued_batches = max_queued_batches;
+        _pool_config.max_memory_per_replica = max_memory_per_replica;
+
+        if (tuning_profile)
+          TuningProfile::load(*tuning_profile).apply(_model_loader, _pool_config);
 
         _pool = std::make_unique<T>(_model_loader, _pool_config);
       }
@@ -78,6 +90,28 @@ namespace ctranslate2 {
         return _pool->num_active_batches();
       }
 
+      std::vector<double> warmup(const std::vector<std::pair<size_t, size_t>>& batch_shapes,
+                                 size_t beam_size,
+                                 bool touch_weights) {
+        models::WarmupOptions options;
+        options.batch_shapes = batch_shapes;
+        options.beam_size = beam_size;
+        options.touch_weights = touch_weights;
+        return _pool->warmup(options);
+      }
+
+      size_t estimate_decoding_memory(size_t batch_size,
+                                      size_t beam_size,
+                                      size_t input_length,
+                                      size_t max_length,
+                                      size_t two_stage_candidates) const {
+        return _pool->estimate_decoding_memory(batch_size,
+                                               beam_size,
+                                               input_length,
+                                               max_length,
+                                               two_stage_candidates).total_bytes();
+      }
+
     protected:
       std::unique_ptr<T> _pool;
       models::ModelLoader _model_loader;
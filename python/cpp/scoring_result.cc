@@ -23,6 +23,7 @@ namespace ctranslate2 {
         ;
 
       declare_async_wrapper<ScoringResult>(m, "AsyncScoringResult");
+      declare_iterator_wrapper<ScoringResult>(m, "ScoringIterator");
     }
 
   }
@@ -68,7 +68,7 @@ namespace ctranslate2 {
       if (interface_obj.contains("strides") && !interface_obj["strides"].is_none())
         throw std::invalid_argument("StorageView does not support arrays with non contiguous memory");
 
-      auto shape = interface["shape"].cast<Shape>();
+      auto shape = Shape(interface["shape"].cast<std::vector<dim_t>>());
       auto dtype = typestr_to_dtype(interface["typestr"].cast<std::string>());
       auto data = interface["data"].cast<py::tuple>();
       auto ptr = data[0].cast<uintptr_t>();
@@ -16,6 +16,15 @@ namespace ctranslate2 {
                       "Score of each translation hypothesis (empty if :obj:`return_scores` was disabled).")
         .def_readonly("attention", &TranslationResult::attention,
                       "Attention matrix of each translation hypothesis (empty if :obj:`return_attention` was disabled).")
+        .def_readonly("topk_ids", &TranslationResult::topk_ids,
+                      "Best token IDs at each decoding step of each translation hypothesis "
+                      "(empty if :obj:`return_topk_logprobs` was disabled).")
+        .def_readonly("topk_logprobs", &TranslationResult::topk_logprobs,
+                      "Log probabilities of the best tokens at each decoding step of each "
+                      "translation hypothesis (empty if :obj:`return_topk_logprobs` was disabled).")
+        .def_readonly("average_exit_depth", &TranslationResult::average_exit_depth,
+                      "Average number of decoder layers run per decoding step in the batch "
+                      "(0 if :obj:`early_exit_threshold` was not set).")
 
         .def("__repr__", [](const TranslationResult& result) {
           return "TranslationResult(hypotheses=" + std::string(py::repr(py::cast(result.hypotheses)))
@@ -48,6 +57,7 @@ namespace ctranslate2 {
         ;
 
       declare_async_wrapper<TranslationResult>(m, "AsyncTranslationResult");
+      declare_iterator_wrapper<TranslationResult>(m, "TranslationIterator");
     }
 
   }
@@ -23,6 +23,76 @@ namespace ctranslate2 {
       return batch;
     }
 
+    static TranslationOptions
+    make_translation_options(size_t beam_size,
+                             float patience,
+                             float beam_pruning_absolute_threshold,
+                             float beam_pruning_relative_threshold,
+                             bool beam_score_bound,
+                             float early_exit_threshold,
+                             size_t early_exit_interval,
+                             size_t two_stage_candidates,
+                             bool two_stage_exact_log_probs,
+                             size_t num_hypotheses,
+                             float length_penalty,
+                             float coverage_penalty,
+                             float repetition_penalty,
+                             size_t no_repeat_ngram_size,
+                             bool disable_unk,
+                             const std::optional<std::vector<std::vector<std::string>>>& suppress_sequences,
+                             const std::optional<std::string>& end_token,
+                             const std::optional<std::vector<std::vector<std::string>>>& stop_sequences,
+                             float prefix_bias_beta,
+                             size_t max_input_length,
+                             size_t max_decoding_length,
+                             size_t min_decoding_length,
+                             bool use_vmap,
+                             bool return_scores,
+                             bool return_attention,
+                             size_t return_topk_logprobs,
+                             bool return_alternatives,
+                             float min_alternative_expansion_prob,
+                             size_t sampling_topk,
+                             float sampling_temperature,
+                             bool replace_unknowns) {
+      TranslationOptions options;
+      options.beam_size = beam_size;
+      options.patience = patience;
+      options.beam_pruning_absolute_threshold = beam_pruning_absolute_threshold;
+      options.beam_pruning_relative_threshold = beam_pruning_relative_threshold;
+      options.beam_score_bound = beam_score_bound;
+      options.early_exit_threshold = early_exit_threshold;
+      options.early_exit_interval = early_exit_interval;
+      options.two_stage_candidates = two_stage_candidates;
+      options.two_stage_exact_log_probs = two_stage_exact_log_probs;
+      options.length_penalty = length_penalty;
+      options.coverage_penalty = coverage_penalty;
+      options.repetition_penalty = repetition_penalty;
+      options.no_repeat_ngram_size = no_repeat_ngram_size;
+      options.disable_unk = disable_unk;
+      options.prefix_bias_beta = prefix_bias_beta;
+      options.sampling_topk = sampling_topk;
+      options.sampling_temperature = sampling_temperature;
+      options.max_input_length = max_input_length;
+      options.max_decoding_length = max_decoding_length;
+      options.min_decoding_length = min_decoding_length;
+      options.num_hypotheses = num_hypotheses;
+      options.use_vmap = use_vmap;
+      options.return_scores = return_scores;
+      options.return_attention = return_attention;
+      options.return_topk_logprobs = return_topk_logprobs;
+      options.return_alternatives = return_alternatives;
+      options.min_alternative_expansion_prob = min_alternative_expansion_prob;
+      options.replace_unknowns = replace_unknowns;
+      if (suppress_sequences)
+        options.suppress_sequences = suppress_sequences.value();
+      if (end_token)
+        options.end_token = end_token.value();
+      if (stop_sequences)
+        options.stop_sequences = stop_sequences.value();
+      return options;
+    }
+
     class TranslatorWrapper : public ReplicaPoolHelper<Translator>
     {
     public:
@@ -33,7 +103,10 @@ namespace ctranslate2 {
                         size_t inter_threads,
                         size_t intra_threads,
                         long max_queued_batches,
-                        py::object files)
+                        py::object files,
+                        const std::vector<std::string>& ensemble_model_paths,
+                        const std::optional<std::string>& tuning_profile,
+                        size_t max_memory_per_replica)
         : ReplicaPoolHelper(model_path,
                             device,
                             device_index,
@@ -41,7 +114,10 @@ namespace ctranslate2 {
                             inter_threads,
                             intra_threads,
                             max_queued_batches,
-                            files)
+                            files,
+                            ensemble_model_paths,
+                            tuning_profile,
+                            max_memory_per_replica)
         , _device(_model_loader.device)
         , _device_index(_model_loader.device_indices)
         , _num_replicas_per_device(_model_loader.num_replicas_per_device)
@@ -65,6 +141,13 @@ namespace ctranslate2 {
                      const std::string& batch_type_str,
                      size_t beam_size,
                      float patience,
+                     float beam_pruning_absolute_threshold,
+                     float beam_pruning_relative_threshold,
+                     bool beam_score_bound,
+                     float early_exit_threshold,
+                     size_t early_exit_interval,
+                     size_t two_stage_candidates,
+                     bool two_stage_exact_log_probs,
                      size_t num_hypotheses,
                      float length_penalty,
                      float coverage_penalty,
@@ -95,6 +178,13 @@ namespace ctranslate2 {
         TranslationOptions options;
         options.beam_size = beam_size;
         options.patience = patience;
+        options.beam_pruning_absolute_threshold = beam_pruning_absolute_threshold;
+        options.beam_pruning_relative_threshold = beam_pruning_relative_threshold;
+        options.beam_score_bound = beam_score_bound;
+        options.early_exit_threshold = early_exit_threshold;
+        options.early_exit_interval = early_exit_interval;
+        options.two_stage_candidates = two_stage_candidates;
+        options.two_stage_exact_log_probs = two_stage_exact_log_probs;
         options.length_penalty = length_penalty;
         options.coverage_penalty = coverage_penalty;
         options.repetition_penalty = repetition_penalty;
@@ -151,6 +241,13 @@ namespace ctranslate2 {
                       bool asynchronous,
                       size_t beam_size,
                       float patience,
+                      float beam_pruning_absolute_threshold,
+                      float beam_pruning_relative_threshold,
+                      bool beam_score_bound,
+                      float early_exit_threshold,
+                      size_t early_exit_interval,
+                      size_t two_stage_candidates,
+                      bool two_stage_exact_log_probs,
                       size_t num_hypotheses,
                       float length_penalty,
                       float coverage_penalty,
@@ -159,6 +256,7 @@ namespace ctranslate2 {
                       bool disable_unk,
                       const std::optional<std::vector<std::vector<std::string>>>& suppress_sequences,
                       const std::optional<std::string>& end_token,
+                      const std::optional<std::vector<std::vector<std::string>>>& stop_sequences,
                       float prefix_bias_beta,
                       size_t max_input_length,
                       size_t max_decoding_length,
@@ -166,6 +264,7 @@ namespace ctranslate2 {
                       bool use_vmap,
                       bool return_scores,
                       bool return_attention,
+                      size_t return_topk_logprobs,
                       bool return_alternatives,
                       float min_alternative_expansion_prob,
                       size_t sampling_topk,
@@ -175,31 +274,37 @@ namespace ctranslate2 {
           return {};
 
         BatchType batch_type = str_to_batch_type(batch_type_str);
-        TranslationOptions options;
-        options.beam_size = beam_size;
-        options.patience = patience;
-        options.length_penalty = length_penalty;
-        options.coverage_penalty = coverage_penalty;
-        options.repetition_penalty = repetition_penalty;
-        options.no_repeat_ngram_size = no_repeat_ngram_size;
-        options.disable_unk = disable_unk;
-        options.prefix_bias_beta = prefix_bias_beta;
-        options.sampling_topk = sampling_topk;
-        options.sampling_temperature = sampling_temperature;
-        options.max_input_length = max_input_length;
-        options.max_decoding_length = max_decoding_length;
-        options.min_decoding_length = min_decoding_length;
-        options.num_hypotheses = num_hypotheses;
-        options.use_vmap = use_vmap;
-        options.return_scores = return_scores;
-        options.return_attention = return_attention;
-        options.return_alternatives = return_alternatives;
-        options.min_alternative_expansion_prob = min_alternative_expansion_prob;
-        options.replace_unknowns = replace_unknowns;
-        if (suppress_sequences)
-          options.suppress_sequences = suppress_sequences.value();
-        if (end_token)
-          options.end_token = end_token.value();
+        const auto options = make_translation_options(beam_size,
+                                                      patience,
+                                                      beam_pruning_absolute_threshold,
+                                                      beam_pruning_relative_threshold,
+                                                      beam_score_bound,
+                                                      early_exit_threshold,
+                                                      early_exit_interval,
+                                                      two_stage_candidates,
+                                                      two_stage_exact_log_probs,
+                                                      num_hypotheses,
+                                                      length_penalty,
+                                                      coverage_penalty,
+                                                      repetition_penalty,
+                                                      no_repeat_ngram_size,
+                                                      disable_unk,
+                                                      suppress_sequences,
+                                                      end_token,
+                                                      stop_sequences,
+                                                      prefix_bias_beta,
+                                                      max_input_length,
+                                                      max_decoding_length,
+                                                      min_decoding_length,
+                                                      use_vmap,
+                                                      return_scores,
+                                                      return_attention,
+                                                      return_topk_logprobs,
+                                                      return_alternatives,
+                                                      min_alternative_expansion_prob,
+                                                      sampling_topk,
+                                                      sampling_temperature,
+                                                      replace_unknowns);
 
         std::shared_lock lock(_mutex);
         assert_model_is_ready();
@@ -213,6 +318,93 @@ namespace ctranslate2 {
         return maybe_wait_on_futures(std::move(futures), asynchronous);
       }
 
+      ResultIteratorWrapper<TranslationResult>
+      translate_iterable(const py::object& source,
+                         const py::object& target_prefix,
+                         size_t max_batch_size,
+                         const std::string& batch_type_str,
+                         size_t read_batch_size,
+                         size_t max_batches_per_replica,
+                         size_t beam_size,
+                         float patience,
+                         float beam_pruning_absolute_threshold,
+                         float beam_pruning_relative_threshold,
+                         bool beam_score_bound,
+                         float early_exit_threshold,
+                         size_t early_exit_interval,
+                         size_t two_stage_candidates,
+                         bool two_stage_exact_log_probs,
+                         size_t num_hypotheses,
+                         float length_penalty,
+                         float coverage_penalty,
+                         float repetition_penalty,
+                         size_t no_repeat_ngram_size,
+                         bool disable_unk,
+                         const std::optional<std::vector<std::vector<std::string>>>& suppress_sequences,
+                         const std::optional<std::string>& end_token,
+                         const std::optional<std::vector<std::vector<std::string>>>& stop_sequences,
+                         float prefix_bias_beta,
+                         size_t max_input_length,
+                         size_t max_decoding_length,
+                         size_t min_decoding_length,
+                         bool use_vmap,
+                         bool return_scores,
+                         bool return_attention,
+                         size_t return_topk_logprobs,
+                         bool return_alternatives,
+                         float min_alternative_expansion_prob,
+                         size_t sampling_topk,
+                         float sampling_temperature,
+                         bool replace_unknowns) {
+        const auto batch_type = str_to_batch_type(batch_type_str);
+        const auto options = make_translation_options(beam_size,
+                                                      patience,
+                                                      beam_pruning_absolute_threshold,
+                                                      beam_pruning_relative_threshold,
+                                                      beam_score_bound,
+                                                      early_exit_threshold,
+                                                      early_exit_interval,
+                                                      two_stage_candidates,
+                                                      two_stage_exact_log_probs,
+                                                      num_hypotheses,
+                                                      length_penalty,
+                                                      coverage_penalty,
+                                                      repetition_penalty,
+                                                      no_repeat_ngram_size,
+                                                      disable_unk,
+                                                      suppress_sequences,
+                                                      end_token,
+                                                      stop_sequences,
+                                                      prefix_bias_beta,
+                                                      max_input_length,
+                                                      max_decoding_length,
+                                                      min_decoding_length,
+                                                      use_vmap,
+                                                      return_scores,
+                                                      return_attention,
+                                                      return_topk_logprobs,
+                                                      return_alternatives,
+                                                      min_alternative_expansion_prob,
+                                                      sampling_topk,
+                                                      sampling_temperature,
+                                                      replace_unknowns);
+
+        std::vector<py::object> iterables = {source};
+        if (!target_prefix.is_none())
+          iterables.emplace_back(target_prefix);
+        auto reader = std::make_unique<PyIterableReader>(iterables);
+
+        std::shared_lock lock(_mutex);
+        assert_model_is_ready();
+
+        return _pool->translate_iterable(std::move(reader),
+                                         options,
+                                         max_batch_size,
+                                         read_batch_size,
+                                         batch_type,
+                                         max_batches_per_replica);
+      }
+
       std::variant<std::vector<ScoringResult>,
                    std::vector<AsyncResult<ScoringResult>>>
       score_batch(const BatchTokens& source,
@@ -237,6 +429,31 @@ namespace ctranslate2 {
         return maybe_wait_on_futures(std::move(futures), asynchronous);
       }
 
+      ResultIteratorWrapper<ScoringResult>
+      score_iterable(const py::object& source,
+                     const py::object& target,
+                     size_t max_batch_size,
+                     const std::string& batch_type_str,
+                     size_t read_batch_size,
+                     size_t max_batches_per_replica,
+                     size_t max_input_length) {
+        const auto batch_type = str_to_batch_type(batch_type_str);
+        ScoringOptions options;
+        options.max_input_length = max_input_length;
+
+        auto reader = std::make_unique<PyIterableReader>(std::vector<py::object>{source, target});
+
+        std::shared_lock lock(_mutex);
+        assert_model_is_ready();
+
+        return _pool->score_iterable(std::move(reader),
+                                     options,
+                                     max_batch_size,
+                                     read_batch_size,
+                                     batch_type,
+                                     max_batches_per_replica);
+      }
+
       ExecutionStats score_file(const std::string& source_path,
                                 const std::string& target_path,
                                 const std::string& output_path,
@@ -283,6 +500,28 @@ namespace ctranslate2 {
         }
       }
 
+      std::vector<double> warmup(const std::vector<std::pair<size_t, size_t>>& batch_shapes,
+                                 size_t beam_size,
+                                 bool touch_weights) {
+        std::shared_lock lock(_mutex);
+        assert_model_is_ready();
+        return ReplicaPoolHelper::warmup(batch_shapes, beam_size, touch_weights);
+      }
+
+      size_t estimate_decoding_memory(size_t batch_size,
+                                      size_t beam_size,
+                                      size_t input_length,
+                                      size_t max_length,
+                                      size_t two_stage_candidates) {
+        std::shared_lock lock(_mutex);
+        assert_model_is_ready();
+        return ReplicaPoolHelper::estimate_decoding_memory(batch_size,
+                                                           beam_size,
+                                                           input_length,
+                                                           max_length,
+                                                           two_stage_candidates);
+      }
+
       void unload_model(const bool to_cpu) {
         if (to_cpu && _device == Device::CPU)
           return;
@@ -367,7 +606,7 @@ namespace ctranslate2 {
                 >>> translator.translate_batch([["▁Hello", "▁world", "!"]])
         )pbdoc")
 
-        .def(py::init<const std::string&, const std::string&, const std::variant<int, std::vector<int>>&, const StringOrMap&, size_t, size_t, long, py::object>(),
+        .def(py::init<const std::string&, const std::string&, const std::variant<int, std::vector<int>>&, const StringOrMap&, size_t, size_t, long, py::object, const std::vector<std::string>&, const std::optional<std::string>&, size_t>(),
              py::arg("model_path"),
              py::arg("device")="cpu",
              py::kw_only(),
@@ -377,6 +616,9 @@ namespace ctranslate2 {
              py::arg("intra_threads")=0,
              py::arg("max_queued_batches")=0,
              py::arg("files")=py::none(),
+             py::arg("ensemble_model_paths")=std::vector<std::string>(),
+             py::arg("tuning_profile")=py::none(),
+             py::arg("max_memory_per_replica")=0,
              R"pbdoc(
                  Initializes the translator.
 
@@ -395,6 +637,15 @@ namespace ctranslate2 {
                    files: Load model files from the memory. This argument is a dictionary mapping
                      file names to file contents as file-like or bytes objects. If this is set,
                      :obj:`model_path` acts as an identifier for this model.
+                  ensemble_model_paths: Paths to additional models to ensemble with the
+                    model. The models should have the same vocabularies and their log
+                    probabilities are averaged at each decoding step.
+                  tuning_profile: Path to a profile written by ``ct2-tuner``. The profile
+                    overrides :obj:`inter_threads`, :obj:`intra_threads`, :obj:`compute_type`,
+                    and sets the default :obj:`max_batch_size`.
+                  max_memory_per_replica: Memory budget of a decoding batch in bytes, as
+                    predicted by :meth:`estimate_decoding_memory` (0 for no limit). Larger
+                    batches are split, and an example that does not fit alone raises an error.
              )pbdoc")
 
         .def_property_readonly("device", &TranslatorWrapper::device,
@@ -408,6 +659,53 @@ namespace ctranslate2 {
         .def_property_readonly("num_active_batches", &TranslatorWrapper::num_active_batches,
                                "Number of batches waiting to be processed or currently processed.")
 
+        .def("estimate_decoding_memory", &TranslatorWrapper::estimate_decoding_memory,
+             py::arg("batch_size"),
+             py::arg("beam_size")=1,
+             py::kw_only(),
+             py::arg("input_length"),
+             py::arg("max_length"),
+             py::arg("two_stage_candidates")=0,
+             R"pbdoc(
+                 Estimates the peak memory used to decode a batch on one translator, excluding
+                 the model weights. The estimate assumes that all hypotheses reach
+                 :obj:`max_length`.
+
+                 Arguments:
+                   batch_size: Number of examples in the batch.
+                   beam_size: Beam size (or number of hypotheses when sampling).
+                   input_length: Maximum source length in the batch.
+                   max_length: Maximum decoding length.
+                   two_stage_candidates: Number of candidates of the two-stage output
+                     projection, which adds the INT8 copy of the projection to the estimate.
+
+                 Returns:
+                   The estimated memory usage in bytes.
+             )pbdoc")
+
+        .def("warmup", &TranslatorWrapper::warmup,
+             py::kw_only(),
+             py::arg("batch_shapes")=std::vector<std::pair<size_t, size_t>>{{1, 16}},
+             py::arg("beam_size")=1,
+             py::arg("touch_weights")=true,
+             py::call_guard<py::gil_scoped_release>(),
+             R"pbdoc(
+                 Runs synthetic batches on all model replicas in parallel so that the first
+                 requests are not slowed down by one-time initializations.
+
+                 This method should be called before submitting other requests.
+
+                 Arguments:
+                   batch_shapes: List of (batch size, length) pairs defining the synthetic
+                     batches to run on each replica.
+                   beam_size: Beam size used to decode the synthetic batches.
+                   touch_weights: Read each memory page of the model weights before running
+                     the batches.
+
+                 Returns:
+                   The warmup time of each replica in milliseconds.
+             )pbdoc")
+
         .def("translate_batch", &TranslatorWrapper::translate_batch,
              py::arg("source"),
              py::arg("target_prefix")=py::none(),
@@ -417,6 +715,13 @@ namespace ctranslate2 {
              py::arg("asynchronous")=false,
              py::arg("beam_size")=2,
              py::arg("patience")=1,
+             py::arg("beam_pruning_absolute_threshold")=0,
+             py::arg("beam_pruning_relative_threshold")=0,
+             py::arg("beam_score_bound")=false,
+             py::arg("early_exit_threshold")=0,
+             py::arg("early_exit_interval")=2,
+             py::arg("two_stage_candidates")=0,
+             py::arg("two_stage_exact_log_probs")=false,
              py::arg("num_hypotheses")=1,
              py::arg("length_penalty")=1,
              py::arg("coverage_penalty")=0,
@@ -425,6 +730,7 @@ namespace ctranslate2 {
              py::arg("disable_unk")=false,
              py::arg("suppress_sequences")=py::none(),
              py::arg("end_token")=py::none(),
+             py::arg("stop_sequences")=py::none(),
              py::arg("prefix_bias_beta")=0,
              py::arg("max_input_length")=1024,
              py::arg("max_decoding_length")=256,
@@ -432,6 +738,7 @@ namespace ctranslate2 {
              py::arg("use_vmap")=false,
              py::arg("return_scores")=false,
              py::arg("return_attention")=false,
+             py::arg("return_topk_logprobs")=0,
              py::arg("return_alternatives")=false,
              py::arg("min_alternative_expansion_prob")=0,
              py::arg("sampling_topk")=1,
@@ -454,6 +761,21 @@ namespace ctranslate2 {
                    patience: Beam search patience factor, as described in
                      https://arxiv.org/abs/2204.05424. The decoding will continue until
                      beam_size*patience hypotheses are finished.
+                   beam_pruning_absolute_threshold: Prune the beams whose log probability is lower
+                     than the best beam log probability minus this value (set 0 to disable).
+                   beam_pruning_relative_threshold: Prune the beams whose log probability is lower
+                     than the best beam log probability by more than this fraction (set 0 to disable).
+                   beam_score_bound: Finish a batch when its best beam can no longer beat the
+                     :obj:`num_hypotheses`-th finished hypothesis under the length penalty.
+                   early_exit_threshold: Stop running the decoder layers of a step when an
+                     intermediate layer predicts the next token with a probability above this
+                     threshold in all batches (set 0 to disable).
+                   early_exit_interval: Number of decoder layers between two early exit tests.
+                   two_stage_candidates: Compute the logits with an INT8 copy of the output layer,
+                     then recompute exactly the logits of this number of candidates with the
+                     best approximate logits (set 0 to disable).
+                   two_stage_exact_log_probs: Exclude the tokens that are not candidates from
+                     the softmax so that the log probabilities only use exact logits.
                    num_hypotheses: Number of hypotheses to return.
                    length_penalty: Exponential penalty applied to the length during beam search.
                    coverage_penalty: Coverage penalty weight applied during beam search.
@@ -464,6 +786,8 @@ namespace ctranslate2 {
                    disable_unk: Disable the generation of the unknown token.
                    suppress_sequences: Disable the generation of some sequences of tokens.
                    end_token: Stop the decoding on this token (defaults to the model EOS token).
+                   stop_sequences: Also stop the decoding when one of these sequences of tokens
+                     is generated. The stop sequence is included in the output.
                    prefix_bias_beta: Parameter for biasing translations towards given prefix.
                    max_input_length: Truncate inputs after this many tokens (set 0 to disable).
                    max_decoding_length: Maximum prediction length.
@@ -471,6 +795,8 @@ namespace ctranslate2 {
                    use_vmap: Use the vocabulary mapping file saved in this model
                    return_scores: Include the scores in the output.
                    return_attention: Include the attention vectors in the output.
+                   return_topk_logprobs: Include the K best token IDs and log probabilities
+                     at each decoding step in the output (set 0 to disable).
                    return_alternatives: Return alternatives at the first unconstrained decoding position.
                    min_alternative_expansion_prob: Minimum initial probability to expand an alternative.
                    sampling_topk: Randomly sample predictions from the top K candidates.
@@ -484,6 +810,48 @@ namespace ctranslate2 {
                    `TranslationOptions <https://github.com/OpenNMT/CTranslate2/blob/master/include/ctranslate2/translation.h>`_ structure in the C++ library.
              )pbdoc")
 
+        .def("_translate_iterable", &TranslatorWrapper::translate_iterable,
+             py::arg("source"),
+             py::arg("target_prefix")=py::none(),
+             py::kw_only(),
+             py::arg("max_batch_size")=32,
+             py::arg("batch_type")="examples",
+             py::arg("read_batch_size")=0,
+             py::arg("max_batches_per_replica")=0,
+             py::arg("beam_size")=2,
+             py::arg("patience")=1,
+             py::arg("beam_pruning_absolute_threshold")=0,
+             py::arg("beam_pruning_relative_threshold")=0,
+             py::arg("beam_score_bound")=false,
+             py::arg("early_exit_threshold")=0,
+             py::arg("early_exit_interval")=2,
+             py::arg("two_stage_candidates")=0,
+             py::arg("two_stage_exact_log_probs")=false,
+             py::arg("num_hypotheses")=1,
+             py::arg("length_penalty")=1,
+             py::arg("coverage_penalty")=0,
+             py::arg("repetition_penalty")=1,
+             py::arg("no_repeat_ngram_size")=0,
+             py::arg("disable_unk")=false,
+             py::arg("suppress_sequences")=py::none(),
+             py::arg("end_token")=py::none(),
+             py::arg("stop_sequences")=py::none(),
+             py::arg("prefix_bias_beta")=0,
+             py::arg("max_input_length")=1024,
+             py::arg("max_decoding_length")=256,
+             py::arg("min_decoding_length")=1,
+             py::arg("use_vmap")=false,
+             py::arg("return_scores")=false,
+             py::arg("return_attention")=false,
+             py::arg("return_topk_logprobs")=0,
+             py::arg("return_alternatives")=false,
+             py::arg("min_alternative_expansion_prob")=0,
+             py::arg("sampling_topk")=1,
+             py::arg("sampling_temperature")=1,
+             py::arg("replace_unknowns")=false,
+             py::keep_alive<0, 1>(),
+             "Implementation of :meth:`translate_iterable`.")
+
         .def("translate_file", &TranslatorWrapper::translate_file,
              py::arg("source_path"),
              py::arg("output_path"),
@@ -494,6 +862,13 @@ namespace ctranslate2 {
              py::arg("batch_type")="examples",
              py::arg("beam_size")=2,
              py::arg("patience")=1,
+             py::arg("beam_pruning_absolute_threshold")=0,
+             py::arg("beam_pruning_relative_threshold")=0,
+             py::arg("beam_score_bound")=false,
+             py::arg("early_exit_threshold")=0,
+             py::arg("early_exit_interval")=2,
+             py::arg("two_stage_candidates")=0,
+             py::arg("two_stage_exact_log_probs")=false,
              py::arg("num_hypotheses")=1,
              py::arg("length_penalty")=1,
              py::arg("coverage_penalty")=0,
@@ -533,6 +908,21 @@ namespace ctranslate2 {
                    patience: Beam search patience factor, as described in
                      https://arxiv.org/abs/2204.05424. The decoding will continue until
                      beam_size*patience hypotheses are finished.
+                   beam_pruning_absolute_threshold: Prune the beams whose log probability is lower
+                     than the best beam log probability minus this value (set 0 to disable).
+                   beam_pruning_relative_threshold: Prune the beams whose log probability is lower
+                     than the best beam log probability by more than this fraction (set 0 to disable).
+                   beam_score_bound: Finish a batch when its best beam can no longer beat the
+                     :obj:`num_hypotheses`-th finished hypothesis under the length penalty.
+                   early_exit_threshold: Stop running the decoder layers of a step when an
+                     intermediate layer predicts the next token with a probability above this
+                     threshold in all batches (set 0 to disable).
+                   early_exit_interval: Number of decoder layers between two early exit tests.
+                   two_stage_candidates: Compute the logits with an INT8 copy of the output layer,
+                     then recompute exactly the logits of this number of candidates with the
+                     best approximate logits (set 0 to disable).
+                   two_stage_exact_log_probs: Exclude the tokens that are not candidates from
+                     the softmax so that the log probabilities only use exact logits.
                    num_hypotheses: Number of hypotheses to return.
                    length_penalty: Exponential penalty applied to the length during beam search.
                    coverage_penalty: Coverage penalty weight applied during beam search.
@@ -590,6 +980,18 @@ namespace ctranslate2 {
                    A list of scoring results.
              )pbdoc")
 
+        .def("_score_iterable", &TranslatorWrapper::score_iterable,
+             py::arg("source"),
+             py::arg("target"),
+             py::kw_only(),
+             py::arg("max_batch_size")=64,
+             py::arg("batch_type")="examples",
+             py::arg("read_batch_size")=0,
+             py::arg("max_batches_per_replica")=0,
+             py::arg("max_input_length")=1024,
+             py::keep_alive<0, 1>(),
+             "Implementation of :meth:`score_iterable`.")
+
         .def("score_file", &TranslatorWrapper::score_file,
              py::arg("source_path"),
              py::arg("target_path"),
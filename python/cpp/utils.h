@@ -1,7 +1,9 @@
 #pragma once
 
 #include <chrono>
+#include <deque>
 #include <future>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <variant>
@@ -11,6 +13,8 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <ctranslate2/batch_reader.h>
+#include <ctranslate2/result_iterator.h>
 #include <ctranslate2/types.h>
 
 namespace py = pybind11;
@@ -112,6 +116,119 @@ namespace ctranslate2 {
       }
     }
 
+    // Reads examples from Python iterables, one iterable per stream. The GIL is acquired
+    // once per chunk of examples so that the batching can run without the GIL.
+    class PyIterableReader : public BatchReader {
+    public:
+      // The GIL should be held when calling the constructor.
+      PyIterableReader(const std::vector<py::object>& iterables, size_t chunk_size = 64)
+        : _chunk_size(chunk_size)
+      {
+        for (const auto& iterable : iterables)
+          _iterators.emplace_back(py::iter(iterable));
+      }
+
+      ~PyIterableReader() override {
+        py::gil_scoped_acquire acquire;
+        _iterators.clear();
+      }
+
+      Example get_next_example() override {
+        if (_examples.empty() && !_end_of_stream)
+          read_chunk();
+        if (_examples.empty())
+          return Example();
+
+        Example example = std::move(_examples.front());
+        _examples.pop_front();
+        return example;
+      }
+
+    private:
+      const size_t _chunk_size;
+      std::vector<py::iterator> _iterators;
+      std::deque<Example> _examples;
+      bool _end_of_stream = false;
+
+      void read_chunk() {
+        py::gil_scoped_acquire acquire;
+
+        for (size_t i = 0; i < _chunk_size; ++i) {
+          std::vector<py::object> items;
+          items.reserve(_iterators.size());
+          size_t num_finished = 0;
+
+          for (auto& iterator : _iterators) {
+            auto item = py::reinterpret_steal<py::object>(PyIter_Next(iterator.ptr()));
+            if (!item) {
+              if (PyErr_Occurred())
+                throw py::error_already_set();
+              ++num_finished;
+            }
+            items.emplace_back(std::move(item));
+          }
+
+          if (num_finished == items.size()) {
+            _end_of_stream = true;
+            break;
+          }
+          if (num_finished > 0)
+            throw std::invalid_argument("Input iterables do not have the same length");
+
+          Example example;
+          example.streams.reserve(items.size());
+          for (size_t s = 0; s < items.size(); ++s) {
+            // Optional streams such as the target prefix can contain None values.
+            if (s > 0 && items[s].is_none())
+              example.streams.emplace_back();
+            else
+              example.streams.emplace_back(items[s].cast<Tokens>());
+          }
+
+          _examples.emplace_back(std::move(example));
+        }
+      }
+    };
+
+    template <typename T>
+    class ResultIteratorWrapper {
+    public:
+      ResultIteratorWrapper(std::unique_ptr<ResultIterator<T>> iterator)
+        : _iterator(std::move(iterator))
+      {
+      }
+
+      ResultIteratorWrapper(ResultIteratorWrapper&&) = default;
+
+      ~ResultIteratorWrapper() {
+        // The background thread may be waiting for the GIL to read the next examples.
+        py::gil_scoped_release release;
+        _iterator.reset();
+      }
+
+      T next() {
+        std::optional<T> result;
+        {
+          py::gil_scoped_release release;
+          result = _iterator->next();
+        }
+        if (!result)
+          throw py::stop_iteration();
+        return std::move(*result);
+      }
+
+    private:
+      std::unique_ptr<ResultIterator<T>> _iterator;
+    };
+
+    template <typename T>
+    static void declare_iterator_wrapper(py::module& m, const char* name) {
+      py::class_<ResultIteratorWrapper<T>>(m, name, "Iterator over the results of a stream of examples.")
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", &ResultIteratorWrapper<T>::next)
+        ;
+    }
+
     template <typename T>
     static void declare_async_wrapper(py::module& m, const char* name) {
       py::class_<AsyncResult<T>>(m, name, "Asynchronous wrapper around a result object.")
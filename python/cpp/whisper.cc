@@ -37,7 +37,8 @@ namespace ctranslate2 {
                bool suppress_blank,
                const std::optional<std::vector<int>>& suppress_tokens,
                size_t sampling_topk,
-               float sampling_temperature) {
+               float sampling_temperature,
+               bool vad_filter) {
         std::vector<std::future<models::WhisperGenerationResult>> futures;
 
         models::WhisperOptions options;
@@ -55,6 +56,7 @@ namespace ctranslate2 {
         options.return_no_speech_prob = return_no_speech_prob;
         options.max_initial_timestamp_index = max_initial_timestamp_index;
         options.suppress_blank = suppress_blank;
+        options.vad_filter = vad_filter;
 
         if (suppress_tokens)
           options.suppress_tokens = suppress_tokens.value();
@@ -79,6 +81,25 @@ namespace ctranslate2 {
           results.emplace_back(future.get());
         return results;
       }
+
+      static models::WhisperSpeechWindows
+      pack_speech(const StorageViewWrapper& features,
+                  size_t window_frames,
+                  float energy_threshold,
+                  float flux_threshold,
+                  size_t min_speech_frames,
+                  size_t min_silence_frames,
+                  size_t speech_pad_frames,
+                  float absolute_energy_threshold) {
+        models::WhisperVadOptions options;
+        options.energy_threshold = energy_threshold;
+        options.flux_threshold = flux_threshold;
+        options.min_speech_frames = min_speech_frames;
+        options.min_silence_frames = min_silence_frames;
+        options.speech_pad_frames = speech_pad_frames;
+        options.absolute_energy_threshold = absolute_energy_threshold;
+        return models::pack_speech(features.get_view(), options, window_frames);
+      }
     };
 
     void register_whisper(py::module& m) {
@@ -133,6 +154,29 @@ namespace ctranslate2 {
 
       declare_async_wrapper<models::WhisperGenerationResult>(m, "WhisperGenerationResultAsync");
 
+      py::class_<models::WhisperSpeechWindows>(m, "WhisperSpeechWindows",
+                                               "Speech regions packed into windows.")
+
+        .def_property_readonly("features", [](const models::WhisperSpeechWindows& windows) {
+          return StorageViewWrapper(windows.features);
+        }, "Windows of speech with shape ``[num_windows, n_mels, window_frames]``.")
+
+        .def_readonly("regions", &models::WhisperSpeechWindows::regions,
+                      "Speech regions of the input features packed in each window, as "
+                      "(start, end) frames.")
+
+        .def("to_input_time", &models::WhisperSpeechWindows::to_input_time,
+             py::arg("window"),
+             py::arg("time"),
+             py::arg("is_end")=false,
+             R"pbdoc(
+                 Maps a time in seconds relative to the start of a window to the time in
+                 the input features. A time between two regions is mapped to the end of
+                 the first region if :obj:`is_end` is set (e.g. for the end of a segment),
+                 and to the start of the second region otherwise.
+             )pbdoc")
+        ;
+
       py::class_<WhisperWrapper>(
         m, "Whisper",
         R"pbdoc(
@@ -195,6 +239,7 @@ namespace ctranslate2 {
              py::arg("suppress_tokens")=std::vector<int>{-1},
              py::arg("sampling_topk")=1,
              py::arg("sampling_temperature")=1,
+             py::arg("vad_filter")=false,
              py::call_guard<py::gil_scoped_release>(),
              R"pbdoc(
                  Encodes the input features and generates from the given prompt.
@@ -225,6 +270,10 @@ namespace ctranslate2 {
                      of symbols as defined in the model ``config.json`` file.
                    sampling_topk: Randomly sample predictions from the top K candidates.
                    sampling_temperature: Sampling temperature to generate more random samples.
+                   vad_filter: Detect the speech in each window with an energy-based voice
+                     activity detection. Windows without speech are not encoded and return
+                     empty sequences, and the silences of the other windows are moved to the
+                     end. The timestamps are mapped back to the input features.
 
                  Returns:
                    A list of generation results.
@@ -248,6 +297,67 @@ namespace ctranslate2 {
                    RuntimeError: if the model is not multilingual.
              )pbdoc")
 
+        .def_static("pack_speech", &WhisperWrapper::pack_speech,
+                    py::arg("features"),
+                    py::kw_only(),
+                    py::arg("window_frames")=3000,
+                    py::arg("energy_threshold")=15,
+                    py::arg("flux_threshold")=8,
+                    py::arg("min_speech_frames")=10,
+                    py::arg("min_silence_frames")=50,
+                    py::arg("speech_pad_frames")=20,
+                    py::arg("absolute_energy_threshold")=0,
+                    py::call_guard<py::gil_scoped_release>(),
+                    R"pbdoc(
+                        Detects the speech regions of a long Mel spectrogram and concatenates
+                        them into windows, so that the silences are not encoded.
+
+                        Arguments:
+                          features: Mel spectogram of the audio, as a float32 array with shape
+                            ``[80, n_frames]``.
+                          window_frames: Number of frames in each window.
+                          energy_threshold: Minimum energy above the noise floor (in dB) for a
+                            frame to be detected as speech.
+                          flux_threshold: Minimum spectral flux (in dB) for a frame to be
+                            detected as a speech onset.
+                          min_speech_frames: Speech regions shorter than this number of frames
+                            are dropped.
+                          min_silence_frames: Silences shorter than this number of frames are
+                            kept.
+                          speech_pad_frames: Number of frames kept before and after each
+                            speech region.
+                          absolute_energy_threshold: When the energy of every frame is above
+                            this level (in dB), the features are kept entirely.
+
+                        Returns:
+                          A :class:`ctranslate2.models.WhisperSpeechWindows` instance. Its
+                          features can be passed to :meth:`generate` and the predicted
+                          timestamps mapped back with :meth:`to_input_time`.
+                    )pbdoc")
+
+        .def("warmup", &WhisperWrapper::warmup,
+             py::kw_only(),
+             py::arg("batch_shapes")=std::vector<std::pair<size_t, size_t>>{{1, 16}},
+             py::arg("beam_size")=1,
+             py::arg("touch_weights")=true,
+             py::call_guard<py::gil_scoped_release>(),
+             R"pbdoc(
+                 Runs synthetic batches on all model replicas in parallel so that the first
+                 requests are not slowed down by one-time initializations.
+
+                 This method should be called before submitting other requests.
+
+                 Arguments:
+                   batch_shapes: List of (batch size, length) pairs defining the synthetic
+                     batches to run on each replica.
+                   beam_size: Beam size used to decode the synthetic batches.
+                   touch_weights: Read each memory page of the model weights before running
+                     the batches.
+
+                 Returns:
+                   The warmup time of each replica in milliseconds.
+             )pbdoc")
+
         ;
     }
 
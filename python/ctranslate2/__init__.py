@@ -30,8 +30,11 @@ try:
         TranslationResult,
         Translator,
         contains_model,
+        get_cpu_fast_math,
+        get_cpu_features,
         get_cuda_device_count,
         get_supported_compute_types,
+        set_cpu_fast_math,
         set_random_seed,
     )
     from ctranslate2.extensions import register_extensions
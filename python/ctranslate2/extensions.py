@@ -1,6 +1,3 @@
-import collections
-import itertools
-
 from typing import Iterable, List, Optional
 
 from ctranslate2._ext import (
@@ -26,6 +23,8 @@ def translator_translate_iterable(
     target_prefix: Optional[Iterable[List[str]]] = None,
     max_batch_size: int = 32,
     batch_type: str = "examples",
+    read_batch_size: int = 0,
+    max_batches_per_replica: int = 0,
     **kwargs,
 ) -> Iterable[TranslationResult]:
     """Translates an iterable of tokens.
@@ -36,7 +35,7 @@ def translator_translate_iterable(
 
     * stream processing (the iterable is not fully materialized in memory)
     * parallel translations (if the translator has multiple workers)
-    * asynchronous batch prefetching
+    * asynchronous batch prefetching in a background thread that does not hold the GIL
     * local sorting by length
 
     Arguments:
@@ -44,21 +43,25 @@ def translator_translate_iterable(
       target_prefix: An optional iterable on target tokens used as prefix.
       max_batch_size: The maximum batch size.
       batch_type: Whether :obj:`max_batch_size` is the number of "examples" or "tokens".
+      read_batch_size: The number of examples (or tokens) that are read and sorted by
+        length before being split into batches (defaults to 16 times
+        :obj:`max_batch_size`).
+      max_batches_per_replica: The maximum number of batches waiting to be processed
+        or being processed by each replica (0 for a default value).
       **kwargs: Any translation options accepted by
         :meth:`ctranslate2.Translator.translate_batch`.
 
     Returns:
       A generator iterator over :class:`ctranslate2.TranslationResult` instances.
     """
-    iterables = [source]
-    if target_prefix is not None:
-        iterables.append(target_prefix)
-
-    yield from _process_iterable(
-        translator.translate_batch,
-        iterables,
-        max_batch_size,
-        batch_type,
+    _check_max_batch_size(max_batch_size)
+    yield from translator._translate_iterable(
+        source,
+        target_prefix,
+        max_batch_size=max_batch_size,
+        batch_type=batch_type,
+        read_batch_size=read_batch_size,
+        max_batches_per_replica=max_batches_per_replica,
         **kwargs,
     )
 
@@ -69,6 +72,8 @@ def translator_score_iterable(
     target: Iterable[List[str]],
     max_batch_size: int = 64,
     batch_type: str = "examples",
+    read_batch_size: int = 0,
+    max_batches_per_replica: int = 0,
     **kwargs,
 ) -> Iterable[ScoringResult]:
     """Scores an iterable of tokens.
@@ -79,7 +84,7 @@ def translator_score_iterable(
 
     * stream processing (the iterable is not fully materialized in memory)
     * parallel scoring (if the translator has multiple workers)
-    * asynchronous batch prefetching
+    * asynchronous batch prefetching in a background thread that does not hold the GIL
     * local sorting by length
 
     Arguments:
@@ -87,17 +92,25 @@ def translator_score_iterable(
       target: An iterable on target tokens.
       max_batch_size: The maximum batch size.
       batch_type: Whether :obj:`max_batch_size` is the number of "examples" or "tokens".
+      read_batch_size: The number of examples (or tokens) that are read and sorted by
+        length before being split into batches (defaults to 16 times
+        :obj:`max_batch_size`).
+      max_batches_per_replica: The maximum number of batches waiting to be processed
+        or being processed by each replica (0 for a default value).
       **kwargs: Any scoring options accepted by
         :meth:`ctranslate2.Translator.score_batch`.
 
     Returns:
       A generator iterator over :class:`ctranslate2.ScoringResult` instances.
     """
-    yield from _process_iterable(
-        translator.score_batch,
-        [source, target],
-        max_batch_size,
-        batch_type,
+    _check_max_batch_size(max_batch_size)
+    yield from translator._score_iterable(
+        source,
+        target,
+        max_batch_size=max_batch_size,
+        batch_type=batch_type,
+        read_batch_size=read_batch_size,
+        max_batches_per_replica=max_batches_per_replica,
         **kwargs,
     )
 
@@ -107,6 +120,8 @@ def generator_generate_iterable(
     start_tokens: Iterable[List[str]],
     max_batch_size: int = 32,
     batch_type: str = "examples",
+    read_batch_size: int = 0,
+    max_batches_per_replica: int = 0,
     **kwargs,
 ) -> Iterable[GenerationResult]:
     """Generates from an iterable of start tokens.
@@ -117,24 +132,31 @@ def generator_generate_iterable(
 
     * stream processing (the iterable is not fully materialized in memory)
     * parallel generations (if the generator has multiple workers)
-    * asynchronous batch prefetching
+    * asynchronous batch prefetching in a background thread that does not hold the GIL
     * local sorting by length
 
     Arguments:
       start_tokens: An iterable on start tokens.
       max_batch_size: The maximum batch size.
       batch_type: Whether :obj:`max_batch_size` is the number of "examples" or "tokens".
+      read_batch_size: The number of examples (or tokens) that are read and sorted by
+        length before being split into batches (defaults to 16 times
+        :obj:`max_batch_size`).
+      max_batches_per_replica: The maximum number of batches waiting to be processed
+        or being processed by each replica (0 for a default value).
       **kwargs: Any generation options accepted by
         :meth:`ctranslate2.Generator.generate_batch`.
 
     Returns:
       A generator iterator over :class:`ctranslate2.GenerationResult` instances.
     """
-    yield from _process_iterable(
-        generator.generate_batch,
-        [start_tokens],
-        max_batch_size,
-        batch_type,
+    _check_max_batch_size(max_batch_size)
+    yield from generator._generate_iterable(
+        start_tokens,
+        max_batch_size=max_batch_size,
+        batch_type=batch_type,
+        read_batch_size=read_batch_size,
+        max_batches_per_replica=max_batches_per_replica,
         **kwargs,
     )
 
@@ -144,6 +166,8 @@ def generator_score_iterable(
     tokens: Iterable[List[str]],
     max_batch_size: int = 64,
     batch_type: str = "examples",
+    read_batch_size: int = 0,
+    max_batches_per_replica: int = 0,
     **kwargs,
 ) -> Iterable[ScoringResult]:
     """Scores an iterable of tokens.
@@ -154,84 +178,35 @@ def generator_score_iterable(
 
     * stream processing (the iterable is not fully materialized in memory)
     * parallel scoring (if the generator has multiple workers)
-    * asynchronous batch prefetching
+    * asynchronous batch prefetching in a background thread that does not hold the GIL
     * local sorting by length
 
     Arguments:
       tokens: An iterable on tokens.
       max_batch_size: The maximum batch size.
       batch_type: Whether :obj:`max_batch_size` is the number of "examples" or "tokens".
+      read_batch_size: The number of examples (or tokens) that are read and sorted by
+        length before being split into batches (defaults to 16 times
+        :obj:`max_batch_size`).
+      max_batches_per_replica: The maximum number of batches waiting to be processed
+        or being processed by each replica (0 for a default value).
       **kwargs: Any score options accepted by
         :meth:`ctranslate2.Generator.score_batch`.
 
     Returns:
       A generator iterator over :class:`ctranslate2.ScoringResult` instances.
     """
-    yield from _process_iterable(
-        generator.score_batch,
-        [tokens],
-        max_batch_size,
-        batch_type,
+    _check_max_batch_size(max_batch_size)
+    yield from generator._score_iterable(
+        tokens,
+        max_batch_size=max_batch_size,
+        batch_type=batch_type,
+        read_batch_size=read_batch_size,
+        max_batches_per_replica=max_batches_per_replica,
         **kwargs,
     )
 
 
-def _process_iterable(process_func, iterables, max_batch_size, batch_type, **kwargs):
+def _check_max_batch_size(max_batch_size):
     if max_batch_size < 1:
         raise ValueError("max_batch_size must be >= 1")
-
-    if len(iterables) == 1:
-        iterable = iterables[0]
-    else:
-        iterable = itertools.zip_longest(*iterables)
-
-    kwargs.update(
-        {
-            "max_batch_size": max_batch_size,
-            "batch_type": batch_type,
-            "asynchronous": True,
-        }
-    )
-
-    read_batch_size = max_batch_size * 16 if max_batch_size > 1 else max_batch_size
-    queue = collections.deque()
-
-    for streams in _batch_iterator(iterable, read_batch_size, batch_type):
-        queue.extend(process_func(*streams, **kwargs))
-
-        while queue and queue[0].done():
-            yield queue.popleft().result()
-
-    while queue:
-        yield queue.popleft().result()
-
-
-def _batch_iterator(iterable, batch_size, batch_type):
-    streams = None
-    cur_batch_size = 0
-
-    for example in iterable:
-        if not isinstance(example, tuple):
-            example = (example,)
-
-        if streams is None:
-            streams = tuple([] for _ in example)
-        for batch, element in zip(streams, example):
-            if element is None and len(streams) > 1:
-                raise ValueError("Input iterables do not have the same length")
-            batch.append(element)
-
-        if batch_type == "examples":
-            cur_batch_size += 1
-        elif batch_type == "tokens":
-            cur_batch_size += len(example[0])
-        else:
-            raise ValueError("Invalid batch type %s" % batch_type)
-
-        if cur_batch_size >= batch_size:
-            yield streams
-            streams = None
-            cur_batch_size = 0
-
-    if streams is not None:
-        yield streams
@@ -7,6 +7,7 @@ try:
         Whisper,
         WhisperGenerationResult,
         WhisperGenerationResultAsync,
+        WhisperSpeechWindows,
     )
 except ImportError as e:
     # Allow using the Python package without the compiled extension.
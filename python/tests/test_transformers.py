@@ -332,6 +332,38 @@ def test_transformers_generator_on_iterables(tmpdir):
         next(generator.generate_iterable(iter([])))
 
 
+@test_utils.only_on_linux
+def test_transformers_generator_session(tmpdir):
+    converter = ctranslate2.converters.TransformersConverter("gpt2")
+    output_dir = str(tmpdir.join("ctranslate2_model"))
+    output_dir = converter.convert(output_dir)
+    generator = ctranslate2.Generator(output_dir)
+
+    tokens = "Ċ The Ġfirst Ġtime ĠI Ġsaw Ġthe Ġnew Ġversion Ġof".split()
+    session = generator.create_session()
+
+    output = generator.generate_in_session(session, ["<|endoftext|>"], max_length=5)
+    assert output.sequences[0] == tokens[:5]
+    output = generator.generate_in_session(session, [], max_length=5)
+    assert output.sequences[0] == tokens[5:]
+    assert session.num_cached_ids == 10
+    assert len(session.ids) == 11
+
+    generator.offload_session(session)
+    assert session.is_offloaded
+
+    output = generator.generate_in_session(session, ["Ġthe"], max_length=3)
+    expected = generator.generate_batch(
+        [["<|endoftext|>"] + tokens + ["Ġthe"]], max_length=13
+    )
+    assert output.sequences[0] == expected[0].sequences[0][10:]
+    assert not session.is_offloaded
+
+    # The decoder state is released when the generator is deleted before the session.
+    del generator
+    assert session.num_cached_ids == 0
+
+
 @test_utils.only_on_linux
 def test_transformers_generator_suppress_sequences(tmpdir):
     converter = ctranslate2.converters.TransformersConverter("gpt2")
@@ -520,6 +552,60 @@ def test_transformers_whisper_invalid_shape(tmpdir):
     assert "(1, 80, 1100)" in error_message
 
 
+@test_utils.only_on_linux
+def test_transformers_whisper_vad_filter(tmpdir):
+    import transformers
+
+    model_name = "openai/whisper-tiny"
+    converter = ctranslate2.converters.TransformersConverter(model_name)
+    output_dir = str(tmpdir.join("ctranslate2_model"))
+    output_dir = converter.convert(output_dir)
+
+    audio_path = os.path.join(test_utils.get_data_dir(), "audio", "jfk.npy")
+    audio = np.load(audio_path)
+
+    # Prepend 8 seconds of silence and add a window without speech.
+    audio = np.concatenate([np.zeros(8 * 16000, dtype=audio.dtype), audio])
+    silence = np.zeros(30 * 16000, dtype=audio.dtype)
+
+    processor = transformers.WhisperProcessor.from_pretrained(model_name)
+    inputs = processor([audio, silence], return_tensors="np", sampling_rate=16000)
+    features = ctranslate2.StorageView.from_array(inputs.input_features)
+
+    model = ctranslate2.models.Whisper(output_dir)
+    prompt = processor.tokenizer.convert_tokens_to_ids(
+        ["<|startoftranscript|>", "<|en|>", "<|transcribe|>"]
+    )
+    timestamp_begin = processor.tokenizer.convert_tokens_to_ids("<|notimestamps|>") + 1
+
+    results = model.generate(
+        features,
+        [prompt, prompt],
+        beam_size=1,
+        return_no_speech_prob=True,
+        vad_filter=True,
+    )
+
+    tokens = results[0].sequences_ids[0]
+    assert tokens[0] >= timestamp_begin
+    assert (tokens[0] - timestamp_begin) * 0.02 >= 7.5
+
+    transcription = processor.decode(
+        [token for token in tokens if token < timestamp_begin]
+    )
+    assert "ask not what your country can do for you" in transcription
+
+    assert results[1].sequences_ids == [[]]
+    assert results[1].no_speech_prob == 1
+
+    windows = ctranslate2.models.Whisper.pack_speech(
+        ctranslate2.StorageView.from_array(inputs.input_features[0])
+    )
+    assert len(windows.regions) == 1
+    assert windows.regions[0][0][0] >= 750
+    assert windows.to_input_time(0, 0) == pytest.approx(windows.regions[0][0][0] / 100)
+
+
 @test_utils.only_on_linux
 def test_transformers_whisper_include_tokenizer_json(tmpdir):
     model_name = "openai/whisper-tiny"
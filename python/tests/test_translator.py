@@ -1,5 +1,6 @@
 import inspect
 import io
+import json
 import logging
 import os
 import shutil
@@ -63,6 +64,13 @@ def test_get_supported_compute_types():
     assert "int8" in compute_types
 
 
+def test_get_cpu_features():
+    features = ctranslate2.get_cpu_features()
+    assert isinstance(features, list)
+    if "AVX512_VNNI" in features:
+        assert "AVX512" in features
+
+
 def test_translator_properties():
     translator = ctranslate2.Translator(_get_model_path(), inter_threads=2)
     assert translator.model_is_loaded
@@ -72,6 +80,29 @@ def test_translator_properties():
     assert translator.num_queued_batches == 0
 
 
+def test_tuning_profile(tmpdir):
+    profile_path = str(tmpdir.join("tuning_profile.json"))
+    with open(profile_path, "w") as profile:
+        json.dump(
+            {
+                "device": "cpu",
+                "inter_threads": 2,
+                "intra_threads": 1,
+                "max_batch_size": 1,
+                "compute_type": "default",
+            },
+            profile,
+        )
+
+    translator = ctranslate2.Translator(_get_model_path(), tuning_profile=profile_path)
+    assert translator.num_translators == 2
+    output = translator.translate_batch(
+        [["آ", "ت", "ز", "م", "و", "ن"], ["آ", "ت", "ش", "ي", "س", "و", "ن"]]
+    )
+    assert output[0].hypotheses == [["a", "t", "z", "m", "o", "n"]]
+    assert output[1].hypotheses == [["a", "c", "h", "i", "s", "o", "n"]]
+
+
 def test_compute_type():
     model_path = _get_model_path()
     with pytest.raises(ValueError, match="compute type"):
@@ -124,6 +155,23 @@ def test_batch_translation_async():
     assert output[1].done()
 
 
+def test_ensemble_translation():
+    translator = ctranslate2.Translator(
+        _get_model_path(), ensemble_model_paths=[_get_model_path()]
+    )
+    output = translator.translate_batch(
+        [["آ", "ت", "ز", "م", "و", "ن"], ["آ", "ت", "ش", "ي", "س", "و", "ن"]],
+        return_scores=True,
+    )
+    expected = _get_transliterator().translate_batch(
+        [["آ", "ت", "ز", "م", "و", "ن"], ["آ", "ت", "ش", "ي", "س", "و", "ن"]],
+        return_scores=True,
+    )
+    for result, expected_result in zip(output, expected):
+        assert result.hypotheses == expected_result.hypotheses
+        assert result.scores[0] == pytest.approx(expected_result.scores[0], abs=1e-4)
+
+
 def test_iterable_translation():
     source = [["آ", "ت", "ز", "م", "و", "ن"], ["آ", "ت", "ش", "ي", "س", "و", "ن"]]
     translator = _get_transliterator()
@@ -151,6 +199,29 @@ def test_iterable_translation():
         next(translator.translate_iterable(iter([])))
 
 
+def test_iterable_translation_prefetching():
+    source = [["آ", "ت", "ز", "م", "و", "ن"], ["آ", "ت", "ش", "ي", "س", "و", "ن"]] * 10
+    translator = _get_transliterator()
+    expected = translator.translate_batch(source)
+
+    results = translator.translate_iterable(
+        iter(source),
+        max_batch_size=2,
+        read_batch_size=6,
+        max_batches_per_replica=1,
+    )
+
+    for result, expected_result in zip(results, expected):
+        assert result.hypotheses == expected_result.hypotheses
+
+    def _failing_source():
+        yield source[0]
+        raise RuntimeError("read error")
+
+    with pytest.raises(RuntimeError, match="read error"):
+        list(translator.translate_iterable(_failing_source()))
+
+
 def test_file_translation(tmpdir):
     input_path = str(tmpdir.join("input.txt"))
     output_path = str(tmpdir.join("output.txt"))
@@ -489,6 +560,138 @@ def test_return_attention():
         assert all(isinstance(value, float) for value in vector)
 
 
+@pytest.mark.parametrize("beam_size", [1, 2])
+def test_return_topk_logprobs(beam_size):
+    translator = _get_transliterator()
+    output = translator.translate_batch(
+        [["آ", "ت", "ز", "م", "و", "ن"]],
+        beam_size=beam_size,
+        return_topk_logprobs=4,
+    )
+    topk_ids = output[0].topk_ids[0]
+    topk_logprobs = output[0].topk_logprobs[0]
+    assert len(topk_ids) == 6  # Target length.
+    assert len(topk_logprobs) == 6
+    for ids, logprobs in zip(topk_ids, topk_logprobs):
+        assert len(ids) == 4
+        assert len(logprobs) == 4
+        assert logprobs == sorted(logprobs, reverse=True)
+        assert all(value <= 0 for value in logprobs)
+
+
+@pytest.mark.parametrize("beam_size", [1, 2])
+def test_stop_sequences(beam_size):
+    translator = _get_transliterator()
+    output = translator.translate_batch(
+        [["آ", "ت", "ز", "م", "و", "ن"]],
+        beam_size=beam_size,
+        stop_sequences=[["z", "m"], ["x", "y"]],
+    )
+    assert output[0].hypotheses[0] == ["a", "t", "z", "m"]
+
+    with pytest.raises(ValueError, match="not in the vocabulary"):
+        translator.translate_batch(
+            [["آ", "ت", "ز", "م", "و", "ن"]],
+            beam_size=beam_size,
+            stop_sequences=[["not-in-vocabulary"]],
+        )
+
+
+def test_beam_pruning():
+    translator = _get_transliterator()
+    source = [["آ", "ت", "ز", "م", "و", "ن"]]
+    greedy = translator.translate_batch(source, beam_size=1, return_scores=True)
+    pruned = translator.translate_batch(
+        source,
+        beam_size=4,
+        beam_pruning_absolute_threshold=1e-6,
+        return_scores=True,
+    )
+    assert pruned[0].hypotheses[0] == greedy[0].hypotheses[0]
+    assert pruned[0].scores[0] == pytest.approx(greedy[0].scores[0], abs=1e-5)
+
+
+def test_beam_score_bound():
+    translator = _get_transliterator()
+    source = [["آ", "ت", "ز", "م", "و", "ن"]]
+    kwargs = dict(beam_size=4, num_hypotheses=3, length_penalty=1, return_scores=True)
+    expected = translator.translate_batch(source, **kwargs)
+    output = translator.translate_batch(source, beam_score_bound=True, **kwargs)
+    assert output[0].hypotheses == expected[0].hypotheses
+    assert output[0].scores == pytest.approx(expected[0].scores, abs=1e-5)
+
+
+def test_early_exit():
+    translator = _get_transliterator()
+    source = [["آ", "ت", "ز", "م", "و", "ن"]]
+    output = translator.translate_batch(source)
+    assert output[0].average_exit_depth == 0
+
+    output = translator.translate_batch(
+        source, early_exit_threshold=1e-6, early_exit_interval=1
+    )
+    assert output[0].hypotheses[0]
+    assert output[0].average_exit_depth == 1
+
+
+def test_two_stage_output():
+    translator = _get_transliterator()
+    source = [["آ", "ت", "ز", "م", "و", "ن"], ["آ", "ت", "ز", "م"]]
+    expected = translator.translate_batch(source)
+
+    for exact_log_probs in (False, True):
+        output = translator.translate_batch(
+            source,
+            two_stage_candidates=10,
+            two_stage_exact_log_probs=exact_log_probs,
+        )
+        for result, expected_result in zip(output, expected):
+            assert result.hypotheses[0] == expected_result.hypotheses[0]
+
+
+def test_memory_budget():
+    translator = _get_transliterator()
+    source = [["آ", "ز", "ا"], ["آ", "ت", "ز", "م", "و", "ن"], ["آ", "ت", "ز", "م"]]
+    expected = translator.translate_batch(source)
+
+    single_example_bytes = translator.estimate_decoding_memory(
+        1, 2, input_length=6, max_length=256
+    )
+    assert single_example_bytes > 0
+    assert (
+        translator.estimate_decoding_memory(4, 2, input_length=6, max_length=256)
+        > single_example_bytes
+    )
+    assert (
+        translator.estimate_decoding_memory(
+            1, 2, input_length=6, max_length=256, two_stage_candidates=8
+        )
+        > single_example_bytes
+    )
+
+    translator = ctranslate2.Translator(
+        _get_model_path(), max_memory_per_replica=single_example_bytes
+    )
+    output = translator.translate_batch(source)
+    assert [result.hypotheses for result in output] == [
+        result.hypotheses for result in expected
+    ]
+
+    translator = ctranslate2.Translator(_get_model_path(), max_memory_per_replica=1024)
+    with pytest.raises(RuntimeError, match="memory budget"):
+        translator.translate_batch(source)
+
+
+def test_warmup():
+    translator = _get_transliterator()
+    times = translator.warmup(batch_shapes=[(1, 4), (2, 8)], beam_size=2)
+    assert len(times) == translator.num_translators
+    assert all(time > 0 for time in times)
+
+    output = translator.translate_batch([["آ", "ت", "ز", "م", "و", "ن"]])
+    assert output[0].hypotheses[0] == ["a", "t", "z", "m", "o", "n"]
+
+
 def test_ignore_scores():
     translator = _get_transliterator()
     output = translator.translate_batch(
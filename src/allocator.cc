@@ -1,10 +1,22 @@
 #include "ctranslate2/allocator.h"
 
+#include "ctranslate2/memory_planner.h"
+
 #include "device_dispatch.h"
+#include "env.h"
 
 namespace ctranslate2 {
 
+  static thread_local bool thread_use_huge_pages = false;
+
   Allocator& get_allocator(Device device) {
+    MemoryPlanner* planner = get_thread_memory_planner(device);
+    if (planner)
+      return *planner;
+
+    if (device == Device::CPU && thread_use_huge_pages)
+      return get_huge_page_allocator();
+
     Allocator* allocator = nullptr;
     DEVICE_DISPATCH(device, allocator = &get_allocator<D>());
     if (!allocator)
@@ -12,4 +24,20 @@ namespace ctranslate2 {
     return *allocator;
   }
 
+  bool use_huge_pages() {
+    static const bool use_huge_pages = read_bool_from_env("CT2_USE_HUGE_PAGES", false);
+    return use_huge_pages;
+  }
+
+  ScopedHugePageAllocation::ScopedHugePageAllocation(Device device)
+    : _previous_state(thread_use_huge_pages)
+  {
+    if (device == Device::CPU && use_huge_pages())
+      thread_use_huge_pages = true;
+  }
+
+  ScopedHugePageAllocation::~ScopedHugePageAllocation() {
+    thread_use_huge_pages = _previous_state;
+  }
+
 }
@@ -6,11 +6,13 @@ namespace ctranslate2 {
                                                          size_t max_batch_size,
                                                          size_t buffer_timeout_in_micros,
                                                          TranslationOptions options,
-                                                         size_t max_buffer_size)
+                                                         size_t max_buffer_size,
+                                                         BatchType batch_type)
     : _translator(std::move(translator))
     , _options(options)
     , _max_batch_size(max_batch_size)
     , _max_buffer_size(max_buffer_size == 0 ? max_batch_size : max_buffer_size)
+    , _batch_type(batch_type)
     , _buffer_timeout(buffer_timeout_in_micros)
   {
     _background_thread = std::make_unique<std::thread>(&BufferedTranslationWrapper::buffer_loop,
@@ -39,8 +41,9 @@ namespace ctranslate2 {
 
       _promises.emplace(std::move(promise));
       _examples.emplace(std::move(source), std::move(target));
+      _buffer_size += get_buffer_size_increment(_examples.back());
 
-      notify = (_examples.size() >= _max_buffer_size);
+      notify = (_buffer_size >= _max_buffer_size);
     }
 
     if (notify)
@@ -65,19 +68,24 @@ namespace ctranslate2 {
     return futures;
   }
 
+  size_t BufferedTranslationWrapper::get_buffer_size_increment(const Example& example) const {
+    return _batch_type == BatchType::Tokens ? example.length() : 1;
+  }
+
   void BufferedTranslationWrapper::buffer_loop() {
     while (true) {
       std::unique_lock<std::mutex> lock(_mutex);
       _cv.wait_for(lock, _buffer_timeout,
-                   [this]{ return _examples.size() >= _max_buffer_size || _stop; });
+                   [this]{ return _buffer_size >= _max_buffer_size || _stop; });
 
       // Get the stop flag value when we hold the lock.
       const bool stop = _stop;
 
       if (!_examples.empty()) {
         // Build full batches unless the timeout is reached or we are stopping the process.
+        // Batches of tokens are not aligned on examples so the whole buffer is flushed.
         size_t flush_size = _examples.size();
-        if (!stop && flush_size > _max_batch_size)
+        if (!stop && _batch_type == BatchType::Examples && flush_size > _max_batch_size)
           flush_size -= flush_size % _max_batch_size;
 
         std::vector<Example> examples;
@@ -86,6 +94,7 @@ namespace ctranslate2 {
         promises.reserve(flush_size);
 
         for (size_t i = 0; i < flush_size; ++i) {
+          _buffer_size -= get_buffer_size_increment(_examples.front());
           examples.emplace_back(std::move(_examples.front()));
           promises.emplace_back(std::move(_promises.front()));
           _examples.pop();
@@ -98,11 +107,12 @@ namespace ctranslate2 {
         _translator->post_examples(
           examples,
           _max_batch_size,
-          BatchType::Examples,
+          _batch_type,
           std::move(promises),
           [this](models::SequenceToSequenceReplica& model, const Batch& batch) {
             return run_translation(model, batch, _options);
-          });
+          },
+          _translator->get_translation_memory_estimator(_options));
       }
 
       if (stop)
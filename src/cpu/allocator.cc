@@ -1,11 +1,19 @@
 #include "ctranslate2/allocator.h"
 
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
 #ifdef _WIN32
 #  include <malloc.h>
 #else
 #  include <cstdlib>
 #endif
 
+#ifdef __linux__
+#  include <sys/mman.h>
+#endif
+
 #ifdef CT2_WITH_MKL
 #  include <mkl.h>
 #endif
@@ -73,6 +81,111 @@ namespace ctranslate2 {
     };
 #endif
 
+    // Allocator mapping large buffers in 2MB-aligned regions backed by huge pages, which
+    // reduces the TLB misses when reading large weights. Explicit huge pages are used when
+    // some are reserved in the 2MB hugetlbfs pool, otherwise transparent huge pages are requested
+    // with madvise. Smaller buffers are forwarded to the default allocator.
+    class HugePageAllocator : public Allocator {
+    public:
+      static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+      HugePageAllocator(Allocator& allocator)
+        : _allocator(allocator)
+      {
+      }
+
+      void* allocate(size_t size, int device_index) override {
+        if (size >= huge_page_size) {
+          const size_t mapped_size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+          void* ptr = map_huge_pages(mapped_size);
+          if (ptr) {
+            const std::lock_guard<std::mutex> lock(_mutex);
+            _mapped_sizes.emplace(ptr, mapped_size);
+            return ptr;
+          }
+        }
+
+        return _allocator.allocate(size, device_index);
+      }
+
+      void free(void* ptr, int device_index) override {
+        {
+          const std::lock_guard<std::mutex> lock(_mutex);
+          auto it = _mapped_sizes.find(ptr);
+          if (it != _mapped_sizes.end()) {
+            unmap_huge_pages(ptr, it->second);
+            _mapped_sizes.erase(it);
+            return;
+          }
+        }
+
+        _allocator.free(ptr, device_index);
+      }
+
+      void clear_cache() override {
+        _allocator.clear_cache();
+      }
+
+    private:
+      static void* map_huge_pages(size_t size) {
+#ifdef __linux__
+        constexpr int protection = PROT_READ | PROT_WRITE;
+        constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#  ifdef MAP_HUGETLB
+        // Request 2MB pages explicitly: the sizes are rounded to 2MB, which would not be
+        // aligned for munmap if the default huge page size of the system is larger.
+#    ifdef MAP_HUGE_SHIFT
+        constexpr int huge_page_flags = MAP_HUGETLB | (21 << MAP_HUGE_SHIFT);  // MAP_HUGE_2MB
+#    else
+        constexpr int huge_page_flags = MAP_HUGETLB;
+#    endif
+        void* ptr = mmap(nullptr, size, protection, flags | huge_page_flags, -1, 0);
+        if (ptr != MAP_FAILED)
+          return ptr;
+#  endif
+
+        // Map a larger region and unmap the parts before and after the 2MB boundaries.
+        const size_t padded_size = size + huge_page_size;
+        void* region = mmap(nullptr, padded_size, protection, flags, -1, 0);
+        if (region == MAP_FAILED)
+          return nullptr;
+
+        char* begin = static_cast<char*>(region);
+        char* aligned = reinterpret_cast<char*>(
+          (reinterpret_cast<uintptr_t>(begin) + huge_page_size - 1) / huge_page_size * huge_page_size);
+        const size_t head_size = aligned - begin;
+        const size_t tail_size = padded_size - head_size - size;
+        if (head_size > 0)
+          munmap(begin, head_size);
+        if (tail_size > 0)
+          munmap(aligned + size, tail_size);
+
+#  ifdef MADV_HUGEPAGE
+        // The region is still usable with regular pages if transparent huge pages are disabled.
+        madvise(aligned, size, MADV_HUGEPAGE);
+#  endif
+        return aligned;
+#else
+        (void)size;
+        return nullptr;
+#endif
+      }
+
+      static void unmap_huge_pages(void* ptr, size_t size) {
+#ifdef __linux__
+        munmap(ptr, size);
+#else
+        (void)ptr;
+        (void)size;
+#endif
+      }
+
+      Allocator& _allocator;
+      std::mutex _mutex;
+      std::unordered_map<void*, size_t> _mapped_sizes;
+    };
+
   }
 
   template<>
@@ -86,4 +199,9 @@ namespace ctranslate2 {
     return allocator;
   }
 
+  Allocator& get_huge_page_allocator() {
+    static cpu::HugePageAllocator allocator(get_allocator<Device::CPU>());
+    return allocator;
+  }
+
 }
@@ -84,13 +84,77 @@ namespace ctranslate2 {
       return GemmBackend::NONE;
     }
 
+    std::vector<GemmBackend> get_gemm_backends(ComputeType compute_type) {
+      const GemmBackend default_backend = get_gemm_backend(compute_type);
+      if (default_backend == GemmBackend::NONE)
+        return {};
+
+      std::vector<GemmBackend> backends = {default_backend};
+      const auto add_backend = [&](GemmBackend backend) {
+        if (backend != default_backend)
+          backends.emplace_back(backend);
+      };
+
+      if (compute_type == ComputeType::FLOAT32) {
+#ifdef CT2_WITH_MKL
+        if (mayiuse_mkl())
+          add_backend(GemmBackend::MKL);
+#endif
+#ifdef CT2_WITH_DNNL
+        add_backend(GemmBackend::DNNL);
+#endif
+#ifdef CT2_WITH_ACCELERATE
+        add_backend(GemmBackend::ACCELERATE);
+#endif
+#ifdef CT2_WITH_OPENBLAS
+        add_backend(GemmBackend::OPENBLAS);
+#endif
+      } else if (compute_type == ComputeType::INT8) {
+        // The input of int8 linear layers is shifted to uint8 when the default backend
+        // prefers the u8s8s32 GEMM, so the other backends should expect the same input.
+        const bool shift_to_u8 = prefer_u8s8s32_gemm();
+#ifdef CT2_WITH_MKL
+        if (shift_to_u8 && mayiuse_mkl())
+          add_backend(GemmBackend::MKL);
+#endif
+#ifdef CT2_WITH_DNNL
+        add_backend(GemmBackend::DNNL);
+#endif
+#ifdef CT2_WITH_RUY
+        if (!shift_to_u8)
+          add_backend(GemmBackend::RUY);
+#endif
+        (void)shift_to_u8;
+      }
+
+      return backends;
+    }
+
     bool has_gemm_backend(ComputeType compute_type) {
       return get_gemm_backend(compute_type) != GemmBackend::NONE;
     }
 
+    static bool cpu_supports_u8s8_dot_product() {
+#if defined(CT2_X86_BUILD)
+      return cpu_supports_avx512_vnni() || cpu_supports_avx_vnni() || cpu_supports_amx_int8();
+#else
+      return false;
+#endif
+    }
+
     bool prefer_u8s8s32_gemm() {
-      const auto gemm_s8_backend = get_gemm_backend(ComputeType::INT8);
-      return gemm_s8_backend == cpu::GemmBackend::MKL || gemm_s8_backend == cpu::GemmBackend::DNNL;
+      switch (get_gemm_backend(ComputeType::INT8)) {
+      case GemmBackend::MKL:
+        // Intel MKL only implements the u8s8s32 GEMM.
+        return true;
+      case GemmBackend::DNNL:
+        // VNNI and AMX multiply uint8 by int8 values natively. On older CPUs the u8s8
+        // products are summed in saturated int16 registers, so we let oneDNN run the
+        // s8s8s32 GEMM instead.
+        return cpu_supports_u8s8_dot_product();
+      default:
+        return false;
+      }
     }
 
     bool pack_gemm_weights(ComputeType compute_type) {
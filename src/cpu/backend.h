@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "ctranslate2/types.h"
 
@@ -23,6 +24,9 @@ namespace ctranslate2 {
     std::string gemm_backend_to_str(GemmBackend gemm_backend);
     bool mayiuse_mkl();
     GemmBackend get_gemm_backend(ComputeType compute_type);
+    // Returns the compiled-in backends that can run the linear layers of this compute type,
+    // starting with the default backend.
+    std::vector<GemmBackend> get_gemm_backends(ComputeType compute_type);
     bool has_gemm_backend(ComputeType compute_type);
     bool prefer_u8s8s32_gemm();
     bool pack_gemm_weights(ComputeType compute_type);
@@ -15,6 +15,13 @@ namespace ctranslate2 {
       return info.vendor;
     }
 
+    std::string cpu_model_id() {
+      return (std::string(cpu_vendor())
+              + "-" + std::to_string(info.family)
+              + "-" + std::to_string(info.model)
+              + "-" + std::to_string(info.stepping));
+    }
+
     bool cpu_is_genuine_intel() {
       return strcmp(cpu_vendor(), CPU_FEATURES_VENDOR_GENUINE_INTEL) == 0;
     }
@@ -39,11 +46,59 @@ namespace ctranslate2 {
               && info.features.avx512bw);
     }
 
+    bool cpu_supports_avx512_vnni() {
+      return cpu_supports_avx512() && info.features.avx512vnni;
+    }
+
+    bool cpu_supports_avx_vnni() {
+      return cpu_supports_avx2() && info.features.avx_vnni;
+    }
+
+    bool cpu_supports_avx512_bf16() {
+      return cpu_supports_avx512() && info.features.avx512_bf16;
+    }
+
+    bool cpu_supports_amx_int8() {
+      return info.features.amx_tile && info.features.amx_int8;
+    }
+
+    bool cpu_supports_amx_bf16() {
+      return info.features.amx_tile && info.features.amx_bf16;
+    }
+
+    std::vector<std::string> cpu_features() {
+      std::vector<std::string> features;
+      const auto add_feature = [&features](const char* name, bool supported) {
+        if (supported)
+          features.emplace_back(name);
+      };
+
+      add_feature("SSE4.1", cpu_supports_sse41());
+      add_feature("AVX", cpu_supports_avx());
+      add_feature("AVX2", cpu_supports_avx2());
+      add_feature("AVX512", cpu_supports_avx512());
+      add_feature("AVX_VNNI", cpu_supports_avx_vnni());
+      add_feature("AVX512_VNNI", cpu_supports_avx512_vnni());
+      add_feature("AVX512_BF16", cpu_supports_avx512_bf16());
+      add_feature("AMX_INT8", cpu_supports_amx_int8());
+      add_feature("AMX_BF16", cpu_supports_amx_bf16());
+      return features;
+    }
+
   }
 }
 
 #elif defined(CT2_ARM64_BUILD)
 
+#if defined(__linux__)
+#  include <sys/auxv.h>
+#  ifndef HWCAP_ASIMDDP
+#    define HWCAP_ASIMDDP (1 << 20)
+#  endif
+#elif defined(__APPLE__)
+#  include <sys/sysctl.h>
+#endif
+
 namespace ctranslate2 {
   namespace cpu {
 
@@ -51,10 +106,42 @@ namespace ctranslate2 {
       return "ARM";
     }
 
+    std::string cpu_model_id() {
+      return cpu_vendor();
+    }
+
     bool cpu_supports_neon() {
       return true;
     }
 
+    static bool detect_dotprod() {
+#if defined(__linux__)
+      return getauxval(AT_HWCAP) & HWCAP_ASIMDDP;
+#elif defined(__APPLE__)
+      int value = 0;
+      size_t size = sizeof (value);
+      if (sysctlbyname("hw.optional.arm.FEAT_DotProd", &value, &size, nullptr, 0) != 0)
+        return false;
+      return value != 0;
+#else
+      return false;
+#endif
+    }
+
+    bool cpu_supports_dotprod() {
+      static const bool supported = detect_dotprod();
+      return supported;
+    }
+
+    std::vector<std::string> cpu_features() {
+      std::vector<std::string> features;
+      if (cpu_supports_neon())
+        features.emplace_back("NEON");
+      if (cpu_supports_dotprod())
+        features.emplace_back("DOTPROD");
+      return features;
+    }
+
   }
 }
 
@@ -1,20 +1,35 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 namespace ctranslate2 {
   namespace cpu {
 
     // Functions returning some info about the current CPU.
 
     const char* cpu_vendor();
+    // Identifies the CPU model, e.g. to key cached measurements.
+    std::string cpu_model_id();
 #if defined(CT2_X86_BUILD)
     bool cpu_is_genuine_intel();
     bool cpu_supports_sse41();
     bool cpu_supports_avx();
     bool cpu_supports_avx2();
     bool cpu_supports_avx512();
+    // Extensions accelerating the int8 and bfloat16 dot products.
+    bool cpu_supports_avx512_vnni();
+    bool cpu_supports_avx_vnni();
+    bool cpu_supports_avx512_bf16();
+    bool cpu_supports_amx_int8();
+    bool cpu_supports_amx_bf16();
 #elif defined(CT2_ARM64_BUILD)
     bool cpu_supports_neon();
+    bool cpu_supports_dotprod();
 #endif
 
+    // Names of the detected features, e.g. "AVX2" or "AVX512_VNNI".
+    std::vector<std::string> cpu_features();
+
   }
 }
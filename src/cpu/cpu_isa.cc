@@ -1,5 +1,6 @@
 #include "cpu_isa.h"
 
+#include <atomic>
 #include <stdexcept>
 
 #include "cpu_info.h"
@@ -63,7 +64,12 @@ namespace ctranslate2 {
 
 #ifdef CT2_WITH_CPU_DISPATCH
 #  if defined(CT2_X86_BUILD)
-      // Note that AVX512 can only be enabled with the environment variable at this time.
+      // AVX512 is only selected on CPUs that also support AVX512-BF16 or AMX (e.g. Intel
+      // Sapphire Rapids and AMD Zen 4). On older CPUs the AVX512 frequency reduction
+      // usually makes it slower than AVX2, so it can only be enabled with the
+      // environment variable.
+      if (cpu_supports_avx512() && (cpu_supports_avx512_bf16() || cpu_supports_amx_bf16()))
+        return CpuIsa::AVX512;
       if (cpu_supports_avx2())
         return CpuIsa::AVX2;
       if (cpu_supports_avx())
@@ -82,5 +88,18 @@ namespace ctranslate2 {
       return cpu_isa;
     }
 
+    static std::atomic<bool>& fast_math_flag() {
+      static std::atomic<bool> flag(read_bool_from_env("CT2_CPU_FAST_MATH"));
+      return flag;
+    }
+
+    bool use_fast_math() {
+      return fast_math_flag().load(std::memory_order_relaxed);
+    }
+
+    void set_fast_math(bool enable) {
+      fast_math_flag().store(enable, std::memory_order_relaxed);
+    }
+
   }
 }
@@ -21,6 +21,11 @@ namespace ctranslate2 {
     // Returns the CPU ISA to dispatch to.
     CpuIsa get_cpu_isa();
 
+    // Returns true if the kernels should use the faster approximations of exp, log, and
+    // erf. The initial value is read from the environment variable CT2_CPU_FAST_MATH.
+    bool use_fast_math();
+    void set_fast_math(bool enable);
+
   }
 }
 
@@ -81,3 +86,14 @@ namespace ctranslate2 {
     CPU_ISA_DEFAULT(cpu::CpuIsa::GENERIC, SINGLE_ARG(STMTS))  \
   }
 #endif
+
+// Same as CPU_ISA_DISPATCH, and also defines the constexpr boolean FAST_MATH from
+// cpu::use_fast_math().
+#define CPU_ISA_FAST_MATH_DISPATCH(STMTS)       \
+  if (cpu::use_fast_math()) {                   \
+    constexpr bool FAST_MATH = true;            \
+    CPU_ISA_DISPATCH(SINGLE_ARG(STMTS));        \
+  } else {                                      \
+    constexpr bool FAST_MATH = false;           \
+    CPU_ISA_DISPATCH(SINGLE_ARG(STMTS));        \
+  }
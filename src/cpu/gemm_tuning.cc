@@ -0,0 +1,421 @@
+#include "gemm_tuning.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
+#include "ctranslate2/primitives.h"
+#include "ctranslate2/utils.h"
+#include "cpu_info.h"
+#include "env.h"
+
+namespace ctranslate2 {
+  namespace cpu {
+
+    // The GEMM of each bucket is measured with m equal to the upper bound of the bucket.
+    constexpr std::array<dim_t, 4> m_buckets = {1, 8, 64, 512};
+    constexpr double min_measure_time_ms = 20;
+    constexpr size_t max_measure_iterations = 50;
+
+    struct TunedShape {
+      std::array<GemmBackend, m_buckets.size()> backends;
+      bool pack = false;
+    };
+
+    // The backend used by the measurements in this thread.
+    static thread_local GemmBackend measured_backend = GemmBackend::NONE;
+
+    static size_t get_m_bucket(dim_t m) {
+      for (size_t i = 0; i < m_buckets.size(); ++i) {
+        if (m <= m_buckets[i])
+          return i;
+      }
+      return m_buckets.size() - 1;
+    }
+
+    static uint64_t get_shape_id(ComputeType compute_type,
+                                 dim_t n,
+                                 dim_t k,
+                                 size_t num_threads) {
+      return ((static_cast<uint64_t>(compute_type) << 56)
+              ^ (static_cast<uint64_t>(num_threads) << 48)
+              ^ (static_cast<uint64_t>(n) << 24)
+              ^ static_cast<uint64_t>(k));
+    }
+
+    static size_t get_num_threads() {
+#ifdef _OPENMP
+      return omp_get_max_threads();
+#else
+      return 1;
+#endif
+    }
+
+    // Runs the measurements with the number of threads of the replicas. The number of
+    // threads is only set with OpenMP, like get_num_threads.
+    class ScopedNumThreads {
+    public:
+      ScopedNumThreads(size_t num_threads)
+        : _previous_num_threads(get_num_threads())
+#ifdef _OPENMP
+        , _num_threads(num_threads == 0 ? _previous_num_threads : num_threads)
+#else
+        , _num_threads(_previous_num_threads)
+#endif
+      {
+        (void)num_threads;
+        if (_num_threads != _previous_num_threads)
+          set_num_threads(_num_threads);
+      }
+
+      ~ScopedNumThreads() {
+        if (_num_threads != _previous_num_threads)
+          set_num_threads(_previous_num_threads);
+      }
+
+      size_t num_threads() const {
+        return _num_threads;
+      }
+
+    private:
+      const size_t _previous_num_threads;
+      const size_t _num_threads;
+    };
+
+    static std::string get_cache_key(ComputeType compute_type,
+                                     dim_t n,
+                                     dim_t k,
+                                     size_t num_threads) {
+      return (compute_type_to_str(compute_type)
+              + ":" + std::to_string(n) + "x" + std::to_string(k)
+              + ":threads=" + std::to_string(num_threads));
+    }
+
+    static GemmBackend str_to_gemm_backend(const std::string& name) {
+      for (const auto backend : {GemmBackend::MKL,
+                                 GemmBackend::DNNL,
+                                 GemmBackend::ACCELERATE,
+                                 GemmBackend::OPENBLAS,
+                                 GemmBackend::RUY}) {
+        if (gemm_backend_to_str(backend) == name)
+          return backend;
+      }
+      return GemmBackend::NONE;
+    }
+
+    class GemmTuningTable {
+    public:
+      GemmTuningTable()
+        : _cpu_model(cpu_model_id())
+      {
+      }
+
+      // Reads the cache file the first time a shape is tuned.
+      void load_cache() {
+        std::lock_guard lock(_cache_mutex);
+        if (_cache_is_loaded)
+          return;
+
+        _cache_is_loaded = true;
+        _cache_path = read_string_from_env("CT2_GEMM_TUNING_CACHE");
+        if (_cache_path.empty())
+          return;
+
+        std::ifstream file(_cache_path);
+        if (!file)
+          return;
+
+        try {
+          _cache = nlohmann::json::parse(file);
+        } catch (const std::exception& e) {
+          spdlog::warn("Ignoring the invalid GEMM tuning cache {}: {}", _cache_path, e.what());
+          _cache = nlohmann::json::object();
+        }
+      }
+
+      const TunedShape* find(uint64_t shape_id) const {
+        if (!_has_shapes.load(std::memory_order_acquire))
+          return nullptr;
+
+        std::shared_lock lock(_mutex);
+        auto it = _shapes.find(shape_id);
+        return it != _shapes.end() ? &it->second : nullptr;
+      }
+
+      // Returns the cached measurements of this shape, if any.
+      bool find_in_cache(const std::string& key, TunedShape& shape) const {
+        std::lock_guard lock(_cache_mutex);
+        const auto cpu_it = _cache.find(_cpu_model);
+        if (cpu_it == _cache.end())
+          return false;
+        const auto shape_it = cpu_it->find(key);
+        if (shape_it == cpu_it->end())
+          return false;
+
+        const auto& backends = shape_it->at("backends");
+        if (backends.size() != shape.backends.size())
+          return false;
+
+        for (size_t i = 0; i < backends.size(); ++i) {
+          shape.backends[i] = str_to_gemm_backend(backends[i].get<std::string>());
+          if (shape.backends[i] == GemmBackend::NONE)
+            return false;
+        }
+
+        shape.pack = shape_it->value("pack", false);
+        return true;
+      }
+
+      void add(uint64_t shape_id, const std::string& key, const TunedShape& shape, bool measured) {
+        {
+          std::unique_lock lock(_mutex);
+          _shapes.emplace(shape_id, shape);
+          _has_shapes.store(true, std::memory_order_release);
+        }
+
+        if (measured) {
+          std::lock_guard lock(_cache_mutex);
+          auto& backends = _cache[_cpu_model][key]["backends"];
+          backends = nlohmann::json::array();
+          for (const auto backend : shape.backends)
+            backends.push_back(gemm_backend_to_str(backend));
+          _cache[_cpu_model][key]["pack"] = shape.pack;
+          _cache_is_modified = true;
+        }
+      }
+
+      void save() {
+        std::lock_guard lock(_cache_mutex);
+        if (!_cache_is_modified)
+          return;
+
+        if (_cache_path.empty()) {
+          static std::once_flag log_once;
+          std::call_once(log_once, []() {
+            spdlog::info("Set CT2_GEMM_TUNING_CACHE to save the GEMM tuning results to a file");
+          });
+          return;
+        }
+
+        std::ofstream file(_cache_path);
+        if (!file) {
+          spdlog::warn("Unable to write the GEMM tuning cache {}", _cache_path);
+          return;
+        }
+
+        file << _cache.dump(2) << std::endl;
+        _cache_is_modified = false;
+      }
+
+    private:
+      const std::string _cpu_model;
+
+      mutable std::shared_mutex _mutex;
+      std::unordered_map<uint64_t, TunedShape> _shapes;
+      std::atomic<bool> _has_shapes = false;
+
+      mutable std::mutex _cache_mutex;
+      std::string _cache_path;
+      nlohmann::json _cache = nlohmann::json::object();
+      bool _cache_is_loaded = false;
+      bool _cache_is_modified = false;
+    };
+
+    static GemmTuningTable& get_tuning_table() {
+      static GemmTuningTable table;
+      return table;
+    }
+
+    template <typename Func>
+    static double measure(const Func& func) {
+      func();
+
+      size_t iterations = 0;
+      double elapsed = 0;
+      const auto start = std::chrono::steady_clock::now();
+
+      do {
+        func();
+        ++iterations;
+        const auto end = std::chrono::steady_clock::now();
+        elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+      } while (elapsed < min_measure_time_ms && iterations < max_measure_iterations);
+
+      return elapsed / iterations;
+    }
+
+    template <typename In, typename Out>
+    static TunedShape measure_linear_gemm(ComputeType compute_type,
+                                          dim_t n,
+                                          dim_t k,
+                                          bool packable) {
+      const auto backends = get_gemm_backends(compute_type);
+      const dim_t max_m = m_buckets.back();
+
+      // The values do not matter for the measurements.
+      std::vector<In> a(max_m * k, In(1));
+      std::vector<In> b(n * k, In(1));
+      std::vector<Out> c(max_m * n);
+      std::vector<Out> compensation;
+      if (compute_type == ComputeType::INT8 && prefer_u8s8s32_gemm())
+        compensation.resize(n, Out(0));
+
+      const Out* a_shift_compensation = compensation.empty() ? nullptr : compensation.data();
+
+      const auto run_gemm = [&](dim_t m, const In* weight, bool weight_is_packed) {
+        primitives<Device::CPU>::gemm(/*a_is_packed=*/false, weight_is_packed,
+                                      /*transpose_a=*/false, /*transpose_b=*/true,
+                                      m, n, k,
+                                      1.f,
+                                      a.data(), k,
+                                      weight, k,
+                                      0.f,
+                                      c.data(), n,
+                                      a_shift_compensation);
+      };
+
+      TunedShape shape;
+      shape.backends.fill(backends[0]);
+      double best_unpacked_time = 0;
+
+      for (size_t i = 0; i < m_buckets.size(); ++i) {
+        double best_time = std::numeric_limits<double>::max();
+
+        for (const auto backend : backends) {
+          if (backends.size() == 1) {
+            shape.backends[i] = backend;
+            break;
+          }
+
+          measured_backend = backend;
+          const double time = measure([&]() { run_gemm(m_buckets[i], b.data(), false); });
+          measured_backend = GemmBackend::NONE;
+
+          if (time < best_time) {
+            best_time = time;
+            shape.backends[i] = backend;
+          }
+        }
+
+        best_unpacked_time += best_time;
+      }
+
+      // Packing is only supported by the default backend (MKL).
+      if (packable) {
+        const dim_t packed_size = primitives<Device::CPU>::gemm_pack_b(b.data(), true, k, n, 1.f);
+
+        if (packed_size > 0) {
+          std::vector<In> packed_b(packed_size / sizeof (In) + 1);
+          primitives<Device::CPU>::gemm_pack_b(b.data(), true, k, n, 1.f, packed_b.data());
+
+          double packed_time = 0;
+          for (const dim_t m : m_buckets)
+            packed_time += measure([&]() { run_gemm(m, packed_b.data(), true); });
+
+          // If there is a single backend, the unpacked GEMM was not measured yet.
+          if (backends.size() == 1) {
+            best_unpacked_time = 0;
+            for (const dim_t m : m_buckets)
+              best_unpacked_time += measure([&]() { run_gemm(m, b.data(), false); });
+          }
+
+          shape.pack = packed_time < best_unpacked_time;
+        }
+      }
+
+      return shape;
+    }
+
+    bool gemm_autotuning_enabled() {
+      return read_bool_from_env("CT2_AUTOTUNE_GEMM");
+    }
+
+    bool tune_linear_gemm(ComputeType compute_type,
+                          dim_t n,
+                          dim_t k,
+                          bool packable,
+                          size_t num_threads) {
+      if (!has_gemm_backend(compute_type))
+        return false;
+
+      const ScopedNumThreads scoped_num_threads(num_threads);
+      num_threads = scoped_num_threads.num_threads();
+
+      auto& table = get_tuning_table();
+      const uint64_t shape_id = get_shape_id(compute_type, n, k, num_threads);
+
+      const TunedShape* tuned_shape = table.find(shape_id);
+      if (tuned_shape)
+        return tuned_shape->pack;
+
+      const std::string key = get_cache_key(compute_type, n, k, num_threads);
+      TunedShape shape;
+
+      table.load_cache();
+
+      if (table.find_in_cache(key, shape)) {
+        table.add(shape_id, key, shape, /*measured=*/false);
+        return shape.pack;
+      }
+
+      switch (compute_type) {
+      case ComputeType::FLOAT32:
+        shape = measure_linear_gemm<float, float>(compute_type, n, k, packable);
+        break;
+      case ComputeType::INT8:
+        shape = measure_linear_gemm<int8_t, int32_t>(compute_type, n, k, packable);
+        break;
+      case ComputeType::INT16:
+        shape = measure_linear_gemm<int16_t, int32_t>(compute_type, n, k, packable);
+        break;
+      default:
+        return false;
+      }
+
+      spdlog::debug("Tuned GEMM {}: {}, {}, {}, {} (packed weight: {})",
+                    key,
+                    gemm_backend_to_str(shape.backends[0]),
+                    gemm_backend_to_str(shape.backends[1]),
+                    gemm_backend_to_str(shape.backends[2]),
+                    gemm_backend_to_str(shape.backends[3]),
+                    shape.pack);
+
+      table.add(shape_id, key, shape, /*measured=*/true);
+      return shape.pack;
+    }
+
+    void save_gemm_tuning_cache() {
+      get_tuning_table().save();
+    }
+
+    GemmBackend get_tuned_gemm_backend(ComputeType compute_type,
+                                       dim_t m,
+                                       dim_t n,
+                                       dim_t k,
+                                       GemmBackend default_backend) {
+      if (measured_backend != GemmBackend::NONE)
+        return measured_backend;
+
+      const TunedShape* shape = get_tuning_table().find(get_shape_id(compute_type,
+                                                                     n,
+                                                                     k,
+                                                                     get_num_threads()));
+      if (!shape)
+        return default_backend;
+      return shape->backends[get_m_bucket(m)];
+    }
+
+  }
+}
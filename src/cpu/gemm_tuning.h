@@ -0,0 +1,39 @@
+#pragma once
+
+#include "backend.h"
+
+namespace ctranslate2 {
+  namespace cpu {
+
+    // Load-time autotuning of the GEMM backend, enabled with CT2_AUTOTUNE_GEMM=1.
+    //
+    // The GEMM of a linear layer with a weight of shape [n, k] is measured with each
+    // compiled-in backend for a few buckets of input rows m. The fastest backend is then
+    // selected when primitives<Device::CPU>::gemm runs a matching shape. The measurements
+    // are cached in a file keyed by CPU model and number of threads, and the backend is
+    // selected for the number of threads of the thread running the GEMM.
+
+    bool gemm_autotuning_enabled();
+
+    // Measures the GEMM backends for a linear weight of shape [n, k] with num_threads
+    // threads (0 for the current number of threads) if this shape was not tuned yet.
+    // Returns true if the GEMM is faster with a packed weight.
+    bool tune_linear_gemm(ComputeType compute_type,
+                          dim_t n,
+                          dim_t k,
+                          bool packable,
+                          size_t num_threads = 0);
+
+    // Writes the new measurements to the cache file.
+    void save_gemm_tuning_cache();
+
+    // Returns the backend selected for a linear layer GEMM, or default_backend if the
+    // shape was not tuned.
+    GemmBackend get_tuned_gemm_backend(ComputeType compute_type,
+                                       dim_t m,
+                                       dim_t n,
+                                       dim_t k,
+                                       GemmBackend default_backend);
+
+  }
+}
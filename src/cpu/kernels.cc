@@ -149,14 +149,46 @@ namespace ctranslate2 {
       vectorized_unary_transform<ISA>(x, y, size, Vec<T, ISA>::rcp);
     }
 
-    template<>
-    void exp<TARGET_ISA>(const float* x, float* y, dim_t size) {
-      vectorized_unary_transform<TARGET_ISA>(x, y, size, Vec<float, TARGET_ISA>::exp);
+    // Vectorized math functions with an accurate or a fast implementation. The generic
+    // implementation always calls the standard functions which are faster than the
+    // scalar approximations.
+    template <CpuIsa ISA, bool FastMath>
+    struct VecMath {
+      using VecType = Vec<float, ISA>;
+      using value_type = vec_type<float, ISA>;
+
+      static constexpr bool fast = FastMath && ISA != CpuIsa::GENERIC;
+
+      static inline value_type exp(value_type a) {
+        if constexpr (fast)
+          return vec_fast_exp<ISA>(a);
+        else
+          return VecType::exp(a);
+      }
+
+      static inline value_type log(value_type a) {
+        if constexpr (fast)
+          return vec_fast_log<ISA>(a);
+        else
+          return VecType::log(a);
+      }
+
+      static inline value_type erf(value_type a) {
+        if constexpr (fast)
+          return vec_erf<ISA, true>(a);
+        else
+          return VecType::erf(a);
+      }
+    };
+
+    template <CpuIsa ISA, bool FastMath>
+    void exp(const float* x, float* y, dim_t size) {
+      vectorized_unary_transform<ISA>(x, y, size, VecMath<ISA, FastMath>::exp);
     }
 
-    template<>
-    void log<TARGET_ISA>(const float* x, float* y, dim_t size) {
-      vectorized_unary_transform<TARGET_ISA>(x, y, size, Vec<float, TARGET_ISA>::log);
+    template <CpuIsa ISA, bool FastMath>
+    void log(const float* x, float* y, dim_t size) {
+      vectorized_unary_transform<ISA>(x, y, size, VecMath<ISA, FastMath>::log);
     }
 
     template<>
@@ -174,14 +206,15 @@ namespace ctranslate2 {
       vectorized_unary_transform<TARGET_ISA>(x, y, size, Vec<float, TARGET_ISA>::tanh);
     }
 
-    template<>
-    void gelu<TARGET_ISA>(const float* x, float* y, dim_t size) {
-      using VecType = Vec<float, TARGET_ISA>;
-      vectorized_unary_transform<TARGET_ISA>(
+    template <CpuIsa ISA, bool FastMath>
+    void gelu(const float* x, float* y, dim_t size) {
+      using VecType = Vec<float, ISA>;
+      using Math = VecMath<ISA, FastMath>;
+      vectorized_unary_transform<ISA>(
         x, y, size,
-        [](vec_type<float, TARGET_ISA> v) {
+        [](vec_type<float, ISA> v) {
           auto u = VecType::mul(VecType::load(0.7071067811865475f), v);
-          u = VecType::add(VecType::load(1.f), VecType::erf(u));
+          u = VecType::add(VecType::load(1.f), Math::erf(u));
           u = VecType::mul(v, u);
           u = VecType::mul(VecType::load(0.5f), u);
           return u;
@@ -205,27 +238,39 @@ namespace ctranslate2 {
         });
     }
 
-    template<>
-    void gelu_sigmoid<TARGET_ISA>(const float* x, float* y, dim_t size) {
-      using VecType = Vec<float, TARGET_ISA>;
-      vectorized_unary_transform<TARGET_ISA>(
+    template <CpuIsa ISA, bool FastMath>
+    void gelu_sigmoid(const float* x, float* y, dim_t size) {
+      using VecType = Vec<float, ISA>;
+      using Math = VecMath<ISA, FastMath>;
+      vectorized_unary_transform<ISA>(
         x, y, size,
-        [](vec_type<float, TARGET_ISA> v) {
+        [](vec_type<float, ISA> v) {
           return VecType::div(v, VecType::add(VecType::load(1.f),
-                                              VecType::exp(VecType::mul(VecType::load(-1.702f), v))));
+                                              Math::exp(VecType::mul(VecType::load(-1.702f), v))));
         });
     }
 
-    template<>
-    void swish<TARGET_ISA>(const float* x, float* y, dim_t size) {
-      using VecType = Vec<float, TARGET_ISA>;
-      vectorized_unary_transform<TARGET_ISA>(
+    template <CpuIsa ISA, bool FastMath>
+    void swish(const float* x, float* y, dim_t size) {
+      using VecType = Vec<float, ISA>;
+      using Math = VecMath<ISA, FastMath>;
+      vectorized_unary_transform<ISA>(
         x, y, size,
-        [](vec_type<float, TARGET_ISA> v) {
-          return VecType::div(v, VecType::add(VecType::load(1.f), VecType::exp(VecType::neg(v))));
+        [](vec_type<float, ISA> v) {
+          return VecType::div(v, VecType::add(VecType::load(1.f), Math::exp(VecType::neg(v))));
         });
     }
 
+#define DECLARE_MATH_IMPL(FAST_MATH)                                    \
+    template void exp<TARGET_ISA, FAST_MATH>(const float* x, float* y, dim_t size); \
+    template void log<TARGET_ISA, FAST_MATH>(const float* x, float* y, dim_t size); \
+    template void gelu<TARGET_ISA, FAST_MATH>(const float* x, float* y, dim_t size); \
+    template void gelu_sigmoid<TARGET_ISA, FAST_MATH>(const float* x, float* y, dim_t size); \
+    template void swish<TARGET_ISA, FAST_MATH>(const float* x, float* y, dim_t size);
+
+    DECLARE_MATH_IMPL(false)
+    DECLARE_MATH_IMPL(true)
+
     template <CpuIsa ISA, typename T>
     void add(T a, const T* x, T* y, dim_t size) {
       auto vec_a = Vec<T, ISA>::load(a);
@@ -337,21 +382,21 @@ namespace ctranslate2 {
     DECLARE_ALL_TYPES(DECLARE_IMPL)
 
 
-    template <>
-    float reduce_logsumexp<TARGET_ISA>(const float* x, dim_t size) {
-      using VecType = Vec<float, TARGET_ISA>;
+    template <CpuIsa ISA, bool FastMath>
+    float reduce_logsumexp(const float* x, dim_t size) {
+      using VecType = Vec<float, ISA>;
 
-      const auto x_max = reduce_max<TARGET_ISA>(x, size);
+      const auto x_max = reduce_max<ISA>(x, size);
       const auto vec_x_max = VecType::load(x_max);
 
       const auto scalar_exp_func = [x_max](vec_type<float> v) {
-        return Vec<float>::exp(Vec<float>::sub(v, x_max));
+        return VecMath<CpuIsa::GENERIC, FastMath>::exp(Vec<float>::sub(v, x_max));
       };
-      const auto vec_exp_func = [vec_x_max](vec_type<float, TARGET_ISA> v) {
-        return VecType::exp(VecType::sub(v, vec_x_max));
+      const auto vec_exp_func = [vec_x_max](vec_type<float, ISA> v) {
+        return VecMath<ISA, FastMath>::exp(VecType::sub(v, vec_x_max));
       };
 
-      const auto exp_sum = vectorized_map_reduce_all<TARGET_ISA>(
+      const auto exp_sum = vectorized_map_reduce_all<ISA>(
         x,
         size,
         static_cast<float>(0),
@@ -364,15 +409,15 @@ namespace ctranslate2 {
       return std::log(exp_sum) + x_max;
     }
 
-    template<>
-    void softmax<TARGET_ISA>(const float* input,
-                             const int32_t* lengths,
-                             float* output,
-                             dim_t batch_size,
-                             dim_t depth,
-                             bool log,
-                             float epsilon) {
-      using VecType = Vec<float, TARGET_ISA>;
+    template <CpuIsa ISA, bool FastMath>
+    void softmax(const float* input,
+                 const int32_t* lengths,
+                 float* output,
+                 dim_t batch_size,
+                 dim_t depth,
+                 bool log,
+                 float epsilon) {
+      using VecType = Vec<float, ISA>;
 
       parallel_for(0, batch_size, 1, [&](dim_t begin, dim_t end) {
         for (dim_t i = begin; i < end; ++i) {
@@ -394,18 +439,18 @@ namespace ctranslate2 {
             }
           }
 
-          const auto x_max = reduce_max<TARGET_ISA>(x, size);
+          const auto x_max = reduce_max<ISA>(x, size);
           const auto vec_x_max = VecType::load(x_max);
 
           const auto scalar_exp_func = [x_max](vec_type<float> v) {
-            return Vec<float>::exp(Vec<float>::sub(v, x_max));
+            return VecMath<CpuIsa::GENERIC, FastMath>::exp(Vec<float>::sub(v, x_max));
           };
-          const auto vec_exp_func = [vec_x_max](vec_type<float, TARGET_ISA> v) {
-            return VecType::exp(VecType::sub(v, vec_x_max));
+          const auto vec_exp_func = [vec_x_max](vec_type<float, ISA> v) {
+            return VecMath<ISA, FastMath>::exp(VecType::sub(v, vec_x_max));
           };
 
           if (log) {
-            const auto exp_sum = vectorized_map_reduce_all<TARGET_ISA>(
+            const auto exp_sum = vectorized_map_reduce_all<ISA>(
               x,
               size,
               static_cast<float>(0),
@@ -414,16 +459,29 @@ namespace ctranslate2 {
               VecType::reduce_add,
               scalar_exp_func,
               Vec<float>::add);
-            add<TARGET_ISA>(-x_max - std::log(exp_sum), x, y, size);
+            add<ISA>(-x_max - std::log(exp_sum), x, y, size);
           } else {
-            vectorized_unary_transform<TARGET_ISA>(x, y, size, vec_exp_func);
-            const auto exp_sum = reduce_sum<TARGET_ISA>(y, size);
-            mul<TARGET_ISA>(static_cast<float>(1) / (exp_sum + epsilon), y, y, size);
+            vectorized_unary_transform<ISA>(x, y, size, vec_exp_func);
+            const auto exp_sum = reduce_sum<ISA>(y, size);
+            mul<ISA>(static_cast<float>(1) / (exp_sum + epsilon), y, y, size);
           }
         }
       });
     }
 
+#define DECLARE_SOFTMAX_IMPL(FAST_MATH)                                 \
+    template float reduce_logsumexp<TARGET_ISA, FAST_MATH>(const float* x, dim_t size); \
+    template void softmax<TARGET_ISA, FAST_MATH>(const float* input,    \
+                                                 const int32_t* lengths, \
+                                                 float* output,         \
+                                                 dim_t batch_size,      \
+                                                 dim_t depth,           \
+                                                 bool log,              \
+                                                 float epsilon);
+
+    DECLARE_SOFTMAX_IMPL(false)
+    DECLARE_SOFTMAX_IMPL(true)
+
     CT2_FFAST_MATH_BEGIN
     template<>
     void layer_norm<TARGET_ISA>(const float* input,
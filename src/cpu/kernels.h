@@ -9,9 +9,11 @@ namespace ctranslate2 {
     template <CpuIsa ISA, typename T>
     void rcp(const T* x, T* y, dim_t size);
 
-    template <CpuIsa ISA>
+    // When FastMath is true, the kernels use faster but less accurate approximations
+    // of exp, log, and erf (see use_fast_math).
+    template <CpuIsa ISA, bool FastMath = false>
     void exp(const float* x, float* y, dim_t size);
-    template <CpuIsa ISA>
+    template <CpuIsa ISA, bool FastMath = false>
     void log(const float* x, float* y, dim_t size);
     template <CpuIsa ISA>
     void sin(const float* x, float* y, dim_t size);
@@ -19,13 +21,13 @@ namespace ctranslate2 {
     void cos(const float* x, float* y, dim_t size);
     template <CpuIsa ISA>
     void tanh(const float* x, float* y, dim_t size);
-    template <CpuIsa ISA>
+    template <CpuIsa ISA, bool FastMath = false>
     void gelu(const float* x, float* y, dim_t size);
     template <CpuIsa ISA>
     void gelu_tanh(const float* x, float* y, dim_t size);
-    template <CpuIsa ISA>
+    template <CpuIsa ISA, bool FastMath = false>
     void gelu_sigmoid(const float* x, float* y, dim_t size);
-    template <CpuIsa ISA>
+    template <CpuIsa ISA, bool FastMath = false>
     void swish(const float* x, float* y, dim_t size);
 
     template <CpuIsa ISA, typename T>
@@ -58,10 +60,10 @@ namespace ctranslate2 {
     template <CpuIsa ISA, typename T>
     T reduce_amax(const T* x, dim_t size);
 
-    template <CpuIsa ISA>
+    template <CpuIsa ISA, bool FastMath = false>
     float reduce_logsumexp(const float* x, dim_t size);
 
-    template <CpuIsa ISA>
+    template <CpuIsa ISA, bool FastMath = false>
     void softmax(const float* input,
                  const int32_t* lengths,
                  float* output,
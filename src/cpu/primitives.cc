@@ -27,6 +27,7 @@
 
 #include "ctranslate2/allocator.h"
 #include "cpu/backend.h"
+#include "cpu/gemm_tuning.h"
 #include "cpu/kernels.h"
 #include "cpu/parallel.h"
 #include "type_dispatch.h"
@@ -62,6 +63,13 @@ namespace ctranslate2 {
       x[indices[i]] = a;
   }
 
+  template<>
+  template <typename T>
+  void primitives<Device::CPU>::indexed_copy(const T* x, T* y, const int32_t* indices, dim_t num_indices) {
+    for (dim_t i = 0; i < num_indices; ++i)
+      y[indices[i]] = x[i];
+  }
+
   template<>
   template <typename T>
   void primitives<Device::CPU>::copy(const T* x, T* y, dim_t size) {
@@ -287,7 +295,7 @@ namespace ctranslate2 {
   void primitives<Device::CPU>::gelu(const float* x, float* y, dim_t size) {
     cpu::parallel_for(0, size, /*grain_size=*/512,
                       [x, y](dim_t begin, dim_t end) {
-                        CPU_ISA_DISPATCH((cpu::gelu<ISA>(x + begin, y + begin, end - begin)));
+                        CPU_ISA_FAST_MATH_DISPATCH((cpu::gelu<ISA, FAST_MATH>(x + begin, y + begin, end - begin)));
                       });
   }
 
@@ -305,7 +313,7 @@ namespace ctranslate2 {
   void primitives<Device::CPU>::gelu_sigmoid(const float* x, float* y, dim_t size) {
     cpu::parallel_for(0, size, /*grain_size=*/512,
                       [x, y](dim_t begin, dim_t end) {
-                        CPU_ISA_DISPATCH((cpu::gelu_sigmoid<ISA>(x + begin, y + begin, end - begin)));
+                        CPU_ISA_FAST_MATH_DISPATCH((cpu::gelu_sigmoid<ISA, FAST_MATH>(x + begin, y + begin, end - begin)));
                       });
   }
 
@@ -314,7 +322,7 @@ namespace ctranslate2 {
   void primitives<Device::CPU>::swish(const float* x, float* y, dim_t size) {
     cpu::parallel_for(0, size, cpu::GRAIN_SIZE / 10,
                       [x, y](dim_t begin, dim_t end) {
-                        CPU_ISA_DISPATCH((cpu::swish<ISA>(x + begin, y + begin, end - begin)));
+                        CPU_ISA_FAST_MATH_DISPATCH((cpu::swish<ISA, FAST_MATH>(x + begin, y + begin, end - begin)));
                       });
   }
 
@@ -322,7 +330,7 @@ namespace ctranslate2 {
   template<>
   float primitives<Device::CPU>::logsumexp(const float* x, dim_t size) {
     float result = 0;
-    CPU_ISA_DISPATCH((result = cpu::reduce_logsumexp<ISA>(x, size)));
+    CPU_ISA_FAST_MATH_DISPATCH((result = cpu::reduce_logsumexp<ISA, FAST_MATH>(x, size)));
     return result;
   }
 
@@ -330,9 +338,9 @@ namespace ctranslate2 {
   void primitives<Device::CPU>::exp(const float* x, float* y, dim_t size) {
 #ifdef CT2_WITH_MKL
     if (cpu::mayiuse_mkl())
-      return vsExp(size, x, y);
+      return vmsExp(size, x, y, cpu::use_fast_math() ? VML_LA : VML_HA);
 #endif
-    CPU_ISA_DISPATCH((cpu::exp<ISA>(x, y, size)));
+    CPU_ISA_FAST_MATH_DISPATCH((cpu::exp<ISA, FAST_MATH>(x, y, size)));
   }
 
   template<>
@@ -340,9 +348,9 @@ namespace ctranslate2 {
   void primitives<Device::CPU>::log(const float* x, float* y, dim_t size) {
 #ifdef CT2_WITH_MKL
     if (cpu::mayiuse_mkl())
-      return vsLn(size, x, y);
+      return vmsLn(size, x, y, cpu::use_fast_math() ? VML_LA : VML_HA);
 #endif
-    CPU_ISA_DISPATCH((cpu::log<ISA>(x, y, size)));
+    CPU_ISA_FAST_MATH_DISPATCH((cpu::log<ISA, FAST_MATH>(x, y, size)));
   }
 
   template<>
@@ -509,6 +517,18 @@ namespace ctranslate2 {
   static cpu::GemmBackend gemm_s8_backend = cpu::get_gemm_backend(ComputeType::INT8);
   static cpu::GemmBackend gemm_s16_backend = cpu::get_gemm_backend(ComputeType::INT16);
 
+  // Linear layers run the GEMM with a transposed and unpacked weight. The backend can be
+  // tuned for these shapes (see gemm_tuning.h).
+  static cpu::GemmBackend get_gemm_backend_for_shape(ComputeType compute_type,
+                                                     cpu::GemmBackend default_backend,
+                                                     bool a_is_packed, bool b_is_packed,
+                                                     bool transpose_a, bool transpose_b,
+                                                     dim_t m, dim_t n, dim_t k) {
+    if (a_is_packed || b_is_packed || transpose_a || !transpose_b)
+      return default_backend;
+    return cpu::get_tuned_gemm_backend(compute_type, m, n, k, default_backend);
+  }
+
 #ifdef CT2_WITH_MKL
   // m value used to pack the b matrix.
   constexpr MKL_INT mkl_gemm_pack_b_m = 1;
@@ -617,12 +637,12 @@ namespace ctranslate2 {
                                      float beta,
                                      float* c, dim_t ldc,
                                      const float*) {
-#ifndef CT2_WITH_MKL
-    (void)a_is_packed;
-    (void)b_is_packed;
-#endif
+    const auto backend = get_gemm_backend_for_shape(ComputeType::FLOAT32, sgemm_backend,
+                                                    a_is_packed, b_is_packed,
+                                                    transpose_a, transpose_b,
+                                                    m, n, k);
 
-    switch (sgemm_backend) {
+    switch (backend) {
 
 #ifdef CT2_WITH_MKL
     case cpu::GemmBackend::MKL: {
@@ -820,12 +840,12 @@ namespace ctranslate2 {
                                      float beta,
                                      int32_t* c, dim_t ldc,
                                      const int32_t* a_shift_compensation) {
-#ifndef CT2_WITH_MKL
-    (void)a_is_packed;
-    (void)b_is_packed;
-#endif
+    const auto backend = get_gemm_backend_for_shape(ComputeType::INT8, gemm_s8_backend,
+                                                    a_is_packed, b_is_packed,
+                                                    transpose_a, transpose_b,
+                                                    m, n, k);
 
-    switch (gemm_s8_backend) {
+    switch (backend) {
 
 #ifdef CT2_WITH_MKL
     case cpu::GemmBackend::MKL: {
@@ -1078,6 +1098,8 @@ namespace ctranslate2 {
   template void                                                         \
   primitives<Device::CPU>::indexed_fill(T*, T, const int32_t*, dim_t);  \
   template void                                                         \
+  primitives<Device::CPU>::indexed_copy(const T*, T*, const int32_t*, dim_t); \
+  template void                                                         \
   primitives<Device::CPU>::copy(const T* x, T* y, dim_t size);          \
   template T                                                            \
   primitives<Device::CPU>::sum(const T* array, dim_t size);             \
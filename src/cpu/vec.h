@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <limits>
 
 #include "ctranslate2/types.h"
 
@@ -76,6 +77,24 @@ namespace ctranslate2 {
         return std::log(a);
       }
 
+      static inline value_type round(value_type a) {
+        return std::nearbyint(a);
+      }
+
+      // Returns 2^n for an integral value n in [-126, 127].
+      static inline value_type exp2i(value_type n) {
+        return std::ldexp(static_cast<T>(1), static_cast<int>(n));
+      }
+
+      // Decomposes a positive normal value as mantissa * 2^exponent, with the mantissa
+      // in [0.5, 1).
+      static inline value_type frexp(value_type a, value_type& exponent) {
+        int e = 0;
+        const value_type mantissa = std::frexp(a, &e);
+        exponent = static_cast<value_type>(e);
+        return mantissa;
+      }
+
       static inline value_type sin(value_type a) {
         return std::sin(a);
       }
@@ -133,6 +152,58 @@ namespace ctranslate2 {
     template <typename T, CpuIsa ISA = CpuIsa::GENERIC>
     using vec_type = typename Vec<T, ISA>::value_type;
 
+    // The functions below are faster approximations used in the fast math mode
+    // (see use_fast_math). They expect finite inputs.
+
+    template <CpuIsa ISA>
+    vec_type<float, ISA> vec_fast_exp(vec_type<float, ISA> a) {
+      using VecType = Vec<float, ISA>;
+
+      // exp(x) = 2^n * exp(r) with n = round(x / ln(2)) and |r| <= ln(2) / 2. The lower
+      // bound gives n = -127 which is encoded as 0, so the result does not underflow to a
+      // (slow) denormal value.
+      const auto x = VecType::max(VecType::min(a, VecType::load(88.f)), VecType::load(-88.f));
+      const auto n = VecType::round(VecType::mul(x, VecType::load(1.44269504088896341f)));
+      const auto r = VecType::mul_add(n, VecType::load(-0.693147180559945309f), x);
+
+      // Degree 4 polynomial fitted on [-ln(2)/2, ln(2)/2]. The relative error is below 1e-5.
+      auto p = VecType::mul_add(VecType::load(4.09464087e-2f), r, VecType::load(1.67439893e-1f));
+      p = VecType::mul_add(p, r, VecType::load(5.00072551e-1f));
+      p = VecType::mul_add(p, r, VecType::load(1.f));
+      p = VecType::mul_add(p, r, VecType::load(1.f));
+      return VecType::mul(p, VecType::exp2i(n));
+    }
+
+    template <CpuIsa ISA>
+    vec_type<float, ISA> vec_fast_log(vec_type<float, ISA> a) {
+      using VecType = Vec<float, ISA>;
+
+      const auto one = VecType::load(1.f);
+
+      // log(x) = e * ln(2) + log(m) with m in [sqrt(0.5), sqrt(2)).
+      vec_type<float, ISA> e;
+      auto m = VecType::frexp(a, e);
+      const auto small_mask = VecType::lt(m, VecType::load(0.707106781186547524f));
+      m = VecType::select(small_mask, VecType::add(m, m), m);
+      e = VecType::select(small_mask, VecType::sub(e, one), e);
+
+      // log(m) = 2 * atanh(s) with s = (m - 1) / (m + 1) and |s| < 0.172. The series is
+      // truncated after s^5 with fitted coefficients. The absolute error is below 1e-7.
+      const auto s = VecType::div(VecType::sub(m, one), VecType::add(m, one));
+      const auto s2 = VecType::mul(s, s);
+      auto p = VecType::mul_add(VecType::load(2.05991797e-1f), s2, VecType::load(3.33276485e-1f));
+      p = VecType::mul_add(VecType::mul(p, s2), s, s);
+      auto y = VecType::mul_add(e, VecType::load(0.693147180559945309f), VecType::add(p, p));
+
+      y = VecType::select(VecType::lt(a, VecType::load(std::numeric_limits<float>::min())),
+                          VecType::load(-std::numeric_limits<float>::infinity()),
+                          y);
+      y = VecType::select(VecType::lt(a, VecType::load(0.f)),
+                          VecType::load(std::numeric_limits<float>::quiet_NaN()),
+                          y);
+      return y;
+    }
+
     template <CpuIsa ISA>
     vec_type<float, ISA> vec_tanh(vec_type<float, ISA> a) {
       using VecType = Vec<float, ISA>;
@@ -176,7 +247,7 @@ namespace ctranslate2 {
       return VecType::select(tiny_mask, x, VecType::div(p, q));
     }
 
-    template <CpuIsa ISA>
+    template <CpuIsa ISA, bool FastMath = false>
     vec_type<float, ISA> vec_erf(vec_type<float, ISA> a) {
       using VecType = Vec<float, ISA>;
 
@@ -207,7 +278,7 @@ namespace ctranslate2 {
       auto pow_2 = VecType::mul(a, a);
       auto neg_pow_2 = VecType::bit_xor(neg_zero_vec, pow_2);
       // auto tmp4 = exp(neg_pow_2);
-      auto tmp4 = VecType::exp(neg_pow_2);
+      auto tmp4 = FastMath ? vec_fast_exp<ISA>(neg_pow_2) : VecType::exp(neg_pow_2);
       auto tmp5 = VecType::bit_xor(neg_zero_vec, tmp4);
       // erf(x) = sign(x) * (1 - r * t * exp(- x * x))
       auto tmp6 = VecType::mul(tmp5, t);
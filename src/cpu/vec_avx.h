@@ -109,6 +109,35 @@ namespace ctranslate2 {
         return log256_ps(a);
       }
 
+      static inline value_type round(value_type a) {
+        return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      }
+
+      static inline value_type exp2i(value_type n) {
+        const auto e = _mm256_cvttps_epi32(_mm256_add_ps(n, _mm256_set1_ps(127.f)));
+#ifdef __AVX2__
+        return _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+#else
+        const auto e_lo = _mm_slli_epi32(_mm256_castsi256_si128(e), 23);
+        const auto e_hi = _mm_slli_epi32(_mm256_extractf128_si256(e, 1), 23);
+        return _mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(e_lo), e_hi, 1));
+#endif
+      }
+
+      static inline value_type frexp(value_type a, value_type& exponent) {
+        const auto bits = _mm256_castps_si256(a);
+#ifdef __AVX2__
+        const auto e = _mm256_srli_epi32(bits, 23);
+#else
+        const auto e_lo = _mm_srli_epi32(_mm256_castsi256_si128(bits), 23);
+        const auto e_hi = _mm_srli_epi32(_mm256_extractf128_si256(bits, 1), 23);
+        const auto e = _mm256_insertf128_si256(_mm256_castsi128_si256(e_lo), e_hi, 1);
+#endif
+        exponent = _mm256_sub_ps(_mm256_cvtepi32_ps(e), _mm256_set1_ps(126.f));
+        const auto mantissa_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff));
+        return _mm256_or_ps(_mm256_and_ps(a, mantissa_mask), _mm256_set1_ps(0.5f));
+      }
+
       static inline value_type sin(value_type a) {
         return sin256_ps(a);
       }
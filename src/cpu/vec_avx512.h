@@ -79,6 +79,20 @@ namespace ctranslate2 {
         return log512_ps(a);
       }
 
+      static inline value_type round(value_type a) {
+        return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      }
+
+      static inline value_type exp2i(value_type n) {
+        const auto e = _mm512_cvttps_epi32(_mm512_add_ps(n, _mm512_set1_ps(127.f)));
+        return _mm512_castsi512_ps(_mm512_slli_epi32(e, 23));
+      }
+
+      static inline value_type frexp(value_type a, value_type& exponent) {
+        exponent = _mm512_add_ps(_mm512_getexp_ps(a), _mm512_set1_ps(1.f));
+        return _mm512_getmant_ps(a, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_src);
+      }
+
       static inline value_type sin(value_type a) {
         return sin512_ps(a);
       }
@@ -90,6 +90,22 @@ namespace ctranslate2 {
         return log_ps(a);
       }
 
+      static inline value_type round(value_type a) {
+        return vrndnq_f32(a);
+      }
+
+      static inline value_type exp2i(value_type n) {
+        const auto e = vcvtq_s32_f32(vaddq_f32(n, vdupq_n_f32(127.f)));
+        return vreinterpretq_f32_s32(vshlq_n_s32(e, 23));
+      }
+
+      static inline value_type frexp(value_type a, value_type& exponent) {
+        const auto bits = vreinterpretq_u32_f32(a);
+        exponent = vsubq_f32(vcvtq_f32_u32(vshrq_n_u32(bits, 23)), vdupq_n_f32(126.f));
+        const auto mantissa = vandq_u32(bits, vdupq_n_u32(0x007fffff));
+        return vreinterpretq_f32_u32(vorrq_u32(mantissa, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+      }
+
       static inline value_type sin(value_type a) {
         return sin_ps(a);
       }
@@ -41,6 +41,15 @@ namespace ctranslate2 {
     THRUST_CALL(thrust::fill, it, it + num_indices, cuda::device_type<T>(a));
   }
 
+  template<>
+  template <typename T>
+  void primitives<Device::CUDA>::indexed_copy(const T* x, T* y, const int32_t* indices, dim_t num_indices) {
+    auto element_it = thrust::device_pointer_cast(cuda::device_cast(y));
+    auto index_it = thrust::device_pointer_cast(indices);
+    auto it = thrust::make_permutation_iterator(element_it, index_it);
+    THRUST_CALL(thrust::copy, cuda::device_cast(x), cuda::device_cast(x) + num_indices, it);
+  }
+
   template<>
   template <typename T>
   void primitives<Device::CUDA>::copy(const T* x, T* y, dim_t size) {
@@ -686,6 +695,8 @@ namespace ctranslate2 {
   template void                                                         \
   primitives<Device::CUDA>::indexed_fill(T*, T, const int32_t*, dim_t); \
   template void                                                         \
+  primitives<Device::CUDA>::indexed_copy(const T*, T*, const int32_t*, dim_t); \
+  template void                                                         \
   primitives<Device::CUDA>::copy<T>(const T* x, T* y, dim_t size);      \
   template T                                                            \
   primitives<Device::CUDA>::sum(const T* array, dim_t size);            \
@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <numeric>
 
@@ -162,6 +164,81 @@ namespace ctranslate2 {
     return attention;
   }
 
+  static std::vector<std::vector<size_t>> build_topk_ids(const StorageView& history,
+                                                         const dim_t batch,
+                                                         const dim_t beam,
+                                                         const bool ignore_last) {
+    const auto k = history.dim(-1);
+    const auto target_length = history.dim(-2) - dim_t(ignore_last);
+
+    std::vector<std::vector<size_t>> topk_ids;
+    topk_ids.reserve(target_length);
+    for (dim_t t = 0; t < target_length; ++t) {
+      const auto* ids = history.index<int32_t>({batch, beam, t, 0});
+      topk_ids.emplace_back(ids, ids + k);
+    }
+    return topk_ids;
+  }
+
+  // Gets the k best log probabilities and their ids for each batch, on the CPU.
+  static void compute_topk_logprobs(const StorageView& log_probs,
+                                    const dim_t k,
+                                    StorageView& topk_ids,
+                                    StorageView& topk_logprobs) {
+    const Device device = log_probs.device();
+    StorageView values(log_probs.dtype(), device);
+    StorageView indices(DataType::INT32, device);
+    ops::TopK(std::min(k, log_probs.dim(-1)))(log_probs, values, indices);
+    topk_logprobs = values.to_float32().to(Device::CPU);
+    topk_ids = indices.to(Device::CPU);
+  }
+
+  // Gets the position with the highest attention of each row, on the CPU. The rows of a batch
+  // only consider the positions in the batch range. The ranges are expected to exclude a few
+  // positions (e.g. special tokens), so only the best positions are copied from the device.
+  static StorageView compute_attention_argmax(const StorageView& attention,
+                                              const std::vector<std::pair<dim_t, dim_t>>& ranges,
+                                              const std::vector<dim_t>& batch_offset,
+                                              const dim_t rows_per_batch) {
+    const Device device = attention.device();
+    StorageView values(attention.dtype(), device);
+    StorageView indices(DataType::INT32, device);
+    ops::TopK(std::min(attention.dim(-1), dim_t(3)))(attention, values, indices);
+    indices = indices.to(Device::CPU);
+
+    const dim_t num_rows = indices.dim(0);
+    const dim_t k = indices.dim(1);
+    StorageView argmax({num_rows}, DataType::INT32);
+
+    for (dim_t r = 0; r < num_rows; ++r) {
+      const auto& range = ranges[batch_offset[r / rows_per_batch]];
+      const auto* best_positions = indices.index<int32_t>({r, 0});
+      int32_t position = 0;
+      for (dim_t i = 0; i < k; ++i) {
+        if (best_positions[i] >= range.first && best_positions[i] < range.second) {
+          position = best_positions[i] - range.first;
+          break;
+        }
+      }
+      argmax.at<int32_t>(r) = position;
+    }
+
+    return argmax;
+  }
+
+  static void append_beam_step_output(StorageView& history,
+                                      StorageView step_output,
+                                      const StorageView& gather_indices,
+                                      const dim_t beam_size,
+                                      const dim_t num_candidates,
+                                      const bool is_expanded) {
+    if (!is_expanded)
+      repeat_batch(step_output, beam_size);
+    split_batch_beam(step_output, beam_size);
+    append_step_output(history, std::move(step_output));
+    gather_beam_flat(history, gather_indices, num_candidates);
+  }
+
   static float compute_coverage_penalty(const std::vector<std::vector<float>>& attention,
                                         const float beta) {
     float penalty = 0;
@@ -222,6 +299,14 @@ namespace ctranslate2 {
     else{
       result.attention.clear();
     }
+
+    if (!result.topk_ids.empty()) {
+      result.topk_ids = index_vector(result.topk_ids, idx);
+      result.topk_logprobs = index_vector(result.topk_logprobs, idx);
+    }
+
+    if (!result.attention_argmax.empty())
+      result.attention_argmax = index_vector(result.attention_argmax, idx);
   }
 
   static inline void finalize_result(DecodingResult& result,
@@ -341,6 +426,68 @@ namespace ctranslate2 {
     return true;
   }
 
+  // Returns true if a hypothesis extending the best active beam could be better than the
+  // num_hypotheses-th finished hypothesis. This assumes the log probs are non positive so the
+  // beam scores can only decrease.
+  static bool can_improve_hypotheses(const DecodingResult& result,
+                                     const size_t num_hypotheses,
+                                     const float best_active_score,
+                                     const dim_t step,
+                                     const dim_t max_length,
+                                     const float length_penalty) {
+    if (best_active_score == std::numeric_limits<float>::lowest())
+      return false;
+
+    std::vector<float> scores;
+    scores.reserve(result.scores.size());
+    for (size_t i = 0; i < result.scores.size(); ++i)
+      scores.emplace_back(finalize_hypothesis_score(result.scores[i],
+                                                    result.hypotheses[i].size(),
+                                                    length_penalty,
+                                                    /*coverage_penalty=*/0,
+                                                    /*attention=*/nullptr));
+
+    std::nth_element(scores.begin(),
+                     scores.begin() + (num_hypotheses - 1),
+                     scores.end(),
+                     std::greater<float>());
+
+    // With a positive length penalty the best normalized score is reached with the longest
+    // hypothesis, otherwise with the shortest.
+    const dim_t length = (length_penalty > 0 ? max_length : std::max(step + 1, dim_t(1)));
+    const float best_possible_score = finalize_hypothesis_score(best_active_score,
+                                                                length,
+                                                                length_penalty,
+                                                                /*coverage_penalty=*/0,
+                                                                /*attention=*/nullptr);
+
+    return best_possible_score >= scores[num_hypotheses - 1];
+  }
+
+  // Returns the number of active beams that are within the pruning thresholds of the best beam.
+  // The beams are visited from best to worst according to order.
+  static dim_t count_beams_within_threshold(const float* scores,
+                                            const std::vector<dim_t>& order,
+                                            const float best_score,
+                                            const float absolute_threshold,
+                                            const float relative_threshold) {
+    float min_score = std::numeric_limits<float>::lowest();
+    if (best_score != std::numeric_limits<float>::lowest()) {
+      if (absolute_threshold > 0)
+        min_score = std::max(min_score, best_score - absolute_threshold);
+      if (relative_threshold > 0)
+        min_score = std::max(min_score, best_score - relative_threshold * std::abs(best_score));
+    }
+
+    dim_t num_beams = 0;
+    for (const dim_t k : order) {
+      if (scores[k] == std::numeric_limits<float>::lowest() || scores[k] < min_score)
+        break;
+      ++num_beams;
+    }
+    return num_beams;
+  }
+
   static inline size_t get_max_candidates(const dim_t beam_size, const float patience) {
     return std::round(float(beam_size) * patience);
   }
@@ -350,12 +497,18 @@ namespace ctranslate2 {
                          const float length_penalty,
                          const float coverage_penalty,
                          const float prefix_bias_beta,
-                         const float patience)
+                         const float patience,
+                         const float pruning_absolute_threshold,
+                         const float pruning_relative_threshold,
+                         const bool stop_on_score_bound)
     : _beam_size(beam_size)
     , _length_penalty(length_penalty)
     , _coverage_penalty(coverage_penalty)
     , _prefix_bias_beta(prefix_bias_beta)
     , _max_candidates(get_max_candidates(beam_size, patience))
+    , _pruning_absolute_threshold(pruning_absolute_threshold)
+    , _pruning_relative_threshold(pruning_relative_threshold)
+    , _stop_on_score_bound(stop_on_score_bound)
   {
   }
 
@@ -373,25 +526,36 @@ namespace ctranslate2 {
                      const size_t num_hypotheses,
                      const bool include_eos_in_hypotheses,
                      const std::vector<std::shared_ptr<LogitsProcessor>>& logits_processors,
-                     const std::vector<std::vector<size_t>>* prefix_ids) const {
+                     const std::vector<std::vector<size_t>>* prefix_ids,
+                     const size_t return_topk_logprobs,
+                     const StopSequences* stop_sequences,
+                     const std::vector<std::pair<dim_t, dim_t>>* attention_argmax_ranges) const {
     PROFILE("beam_search");
     const Device device = decoder.device();
     const DataType dtype = decoder.output_type();
     const dim_t vocabulary_size = decoder.output_size();
     const dim_t batch_size = start_ids.size();
 
-    // We get more candidates than the beam size so that if half the candidates are EOS,
-    // we can replace finished hypotheses with active beams.
-    const dim_t num_candidates = _beam_size * 2;
-
     // Only the first beam is considered in the first step. As an additional optimization
     // we try to run the first step without expanding the batch size.
     const bool expand_after_first_step = (device == Device::CPU
-                                          && num_candidates <= vocabulary_size);
+                                          && _beam_size * 2 <= vocabulary_size);
 
     // We can exit early when the first beam finishes and no penalties are used.
     const bool allow_early_exit = (_length_penalty == 0 && _coverage_penalty == 0);
 
+    // Otherwise we can optionally exit when the active beams can no longer improve the best
+    // hypotheses.
+    const bool use_score_bound = (_stop_on_score_bound
+                                  && !allow_early_exit
+                                  && _coverage_penalty == 0);
+
+    // The number of beams is reduced when the pruning thresholds leave fewer beams
+    // in all batches. The beams are never pruned below the number of hypotheses.
+    const bool prune_beams = (_pruning_absolute_threshold > 0 || _pruning_relative_threshold > 0);
+    const dim_t min_beam_size = std::min(std::max(dim_t(num_hypotheses), dim_t(1)), _beam_size);
+    dim_t beam_size = _beam_size;
+
     StorageView topk_ids({batch_size}, DataType::INT32);
     StorageView topk_scores(dtype);
 
@@ -426,9 +590,19 @@ namespace ctranslate2 {
     StorageView alive_seq_scores_prev;
     StorageView alive_attention;
     StorageView full_alive_attention;
+    StorageView alive_topk_ids;
+    StorageView alive_topk_logprobs;
+    StorageView alive_attention_argmax;
+    const bool gather_attention = (return_attention || _coverage_penalty != 0);
+    // State of each beam in the stop sequences automaton.
+    std::vector<int32_t> stop_states;
     for (dim_t step = 0; step < max_length; ++step) {
       const bool is_expanded = (!expand_after_first_step || step > 0);
 
+      // We get more candidates than the beam size so that if half the candidates are EOS,
+      // we can replace finished hypotheses with active beams.
+      const dim_t num_candidates = beam_size * 2;
+
       // Compute log probs for the current step.
       StorageView attention_step(dtype, device);
       convert_to_original_word_ids(decoder, topk_ids);
@@ -436,8 +610,8 @@ namespace ctranslate2 {
               topk_ids.to(device),
               state,
               &logits,  // output shape: (cur_batch_size*beam_size x vocab_size), if not expanded beam_size is 1
-              (return_attention || _coverage_penalty != 0) ? &attention_step : nullptr);
-      const dim_t cur_batch_size = is_expanded ? logits.dim(0) / _beam_size : logits.dim(0);
+              (gather_attention || attention_argmax_ranges) ? &attention_step : nullptr);
+      const dim_t cur_batch_size = is_expanded ? logits.dim(0) / beam_size : logits.dim(0);
 
       DisableTokens disable_tokens(logits);
 
@@ -453,9 +627,9 @@ namespace ctranslate2 {
         for (const auto& logits_processor : logits_processors)
           logits_processor->apply(step, logits, disable_tokens, alive_seq, batch_offset, prefix_ids);
         if (alive_seq)
-          split_batch_beam(alive_seq, _beam_size);
+          split_batch_beam(alive_seq, beam_size);
         if (alive_seq_scores)
-          split_batch_beam(alive_seq_scores, _beam_size);
+          split_batch_beam(alive_seq_scores, beam_size);
       }
 
       disable_tokens.apply();
@@ -473,6 +647,12 @@ namespace ctranslate2 {
         log_probs.shallow_copy(logits);
       }
 
+      // Get the best tokens of each beam before accumulating the beam log probs.
+      StorageView topk_ids_step;
+      StorageView topk_logprobs_step;
+      if (return_topk_logprobs > 0)
+        compute_topk_logprobs(log_probs, return_topk_logprobs, topk_ids_step, topk_logprobs_step);
+
       // Multiply by the current beam log probs.
       if (topk_scores) {
         DEVICE_AND_TYPE_DISPATCH(log_probs.device(), log_probs.dtype(),
@@ -489,7 +669,7 @@ namespace ctranslate2 {
       sampler(log_probs, topk_ids, topk_scores, num_candidates);
 
       // Unflatten the ids.
-      StorageView gather_indices = unflatten_ids(topk_ids, _beam_size, vocabulary_size, is_expanded);
+      StorageView gather_indices = unflatten_ids(topk_ids, beam_size, vocabulary_size, is_expanded);
 
       if (prefix_ids) {
         if (use_hard_prefix) {
@@ -499,7 +679,7 @@ namespace ctranslate2 {
                                     *prefix_ids,
                                     end_id,
                                     batch_offset,
-                                    _beam_size,
+                                    beam_size,
                                     &gather_indices,
                                     is_expanded);
         } else if (bias_towards_prefix) {
@@ -511,6 +691,18 @@ namespace ctranslate2 {
         }
       }
 
+      // Update the stop sequences state of each candidate.
+      std::vector<int32_t> candidate_stop_states;
+      if (stop_sequences) {
+        candidate_stop_states.resize(topk_ids.size());
+        for (dim_t c = 0; c < topk_ids.size(); ++c) {
+          const int32_t state = (stop_states.empty()
+                                 ? StopSequences::initial_state
+                                 : stop_states[gather_indices.at<int32_t>(c)]);
+          candidate_stop_states[c] = stop_sequences->next_state(state, topk_ids.at<int32_t>(c));
+        }
+      }
+
       // Append last prediction.
       append_step_output(alive_seq, topk_ids, &gather_indices);
 
@@ -530,32 +722,68 @@ namespace ctranslate2 {
       // Keep track of the previous score so we can calculate the adjacent different
       alive_seq_scores_prev = topk_scores;
 
-      if (attention_step) {
+      if (attention_argmax_ranges) {
+        append_beam_step_output(alive_attention_argmax,
+                                compute_attention_argmax(attention_step,
+                                                         *attention_argmax_ranges,
+                                                         batch_offset,
+                                                         is_expanded ? beam_size : 1),
+                                gather_indices, beam_size, num_candidates, is_expanded);
+      }
+
+      if (gather_attention) {
         if (!is_expanded)
-          repeat_batch(attention_step, _beam_size);
-        split_batch_beam(attention_step, _beam_size);
+          repeat_batch(attention_step, beam_size);
+        split_batch_beam(attention_step, beam_size);
         append_step_output(alive_attention, attention_step.to_float32().to(Device::CPU));
         gather_beam_flat(alive_attention, gather_indices, num_candidates);
       }
 
+      if (topk_ids_step) {
+        append_beam_step_output(alive_topk_ids, std::move(topk_ids_step),
+                                gather_indices, beam_size, num_candidates, is_expanded);
+        append_beam_step_output(alive_topk_logprobs, std::move(topk_logprobs_step),
+                                gather_indices, beam_size, num_candidates, is_expanded);
+      }
+
       // Check if some hypotheses are finished.
       std::vector<int32_t> non_finished_index;
       non_finished_index.reserve(cur_batch_size);
 
       // Only keep the first beam_size candidates.
-      StorageView active_beams({cur_batch_size * _beam_size}, DataType::INT32);
+      StorageView active_beams({cur_batch_size * beam_size}, DataType::INT32);
+
+      StorageView candidate_scores;
+      std::vector<float> beam_scores;
+      if (prune_beams || use_score_bound) {
+        candidate_scores = topk_scores.to_float32().to(Device::CPU);
+        beam_scores.resize(cur_batch_size * beam_size);
+      }
+
+      std::vector<std::vector<dim_t>> beam_order;
+      dim_t next_beam_size = min_beam_size;
+      if (prune_beams)
+        beam_order.resize(cur_batch_size);
 
       for (dim_t i = 0; i < cur_batch_size; ++i) {
         const dim_t batch_id = batch_offset[i];
         auto& result = results[batch_id];
-        dim_t secondary_candidates_offset = _beam_size;
+        dim_t secondary_candidates_offset = beam_size;
+
+        const dim_t prefix_length = use_hard_prefix ? prefix_ids->at(batch_id).size() : 0;
+        const auto is_stopped = [&](const dim_t candidate) {
+          return (stop_sequences
+                  && step >= prefix_length
+                  && stop_sequences->is_match(candidate_stop_states[i * num_candidates + candidate]));
+        };
 
-        for (dim_t k = 0; k < _beam_size; ++k) {
+        for (dim_t k = 0; k < beam_size; ++k) {
           const size_t last_id = topk_ids.at<int32_t>({i, k});
-          const dim_t prefix_length = use_hard_prefix ? prefix_ids->at(batch_id).size() : 0;
           dim_t next_beam_id = k;
 
-          if ((last_id == end_id && step >= prefix_length) || step + 1 == max_length) {
+          if ((last_id == end_id && step >= prefix_length)
+              || is_stopped(k)
+              || step + 1 == max_length) {
             if (k == 0)
               top_beam_finished[i] = true;
 
@@ -568,10 +796,18 @@ namespace ctranslate2 {
             result.hypotheses.emplace_back(build_hypothesis(alive_seq, i, k, ignore_last_token));
             if (alive_attention)
               result.attention.emplace_back(build_attention(alive_attention, i, k, ignore_last_token));
+            if (alive_topk_ids) {
+              result.topk_ids.emplace_back(build_topk_ids(alive_topk_ids, i, k, ignore_last_token));
+              result.topk_logprobs.emplace_back(
+                build_attention(alive_topk_logprobs, i, k, ignore_last_token));
+            }
+            if (alive_attention_argmax)
+              result.attention_argmax.emplace_back(
+                build_hypothesis(alive_attention_argmax, i, k, ignore_last_token));
             // Move another active beam to this position.
             for (dim_t j = secondary_candidates_offset; j < num_candidates; ++j) {
               const auto candidate = topk_ids.at<int32_t>({i, j});
-              if (static_cast<size_t>(candidate) != end_id) {
+              if (static_cast<size_t>(candidate) != end_id && !is_stopped(j)) {
                 next_beam_id = j;
                 secondary_candidates_offset = j + 1;
                 break;
@@ -579,7 +815,25 @@ namespace ctranslate2 {
             }
           }
 
-          active_beams.at<int32_t>(i * _beam_size + k) = i * num_candidates + next_beam_id;
+          active_beams.at<int32_t>(i * beam_size + k) = i * num_candidates + next_beam_id;
+        }
+
+        // Score of the active beams, or the lowest score for beams that finished
+        // on this step and could not be replaced.
+        float* active_scores = nullptr;
+        float best_active_score = std::numeric_limits<float>::lowest();
+        if (candidate_scores) {
+          active_scores = beam_scores.data() + i * beam_size;
+          for (dim_t k = 0; k < beam_size; ++k) {
+            const dim_t candidate = active_beams.at<int32_t>(i * beam_size + k) - i * num_candidates;
+            const size_t last_id = topk_ids.at<int32_t>({i, candidate});
+            const bool is_active = ((last_id != end_id || step < prefix_length)
+                                    && !is_stopped(candidate));
+            active_scores[k] = (is_active
+                                ? candidate_scores.at<float>({i, candidate})
+                                : std::numeric_limits<float>::lowest());
+            best_active_score = std::max(best_active_score, active_scores[k]);
+          }
         }
 
         bool is_finished = false;
@@ -588,7 +842,15 @@ namespace ctranslate2 {
         else if (allow_early_exit)
           is_finished = top_beam_finished[i] && result.hypotheses.size() >= num_hypotheses;
         else
-          is_finished = result.hypotheses.size() >= _max_candidates;
+          is_finished = (result.hypotheses.size() >= _max_candidates
+                         || (use_score_bound
+                             && result.hypotheses.size() >= num_hypotheses
+                             && !can_improve_hypotheses(result,
+                                                        num_hypotheses,
+                                                        best_active_score,
+                                                        step,
+                                                        max_length,
+                                                        _length_penalty)));
 
         if (is_finished) {
           finalize_result(result,
@@ -599,6 +861,26 @@ namespace ctranslate2 {
                           return_attention);
         } else {
           non_finished_index.emplace_back(i);
+
+          if (prune_beams) {
+            std::vector<dim_t>& order = beam_order[i];
+            order.resize(beam_size);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(),
+                             [active_scores](const dim_t a, const dim_t b) {
+                               return active_scores[a] > active_scores[b];
+                             });
+
+            // The scores are not meaningful while the beams are forced to follow the prefix.
+            const dim_t num_kept_beams = (step < prefix_length
+                                          ? beam_size
+                                          : count_beams_within_threshold(active_scores,
+                                                                         order,
+                                                                         best_active_score,
+                                                                         _pruning_absolute_threshold,
+                                                                         _pruning_relative_threshold));
+            next_beam_size = std::max(next_beam_size, num_kept_beams);
+          }
         }
       }
 
@@ -608,20 +890,52 @@ namespace ctranslate2 {
       if (next_batch_size == 0) {
         if (!is_expanded) {
           // We should ensure that states are replicated before exiting this function.
-          decoder.replicate_state(state, _beam_size);
+          decoder.replicate_state(state, beam_size);
         }
         break;
       }
 
+      // Keep the best beams of each batch when the pruning removed beams in all batches.
+      if (prune_beams && next_beam_size < beam_size) {
+        // The batches that finished on this step are removed below, but their rows are
+        // still gathered so they should reference valid candidates.
+        StorageView pruned_beams({cur_batch_size * next_beam_size}, DataType::INT32);
+        for (dim_t i = 0; i < cur_batch_size; ++i) {
+          const std::vector<dim_t>& order = beam_order[i];
+          for (dim_t k = 0; k < next_beam_size; ++k)
+            pruned_beams.at<int32_t>(i * next_beam_size + k) = active_beams.at<int32_t>(
+              i * beam_size + (order.empty() ? k : order[k]));
+        }
+        active_beams = std::move(pruned_beams);
+        beam_size = next_beam_size;
+
+        if (bias_towards_prefix) {
+          for (auto& beams_diverged : beams_diverged_from_prefix)
+            beams_diverged.resize(beam_size);
+        }
+      }
+
+      if (stop_sequences) {
+        stop_states.resize(active_beams.size());
+        for (dim_t b = 0; b < active_beams.size(); ++b)
+          stop_states[b] = candidate_stop_states[active_beams.at<int32_t>(b)];
+      }
+
       gather(gather_indices, active_beams);
-      gather_beam_flat(topk_ids, active_beams, _beam_size);
-      gather_beam_flat(topk_scores, active_beams, _beam_size);
-      gather_beam_flat(alive_seq, active_beams, _beam_size);
-      gather_beam_flat(alive_seq_scores, active_beams, _beam_size);
+      gather_beam_flat(topk_ids, active_beams, beam_size);
+      gather_beam_flat(topk_scores, active_beams, beam_size);
+      gather_beam_flat(alive_seq, active_beams, beam_size);
+      gather_beam_flat(alive_seq_scores, active_beams, beam_size);
       if (alive_attention)
-        gather_beam_flat(alive_attention, active_beams, _beam_size);
+        gather_beam_flat(alive_attention, active_beams, beam_size);
       if (full_alive_attention)
-        gather_beam_flat(full_alive_attention, active_beams, _beam_size);
+        gather_beam_flat(full_alive_attention, active_beams, beam_size);
+      if (alive_topk_ids) {
+        gather_beam_flat(alive_topk_ids, active_beams, beam_size);
+        gather_beam_flat(alive_topk_logprobs, active_beams, beam_size);
+      }
+      if (alive_attention_argmax)
+        gather_beam_flat(alive_attention_argmax, active_beams, beam_size);
 
       // If some sentences finished on this step, ignore them for the next step.
       std::unique_ptr<StorageView> keep_batches;
@@ -640,16 +954,32 @@ namespace ctranslate2 {
           gather(alive_attention, *keep_batches);
         if (full_alive_attention)
           gather(full_alive_attention, *keep_batches);
+        if (alive_topk_ids) {
+          gather(alive_topk_ids, *keep_batches);
+          gather(alive_topk_logprobs, *keep_batches);
+        }
+        if (alive_attention_argmax)
+          gather(alive_attention_argmax, *keep_batches);
+        if (stop_sequences) {
+          std::vector<int32_t> keep_stop_states;
+          keep_stop_states.reserve(next_batch_size * beam_size);
+          for (const int32_t i : non_finished_index) {
+            keep_stop_states.insert(keep_stop_states.end(),
+                                    stop_states.begin() + i * beam_size,
+                                    stop_states.begin() + (i + 1) * beam_size);
+          }
+          stop_states = std::move(keep_stop_states);
+        }
         if (keep_batches->device() != device)
           *keep_batches = keep_batches->to(device);
       }
 
       if (gather_indices.device() != device)
         gather_indices = gather_indices.to(device);
-      decoder.update_state(state, gather_indices, _beam_size, keep_batches.get());
+      decoder.update_state(state, gather_indices, beam_size, keep_batches.get());
 
-      topk_ids.reshape({next_batch_size * _beam_size});
-      topk_scores.reshape({next_batch_size * _beam_size});
+      topk_ids.reshape({next_batch_size * beam_size});
+      topk_scores.reshape({next_batch_size * beam_size});
 
       if (bias_towards_prefix)
         bias_towards_prefix = !all_beams_diverged_from_prefix(beams_diverged_from_prefix);
@@ -679,7 +1009,10 @@ namespace ctranslate2 {
                        const size_t num_hypotheses,
                        const bool include_eos_in_hypotheses,
                        const std::vector<std::shared_ptr<LogitsProcessor>>& logits_processors,
-                       const std::vector<std::vector<size_t>>* prefix_ids) const {
+                       const std::vector<std::vector<size_t>>* prefix_ids,
+                       const size_t return_topk_logprobs,
+                       const StopSequences* stop_sequences,
+                       const std::vector<std::pair<dim_t, dim_t>>* attention_argmax_ranges) const {
     const dim_t batch_size = start_ids.size();
 
     // We can return multiple hypotheses from greedy search when random sampling is enabled.
@@ -694,6 +1027,9 @@ namespace ctranslate2 {
       std::vector<std::vector<size_t>> repeat_prefix_ids;
       if (prefix_ids)
         repeat_prefix_ids = repeat_vector(*prefix_ids, num_hypotheses);
+      std::vector<std::pair<dim_t, dim_t>> repeat_attention_argmax_ranges;
+      if (attention_argmax_ranges)
+        repeat_attention_argmax_ranges = repeat_vector(*attention_argmax_ranges, num_hypotheses);
 
       std::vector<DecodingResult> results = search(decoder,
                                                    state,
@@ -708,7 +1044,12 @@ namespace ctranslate2 {
                                                    /*num_hypotheses=*/1,
                                                    include_eos_in_hypotheses,
                                                    logits_processors,
-                                                   prefix_ids ? &repeat_prefix_ids : nullptr);
+                                                   prefix_ids ? &repeat_prefix_ids : nullptr,
+                                                   return_topk_logprobs,
+                                                   stop_sequences,
+                                                   attention_argmax_ranges
+                                                   ? &repeat_attention_argmax_ranges
+                                                   : nullptr);
 
       std::vector<DecodingResult> final_results(batch_size);
 
@@ -722,6 +1063,12 @@ namespace ctranslate2 {
         if (return_attention){
           final_result.attention.emplace_back(std::move(result.attention[0]));
         }
+        if (return_topk_logprobs > 0) {
+          final_result.topk_ids.emplace_back(std::move(result.topk_ids[0]));
+          final_result.topk_logprobs.emplace_back(std::move(result.topk_logprobs[0]));
+        }
+        if (attention_argmax_ranges)
+          final_result.attention_argmax.emplace_back(std::move(result.attention_argmax[0]));
       }
 
       for (auto& result : final_results)
@@ -751,6 +1098,12 @@ namespace ctranslate2 {
       if (return_attention){
         results[i].attention.resize(1);
       }
+      if (return_topk_logprobs > 0) {
+        results[i].topk_ids.resize(1);
+        results[i].topk_logprobs.resize(1);
+      }
+      if (attention_argmax_ranges)
+        results[i].attention_argmax.resize(1);
         
     }
 
@@ -759,13 +1112,17 @@ namespace ctranslate2 {
     StorageView attention_step;
     StorageView attention_step_device(dtype, device);
     StorageView alive_seq(DataType::INT32);
+    std::vector<int32_t> stop_states;
+    if (stop_sequences)
+      stop_states.resize(batch_size, StopSequences::initial_state);
+
     for (dim_t step = 0; step < max_length; ++step) {
       convert_to_original_word_ids(decoder, sample_from);
       decoder(start_step + step,
               sample_from.to(device),
               state,
               &logits,
-              gather_attention ? &attention_step_device : nullptr);
+              (gather_attention || attention_argmax_ranges) ? &attention_step_device : nullptr);
 
       DisableTokens disable_tokens(logits);
 
@@ -780,14 +1137,25 @@ namespace ctranslate2 {
 
       // Compute log probs only if required.
       StorageView log_probs(dtype, device);
-      if (return_scores)
+      if (return_scores || return_topk_logprobs > 0)
         ops::LogSoftMax()(logits);
       log_probs.shallow_copy(logits);
 
+      StorageView topk_ids_step;
+      StorageView topk_logprobs_step;
+      if (return_topk_logprobs > 0)
+        compute_topk_logprobs(log_probs, return_topk_logprobs, topk_ids_step, topk_logprobs_step);
+
       sampler(log_probs, best_ids, best_probs);
       if (prefix_ids)
         update_sample_with_prefix(step, best_ids, best_probs, *prefix_ids, end_id, batch_offset);
-      if (attention_step_device)
+      StorageView attention_argmax_step;
+      if (attention_argmax_ranges)
+        attention_argmax_step = compute_attention_argmax(attention_step_device,
+                                                         *attention_argmax_ranges,
+                                                         batch_offset,
+                                                         /*rows_per_batch=*/1);
+      if (gather_attention)
         attention_step.copy_from(attention_step_device.to_float32());
 
       if (!logits_processors.empty()) {
@@ -810,6 +1178,15 @@ namespace ctranslate2 {
 
         if (word_id != end_id || include_eos_in_hypotheses) {
           results[batch_id].hypotheses[0].push_back(word_id);
+          if (topk_ids_step) {
+            const dim_t k = topk_ids_step.dim(-1);
+            const auto* ids = topk_ids_step.index<int32_t>({i, 0});
+            const auto* logprobs = topk_logprobs_step.index<float>({i, 0});
+            results[batch_id].topk_ids[0].emplace_back(ids, ids + k);
+            results[batch_id].topk_logprobs[0].emplace_back(logprobs, logprobs + k);
+          }
+          if (attention_argmax_step)
+            results[batch_id].attention_argmax[0].push_back(attention_argmax_step.at<int32_t>(i));
           if (attention_step) {
             const auto* attn = attention_step.index<float>({i, 0});
             results[batch_id].attention[0].emplace_back(attn, attn + attention_step.dim(-1));
@@ -831,7 +1208,14 @@ namespace ctranslate2 {
           results[batch_id].token_scores[0].push_back(best_probs.scalar_at<float>({i, 0}));
         }
 
+        bool is_stopped = false;
+        if (stop_sequences) {
+          stop_states[i] = stop_sequences->next_state(stop_states[i], word_id);
+          is_stopped = step >= prefix_length && stop_sequences->is_match(stop_states[i]);
+        }
+
         const bool is_finished = ((word_id == end_id && step >= prefix_length)
+                                  || is_stopped
                                   || (step + 1 == max_length));
 
         if (is_finished) {
@@ -856,6 +1240,8 @@ namespace ctranslate2 {
       // Remove finished sentences from the execution.
       if (count_alive != cur_batch_size) {
         batch_offset = index_vector(batch_offset, non_finished_index);
+        if (stop_sequences)
+          stop_states = index_vector(stop_states, non_finished_index);
 
         StorageView alive({count_alive}, non_finished_index);
         if (alive_seq)
@@ -934,11 +1320,24 @@ namespace ctranslate2 {
       throw std::invalid_argument("The maximum decoding length must be > 0");
     if (options.repetition_penalty <= 0)
       throw std::invalid_argument("The repetition penalty must be > 0");
+    if (options.beam_pruning_absolute_threshold < 0
+        || options.beam_pruning_relative_threshold < 0)
+      throw std::invalid_argument("The beam pruning thresholds must be >= 0");
+    if (options.early_exit_threshold < 0 || options.early_exit_threshold > 1)
+      throw std::invalid_argument("The early exit threshold must be between 0 and 1");
+    if (options.early_exit_interval == 0)
+      throw std::invalid_argument("The early exit interval must be > 0");
     if (options.prefix_bias_beta >= 1)
       throw std::invalid_argument("The beta value in biased decoding must be < 1");
     if (options.prefix_bias_beta > 0 && options.return_alternatives)
       throw std::invalid_argument("Biased decoding is not compatible with the return_alternatives "
                                   "mode");
+    if (options.return_attention_argmax && options.return_alternatives)
+      throw std::invalid_argument("Returning the attention argmax is not compatible with the "
+                                  "return_alternatives mode");
+    if (options.return_topk_logprobs > 0 && options.return_alternatives)
+      throw std::invalid_argument("Returning the top-k log probabilities is not compatible with "
+                                  "the return_alternatives mode");
     if (options.return_alternatives
         && (options.min_alternative_expansion_prob < 0
             || options.min_alternative_expansion_prob > 1))
@@ -963,7 +1362,10 @@ namespace ctranslate2 {
                                           options.length_penalty,
                                           options.coverage_penalty,
                                           options.prefix_bias_beta,
-                                          options.patience);
+                                          options.patience,
+                                          options.beam_pruning_absolute_threshold,
+                                          options.beam_pruning_relative_threshold,
+                                          options.beam_score_bound);
   }
 
   static std::vector<std::shared_ptr<LogitsProcessor>>
@@ -1003,7 +1405,8 @@ namespace ctranslate2 {
                       layers::DecoderState& state,
                       std::vector<size_t> start_tokens,
                       const size_t end_id,
-                      const DecodingOptions& options) {
+                      const DecodingOptions& options,
+                      const StopSequences* stop_sequences) {
     DecodingResult result;
     result.hypotheses.resize(options.num_hypotheses);
     if (options.return_scores){
@@ -1154,7 +1557,10 @@ namespace ctranslate2 {
                                                   options.return_attention,
                                                   /*num_hypotheses=*/1,
                                                   options.include_eos_in_hypotheses,
-                                                  logits_processors);
+                                                  logits_processors,
+                                                  /*prefix_ids=*/nullptr,
+                                                  /*return_topk_logprobs=*/0,
+                                                  stop_sequences);
 
     // Update the result with the suffix decoding.
     for (size_t i = 0; i < suffix_results.size(); ++i) {
@@ -1192,6 +1598,41 @@ namespace ctranslate2 {
     return new_ids;
   }
 
+  // Enables the decoder early exit for the duration of a decoding.
+  class ScopedEarlyExit {
+  public:
+    ScopedEarlyExit(layers::Decoder& decoder, const DecodingOptions& options)
+      : _decoder(decoder)
+    {
+      _decoder.set_early_exit(options.early_exit_threshold, options.early_exit_interval);
+    }
+
+    ~ScopedEarlyExit() {
+      _decoder.set_early_exit(0);
+    }
+
+  private:
+    layers::Decoder& _decoder;
+  };
+
+  // Enables the two-stage output projection for the duration of a decoding.
+  class ScopedTwoStageOutput {
+  public:
+    ScopedTwoStageOutput(layers::Decoder& decoder, const DecodingOptions& options)
+      : _decoder(decoder)
+    {
+      _decoder.set_two_stage_output(options.two_stage_candidates,
+                                    options.two_stage_exact_log_probs);
+    }
+
+    ~ScopedTwoStageOutput() {
+      _decoder.set_two_stage_output(0);
+    }
+
+  private:
+    layers::Decoder& _decoder;
+  };
+
   std::vector<DecodingResult>
   decode(layers::Decoder& decoder,
          layers::DecoderState& state,
@@ -1204,6 +1645,9 @@ namespace ctranslate2 {
     if (batch_size == 0)
       throw std::invalid_argument("No decoder start tokens are set");
 
+    const ScopedEarlyExit early_exit(decoder, options);
+    const ScopedTwoStageOutput two_stage_output(decoder, options);
+
     std::vector<DecodingResult> results;
 
     if (decoder.output_layer_is_updated()) {
@@ -1216,8 +1660,21 @@ namespace ctranslate2 {
 
       options.disable_ids = map_to_output_word_ids(decoder, options.disable_ids);
       options.disable_ids_begin = map_to_output_word_ids(decoder, options.disable_ids_begin);
+
+      for (auto& ids : options.stop_sequences) {
+        auto output_ids = map_to_output_word_ids(decoder, ids);
+        // Ignore stop sequences that can not be generated with the current output layer.
+        if (output_ids.size() != ids.size())
+          ids.clear();
+        else
+          ids = std::move(output_ids);
+      }
     }
 
+    std::unique_ptr<const StopSequences> stop_sequences;
+    if (!options.stop_sequences.empty())
+      stop_sequences = std::make_unique<StopSequences>(options.stop_sequences);
+
     if (options.return_alternatives) {
       results.reserve(batch_size);
       for (size_t i = 0; i < batch_size; ++i) {
@@ -1226,7 +1683,8 @@ namespace ctranslate2 {
                                                  batch_state,
                                                  start_tokens[i],
                                                  end_id,
-                                                 options));
+                                                 options,
+                                                 stop_sequences.get()));
       }
 
     } else {
@@ -1234,6 +1692,16 @@ namespace ctranslate2 {
       std::vector<std::vector<size_t>> prefix_ids;
       std::tie(start_ids, prefix_ids) = split_start_tokens(start_tokens);
 
+      std::vector<std::pair<dim_t, dim_t>> attention_argmax_ranges;
+      if (options.return_attention_argmax) {
+        attention_argmax_ranges = options.attention_argmax_ranges;
+        if (attention_argmax_ranges.empty())
+          attention_argmax_ranges.resize(batch_size, {0, std::numeric_limits<dim_t>::max()});
+        else if (attention_argmax_ranges.size() != batch_size)
+          throw std::invalid_argument("The number of attention argmax ranges does not match "
+                                      "the batch size");
+      }
+
       const auto search_strategy = make_search_strategy(options);
       const auto sampler = make_sampler(options);
       const auto logits_processors = make_logits_processors(options);
@@ -1250,17 +1718,31 @@ namespace ctranslate2 {
                                         options.num_hypotheses,
                                         options.include_eos_in_hypotheses,
                                         logits_processors,
-                                        prefix_ids.empty() ? nullptr : &prefix_ids);
+                                        prefix_ids.empty() ? nullptr : &prefix_ids,
+                                        options.return_topk_logprobs,
+                                        stop_sequences.get(),
+                                        options.return_attention_argmax
+                                        ? &attention_argmax_ranges
+                                        : nullptr);
     }
 
+    const float average_exit_depth = decoder.average_exit_depth();
+
     for (size_t b = 0; b < batch_size; ++b) {
       auto& result = results[b];
+      result.average_exit_depth = average_exit_depth;
 
       for (size_t i = 0; i < result.hypotheses.size(); ++i) {
         // Restore original word ids.
         if (decoder.output_layer_is_updated()) {
           for (auto& id : result.hypotheses[i])
             id = decoder.to_original_word_id(id);
+          if (!result.topk_ids.empty()) {
+            for (auto& step_ids : result.topk_ids[i]) {
+              for (auto& id : step_ids)
+                id = decoder.to_original_word_id(id);
+            }
+          }
         }
       }
     }
@@ -1,6 +1,8 @@
 #include "ctranslate2/decoding_utils.h"
 
+#include <queue>
 #include <set>
+#include <stdexcept>
 
 #include "ctranslate2/ops/ops.h"
 #include "dispatch.h"
@@ -193,4 +195,79 @@ namespace ctranslate2 {
     }
   }
 
+
+  StopSequences::StopSequences(const std::vector<std::vector<size_t>>& sequences)
+    : _transitions(1)
+    , _fallback(1, initial_state)
+    , _is_match(1, false)
+  {
+    // Build the trie of stop sequences.
+    for (const auto& sequence : sequences) {
+      if (sequence.empty())
+        continue;
+
+      int32_t state = initial_state;
+      for (const size_t id : sequence) {
+        const auto it = _transitions[state].find(id);
+        if (it != _transitions[state].end()) {
+          state = it->second;
+          continue;
+        }
+
+        const int32_t new_state = _transitions.size();
+        _transitions[state].emplace(id, new_state);
+        _transitions.emplace_back();
+        _fallback.emplace_back(initial_state);
+        _is_match.emplace_back(false);
+        state = new_state;
+      }
+
+      _is_match[state] = true;
+    }
+
+    // Link each state to the state of its longest proper suffix, in breadth-first order.
+    std::queue<int32_t> states;
+    for (const auto& transition : _transitions[initial_state])
+      states.push(transition.second);
+
+    while (!states.empty()) {
+      const int32_t state = states.front();
+      states.pop();
+
+      for (const auto& transition : _transitions[state]) {
+        const int32_t next = transition.second;
+        _fallback[next] = next_state(_fallback[state], transition.first);
+        if (_is_match[_fallback[next]])
+          _is_match[next] = true;
+        states.push(next);
+      }
+    }
+  }
+
+  int32_t StopSequences::next_state(int32_t state, size_t id) const {
+    while (true) {
+      const auto& transitions = _transitions[state];
+      const auto it = transitions.find(id);
+      if (it != transitions.end())
+        return it->second;
+      if (state == initial_state)
+        return initial_state;
+      state = _fallback[state];
+    }
+  }
+
+  std::vector<std::vector<size_t>>
+  stop_sequences_to_ids(const Vocabulary& vocabulary,
+                        const std::vector<std::vector<std::string>>& stop_sequences) {
+    for (const auto& sequence : stop_sequences) {
+      for (const auto& token : sequence) {
+        if (!vocabulary.contains(token))
+          throw std::invalid_argument("The stop sequence token '" + token
+                                      + "' is not in the vocabulary");
+      }
+    }
+
+    return vocabulary.to_ids(stop_sequences);
+  }
+
 }
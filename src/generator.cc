@@ -18,7 +18,16 @@ namespace ctranslate2 {
         auto results = generator.generate(batch.get_stream(0), options);
         spdlog::debug("Finished batch generation");
         return results;
-      });
+      },
+      get_generation_memory_estimator(options));
+  }
+
+  Generator::MemoryEstimateFunc
+  Generator::get_generation_memory_estimator(const GenerationOptions& options) const {
+    return get_decoding_memory_estimator(std::max(options.beam_size, options.num_hypotheses),
+                                         options.max_length,
+                                         /*max_input_length=*/0,
+                                         options.two_stage_candidates);
   }
 
   std::vector<std::future<ScoringResult>>
@@ -38,6 +47,43 @@ namespace ctranslate2 {
       });
   }
 
+  std::unique_ptr<ResultIterator<GenerationResult>>
+  Generator::generate_iterable(std::unique_ptr<BatchReader> reader,
+                               const GenerationOptions& options,
+                               size_t max_batch_size,
+                               size_t read_batch_size,
+                               BatchType batch_type,
+                               size_t max_batches_per_replica) {
+    return post_stream<GenerationResult>(
+      std::move(reader),
+      [options](models::SequenceGeneratorReplica& generator, const Batch& batch) {
+        return generator.generate(batch.get_stream(0), options);
+      },
+      max_batch_size,
+      read_batch_size,
+      batch_type,
+      max_batches_per_replica,
+      get_generation_memory_estimator(options));
+  }
+
+  std::unique_ptr<ResultIterator<ScoringResult>>
+  Generator::score_iterable(std::unique_ptr<BatchReader> reader,
+                            const ScoringOptions& options,
+                            size_t max_batch_size,
+                            size_t read_batch_size,
+                            BatchType batch_type,
+                            size_t max_batches_per_replica) {
+    return post_stream<ScoringResult>(
+      std::move(reader),
+      [options](models::SequenceGeneratorReplica& generator, const Batch& batch) {
+        return generator.score(batch.get_stream(0), options);
+      },
+      max_batch_size,
+      read_batch_size,
+      batch_type,
+      max_batches_per_replica);
+  }
+
   std::future<StorageView>
   Generator::forward_batch_async(std::vector<std::vector<std::string>> tokens,
                                  const bool return_log_probs) {
@@ -69,4 +115,159 @@ namespace ctranslate2 {
       });
   }
 
+
+  std::shared_ptr<models::GenerationSession>
+  Generator::create_session(std::chrono::milliseconds idle_timeout) {
+    evict_idle_sessions();
+
+    const std::lock_guard<std::mutex> lock(_sessions_mutex);
+    const size_t replica_index = _next_session_replica++ % num_replicas();
+
+    // The decoder state can reference the thread-local allocator of the owning replica,
+    // so it is released by this replica when the session is destroyed.
+    std::shared_ptr<models::GenerationSession> session(
+      new models::GenerationSession(replica_index, idle_timeout),
+      [weak_releaser = std::weak_ptr<SessionReleaser>(_session_releaser)]
+      (models::GenerationSession* session) {
+        const auto releaser = weak_releaser.lock();
+        if (!releaser) {
+          delete session;
+          return;
+        }
+
+        {
+          std::unique_lock<std::mutex> lock(releaser->mutex);
+          if (!releaser->generator) {
+            lock.unlock();
+            delete session;
+            return;
+          }
+          ++releaser->num_pending_releases;
+        }
+
+        // The job is posted without holding the lock since the queue could be full.
+        releaser->generator->release_session(session);
+
+        {
+          const std::lock_guard<std::mutex> lock(releaser->mutex);
+          --releaser->num_pending_releases;
+        }
+        releaser->released.notify_all();
+      });
+
+    _sessions.emplace_back(session);
+    return session;
+  }
+
+  void Generator::release_session(models::GenerationSession* session) {
+    std::shared_ptr<models::GenerationSession> owned_session(session);
+    const size_t replica_index = owned_session->replica_index();
+
+    // The session is destroyed in place when the owning replica releases it.
+    if (is_replica_thread(replica_index))
+      return;
+
+    post_to_replica<bool>(
+      replica_index,
+      [owned_session = std::move(owned_session)](models::SequenceGeneratorReplica& generator) {
+        generator.evict_session(*owned_session);
+        return true;
+      });
+  }
+
+  Generator::~Generator() {
+    {
+      std::unique_lock<std::mutex> lock(_session_releaser->mutex);
+      _session_releaser->generator = nullptr;
+      _session_releaser->released.wait(lock, [this] {
+        return _session_releaser->num_pending_releases == 0;
+      });
+    }
+
+    // The sessions that are still alive are released by their replica before the
+    // replicas are destroyed: the queued jobs are run before the worker threads exit.
+    const std::lock_guard<std::mutex> lock(_sessions_mutex);
+    for (const auto& weak_session : _sessions) {
+      auto session = weak_session.lock();
+      if (!session)
+        continue;
+
+      const size_t replica_index = session->replica_index();
+      post_to_replica<bool>(
+        replica_index,
+        [session = std::move(session)](models::SequenceGeneratorReplica& generator) {
+          generator.evict_session(*session);
+          return true;
+        });
+    }
+  }
+
+  std::future<GenerationResult>
+  Generator::generate_in_session_async(const std::shared_ptr<models::GenerationSession>& session,
+                                       std::vector<std::string> tokens,
+                                       const GenerationOptions& options) {
+    if (!session)
+      throw std::invalid_argument("The generation session is not set");
+
+    evict_idle_sessions();
+
+    return post_to_replica<GenerationResult>(
+      session->replica_index(),
+      [session, tokens = std::move(tokens), options]
+      (models::SequenceGeneratorReplica& generator) {
+        return generator.generate_in_session(*session, tokens, options);
+      });
+  }
+
+  void Generator::offload_session(const std::shared_ptr<models::GenerationSession>& session) {
+    if (!session)
+      throw std::invalid_argument("The generation session is not set");
+
+    post_to_replica<bool>(
+      session->replica_index(),
+      [session](models::SequenceGeneratorReplica& generator) {
+        generator.offload_session(*session);
+        return true;
+      }).get();
+  }
+
+  size_t Generator::evict_idle_sessions() {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<std::pair<size_t, std::weak_ptr<models::GenerationSession>>> idle_sessions;
+
+    {
+      const std::lock_guard<std::mutex> lock(_sessions_mutex);
+      std::vector<std::weak_ptr<models::GenerationSession>> active_sessions;
+      active_sessions.reserve(_sessions.size());
+
+      for (auto& weak_session : _sessions) {
+        const auto session = weak_session.lock();
+        if (!session)
+          continue;
+        if (session->num_cached_ids() > 0 && session->is_idle(now))
+          idle_sessions.emplace_back(session->replica_index(), weak_session);
+        active_sessions.emplace_back(std::move(weak_session));
+      }
+
+      _sessions = std::move(active_sessions);
+    }
+
+    // The decoder state is released by the owning replica, after the pending generations
+    // of this session. The session could be used again in the meantime so it is checked again.
+    for (auto& [replica_index, weak_session] : idle_sessions) {
+      post_to_replica<bool>(
+        replica_index,
+        [weak_session = std::move(weak_session)]
+        (models::SequenceGeneratorReplica& generator) {
+          const auto session = weak_session.lock();
+          if (!session || !session->is_idle())
+            return false;
+          generator.evict_session(*session);
+          return true;
+        });
+    }
+
+    return idle_sessions.size();
+  }
+
 }
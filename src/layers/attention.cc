@@ -4,6 +4,7 @@
 #include <cmath>
 #include <iostream>
 
+#include "ctranslate2/memory_planner.h"
 #include "dispatch.h"
 
 namespace ctranslate2 {
@@ -29,78 +30,154 @@ namespace ctranslate2 {
       return positions;
     }
 
-    static StorageView get_relative_position_bucket(bool bidirectional,
-                                                    dim_t query_length,
-                                                    dim_t key_length,
-                                                    dim_t num_buckets,
-                                                    dim_t max_distance,
-                                                    dim_t query_offset = 0) {
-      StorageView relative_buckets({query_length, key_length}, DataType::INT32);
+    static int32_t get_relative_position_bucket(int32_t relative_position,
+                                                bool bidirectional,
+                                                dim_t num_buckets,
+                                                dim_t max_distance) {
+      int32_t relative_bucket = 0;
 
-      if (bidirectional)
+      if (bidirectional) {
         num_buckets /= 2;
+        if (relative_position > 0)
+          relative_bucket += num_buckets;
+        else
+          relative_position = std::abs(relative_position);
+      } else {
+        relative_position = -std::min(relative_position, 0);
+      }
 
       const dim_t max_exact = num_buckets / 2;
+      const bool is_small = relative_position < max_exact;
+
+      if (!is_small) {
+        relative_position = std::min(
+          int32_t(float(max_exact)
+                  + std::log(float(relative_position) / float(max_exact))
+                  / std::log(float(max_distance) / float(max_exact))
+                  * float(num_buckets - max_exact)),
+          int32_t(num_buckets - 1));
+      }
 
-      for (dim_t i = 0; i < query_length; ++i) {
-        for (dim_t j = 0; j < key_length; ++j) {
-          int32_t relative_position = j - (i + query_offset);
-          int32_t& relative_bucket = relative_buckets.at<int32_t>(i * key_length + j);
+      return relative_bucket + relative_position;
+    }
 
-          relative_bucket = 0;
+    const StorageView& RelativePositionCache::positions(dim_t length,
+                                                        dim_t max_position,
+                                                        bool with_cache,
+                                                        Device device) {
+      // The cached positions outlive the decoding step.
+      const ScopedDeviceAllocation device_allocation;
 
-          if (bidirectional) {
-            if (relative_position > 0)
-              relative_bucket += num_buckets;
-            else
-              relative_position = std::abs(relative_position);
-          } else {
-            relative_position = -std::min(relative_position, 0);
-          }
+      if (with_cache) {
+        // The positions for a length are the suffix of the positions for a longer length,
+        // so we can return a view on a larger cached buffer.
+        if (!_positions_with_cache || length > _positions_length) {
+          _positions_length = std::max(length, 2 * _positions_length);
+          _positions_with_cache = true;
+          _positions = make_relative_positions(_positions_length, max_position, true).to(device);
+        }
 
-          const bool is_small = relative_position < max_exact;
+        _positions_view = StorageView(DataType::INT32, device);
+        _positions_view.view(_positions.data<int32_t>() + _positions_length - length, {1, length});
+        return _positions_view;
+      }
 
-          if (!is_small) {
-            relative_position = std::min(
-              int32_t(float(max_exact)
-                      + std::log(float(relative_position) / float(max_exact))
-                      / std::log(float(max_distance) / float(max_exact))
-                      * float(num_buckets - max_exact)),
-              int32_t(num_buckets - 1));
-          }
+      if (_positions_with_cache || length != _positions_length) {
+        _positions_length = length;
+        _positions_with_cache = false;
+        _positions = make_relative_positions(length, max_position, false).to(device);
+      }
+
+      return _positions;
+    }
 
-          relative_bucket += relative_position;
+    void RelativePositionCache::update_bias_table(const StorageView& relative_attention_bias,
+                                                  dim_t max_time,
+                                                  dim_t max_distance,
+                                                  bool bidirectional) {
+      if (max_time <= _bias_table_max_time)
+        return;
 
-        }
-      }
+      max_time = std::max(max_time, 2 * _bias_table_max_time);
 
-      return relative_buckets;
+      const dim_t num_buckets = relative_attention_bias.dim(0);
+      const dim_t num_positions = 2 * max_time - 1;
+
+      // The bucket only depends on the relative position, so it is computed once
+      // per position instead of once per (query, key) pair.
+      StorageView buckets({num_positions}, DataType::INT32);
+      auto* buckets_data = buckets.data<int32_t>();
+      for (dim_t i = 0; i < num_positions; ++i)
+        buckets_data[i] = get_relative_position_bucket(i - (max_time - 1),
+                                                       bidirectional,
+                                                       num_buckets,
+                                                       max_distance);
+
+      _bias_table = StorageView(relative_attention_bias.dtype(), relative_attention_bias.device());
+      ops::Gather()(relative_attention_bias,
+                    buckets.to(relative_attention_bias.device()),
+                    _bias_table);
+      _bias_table_max_time = max_time;
+
+      // Invalidate the cached bias.
+      _bias_query_length = 0;
     }
 
-    static StorageView compute_relative_bias(const StorageView& relative_attention_bias,
-                                             dim_t query_length,
-                                             dim_t key_length,
-                                             dim_t max_distance,
-                                             bool is_decoder,
-                                             dim_t query_offset = 0) {
+    const StorageView& RelativePositionCache::bias(const StorageView& relative_attention_bias,
+                                                   dim_t query_length,
+                                                   dim_t key_length,
+                                                   dim_t max_distance,
+                                                   bool bidirectional,
+                                                   dim_t query_offset) {
+      // The cached bias outlives the decoding step.
+      const ScopedDeviceAllocation device_allocation;
+
       const Device device = relative_attention_bias.device();
       const DataType dtype = relative_attention_bias.dtype();
-      const dim_t num_buckets = relative_attention_bias.dim(0);
+      const dim_t num_heads = relative_attention_bias.dim(1);
 
-      StorageView relative_attention_bucket = get_relative_position_bucket(!is_decoder,
-                                                                           query_length,
-                                                                           key_length,
-                                                                           num_buckets,
-                                                                           max_distance,
-                                                                           query_offset);
+      update_bias_table(relative_attention_bias,
+                        std::max(query_length + query_offset, key_length),
+                        max_distance,
+                        bidirectional);
 
+      if (query_length == _bias_query_length
+          && key_length == _bias_key_length
+          && query_offset == _bias_query_offset)
+        return _bias;
+
+      const dim_t center = _bias_table_max_time - 1;
       StorageView values(dtype, device);
-      ops::Gather()(relative_attention_bias, relative_attention_bucket.to(device), values);
 
-      StorageView values_t(dtype, device);
-      ops::Transpose({2, 0, 1})(values, values_t);
+      if (query_length == 1) {
+        // The relative positions of a single query are contiguous in the bias table.
+        const dim_t first_position = center - query_offset;
+        StorageView rows(dtype, device);
+        TYPE_DISPATCH(dtype, rows.view(_bias_table.data<T>() + first_position * num_heads,
+                                       {key_length, num_heads}));
+        ops::Transpose()(rows, values);
+        values.reshape({num_heads, 1, key_length});
+
+        // Do not record this bias in the cache since the next step will use another offset.
+        _bias = std::move(values);
+        _bias_query_length = 0;
+        return _bias;
+      }
+
+      StorageView indices({query_length, key_length}, DataType::INT32);
+      auto* indices_data = indices.data<int32_t>();
+      for (dim_t i = 0; i < query_length; ++i) {
+        for (dim_t j = 0; j < key_length; ++j)
+          indices_data[i * key_length + j] = j - (i + query_offset) + center;
+      }
+
+      ops::Gather()(_bias_table, indices.to(device), values);
+      ops::Transpose({2, 0, 1})(values, _bias);
 
-      return values_t;
+      _bias_query_length = query_length;
+      _bias_key_length = key_length;
+      _bias_query_offset = query_offset;
+      return _bias;
     }
 
     StorageView reduce_multi_head_attention(const StorageView& attention,
@@ -124,6 +201,128 @@ namespace ctranslate2 {
       return reduced_attention;
     }
 
+    // Calls func(row, begin, end) for each range of timesteps of the batch b that are stored
+    // in the same cache row.
+    template <typename Func>
+    static void for_each_cache_range(const StorageView& cache_rows,
+                                     const dim_t b,
+                                     const dim_t time,
+                                     const Func& func) {
+      const dim_t rows_time = cache_rows.dim(1);
+      const int32_t* rows = cache_rows.data<int32_t>() + b * rows_time;
+      const auto row_at = [&](const dim_t t) {
+        return t < rows_time ? dim_t(rows[t]) : b;
+      };
+
+      for (dim_t begin = 0, end = 0; begin < time; begin = end) {
+        const dim_t row = row_at(begin);
+        for (end = begin + 1; end < time && row_at(end) == row; ++end);
+        func(row, begin, end);
+      }
+    }
+
+    template <Device D, typename T>
+    static void gather_cache_rows(const T* cache,
+                                  const StorageView& cache_rows,
+                                  const dim_t batch_size,
+                                  const dim_t num_heads,
+                                  const dim_t time,
+                                  const dim_t head_dim,
+                                  T* output) {
+      for (dim_t b = 0; b < batch_size; ++b) {
+        for_each_cache_range(cache_rows, b, time, [&](dim_t row, dim_t begin, dim_t end) {
+          for (dim_t h = 0; h < num_heads; ++h) {
+            primitives<D>::copy(cache + ((row * num_heads + h) * time + begin) * head_dim,
+                                output + ((b * num_heads + h) * time + begin) * head_dim,
+                                (end - begin) * head_dim);
+          }
+        });
+      }
+    }
+
+    void gather_cache_rows(const StorageView& cache,
+                           const StorageView& cache_rows,
+                           StorageView& output) {
+      const dim_t batch_size = cache_rows.dim(0);
+      const dim_t num_heads = cache.dim(1);
+      const dim_t time = cache.dim(2);
+      const dim_t head_dim = cache.dim(3);
+
+      output.resize({batch_size, num_heads, time, head_dim});
+      DEVICE_AND_TYPE_DISPATCH(cache.device(), cache.dtype(),
+                               (gather_cache_rows<D, T>(cache.data<T>(),
+                                                        cache_rows,
+                                                        batch_size,
+                                                        num_heads,
+                                                        time,
+                                                        head_dim,
+                                                        output.data<T>())));
+    }
+
+    // Computes queries * keys^T when the keys are read through the cache rows.
+    // Each range of timesteps stored in the same row is a single batched GEMM over the heads.
+    static void matmul_keys_with_cache_rows(const StorageView& queries,
+                                            const StorageView& keys,
+                                            const StorageView& cache_rows,
+                                            const float alpha,
+                                            StorageView& output) {
+      const dim_t batch_size = queries.dim(0);
+      const dim_t num_heads = keys.dim(1);
+      const dim_t time = keys.dim(2);
+      const dim_t head_dim = keys.dim(3);
+
+      output.resize({batch_size, num_heads, 1, time});
+      const float* queries_data = queries.data<float>();
+      const float* keys_data = keys.data<float>();
+      float* output_data = output.data<float>();
+
+      for (dim_t b = 0; b < batch_size; ++b) {
+        for_each_cache_range(cache_rows, b, time, [&](dim_t row, dim_t begin, dim_t end) {
+          primitives<Device::CPU>::gemm_batch_strided(
+            /*transpose_a=*/false, /*transpose_b=*/true,
+            1, end - begin, head_dim,
+            alpha,
+            queries_data + b * num_heads * head_dim, head_dim, head_dim,
+            keys_data + (row * num_heads * time + begin) * head_dim, head_dim, time * head_dim,
+            0.f,
+            output_data + b * num_heads * time + begin, time, time,
+            num_heads);
+        });
+      }
+    }
+
+    // Computes attention * values when the values are read through the cache rows.
+    static void matmul_values_with_cache_rows(const StorageView& attention,
+                                              const StorageView& values,
+                                              const StorageView& cache_rows,
+                                              StorageView& output) {
+      const dim_t batch_size = attention.dim(0);
+      const dim_t num_heads = values.dim(1);
+      const dim_t time = values.dim(2);
+      const dim_t head_dim = values.dim(3);
+
+      output.resize({batch_size, num_heads, 1, head_dim});
+      const float* attention_data = attention.data<float>();
+      const float* values_data = values.data<float>();
+      float* output_data = output.data<float>();
+
+      for (dim_t b = 0; b < batch_size; ++b) {
+        float beta = 0;
+        for_each_cache_range(cache_rows, b, time, [&](dim_t row, dim_t begin, dim_t end) {
+          primitives<Device::CPU>::gemm_batch_strided(
+            /*transpose_a=*/false, /*transpose_b=*/false,
+            1, head_dim, end - begin,
+            1.f,
+            attention_data + b * num_heads * time + begin, time, time,
+            values_data + (row * num_heads * time + begin) * head_dim, head_dim, time * head_dim,
+            beta,
+            output_data + b * num_heads * head_dim, head_dim, head_dim,
+            num_heads);
+          beta = 1;
+        });
+      }
+    }
+
     static void matmul_with_relative_representations(const ops::MatMul& matmul_op,
                                                      const StorageView& a,
                                                      const StorageView& b,
@@ -171,27 +370,20 @@ namespace ctranslate2 {
                                       const StorageView* values_lengths,
                                       const StorageView* relative_position_keys,
                                       const StorageView* relative_position_values,
-                                      const StorageView* relative_attention_bias,
-                                      dim_t maximum_relative_position,
+                                      const StorageView* relative_positions,
+                                      const StorageView* position_bias,
                                       StorageView& output,
                                       StorageView* attention = nullptr,
                                       float queries_scale = 1,
-                                      bool is_decoder = false,
-                                      bool with_cache = false,
-                                      dim_t beam_size = 1) {
+                                      dim_t beam_size = 1,
+                                      const StorageView* cache_rows = nullptr) {
       PROFILE("dot_product_attention");
 
-      std::unique_ptr<const StorageView> relative_positions;
-      if (relative_position_keys || relative_position_values) {
-        const dim_t max_time = keys.dim(2);
-        relative_positions = std::make_unique<StorageView>(
-          make_relative_positions(max_time,
-                                  maximum_relative_position,
-                                  with_cache).to(queries.device()));
-      }
-
       const ops::MatMul keys_matmul(/*trans_a=*/false, /*trans_b=*/true, queries_scale);
-      keys_matmul(queries, keys, output);
+      if (cache_rows)
+        matmul_keys_with_cache_rows(queries, keys, *cache_rows, queries_scale, output);
+      else
+        keys_matmul(queries, keys, output);
       if (relative_position_keys)
         add_relative_representations(queries,
                                      *relative_positions,
@@ -199,20 +391,11 @@ namespace ctranslate2 {
                                      keys_matmul,
                                      output);
 
-      if (relative_attention_bias) {
-        const dim_t query_length = queries.dim(2);
-        const dim_t key_length = keys.dim(2);
-        const StorageView position_bias = compute_relative_bias(*relative_attention_bias,
-                                                                query_length,
-                                                                key_length,
-                                                                maximum_relative_position,
-                                                                is_decoder,
-                                                                with_cache ? key_length - 1 : 0);
-
+      if (position_bias) {
         DEVICE_AND_TYPE_DISPATCH(output.device(), output.dtype(),
-                                 primitives<D>::add_batch_broadcast(position_bias.data<T>(),
+                                 primitives<D>::add_batch_broadcast(position_bias->data<T>(),
                                                                     output.data<T>(),
-                                                                    position_bias.size(),
+                                                                    position_bias->size(),
                                                                     output.size()));
       }
 
@@ -231,7 +414,10 @@ namespace ctranslate2 {
       ops::SoftMax()(output, values_lengths, attn);
 
       const ops::MatMul values_matmul;
-      values_matmul(attn, values, output);
+      if (cache_rows)
+        matmul_values_with_cache_rows(attn, values, *cache_rows, output);
+      else
+        values_matmul(attn, values, output);
       if (relative_position_values)
         add_relative_representations(attn,
                                      *relative_positions,
@@ -307,7 +493,7 @@ namespace ctranslate2 {
                                            bool self_attention,
                                            bool pre_norm,
                                            bool is_decoder)
-      : _num_heads(num_heads)
+      : _num_heads(model.get_attribute_with_default<int32_t>(scope + "/num_heads", num_heads))
       , _self_attention(self_attention)
       , _is_decoder(is_decoder)
       , _linear(make_linear_layers(model, scope, self_attention))
@@ -319,7 +505,7 @@ namespace ctranslate2 {
       , _relative_position_values(model.get_variable_if_exists(scope + "/relative_position_values"))
       , _queries_scale(model.get_attribute_with_default<float>(
                          scope + "/queries_scale",
-                         1.f / std::sqrt(static_cast<float>(_d_model / _num_heads))))
+                         1.f / std::sqrt(static_cast<float>(_d_model / num_heads))))
     {
       if (_relative_position_keys)
         _maximum_relative_position = (_relative_position_keys->dim(0) - 1) / 2;
@@ -346,7 +532,8 @@ namespace ctranslate2 {
                                         StorageView* cached_values,
                                         StorageView* attention,
                                         const Padder* queries_padder,
-                                        const Padder* values_padder) const {
+                                        const Padder* values_padder,
+                                        const StorageView* cache_rows) const {
       PROFILE("MultiHeadAttention");
       const Device device = queries.device();
       const DataType dtype = queries.dtype();
@@ -361,6 +548,16 @@ namespace ctranslate2 {
         q = &queries_proj;
       }
 
+      // The length mask is prepared for the number of heads of the unpruned model.
+      StorageView pruned_lengths(DataType::INT32, device);
+      if (values_lengths && values_lengths->dim(1) > _num_heads) {
+        StorageView removed_lengths(DataType::INT32, device);
+        ops::Split(1, {_num_heads, values_lengths->dim(1) - _num_heads})(*values_lengths,
+                                                                          pruned_lengths,
+                                                                          removed_lengths);
+        values_lengths = &pruned_lengths;
+      }
+
       _linear[0](*q, fused_proj);
 
       dim_t beam_size = 1;
@@ -392,6 +589,8 @@ namespace ctranslate2 {
             *cached_keys = std::move(keys_proj);
             *cached_values = std::move(values_proj);
           } else {
+            // The cache outlives the step so it is not allocated from the memory plan.
+            const ScopedDeviceAllocation device_allocation;
             StorageView& tmp = fused_proj;  // Reuse storage.
             tmp = std::move(*cached_keys);
             ops::Concat(2)({&tmp, &keys_proj}, *cached_keys);
@@ -406,6 +605,26 @@ namespace ctranslate2 {
         values_proj.shallow_copy(*cached_values);
       }
 
+      const bool with_cache = bool(cached_keys);
+      const dim_t query_length = queries_proj.dim(2);
+      const dim_t key_length = keys_proj.dim(2);
+
+      const StorageView* relative_positions = nullptr;
+      if (_relative_position_keys || _relative_position_values)
+        relative_positions = &_relative_position_cache.positions(key_length,
+                                                                 _maximum_relative_position,
+                                                                 with_cache,
+                                                                 device);
+
+      const StorageView* position_bias = nullptr;
+      if (_relative_attention_bias)
+        position_bias = &_relative_position_cache.bias(*_relative_attention_bias,
+                                                       query_length,
+                                                       key_length,
+                                                       _maximum_relative_position,
+                                                       /*bidirectional=*/!_is_decoder,
+                                                       with_cache ? key_length - 1 : 0);
+
       StorageView& context = fused_proj;  // Reuse storage.
       dot_product_attention(queries_proj,
                             keys_proj,
@@ -413,14 +632,13 @@ namespace ctranslate2 {
                             values_lengths,
                             _relative_position_keys,
                             _relative_position_values,
-                            _relative_attention_bias,
-                            _maximum_relative_position,
+                            relative_positions,
+                            position_bias,
                             context,
                             attention,
                             _queries_scale,
-                            _is_decoder,
-                            bool(cached_keys),
-                            beam_size);
+                            beam_size,
+                            with_cache && _self_attention ? cache_rows : nullptr);
 
       combine_heads(context, _num_heads, queries_padder, beam_size);
       _linear.back()(context, output);
@@ -430,6 +648,37 @@ namespace ctranslate2 {
       }
     }
 
+    void MultiHeadAttention::append_to_cache(const StorageView& queries,
+                                             StorageView& cached_keys,
+                                             StorageView& cached_values) const {
+      PROFILE("MultiHeadAttention::append_to_cache");
+      if (!_self_attention)
+        throw std::logic_error("append_to_cache is only supported by self-attention layers");
+
+      const Device device = queries.device();
+      const DataType dtype = queries.dtype();
+      StorageView fused_proj(dtype, device);
+      StorageView queries_proj(dtype, device);
+      StorageView keys_proj(dtype, device);
+      StorageView values_proj(dtype, device);
+
+      const StorageView* q = &queries;
+      if (_pre_norm) {
+        _layer_norm(queries, queries_proj);
+        q = &queries_proj;
+      }
+
+      _linear[0](*q, fused_proj);
+      split_heads(fused_proj, 3 * _num_heads);
+      ops::Split(1)(fused_proj, queries_proj, keys_proj, values_proj);
+
+      StorageView& tmp = fused_proj;  // Reuse storage.
+      tmp = std::move(cached_keys);
+      ops::Concat(2)({&tmp, &keys_proj}, cached_keys);
+      tmp = std::move(cached_values);
+      ops::Concat(2)({&tmp, &values_proj}, cached_values);
+    }
+
     StorageView MultiHeadAttention::prepare_length_mask(const StorageView& lengths,
                                                         const dim_t num_heads,
                                                         const dim_t num_queries,
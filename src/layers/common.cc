@@ -1,9 +1,11 @@
 #include "ctranslate2/layers/common.h"
 
 #include <cmath>
+#include <limits>
 
 #include "ctranslate2/ops/activation.h"
 #include "cpu/backend.h"
+#include "cpu/parallel.h"
 #include "dispatch.h"
 
 namespace ctranslate2 {
@@ -294,6 +296,10 @@ namespace ctranslate2 {
                      /*shift_to_uint8=*/bool(_u8_shift_compensation),
                      /*round_before_cast=*/model.round_before_cast_in_quantization())
       , _dequantize_op(activation_type)
+      , _round_before_cast(model.round_before_cast_in_quantization())
+      , _approximate_weight(_weight.device(), DataType::INT8)
+      , _approximate_qscale(_weight.device(), DataType::FLOAT32)
+      , _approximate_u8_shift_compensation(_weight.device(), DataType::INT32)
     {
     }
 
@@ -329,6 +335,8 @@ namespace ctranslate2 {
         _partial_qscale.clear();
         _partial_u8_shift_compensation.clear();
       }
+
+      release_two_stage();
     }
 
     void Dense::operator()(const StorageView& input, StorageView& output) const {
@@ -358,6 +366,148 @@ namespace ctranslate2 {
       }
     }
 
+    bool Dense::supports_two_stage() const {
+      const auto device = _weight.device();
+      return (!_quantized_gemm
+              && !_packed_weight
+              && (_weight.dtype() == DataType::FLOAT32
+                  || (device == Device::CUDA && _weight.dtype() == DataType::FLOAT16))
+              && mayiuse_int8(device, _weight.device_index()));
+    }
+
+    void Dense::quantize_approximate_weight() {
+      const StorageView& weight = _partial_weight.empty() ? _weight : _partial_weight;
+      const bool shift_to_uint8 = weight.device() == Device::CPU && cpu::prefer_u8s8s32_gemm();
+
+      const ops::Quantize quantize_op(ops::Quantize::ScaleType::PER_LAYER,
+                                      /*shift_to_uint8=*/false,
+                                      _round_before_cast);
+      quantize_op(weight, _approximate_weight, _approximate_qscale);
+
+      if (shift_to_uint8)
+        _approximate_u8_shift_compensation = ops::Gemm::compensate_u8_input(_approximate_weight,
+                                                                            /*transpose=*/true,
+                                                                            weight.dim(1),
+                                                                            weight.dim(0),
+                                                                            /*alpha=*/1);
+    }
+
+    void Dense::release_two_stage() {
+      _approximate_weight.release();
+      _approximate_qscale.release();
+      _approximate_u8_shift_compensation.release();
+    }
+
+    void Dense::compute_two_stage(const StorageView& input,
+                                  StorageView& output,
+                                  dim_t num_candidates,
+                                  bool exact_only) {
+      PROFILE("Dense::compute_two_stage");
+      if (_approximate_weight.empty())
+        quantize_approximate_weight();
+
+      const StorageView* bias = _partial_bias.empty() ? _bias : &_partial_bias;
+      const StorageView* compensation = (_approximate_u8_shift_compensation.empty()
+                                         ? nullptr
+                                         : &_approximate_u8_shift_compensation);
+      const auto device = input.device();
+      const dim_t depth = input.dim(-1);
+      const dim_t num_rows = input.size() / depth;
+
+      StorageView rows(input.dtype(), device);
+      rows.view(const_cast<void*>(input.buffer()), {num_rows, depth});
+
+      // First stage: approximate outputs with the INT8 weight.
+      const ops::Quantize quantize_op(ops::Quantize::ScaleType::PER_LAYER,
+                                      /*shift_to_uint8=*/bool(compensation),
+                                      _round_before_cast);
+      const ops::Gemm gemm_op(/*alpha=*/1, /*beta=*/0, /*trans_a=*/false, /*trans_b=*/true);
+      StorageView qinput(DataType::INT8, device);
+      StorageView qinput_scale(DataType::FLOAT32, device);
+      StorageView qoutput(DataType::INT32, device);
+      quantize_op(rows, qinput, qinput_scale);
+      gemm_op(qinput, _approximate_weight, qoutput, compensation);
+      ops::Dequantize()(qoutput,
+                        qinput_scale,
+                        _approximate_qscale,
+                        /*trans_a=*/false,
+                        /*trans_b=*/true,
+                        output,
+                        bias);
+
+      // Second stage: exact outputs of the candidates.
+      rescore_candidates(input, output, num_candidates, exact_only);
+    }
+
+    void Dense::rescore_candidates(const StorageView& input,
+                                   StorageView& output,
+                                   dim_t num_candidates,
+                                   bool exact_only) const {
+      PROFILE("Dense::rescore_candidates");
+      const StorageView& weight = _partial_weight.empty() ? _weight : _partial_weight;
+      const StorageView* bias = _partial_bias.empty() ? _bias : &_partial_bias;
+      const auto device = input.device();
+      const dim_t depth = input.dim(-1);
+      const dim_t num_rows = input.size() / depth;
+      const dim_t output_depth = weight.dim(0);
+      num_candidates = std::min(num_candidates, output_depth);
+
+      Shape output_shape = input.shape();
+      output_shape.back() = output_depth;
+      output.reshape({num_rows, output_depth});
+
+      StorageView candidates(output.dtype(), device);
+      StorageView candidate_ids(DataType::INT32, device);
+      const ops::TopK topk_op(num_candidates);
+      topk_op(output, candidates, candidate_ids);
+
+      StorageView candidate_weight(weight.dtype(), device);
+      ops::Gather()(weight, candidate_ids, candidate_weight);  // [rows, candidates, depth]
+
+      StorageView input_3d(input.dtype(), device);
+      input_3d.view(const_cast<void*>(input.buffer()), {num_rows, 1, depth});
+      StorageView exact(input.dtype(), device);
+      ops::MatMul(/*trans_a=*/false, /*trans_b=*/true)(input_3d, candidate_weight, exact);
+      exact.reshape({num_rows, num_candidates});
+
+      if (bias) {
+        StorageView candidate_bias(bias->dtype(), device);
+        ops::Gather()(*bias, candidate_ids, candidate_bias);
+        ops::Add()(exact, candidate_bias, exact);
+      }
+
+      if (exact.dtype() != output.dtype())
+        exact = exact.to(output.dtype());
+
+      // Replace the approximate outputs of the candidates by the exact outputs.
+      StorageView row_offsets({num_rows}, DataType::INT32);
+      for (dim_t i = 0; i < num_rows; ++i)
+        row_offsets.at<int32_t>(i) = i * output_depth;
+      row_offsets = row_offsets.to(device);
+
+      StorageView flat_ids(DataType::INT32, device);
+      flat_ids.resize_as(candidate_ids);
+
+      DEVICE_DISPATCH(device,
+                      primitives<D>::add_depth_broadcast(row_offsets.data<int32_t>(),
+                                                         candidate_ids.data<int32_t>(),
+                                                         flat_ids.data<int32_t>(),
+                                                         row_offsets.size(),
+                                                         candidate_ids.size()));
+
+      if (exact_only) {
+        TYPE_DISPATCH(output.dtype(), output.fill(std::numeric_limits<T>::lowest()));
+      }
+
+      DEVICE_AND_TYPE_DISPATCH(device, output.dtype(),
+                               primitives<D>::indexed_copy(exact.data<T>(),
+                                                           output.data<T>(),
+                                                           flat_ids.data<int32_t>(),
+                                                           flat_ids.size()));
+
+      output.reshape(std::move(output_shape));
+    }
+
 
     LayerNorm::LayerNorm(const models::Model& model, const std::string& scope)
       : _beta(model.get_variable_if_exists(scope + "/beta"))
@@ -384,14 +534,32 @@ namespace ctranslate2 {
                    const std::string& scope,
                    dim_t stride,
                    dim_t padding,
-                   dim_t dilation)
-      : _conv_op(stride, padding, dilation)
+                   dim_t dilation,
+                   const ops::ActivationType* activation_type)
+      : _stride(stride)
+      , _padding(padding)
+      , _conv_op(stride, padding, dilation, activation_type)
       , _weight(model.get_variable(scope + "/weight"))
-      , _bias(model.get_variable_if_exists(scope + "/bias")) {
+      , _bias(model.get_variable_if_exists(scope + "/bias"))
+      , _qscale(model.get_variable_if_exists(scope + "/weight_scale"))
+      , _u8_shift_compensation((_weight.device() == Device::CPU
+                                && _weight.dtype() == DataType::INT8
+                                && cpu::prefer_u8s8s32_gemm())
+                               ? &model.get_variable(scope + "/weight_compensation")
+                               : nullptr)
+      , _output_type(_weight.dtype() == DataType::INT8 ? DataType::FLOAT32 : _weight.dtype())
+      , _gemm_op(/*alpha=*/1, /*beta=*/0, /*trans_a=*/false, /*trans_b=*/true)
+      , _quantize_op(ops::Quantize::ScaleType::PER_LAYER,
+                     /*shift_to_uint8=*/bool(_u8_shift_compensation),
+                     /*round_before_cast=*/model.round_before_cast_in_quantization())
+      , _dequantize_op(activation_type)
+    {
+      if (_weight.dtype() == DataType::INT8 && dilation != 1)
+        throw std::invalid_argument("Conv1D: dilation is not supported with int8 weights");
     }
 
     DataType Conv1D::output_type() const {
-      return _weight.dtype();
+      return _output_type;
     }
 
     dim_t Conv1D::output_size() const {
@@ -403,11 +571,95 @@ namespace ctranslate2 {
     }
 
     void Conv1D::operator()(const StorageView& input, StorageView& output) const {
-      if (_bias)
+      if (_weight.dtype() == DataType::INT8)
+        compute_quantized(input, output);
+      else if (_bias)
         _conv_op(input, _weight, *_bias, output);
       else
         _conv_op(input, _weight, output);
     }
 
+    // Copies the input window of each output position in a row:
+    // windows[b * output_length + t][c * kernel_size + k] = input[b][c][t * stride - padding + k]
+    static void gather_conv1d_windows(const float* input,
+                                      float* windows,
+                                      const dim_t batch_size,
+                                      const dim_t in_channels,
+                                      const dim_t input_length,
+                                      const dim_t output_length,
+                                      const dim_t kernel_size,
+                                      const dim_t stride,
+                                      const dim_t padding) {
+      const dim_t window_size = in_channels * kernel_size;
+
+      cpu::parallel_for(0, batch_size * output_length, 1, [&](dim_t begin, dim_t end) {
+        for (dim_t i = begin; i < end; ++i) {
+          const dim_t b = i / output_length;
+          const dim_t t_out = i % output_length;
+          const dim_t t_in = t_out * stride - padding;
+
+          const float* x = input + b * (in_channels * input_length);
+          float* window = windows + i * window_size;
+
+          for (dim_t c = 0; c < in_channels; ++c) {
+            for (dim_t k = 0; k < kernel_size; ++k) {
+              const dim_t t = t_in + k;
+              window[c * kernel_size + k] = (t >= 0 && t < input_length
+                                             ? x[c * input_length + t]
+                                             : 0.f);
+            }
+          }
+        }
+      });
+    }
+
+    void Conv1D::compute_quantized(const StorageView& input, StorageView& output) const {
+      PROFILE("Conv1D");
+
+      if (input.device() != Device::CPU || input.dtype() != DataType::FLOAT32)
+        throw std::invalid_argument("Conv1D: int8 weights require a float32 input on CPU");
+
+      const dim_t batch_size = input.dim(0);
+      const dim_t in_channels = input.dim(1);
+      const dim_t input_length = input.dim(2);
+      const dim_t out_channels = _weight.dim(0);
+      const dim_t kernel_size = _weight.dim(2);
+      const dim_t window_size = in_channels * kernel_size;
+      const dim_t output_length = (input_length + 2 * _padding - kernel_size) / _stride + 1;
+
+      // The convolution is a GEMM between the input windows and the flattened filters.
+      StorageView windows({batch_size * output_length, window_size}, DataType::FLOAT32);
+      gather_conv1d_windows(input.data<float>(),
+                            windows.data<float>(),
+                            batch_size,
+                            in_channels,
+                            input_length,
+                            output_length,
+                            kernel_size,
+                            _stride,
+                            _padding);
+
+      const StorageView weight({out_channels, window_size},
+                               const_cast<int8_t*>(_weight.data<int8_t>()));
+
+      StorageView qwindows(DataType::INT8);
+      StorageView qwindows_scale(DataType::FLOAT32);
+      StorageView qoutput(DataType::INT32);
+      _quantize_op(windows, qwindows, qwindows_scale);
+      _gemm_op(qwindows, weight, qoutput, _u8_shift_compensation);
+
+      StorageView rows(_output_type);
+      _dequantize_op(qoutput,
+                     qwindows_scale,
+                     *_qscale,
+                     /*trans_a=*/false,
+                     /*trans_b=*/true,
+                     rows,
+                     _bias);
+
+      rows.reshape({batch_size, output_length, out_channels});
+      ops::Transpose({0, 2, 1})(rows, output);
+    }
+
   }
 }
@@ -5,7 +5,9 @@
 
 #include "ctranslate2/decoding_utils.h"
 #include "ctranslate2/ops/ops.h"
+#include "ctranslate2/layers/attention.h"
 #include "dispatch.h"
+#include "env.h"
 
 namespace ctranslate2 {
   namespace layers {
@@ -26,8 +28,14 @@ namespace ctranslate2 {
     }
 
 
+    // When the self-attention caches are reordered lazily, they are compacted once the
+    // timesteps are read from this many ranges of cache rows on average.
+    constexpr dim_t max_cache_ranges_per_row = 16;
+
     Decoder::Decoder(Device device)
-      : _device(device) {
+      : _device(device)
+      , _reorder_caches_lazily(device == Device::CPU
+                               && read_bool_from_env("CT2_LAZY_CACHE_REORDER")) {
     }
 
     void Decoder::update_state(DecoderState& state, const StorageView& alive_batches) const {
@@ -46,7 +54,12 @@ namespace ctranslate2 {
         merge_batch_beam(beam_indices);
       }
 
+      const bool lazy_update = (_reorder_caches_lazily
+                                && update_cache_rows(state, beam_indices, bool(alive_batches)));
+
       for (auto& [name, value] : state) {
+        if (lazy_update && (name == cache_rows_state || is_self_attention_cache(name)))
+          continue;
         if (replicate_state(name))
           ops::Gather()(value, beam_indices);
         else if (alive_batches)
@@ -54,6 +67,71 @@ namespace ctranslate2 {
       }
     }
 
+    // Instead of gathering the self-attention caches after each step, the beam indices are
+    // composed with the cache rows of the previous steps. The caches are compacted when the
+    // batch size changes or when the cache rows are too fragmented. Returns false if the
+    // caches should be gathered.
+    bool Decoder::update_cache_rows(DecoderState& state,
+                                    const StorageView& beam_indices,
+                                    const bool compact) const {
+      const StorageView* cache = nullptr;
+      for (const auto& [name, value] : state) {
+        if (is_self_attention_cache(name)) {
+          cache = &value;
+          break;
+        }
+      }
+
+      if (!cache || cache->empty() || cache->dtype() != DataType::FLOAT32)
+        return false;
+
+      const dim_t num_rows = cache->dim(0);
+      const dim_t time = cache->dim(2);
+      const dim_t batch_size = beam_indices.size();
+      const int32_t* parents = beam_indices.data<int32_t>();
+
+      auto it = state.find(cache_rows_state);
+      const StorageView* prev_rows = it != state.end() ? &it->second : nullptr;
+      const dim_t prev_time = prev_rows ? prev_rows->dim(1) : 0;
+      const int32_t* prev_rows_data = prev_rows ? prev_rows->data<int32_t>() : nullptr;
+
+      StorageView cache_rows({batch_size, time}, DataType::INT32);
+      int32_t* rows = cache_rows.data<int32_t>();
+      dim_t num_ranges = 0;
+
+      for (dim_t b = 0; b < batch_size; ++b) {
+        const int32_t parent = parents[b];
+        for (dim_t t = 0; t < time; ++t) {
+          const int32_t row = t < prev_time ? prev_rows_data[parent * prev_time + t] : parent;
+          if (t == 0 || row != rows[t - 1])
+            ++num_ranges;
+          rows[t] = row;
+        }
+        rows += time;
+      }
+
+      if (compact
+          || batch_size != num_rows
+          || num_ranges > max_cache_ranges_per_row * batch_size) {
+        for (auto& [name, value] : state) {
+          if (is_self_attention_cache(name)) {
+            StorageView compacted(value.dtype(), value.device());
+            gather_cache_rows(value, cache_rows, compacted);
+            value = std::move(compacted);
+          }
+        }
+
+        if (prev_rows)
+          state.erase(it);
+      } else if (prev_rows) {
+        it->second = std::move(cache_rows);
+      } else {
+        state.emplace(cache_rows_state, std::move(cache_rows));
+      }
+
+      return true;
+    }
+
     void Decoder::replicate_state(DecoderState& state, const dim_t beam_size) const {
       for (auto& [name, value] : state) {
         if (value && replicate_state(name))
@@ -69,6 +147,38 @@ namespace ctranslate2 {
       return true;
     }
 
+    bool Decoder::is_self_attention_cache(const std::string&) const {
+      return false;
+    }
+
+    void Decoder::select_output_weights(const StorageView* index,
+                                        const StorageView* extra_bias) {
+      output_layer().select_weights(index, extra_bias);
+    }
+
+    void Decoder::set_early_exit(float threshold, dim_t interval) {
+      _early_exit_threshold = threshold;
+      _early_exit_interval = std::max(interval, dim_t(1));
+      _num_exit_steps = 0;
+      _total_exit_depth = 0;
+    }
+
+    float Decoder::average_exit_depth() const {
+      if (_num_exit_steps == 0)
+        return 0;
+      return float(_total_exit_depth) / float(_num_exit_steps);
+    }
+
+    void Decoder::set_two_stage_output(dim_t num_candidates, bool exact_log_probs) {
+      _two_stage_candidates = num_candidates;
+      _two_stage_exact_log_probs = exact_log_probs;
+    }
+
+    void Decoder::record_exit_depth(dim_t depth) {
+      ++_num_exit_steps;
+      _total_exit_depth += depth;
+    }
+
     void Decoder::update_output_layer(const dim_t size_multiple,
                                       const std::vector<size_t>& restrict_ids) {
       const dim_t current_output_size = output_size();
@@ -92,7 +202,7 @@ namespace ctranslate2 {
 
         // Reset the output layer if the output size is the vocabulary size.
         if (new_output_size == _vocabulary_size && padding_size == 0) {
-          output_layer().select_weights(nullptr);
+          select_output_weights(nullptr, nullptr);
           _to_output_word_id.clear();
           _to_original_word_id.clear();
           return;
@@ -130,7 +240,7 @@ namespace ctranslate2 {
       if (index.device() != _device)
         index = index.to(_device);
 
-      output_layer().select_weights(&index, extra_bias.get());
+      select_output_weights(&index, extra_bias.get());
 
       _to_original_word_id = std::move(ids);
       _to_output_word_id.reserve(_to_original_word_id.size());
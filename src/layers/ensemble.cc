@@ -0,0 +1,291 @@
+#include "ctranslate2/layers/ensemble.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "ctranslate2/ops/ops.h"
+#include "ctranslate2/utils.h"
+
+namespace ctranslate2 {
+  namespace layers {
+
+    static const std::string member_prefix = "member_";
+
+    EnsembleEncoder::EnsembleEncoder(std::vector<std::unique_ptr<Encoder>> members)
+      : _members(std::move(members))
+    {
+      if (_members.empty())
+        throw std::invalid_argument("An ensemble should contain at least one encoder");
+    }
+
+    size_t EnsembleEncoder::num_input_features() const {
+      return _members[0]->num_input_features();
+    }
+
+    DataType EnsembleEncoder::output_type() const {
+      return _members[0]->output_type();
+    }
+
+    dim_t EnsembleEncoder::output_size() const {
+      const auto sizes = output_sizes();
+      return std::accumulate(sizes.begin(), sizes.end(), dim_t(0));
+    }
+
+    std::vector<dim_t> EnsembleEncoder::output_sizes() const {
+      std::vector<dim_t> sizes;
+      sizes.reserve(_members.size());
+      for (const auto& member : _members)
+        sizes.emplace_back(member->output_size());
+      return sizes;
+    }
+
+    void EnsembleEncoder::operator()(const std::vector<StorageView>& ids,
+                                     const StorageView* lengths,
+                                     StorageView& output) {
+      if (!lengths && ids.size() != 1)
+        throw std::invalid_argument("The lengths are required to encode multiple input features "
+                                    "with an ensemble");
+
+      const Device device = ids[0].device();
+      std::vector<StorageView> outputs;
+      outputs.reserve(_members.size());
+
+      for (const auto& member : _members) {
+        outputs.emplace_back(member->output_type(), device);
+        if (lengths)
+          (*member)(ids, *lengths, outputs.back());
+        else
+          (*member)(ids[0], outputs.back());
+      }
+
+      if (outputs.size() == 1) {
+        output = std::move(outputs[0]);
+        return;
+      }
+
+      std::vector<const StorageView*> inputs;
+      inputs.reserve(outputs.size());
+      for (const auto& member_output : outputs)
+        inputs.emplace_back(&member_output);
+      ops::Concat(-1)(inputs, output);
+    }
+
+
+    static std::vector<std::string> make_member_prefixes(size_t num_members) {
+      std::vector<std::string> prefixes;
+      prefixes.reserve(num_members);
+      for (size_t i = 0; i < num_members; ++i)
+        prefixes.emplace_back(member_prefix + std::to_string(i) + "/");
+      return prefixes;
+    }
+
+    static Device get_members_device(const std::vector<std::unique_ptr<Decoder>>& members) {
+      if (members.empty())
+        throw std::invalid_argument("An ensemble should contain at least one decoder");
+      return members[0]->device();
+    }
+
+    EnsembleDecoder::EnsembleDecoder(std::vector<std::unique_ptr<Decoder>> members,
+                                     std::vector<dim_t> memory_sizes)
+      : Decoder(get_members_device(members))
+      , _members(std::move(members))
+      , _memory_sizes(std::move(memory_sizes))
+      , _prefixes(make_member_prefixes(_members.size()))
+    {
+      if (!_memory_sizes.empty() && _memory_sizes.size() != _members.size())
+        throw std::invalid_argument("The ensemble has "
+                                    + std::to_string(_members.size())
+                                    + " decoders but "
+                                    + std::to_string(_memory_sizes.size())
+                                    + " memory sizes are set");
+
+      for (const auto& member : _members) {
+        if (member->output_size() != _members[0]->output_size())
+          throw std::invalid_argument("The decoders of an ensemble should have the same "
+                                      "output size, but got "
+                                      + std::to_string(member->output_size())
+                                      + " and "
+                                      + std::to_string(_members[0]->output_size()));
+      }
+    }
+
+    DecoderState EnsembleDecoder::initial_state(bool iterative_decoding) const {
+      DecoderState state;
+      for (size_t i = 0; i < _members.size(); ++i) {
+        for (auto& [name, value] : _members[i]->initial_state(iterative_decoding))
+          state.emplace(_prefixes[i] + name, std::move(value));
+      }
+      return state;
+    }
+
+    void EnsembleDecoder::operator()(dim_t step,
+                                     const StorageView& ids,
+                                     DecoderState& state,
+                                     StorageView* logits,
+                                     StorageView* attention) {
+      forward_members(state, logits, [&](size_t i,
+                                         DecoderState& member_state,
+                                         StorageView* member_logits) {
+        // The attention is only returned by the first member.
+        (*_members[i])(step, ids, member_state, member_logits, i == 0 ? attention : nullptr);
+      });
+    }
+
+    void EnsembleDecoder::operator()(const StorageView& ids,
+                                     const StorageView& lengths,
+                                     DecoderState& state,
+                                     StorageView& logits) {
+      forward_members(state, &logits, [&](size_t i,
+                                           DecoderState& member_state,
+                                           StorageView* member_logits) {
+        (*_members[i])(ids, lengths, member_state, *member_logits);
+      });
+    }
+
+    template <typename Func>
+    void EnsembleDecoder::forward_members(DecoderState& state,
+                                          StorageView* logits,
+                                          const Func& func) {
+      const size_t num_members = _members.size();
+
+      // Each member receives its own memory since the decoders can update it in place
+      // (e.g. to remove the padding positions).
+      std::vector<StorageView> memories;
+      auto memory_it = state.find("memory");
+      if (memory_it != state.end()) {
+        const StorageView& memory = memory_it->second;
+        memories.reserve(num_members);
+
+        if (_memory_sizes.empty()) {
+          for (size_t i = 0; i < num_members; ++i)
+            memories.emplace_back(memory);
+        } else {
+          memories.resize(num_members);
+          std::vector<StorageView*> outputs;
+          outputs.reserve(num_members);
+          for (auto& member_memory : memories)
+            outputs.emplace_back(&member_memory);
+          ops::Split(-1, _memory_sizes)(memory, outputs);
+        }
+      }
+
+      bool memory_is_released = !memories.empty();
+      std::vector<std::string> shared_names;
+
+      for (size_t i = 0; i < num_members; ++i) {
+        const std::string& prefix = _prefixes[i];
+
+        // Move the entries of this member and the shared entries to the member state.
+        DecoderState member_state;
+        shared_names.clear();
+
+        for (auto it = state.begin(); it != state.end();) {
+          const std::string& name = it->first;
+
+          if (starts_with(name, prefix)) {
+            member_state.emplace(name.substr(prefix.size()), std::move(it->second));
+          } else if (name != "memory" && !starts_with(name, member_prefix)) {
+            member_state.emplace(name, std::move(it->second));
+            shared_names.emplace_back(name);
+          } else {
+            ++it;
+            continue;
+          }
+
+          it = state.erase(it);
+        }
+
+        if (!memories.empty())
+          member_state.emplace("memory", std::move(memories[i]));
+
+        StorageView member_logits(output_type(), _device);
+        func(i, member_state, logits ? &member_logits : nullptr);
+
+        for (auto& [name, value] : member_state) {
+          if (name == "memory") {
+            memory_is_released = false;
+            continue;
+          }
+
+          const bool is_shared = (std::find(shared_names.begin(), shared_names.end(), name)
+                                  != shared_names.end());
+          state.emplace(is_shared ? name : prefix + name, std::move(value));
+        }
+
+        if (logits) {
+          ops::LogSoftMax()(member_logits);
+          if (i == 0)
+            *logits = std::move(member_logits);
+          else
+            ops::Add()(*logits, member_logits, *logits);
+        }
+      }
+
+      // The members no longer need the memory after the first step.
+      if (memory_is_released)
+        state.erase("memory");
+
+      if (logits && num_members > 1) {
+        StorageView scale(1.f / static_cast<float>(num_members));
+        if (logits->dtype() != DataType::FLOAT32)
+          scale = scale.to(logits->dtype());
+        ops::Mul()(*logits, scale, *logits);
+      }
+    }
+
+    std::pair<const Decoder*, std::string>
+    EnsembleDecoder::resolve_state(const std::string& name) const {
+      if (starts_with(name, member_prefix)) {
+        const size_t separator = name.find('/');
+        if (separator != std::string::npos) {
+          const size_t index = std::stoul(name.substr(member_prefix.size(),
+                                                      separator - member_prefix.size()));
+          if (index < _members.size())
+            return std::make_pair(_members[index].get(), name.substr(separator + 1));
+        }
+      }
+
+      return std::make_pair(nullptr, name);
+    }
+
+    bool EnsembleDecoder::replicate_state(const std::string& name) const {
+      const auto [member, member_name] = resolve_state(name);
+      return (member ? member : _members[0].get())->replicate_state(member_name);
+    }
+
+    bool EnsembleDecoder::is_self_attention_cache(const std::string& name) const {
+      const auto [member, member_name] = resolve_state(name);
+      return member && member->is_self_attention_cache(member_name);
+    }
+
+    void EnsembleDecoder::set_early_exit(float threshold, dim_t interval) {
+      Decoder::set_early_exit(threshold, interval);
+      for (const auto& member : _members)
+        member->set_early_exit(threshold, interval);
+    }
+
+    float EnsembleDecoder::average_exit_depth() const {
+      float depth = 0;
+      for (const auto& member : _members)
+        depth += member->average_exit_depth();
+      return depth / static_cast<float>(_members.size());
+    }
+
+    void EnsembleDecoder::set_two_stage_output(dim_t num_candidates, bool exact_log_probs) {
+      Decoder::set_two_stage_output(num_candidates, exact_log_probs);
+      for (const auto& member : _members)
+        member->set_two_stage_output(num_candidates, exact_log_probs);
+    }
+
+    Dense& EnsembleDecoder::output_layer() {
+      return _members[0]->output_layer();
+    }
+
+    void EnsembleDecoder::select_output_weights(const StorageView* index,
+                                                const StorageView* extra_bias) {
+      for (const auto& member : _members)
+        member->select_output_weights(index, extra_bias);
+    }
+
+  }
+}
@@ -100,7 +100,8 @@ namespace ctranslate2 {
                                              StorageView& output,
                                              StorageView* attention,
                                              const Padder* input_padder,
-                                             const Padder* memory_padder) const {
+                                             const Padder* memory_padder,
+                                             const StorageView* cache_rows) const {
       PROFILE("TransformerDecoderLayer");
       _self_attention(input,
                       input,
@@ -110,7 +111,8 @@ namespace ctranslate2 {
                       cached_self_attn_values,
                       nullptr,
                       input_padder,
-                      input_padder);
+                      input_padder,
+                      cache_rows);
 
       StorageView context(input.dtype(), input.device());
       if (_encoder_attention) {
@@ -252,7 +254,8 @@ namespace ctranslate2 {
       , _with_encoder_attention(_layers.front()->has_cross_attention())
       , _alignment_layer(model.get_attribute_with_default<int32_t>(scope + "/alignment_layer", -1))
       , _alignment_heads(model.get_attribute_with_default<int32_t>(scope + "/alignment_heads", 1))
-      , _proj(model, scope + "/projection") {
+      , _proj(model, scope + "/projection")
+      , _memory_planner(make_memory_planner(model.device())) {
       if (_alignment_layer < 0)
         _alignment_layer = _layers.size() + _alignment_layer;
       if (_alignment_heads == 0)
@@ -287,6 +290,10 @@ namespace ctranslate2 {
       return !_with_encoder_attention || !starts_with(name, "memory");
     }
 
+    bool TransformerDecoder::is_self_attention_cache(const std::string& name) const {
+      return starts_with(name, "self_keys_") || starts_with(name, "self_values_");
+    }
+
     void TransformerDecoder::operator()(dim_t step,
                                         const StorageView& ids,
                                         DecoderState& state,
@@ -309,9 +316,10 @@ namespace ctranslate2 {
       new_layer.copy_from(layer);
 
       if (layers) {
-        //concatnate along the 2 axis [batches, heads, layers, frames] i.e. layers 
+        // Concatenate along the heads axis [batch, heads, time, frames], since the number
+        // of heads can differ between layers of a pruned model.
         const StorageView cur_layers(std::move(layers));
-        ops::Concat(2)({&cur_layers, &new_layer}, layers);
+        ops::Concat(1)({&cur_layers, &new_layer}, layers);
       } else {
         layers = std::move(new_layer);
       }
@@ -328,6 +336,25 @@ namespace ctranslate2 {
       const Device device = ids.device();
       const bool is_sequence = ids.rank() > 1;
 
+      // The early exit requires the cross-attention caches that are filled in the first step.
+      const bool early_exit = (_early_exit_threshold > 0
+                               && !is_sequence
+                               && step > 0
+                               && outputs
+                               && return_logits
+                               && !attention);
+
+      // The temporary buffers of the incremental decoding steps are served from a planned
+      // arena. The allocations only depend on the batch size and the requested outputs.
+      // With early exit they also depend on the exit layer, so the arena is not used.
+      std::unique_ptr<ScopedMemoryPlan> memory_plan;
+      if (!is_sequence && step > 0 && use_memory_planner() && !early_exit) {
+        const size_t shape_class = (static_cast<size_t>(ids.dim(0)) << 2
+                                    | (outputs ? 2 : 0)
+                                    | (attention ? 1 : 0));
+        memory_plan = std::make_unique<ScopedMemoryPlan>(*_memory_planner, shape_class);
+      }
+
       StorageView layer_in(output_type(), device);
       StorageView layer_out(output_type(), device);
 
@@ -402,8 +429,18 @@ namespace ctranslate2 {
       }
 
 
+      const StorageView* cache_rows = nullptr;
+      if (step > 0) {
+        const auto it = state.find(cache_rows_state);
+        if (it != state.end())
+          cache_rows = &it->second;
+      }
+
       //set up the attention layers
       StorageView attention_layers;
+      StorageView exit_logits(output_type(), device);
+      size_t exit_depth = _layers.size();
+
       for (size_t l = 0; l < _layers.size(); ++l) {
         StorageView* cached_self_attn_keys = nullptr;
         StorageView* cached_self_attn_values = nullptr;
@@ -431,14 +468,37 @@ namespace ctranslate2 {
                       layer_out,
                       l >= (_layers.size() - 6) ? attention : nullptr,
                       input_padder.get(),
-                      memory_padder.get());
+                      memory_padder.get(),
+                      cache_rows);
         layer_in = std::move(layer_out);
 
         if(attention && l >= (_layers.size() - 6)){
           append_attention_layer(attention_layers, *attention);
         }
+
+        const size_t depth = l + 1;
+        if (early_exit && depth < _layers.size() && depth % _early_exit_interval == 0) {
+          compute_logits(layer_in, exit_logits);
+
+          if (is_confident(exit_logits)) {
+            // The next steps attend to the skipped layers, so their cache is filled with
+            // the hidden state of the exit layer.
+            for (size_t s = depth; s < _layers.size(); ++s) {
+              const std::string s_str = std::to_string(s);
+              _layers[s]->propagate_state(layer_in,
+                                          state.at("self_keys_" + s_str),
+                                          state.at("self_values_" + s_str));
+            }
+
+            exit_depth = depth;
+            break;
+          }
+        }
       }
 
+      if (early_exit)
+        record_exit_depth(exit_depth);
+
       if (step == 0) {
         // The memory is no longer needed as its projections were cached in the first step.
         state.erase("memory");
@@ -449,12 +509,19 @@ namespace ctranslate2 {
       //   if (!is_sequence)
       //     attention->squeeze(1);
       // }
+      // The outputs outlive the step so they are not allocated from the memory plan.
+      const ScopedDeviceAllocation device_allocation;
+
       if(attention_layers && attention){
         dim_t reduced_alignment_heads = attention_layers.dim(1) * attention_layers.dim(2);
         *attention = reduce_multi_head_attention(attention_layers.reshape({attention_layers.dim(0), reduced_alignment_heads, attention_layers.dim(3)}), reduced_alignment_heads);
       }
 
-      if (outputs) {
+      if (outputs && exit_depth < _layers.size()) {
+        *outputs = std::move(exit_logits);
+        outputs->squeeze(1);
+
+      } else if (outputs) {
         if (_output_norm)
           (*_output_norm)(layer_in, layer_in);
         if (_project_out) {
@@ -465,8 +532,15 @@ namespace ctranslate2 {
         if (_outputs_scale)
           ops::Mul()(layer_in, *_outputs_scale, layer_in);
 
-        if (return_logits)
+        if (return_logits && use_two_stage_output(step, is_sequence))
+          _proj.compute_two_stage(layer_in,
+                                  *outputs,
+                                  _two_stage_candidates,
+                                  _two_stage_exact_log_probs);
+        else if (return_logits)
           _proj(layer_in, *outputs);
+        else if (memory_plan)
+          *outputs = layer_in;  // Copy the hidden states out of the memory plan.
         else
           *outputs = std::move(layer_in);
 
@@ -477,5 +551,55 @@ namespace ctranslate2 {
       }
     }
 
+
+    void TransformerDecoder::compute_logits(const StorageView& hidden, StorageView& logits) {
+      StorageView tmp(hidden.dtype(), hidden.device());
+      StorageView projected(hidden.dtype(), hidden.device());
+      const StorageView* x = &hidden;
+
+      if (_output_norm) {
+        (*_output_norm)(*x, tmp);
+        x = &tmp;
+      }
+      if (_project_out) {
+        (*_project_out)(*x, projected);
+        x = &projected;
+      }
+      if (_outputs_scale) {
+        ops::Mul()(*x, *_outputs_scale, tmp);
+        x = &tmp;
+      }
+
+      _proj(*x, logits);
+    }
+
+    bool TransformerDecoder::use_two_stage_output(dim_t step, bool is_sequence) const {
+      return (_two_stage_candidates > 0
+              && step >= 0
+              && !is_sequence
+              && _two_stage_candidates < _proj.output_size()
+              && _proj.supports_two_stage());
+    }
+
+    bool TransformerDecoder::is_confident(const StorageView& logits) const {
+      const Device device = logits.device();
+      StorageView probs(logits.dtype(), device);
+      StorageView max_probs(logits.dtype(), device);
+      StorageView max_ids(DataType::INT32, device);
+
+      ops::SoftMax()(logits, probs);
+      ops::TopK(1)(probs, max_probs, max_ids);
+
+      if (max_probs.dtype() != DataType::FLOAT32)
+        max_probs = max_probs.to_float32();
+
+      for (const float prob : max_probs.to_vector<float>()) {
+        if (prob < _early_exit_threshold)
+          return false;
+      }
+
+      return true;
+    }
+
   }
 }
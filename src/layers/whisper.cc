@@ -4,8 +4,19 @@ namespace ctranslate2 {
   namespace layers {
 
     WhisperEncoder::WhisperEncoder(const models::Model& model, const std::string& scope)
-      : _conv1(model, scope + "/conv1", /*stride=*/1, /*padding=*/1)
-      , _conv2(model, scope + "/conv2", /*stride=*/2, /*padding=*/1)
+      : _conv_activation_type(ops::ActivationType::GELU)
+      , _conv1(model,
+               scope + "/conv1",
+               /*stride=*/1,
+               /*padding=*/1,
+               /*dilation=*/1,
+               &_conv_activation_type)
+      , _conv2(model,
+               scope + "/conv2",
+               /*stride=*/2,
+               /*padding=*/1,
+               /*dilation=*/1,
+               &_conv_activation_type)
       , _transpose({0, 2, 1})
       , _position_embedding(model, scope + "/position_encodings")
       , _num_heads(model.get_attribute_with_default<int32_t>(scope + "/num_heads", 8))
@@ -21,8 +32,8 @@ namespace ctranslate2 {
     void WhisperEncoder::operator()(const StorageView& features, StorageView& output) {
       PROFILE("WhisperEncoder");
 
-      const dim_t expected_depth = _conv1.input_size();
-      const dim_t expected_time = _position_embedding.num_positions() * 2;
+      const dim_t expected_depth = input_size();
+      const dim_t expected_time = input_time();
 
       if (features.rank() != 3)
         throw std::invalid_argument("Expected input features to have 3 dimensions, but got "
@@ -46,10 +57,7 @@ namespace ctranslate2 {
       StorageView input(output_type(), features.device());
 
       _conv1(features, input);
-      _gelu(input, input);
-
       _conv2(input, output);
-      _gelu(output, output);
 
       _transpose(output, input);
       _position_embedding(input);
@@ -0,0 +1,247 @@
+#include "ctranslate2/memory_estimator.h"
+
+#include <algorithm>
+
+#include "ctranslate2/models/ensemble.h"
+
+namespace ctranslate2 {
+
+  struct AttentionDims {
+    dim_t num_heads = 0;
+    dim_t kv_size = 0;  // Size of the keys (or values) of a position.
+  };
+
+  struct LayerDims {
+    AttentionDims self_attention;
+    AttentionDims cross_attention;  // num_heads is 0 if the layer has no cross attention.
+    dim_t ffn_size = 0;
+  };
+
+  struct StackDims {
+    dim_t d_model = 0;
+    std::vector<LayerDims> layers;
+  };
+
+  static dim_t get_dim_if_exists(const models::Model& model,
+                                 const std::string& name,
+                                 const dim_t axis) {
+    const StorageView* variable = model.get_variable_if_exists(name);
+    return variable && variable->rank() > axis ? variable->dim(axis) : 0;
+  }
+
+  static AttentionDims get_attention_dims(const models::Model& model,
+                                          const std::string& scope,
+                                          const dim_t d_model,
+                                          const dim_t num_heads) {
+    AttentionDims dims;
+    dims.num_heads = model.get_attribute_with_default<int32_t>(scope + "/num_heads", num_heads);
+    dims.kv_size = d_model / num_heads * dims.num_heads;
+    return dims;
+  }
+
+  // The dimensions are read from the layer norms and biases which keep their shape when
+  // the linear weights are packed.
+  static StackDims get_stack_dims(const models::Model& model, const std::string& scope) {
+    StackDims dims;
+    dims.d_model = get_dim_if_exists(model, scope + "/layer_0/self_attention/layer_norm/gamma", 0);
+    if (dims.d_model == 0)
+      return dims;
+
+    // Same fallbacks as the layers, with the number of heads of older specifications.
+    dim_t num_heads = model.get_attribute_with_default<int32_t>(scope + "/num_heads", 0);
+    if (num_heads == 0)
+      num_heads = model.get_attribute_with_default<int32_t>("num_heads", 0);
+    if (num_heads == 0)
+      num_heads = model.default_num_heads();
+    if (num_heads == 0)
+      num_heads = 8;
+
+    for (size_t i = 0;; ++i) {
+      const std::string layer_scope = scope + "/layer_" + std::to_string(i);
+      if (!model.layer_exists(layer_scope))
+        break;
+
+      LayerDims layer;
+      layer.self_attention = get_attention_dims(model,
+                                                layer_scope + "/self_attention",
+                                                dims.d_model,
+                                                num_heads);
+      if (model.layer_exists(layer_scope + "/attention"))
+        layer.cross_attention = get_attention_dims(model,
+                                                   layer_scope + "/attention",
+                                                   dims.d_model,
+                                                   num_heads);
+
+      layer.ffn_size = get_dim_if_exists(model, layer_scope + "/ffn/linear_0/weight", 0);
+      if (layer.ffn_size == 0)
+        layer.ffn_size = get_dim_if_exists(model, layer_scope + "/ffn/linear_0/bias", 0);
+      if (layer.ffn_size == 0)
+        layer.ffn_size = 4 * dims.d_model;
+
+      dims.layers.emplace_back(layer);
+    }
+
+    return dims;
+  }
+
+  // Peak number of activations in a layer running num_sequences * length queries over
+  // key_length positions and memory_length encoder positions.
+  static dim_t get_layer_activations(const StackDims& stack,
+                                     const LayerDims& layer,
+                                     const dim_t num_sequences,
+                                     const dim_t length,
+                                     const dim_t key_length,
+                                     const dim_t memory_length) {
+    const dim_t num_tokens = num_sequences * length;
+
+    // Fused projections, context, and attention scores before and after the softmax.
+    const auto attention = [&](const AttentionDims& dims, const dim_t keys) {
+      return (num_tokens * 4 * dims.kv_size
+              + 2 * num_sequences * dims.num_heads * length * keys);
+    };
+
+    dim_t peak = std::max(attention(layer.self_attention, key_length),
+                          num_tokens * layer.ffn_size);
+    if (layer.cross_attention.num_heads > 0)
+      peak = std::max(peak, attention(layer.cross_attention, memory_length));
+
+    // The layer input and output are alive during the whole layer.
+    return 2 * num_tokens * stack.d_model + peak;
+  }
+
+  static MemoryEstimate estimate_member_memory(const models::Model& model,
+                                               const dim_t batch_size,
+                                               const dim_t beam_size,
+                                               const dim_t input_length,
+                                               const dim_t max_length,
+                                               const dim_t two_stage_candidates) {
+    const StackDims encoder = get_stack_dims(model, "encoder");
+    const StackDims decoder = get_stack_dims(model, "decoder");
+    const bool is_encoder_decoder = !encoder.layers.empty();
+
+    const dim_t num_hypotheses = batch_size * beam_size;
+    const dim_t memory_length = is_encoder_decoder ? input_length : 0;
+    const dim_t prompt_length = is_encoder_decoder ? 0 : input_length;
+    const dim_t decoder_length = prompt_length + max_length;
+
+    dim_t cache_size = 0;
+    dim_t largest_layer_cache_size = 0;
+    for (const auto& layer : decoder.layers) {
+      const dim_t layer_cache_size = 2 * num_hypotheses * (
+        decoder_length * layer.self_attention.kv_size
+        + memory_length * layer.cross_attention.kv_size);
+      cache_size += layer_cache_size;
+      largest_layer_cache_size = std::max(largest_layer_cache_size, layer_cache_size);
+    }
+
+    // Beam search gathers the cache of each layer into a new buffer.
+    if (beam_size > 1)
+      cache_size += largest_layer_cache_size;
+
+    dim_t activations = 0;
+    for (const auto& layer : encoder.layers)
+      activations = std::max(activations, get_layer_activations(encoder,
+                                                                layer,
+                                                                batch_size,
+                                                                input_length,
+                                                                input_length,
+                                                                0));
+
+    dim_t decoder_activations = 0;
+    for (const auto& layer : decoder.layers) {
+      if (prompt_length > 0)
+        decoder_activations = std::max(decoder_activations,
+                                       get_layer_activations(decoder,
+                                                             layer,
+                                                             num_hypotheses,
+                                                             prompt_length,
+                                                             prompt_length,
+                                                             memory_length));
+
+      decoder_activations = std::max(decoder_activations,
+                                     get_layer_activations(decoder,
+                                                           layer,
+                                                           num_hypotheses,
+                                                           1,
+                                                           decoder_length,
+                                                           memory_length));
+    }
+
+    // Logits, log probabilities, and candidates of each hypothesis.
+    dim_t vocabulary_size = get_dim_if_exists(model, "decoder/embeddings/weight", 0);
+    if (vocabulary_size == 0)
+      vocabulary_size = get_dim_if_exists(model, "decoder/projection/bias", 0);
+    decoder_activations = std::max(decoder_activations,
+                                   num_hypotheses * (decoder.d_model + 3 * vocabulary_size));
+
+    // The two-stage output quantizes a copy of a float projection that is not packed (see
+    // Dense::supports_two_stage). A step also keeps the INT32 approximate logits and the
+    // projection rows of the candidates.
+    dim_t approximate_weight_size = 0;
+    const StorageView* projection = model.get_variable_if_exists("decoder/projection/weight");
+    if (two_stage_candidates > 0
+        && projection
+        && projection->rank() == 2
+        && (projection->dtype() == DataType::FLOAT32 || projection->dtype() == DataType::FLOAT16)
+        && !model.get_variable_if_exists("decoder/projection/weight_packed")) {
+      const dim_t output_size = projection->dim(0);
+      const dim_t num_candidates = std::min(two_stage_candidates, output_size);
+      // INT8 weight, with a float scale and an INT32 compensation per output.
+      approximate_weight_size = projection->size() + output_size * 8;
+      decoder_activations = std::max(decoder_activations,
+                                     num_hypotheses * (decoder.d_model
+                                                       + 4 * vocabulary_size
+                                                       + num_candidates * decoder.d_model));
+    }
+
+    // The encoder output is repeated for each hypothesis until it is projected in the
+    // first decoding step.
+    const dim_t memory_size = num_hypotheses * memory_length * encoder.d_model;
+    activations = std::max(activations, memory_size + decoder_activations);
+
+    const DataType float_type = get_default_float_type(model.effective_compute_type());
+    const size_t item_size = float_type == DataType::FLOAT16 ? 2 : 4;
+
+    MemoryEstimate estimate;
+    estimate.cache_bytes = cache_size * item_size;
+    estimate.activation_bytes = activations * item_size;
+    estimate.weight_bytes = approximate_weight_size;
+    return estimate;
+  }
+
+  MemoryEstimate estimate_decoding_memory(const models::Model& model,
+                                          dim_t batch_size,
+                                          dim_t beam_size,
+                                          dim_t input_length,
+                                          dim_t max_length,
+                                          dim_t two_stage_candidates) {
+    batch_size = std::max(batch_size, dim_t(1));
+    beam_size = std::max(beam_size, dim_t(1));
+    input_length = std::max(input_length, dim_t(1));
+    max_length = std::max(max_length, dim_t(1));
+
+    const auto* ensemble = dynamic_cast<const models::EnsembleModel*>(&model);
+    if (!ensemble)
+      return estimate_member_memory(model,
+                                    batch_size,
+                                    beam_size,
+                                    input_length,
+                                    max_length,
+                                    two_stage_candidates);
+
+    MemoryEstimate estimate;
+    for (const auto& member : ensemble->members()) {
+      const auto member_estimate = estimate_member_memory(*member,
+                                                          batch_size,
+                                                          beam_size,
+                                                          input_length,
+                                                          max_length,
+                                                          two_stage_candidates);
+      estimate.cache_bytes += member_estimate.cache_bytes;
+      estimate.activation_bytes += member_estimate.activation_bytes;
+      estimate.weight_bytes += member_estimate.weight_bytes;
+    }
+    return estimate;
+  }
+
+}
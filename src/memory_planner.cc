@@ -0,0 +1,360 @@
+#include "ctranslate2/memory_planner.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "device_dispatch.h"
+#include "env.h"
+
+namespace ctranslate2 {
+
+  static thread_local MemoryPlanner* thread_memory_planner = nullptr;
+  static thread_local size_t thread_device_allocation_depth = 0;
+
+  constexpr size_t arena_alignment = 64;
+  constexpr size_t no_free_time = std::numeric_limits<size_t>::max();
+
+  static size_t align_size(size_t size) {
+    return (size + arena_alignment - 1) / arena_alignment * arena_alignment;
+  }
+
+  static Allocator& get_device_allocator(Device device) {
+    // The arena is reused by all steps, so it is worth backing it with huge pages.
+    if (device == Device::CPU && use_huge_pages())
+      return get_huge_page_allocator();
+
+    Allocator* allocator = nullptr;
+    DEVICE_DISPATCH(device, allocator = &get_allocator<D>());
+    return *allocator;
+  }
+
+  MemoryPlanner::MemoryPlanner(Device device)
+    : _device(device)
+    , _allocator(get_device_allocator(device))
+  {
+  }
+
+  MemoryPlanner::~MemoryPlanner() {
+    if (_arena)
+      _allocator.free(_arena, _arena_device_index);
+  }
+
+  bool MemoryPlanner::release() {
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _released = true;
+    return _num_live_buffers == 0;
+  }
+
+  void MemoryPlannerDeleter::operator()(MemoryPlanner* planner) const {
+    if (planner->release())
+      delete planner;
+  }
+
+  MemoryPlannerPtr make_memory_planner(Device device) {
+    return MemoryPlannerPtr(new MemoryPlanner(device));
+  }
+
+  void MemoryPlanner::begin_step(size_t shape_class) {
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (_mode != Mode::Idle)
+      throw std::runtime_error("MemoryPlanner: a step is already running");
+
+    _time = 0;
+    _next_block = 0;
+    _plan = &_plans[shape_class];
+
+    // The arena offsets are not valid while buffers of a previous step are still live.
+    if (_num_live_arena_buffers > 0) {
+      _mode = Mode::Direct;
+    } else if (_plan->blocks.empty() || _plan->stale) {
+      _mode = Mode::Record;
+      _records.clear();
+      _recorded_ptrs.clear();
+    } else {
+      _mode = Mode::Replay;
+      _arena_plan = _plan;
+    }
+  }
+
+  void MemoryPlanner::end_step() {
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (_mode == Mode::Record) {
+      *_plan = build_plan(_plan->blocks.empty() ? nullptr : _plan);
+      _records.clear();
+      _recorded_ptrs.clear();
+
+      // Size the replay tables for all plans.
+      if (_block_states.size() < _plan->blocks.size())
+        _block_states.resize(_plan->blocks.size(), BlockState::Free);
+      if (_slot_blocks.size() < _plan->slot_offsets.size())
+        _slot_blocks.resize(_plan->slot_offsets.size());
+    } else if (_mode == Mode::Replay) {
+      if (_next_block != _plan->blocks.size())
+        _plan->stale = true;
+    }
+
+    _mode = Mode::Idle;
+    _plan = nullptr;
+  }
+
+  void* MemoryPlanner::allocate(size_t size, int device_index) {
+    const std::lock_guard<std::mutex> lock(_mutex);
+    ++_num_live_buffers;
+
+    if (_mode == Mode::Record) {
+      void* ptr = _allocator.allocate(size, device_index);
+      _recorded_ptrs.emplace(ptr, _records.size());
+      _records.push_back({size, _time++, no_free_time});
+      return ptr;
+    }
+
+    if (_mode == Mode::Replay) {
+      const size_t index = _next_block++;
+
+      if (index >= _plan->blocks.size()) {
+        _plan->stale = true;
+      } else {
+        // The arena memory of a buffer that was not released as planned may overlap
+        // the next blocks.
+        for (size_t i = _plan->due_offsets[index]; i < _plan->due_offsets[index + 1]; ++i) {
+          BlockState& state = _block_states[_plan->due_blocks[i]];
+          if (state == BlockState::Live) {
+            state = BlockState::Overdue;
+            ++_num_overdue_blocks;
+          }
+        }
+
+        const Block& block = _plan->blocks[index];
+
+        if (block.in_arena) {
+          if (size < block.size || size > block.capacity || _num_overdue_blocks > 0) {
+            _plan->stale = true;
+          } else if (_arena_size >= _plan->arena_size
+                     || reserve_arena(_plan->arena_size, device_index)) {
+            _block_states[index] = BlockState::Live;
+            _slot_blocks[block.slot] = index;
+            ++_num_live_arena_buffers;
+            ++_num_planned_allocations;
+            return static_cast<char*>(_arena) + block.offset;
+          }
+        }
+      }
+    }
+
+    return _allocator.allocate(size, device_index);
+  }
+
+  void MemoryPlanner::free(void* ptr, int device_index) {
+    bool delete_planner = false;
+
+    {
+      const std::lock_guard<std::mutex> lock(_mutex);
+
+      if (_mode == Mode::Record) {
+        auto it = _recorded_ptrs.find(ptr);
+        if (it != _recorded_ptrs.end()) {
+          _records[it->second].free_time = _time++;
+          _recorded_ptrs.erase(it);
+        }
+      }
+
+      const char* arena = static_cast<const char*>(_arena);
+      const char* address = static_cast<const char*>(ptr);
+
+      if (arena && address >= arena && address < arena + _arena_size) {
+        const auto& slot_offsets = _arena_plan->slot_offsets;
+        const size_t slot = std::lower_bound(slot_offsets.begin(),
+                                             slot_offsets.end(),
+                                             size_t(address - arena)) - slot_offsets.begin();
+        BlockState& state = _block_states[_slot_blocks[slot]];
+        if (state == BlockState::Overdue)
+          --_num_overdue_blocks;
+        state = BlockState::Free;
+        --_num_live_arena_buffers;
+      } else {
+        _allocator.free(ptr, device_index);
+      }
+
+      --_num_live_buffers;
+      delete_planner = _released && _num_live_buffers == 0;
+    }
+
+    // The owner released the planner before this buffer was freed.
+    if (delete_planner)
+      delete this;
+  }
+
+  void MemoryPlanner::clear_cache() {
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (_arena && _num_live_arena_buffers == 0) {
+      _allocator.free(_arena, _arena_device_index);
+      _arena = nullptr;
+      _arena_size = 0;
+    }
+
+    _allocator.clear_cache();
+  }
+
+  bool MemoryPlanner::reserve_arena(size_t size, int device_index) {
+    // The arena can only be reallocated when no buffers are using it.
+    if (_num_live_arena_buffers > 0)
+      return false;
+
+    if (_arena)
+      _allocator.free(_arena, _arena_device_index);
+
+    _arena = _allocator.allocate(size, device_index);
+    _arena_size = size;
+    _arena_device_index = device_index;
+    return true;
+  }
+
+  MemoryPlanner::Plan MemoryPlanner::build_plan(const Plan* previous_plan) const {
+    Plan plan;
+    plan.blocks.resize(_records.size());
+
+    std::vector<size_t> arena_blocks;
+    arena_blocks.reserve(_records.size());
+
+    for (size_t i = 0; i < _records.size(); ++i) {
+      const Record& record = _records[i];
+      Block& block = plan.blocks[i];
+      block.size = record.size;
+
+      // Buffers that are still used after the step can not be served from the arena.
+      if (record.free_time == no_free_time)
+        continue;
+
+      size_t capacity = record.size;
+
+      if (previous_plan && i < previous_plan->blocks.size()) {
+        const Block& previous_block = previous_plan->blocks[i];
+
+        // Reserve more memory for buffers that grow from one step to the next,
+        // e.g. the attention weights which depend on the decoding length.
+        if (previous_block.in_arena) {
+          if (record.size > previous_block.size)
+            capacity = record.size * 2;
+          capacity = std::max(capacity, previous_block.capacity);
+        }
+      }
+
+      block.capacity = align_size(capacity);
+      block.in_arena = true;
+      arena_blocks.emplace_back(i);
+    }
+
+    // Assign offsets to the largest buffers first.
+    std::stable_sort(arena_blocks.begin(), arena_blocks.end(),
+                     [&plan](size_t a, size_t b) {
+                       return plan.blocks[a].capacity > plan.blocks[b].capacity;
+                     });
+
+    std::vector<size_t> placed_blocks;
+    placed_blocks.reserve(arena_blocks.size());
+    std::vector<std::pair<size_t, size_t>> used_ranges;
+
+    for (const size_t index : arena_blocks) {
+      Block& block = plan.blocks[index];
+      const Record& record = _records[index];
+
+      used_ranges.clear();
+      for (const size_t other_index : placed_blocks) {
+        const Record& other_record = _records[other_index];
+        const bool live_at_same_time = (record.alloc_time < other_record.free_time
+                                        && other_record.alloc_time < record.free_time);
+        if (live_at_same_time) {
+          const Block& other_block = plan.blocks[other_index];
+          used_ranges.emplace_back(other_block.offset, other_block.offset + other_block.capacity);
+        }
+      }
+
+      std::sort(used_ranges.begin(), used_ranges.end());
+
+      // Use the first gap that is large enough for this buffer.
+      size_t offset = 0;
+      for (const auto& range : used_ranges) {
+        if (offset + block.capacity <= range.first)
+          break;
+        offset = std::max(offset, range.second);
+      }
+
+      block.offset = offset;
+      plan.arena_size = std::max(plan.arena_size, offset + block.capacity);
+      placed_blocks.emplace_back(index);
+      plan.slot_offsets.emplace_back(offset);
+    }
+
+    std::sort(plan.slot_offsets.begin(), plan.slot_offsets.end());
+    plan.slot_offsets.erase(std::unique(plan.slot_offsets.begin(), plan.slot_offsets.end()),
+                            plan.slot_offsets.end());
+    for (const size_t index : arena_blocks) {
+      Block& block = plan.blocks[index];
+      block.slot = std::lower_bound(plan.slot_offsets.begin(),
+                                    plan.slot_offsets.end(),
+                                    block.offset) - plan.slot_offsets.begin();
+    }
+
+    // A buffer is due when the first allocation after its recorded release is made.
+    std::vector<size_t> due_index(_records.size(), _records.size());
+    plan.due_offsets.assign(_records.size() + 2, 0);
+    for (const size_t index : arena_blocks) {
+      const size_t free_time = _records[index].free_time;
+      const auto next = std::upper_bound(_records.begin(), _records.end(), free_time,
+                                         [](size_t time, const Record& record) {
+                                           return time < record.alloc_time;
+                                         });
+      due_index[index] = next - _records.begin();
+      ++plan.due_offsets[due_index[index] + 1];
+    }
+    for (size_t i = 1; i < plan.due_offsets.size(); ++i)
+      plan.due_offsets[i] += plan.due_offsets[i - 1];
+
+    plan.due_blocks.resize(arena_blocks.size());
+    std::vector<size_t> positions(plan.due_offsets.begin(), plan.due_offsets.end() - 1);
+    for (size_t index = 0; index < _records.size(); ++index) {
+      if (plan.blocks[index].in_arena)
+        plan.due_blocks[positions[due_index[index]]++] = index;
+    }
+
+    return plan;
+  }
+
+
+  ScopedMemoryPlan::ScopedMemoryPlan(MemoryPlanner& planner, size_t shape_class)
+    : _planner(planner)
+    , _previous_planner(thread_memory_planner)
+  {
+    _planner.begin_step(shape_class);
+    thread_memory_planner = &_planner;
+  }
+
+  ScopedMemoryPlan::~ScopedMemoryPlan() {
+    thread_memory_planner = _previous_planner;
+    _planner.end_step();
+  }
+
+  ScopedDeviceAllocation::ScopedDeviceAllocation()
+  {
+    ++thread_device_allocation_depth;
+  }
+
+  ScopedDeviceAllocation::~ScopedDeviceAllocation() {
+    --thread_device_allocation_depth;
+  }
+
+  MemoryPlanner* get_thread_memory_planner(Device device) {
+    if (thread_device_allocation_depth == 0
+        && thread_memory_planner
+        && thread_memory_planner->device() == device)
+      return thread_memory_planner;
+    return nullptr;
+  }
+
+  bool use_memory_planner() {
+    static const bool use_planner = read_bool_from_env("CT2_USE_MEMORY_PLANNER", false);
+    return use_planner;
+  }
+
+}
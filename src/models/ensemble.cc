@@ -0,0 +1,117 @@
+#include "ctranslate2/models/ensemble.h"
+
+#include "ctranslate2/layers/ensemble.h"
+#include "ctranslate2/layers/transformer.h"
+#include "ctranslate2/models/transformer.h"
+
+namespace ctranslate2 {
+  namespace models {
+
+    static void check_same_vocabulary(const Vocabulary& vocabulary,
+                                      const Vocabulary& other,
+                                      const std::string& name) {
+      bool same = (vocabulary.size() == other.size());
+      for (size_t i = 0; same && i < vocabulary.size(); ++i)
+        same = (vocabulary.to_token(i) == other.to_token(i));
+
+      if (!same)
+        throw std::invalid_argument("The models of an ensemble should have the same "
+                                    + name + " vocabulary");
+    }
+
+    template <typename ModelType>
+    static std::vector<const ModelType*>
+    get_members_as(const std::vector<std::shared_ptr<const Model>>& members) {
+      std::vector<const ModelType*> models;
+      models.reserve(members.size());
+      for (const auto& member : members) {
+        const auto* model = dynamic_cast<const ModelType*>(member.get());
+        if (!model)
+          throw std::invalid_argument("This model type does not support ensemble decoding");
+        models.emplace_back(model);
+      }
+      return models;
+    }
+
+    EnsembleModel::EnsembleModel(std::vector<std::shared_ptr<const Model>> members)
+      : _members(std::move(members))
+    {
+      if (_members.empty())
+        throw std::invalid_argument("An ensemble should contain at least one model");
+
+      for (const auto& member : _members) {
+        if (member->device() != _members[0]->device()
+            || member->device_index() != _members[0]->device_index())
+          throw std::invalid_argument("The models of an ensemble should be on the same device");
+      }
+
+      set_device(_members[0]->device(), _members[0]->device_index());
+    }
+
+    std::unique_ptr<SequenceToSequenceReplica> EnsembleModel::as_sequence_to_sequence() const {
+      const auto scoped_device_setter = get_scoped_device_setter();
+      const auto models = get_members_as<TransformerModel>(_members);
+
+      std::vector<std::unique_ptr<layers::Encoder>> encoders;
+      std::vector<std::unique_ptr<layers::Decoder>> decoders;
+
+      for (const auto* model : models) {
+        if (model->num_source_vocabularies() != models[0]->num_source_vocabularies())
+          throw std::invalid_argument("The models of an ensemble should have the same "
+                                      "number of source features");
+        for (size_t i = 0; i < model->num_source_vocabularies(); ++i)
+          check_same_vocabulary(model->get_source_vocabulary(i),
+                                models[0]->get_source_vocabulary(i),
+                                "source");
+        check_same_vocabulary(model->get_target_vocabulary(),
+                              models[0]->get_target_vocabulary(),
+                              "target");
+
+        encoders.emplace_back(std::make_unique<layers::TransformerEncoder>(*model, "encoder"));
+        decoders.emplace_back(std::make_unique<layers::TransformerDecoder>(*model, "decoder"));
+      }
+
+      auto encoder = std::make_unique<layers::EnsembleEncoder>(std::move(encoders));
+      auto decoder = std::make_unique<layers::EnsembleDecoder>(std::move(decoders),
+                                                               encoder->output_sizes());
+
+      return std::make_unique<EncoderDecoderReplica>(
+        shared_from_this(),
+        std::static_pointer_cast<const SequenceToSequenceModel>(_members[0]),
+        std::move(encoder),
+        std::move(decoder));
+    }
+
+    std::unique_ptr<SequenceGeneratorReplica> EnsembleModel::as_sequence_generator() const {
+      const auto scoped_device_setter = get_scoped_device_setter();
+      const auto models = get_members_as<TransformerDecoderModel>(_members);
+
+      std::vector<std::unique_ptr<layers::Decoder>> decoders;
+
+      for (const auto* model : models) {
+        check_same_vocabulary(model->get_vocabulary(), models[0]->get_vocabulary(), "target");
+        decoders.emplace_back(std::make_unique<layers::TransformerDecoder>(*model, "decoder"));
+      }
+
+      auto decoder = std::make_unique<layers::EnsembleDecoder>(std::move(decoders));
+
+      return std::make_unique<DecoderReplica>(
+        shared_from_this(),
+        std::static_pointer_cast<const LanguageModel>(_members[0]),
+        std::move(decoder));
+    }
+
+    std::shared_ptr<const Model> EnsembleModel::copy_to(Device device, int device_index) const {
+      std::vector<std::shared_ptr<const Model>> members;
+      members.reserve(_members.size());
+      for (const auto& member : _members)
+        members.emplace_back(member->copy_to(device, device_index));
+      return std::make_shared<EnsembleModel>(std::move(members));
+    }
+
+    std::unique_ptr<Model> EnsembleModel::clone() const {
+      return std::make_unique<EnsembleModel>(*this);
+    }
+
+  }
+}
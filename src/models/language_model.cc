@@ -1,6 +1,7 @@
 #include "ctranslate2/models/language_model.h"
 
 #include "ctranslate2/decoding.h"
+#include "ctranslate2/memory_planner.h"
 
 namespace ctranslate2 {
   namespace models {
@@ -26,6 +27,37 @@ namespace ctranslate2 {
     }
 
 
+    GenerationSession::GenerationSession(size_t replica_index,
+                                         std::chrono::milliseconds idle_timeout)
+      : _replica_index(replica_index)
+      , _idle_timeout(idle_timeout)
+      , _last_use(std::chrono::steady_clock::now())
+    {
+    }
+
+    std::vector<size_t> GenerationSession::ids() const {
+      const std::lock_guard<std::mutex> lock(_mutex);
+      return _ids;
+    }
+
+    size_t GenerationSession::num_cached_ids() const {
+      const std::lock_guard<std::mutex> lock(_mutex);
+      return _num_cached_ids;
+    }
+
+    bool GenerationSession::is_offloaded() const {
+      const std::lock_guard<std::mutex> lock(_mutex);
+      return _offloaded;
+    }
+
+    bool GenerationSession::is_idle(std::chrono::steady_clock::time_point now) const {
+      if (_idle_timeout.count() == 0)
+        return false;
+      const std::lock_guard<std::mutex> lock(_mutex);
+      return now - _last_use > _idle_timeout;
+    }
+
+
     std::vector<ScoringResult>
     SequenceGeneratorReplica::score(const std::vector<std::vector<std::string>>& tokens,
                                     const ScoringOptions& options) {
@@ -53,6 +85,41 @@ namespace ctranslate2 {
       return run_generation(start_tokens, options);
     }
 
+    GenerationResult
+    SequenceGeneratorReplica::generate_in_session(GenerationSession& session,
+                                                  const std::vector<std::string>& tokens,
+                                                  const GenerationOptions& options) {
+      PROFILE("SequenceGeneratorReplica::generate_in_session");
+      const auto scoped_device_setter = model()->get_scoped_device_setter();
+      const auto& vocabulary = _model->get_vocabulary();
+      return run_generation_in_session(session, vocabulary.to_ids({tokens})[0], options);
+    }
+
+    void SequenceGeneratorReplica::offload_session(GenerationSession& session) {
+      for (auto& pair : session._state) {
+        if (pair.second && pair.second.device() != Device::CPU)
+          pair.second = pair.second.to(Device::CPU);
+      }
+
+      const std::lock_guard<std::mutex> lock(session._mutex);
+      session._offloaded = !session._state.empty();
+    }
+
+    void SequenceGeneratorReplica::evict_session(GenerationSession& session) {
+      session._state.clear();
+
+      const std::lock_guard<std::mutex> lock(session._mutex);
+      session._num_cached_ids = 0;
+      session._offloaded = false;
+    }
+
+    GenerationResult
+    SequenceGeneratorReplica::run_generation_in_session(GenerationSession&,
+                                                        const std::vector<size_t>&,
+                                                        const GenerationOptions&) {
+      throw std::runtime_error("This model does not support generation sessions");
+    }
+
     StorageView
     SequenceGeneratorReplica::forward(const std::vector<std::vector<std::string>>& tokens,
                                       const bool return_log_probs) {
@@ -94,7 +161,14 @@ namespace ctranslate2 {
 
     DecoderReplica::DecoderReplica(const std::shared_ptr<const LanguageModel>& model,
                                    std::unique_ptr<layers::Decoder> decoder)
-      : SequenceGeneratorReplica(model)
+      : DecoderReplica(model, model, std::move(decoder))
+    {
+    }
+
+    DecoderReplica::DecoderReplica(const std::shared_ptr<const Model>& replica_model,
+                                   const std::shared_ptr<const LanguageModel>& model,
+                                   std::unique_ptr<layers::Decoder> decoder)
+      : SequenceGeneratorReplica(replica_model, model)
       , _model(model)
       , _decoder(std::move(decoder))
     {
@@ -121,15 +195,18 @@ namespace ctranslate2 {
       return tokens.size() < 2;
     }
 
-    std::vector<GenerationResult>
-    DecoderReplica::run_generation(const std::vector<std::vector<std::string>>& start_tokens,
-                                   const GenerationOptions& options) {
-      const auto& vocabulary = _model->get_vocabulary();
-      _decoder->update_output_layer(_model->preferred_size_multiple());
-
+    static DecodingOptions make_decoding_options(const GenerationOptions& options,
+                                                 const Vocabulary& vocabulary) {
       DecodingOptions decoding_options;
       decoding_options.beam_size = options.beam_size;
       decoding_options.patience = options.patience;
+      decoding_options.beam_pruning_absolute_threshold = options.beam_pruning_absolute_threshold;
+      decoding_options.beam_pruning_relative_threshold = options.beam_pruning_relative_threshold;
+      decoding_options.beam_score_bound = options.beam_score_bound;
+      decoding_options.early_exit_threshold = options.early_exit_threshold;
+      decoding_options.early_exit_interval = options.early_exit_interval;
+      decoding_options.two_stage_candidates = options.two_stage_candidates;
+      decoding_options.two_stage_exact_log_probs = options.two_stage_exact_log_probs;
       decoding_options.length_penalty = options.length_penalty;
       decoding_options.repetition_penalty = options.repetition_penalty;
       decoding_options.no_repeat_ngram_size = options.no_repeat_ngram_size;
@@ -139,17 +216,69 @@ namespace ctranslate2 {
       decoding_options.sampling_temperature = options.sampling_temperature;
       decoding_options.num_hypotheses = options.num_hypotheses;
       decoding_options.return_scores = options.return_scores;
+      decoding_options.return_topk_logprobs = options.return_topk_logprobs;
       decoding_options.return_alternatives = options.return_alternatives;
       decoding_options.min_alternative_expansion_prob = options.min_alternative_expansion_prob;
       decoding_options.disable_sequences = vocabulary.to_ids(options.suppress_sequences);
+      decoding_options.stop_sequences = stop_sequences_to_ids(vocabulary, options.stop_sequences);
       if (options.disable_unk)
         decoding_options.disable_ids.push_back(vocabulary.unk_id());
+      return decoding_options;
+    }
+
+    static size_t get_end_id(const GenerationOptions& options, const Vocabulary& vocabulary) {
+      return (options.end_token.empty()
+              ? vocabulary.eos_id()
+              : vocabulary.to_id(options.end_token));
+    }
+
+    static GenerationResult make_generation_result(DecodingResult result,
+                                                   const std::vector<size_t>& start_ids,
+                                                   const size_t end_id,
+                                                   const Vocabulary& vocabulary) {
+      // Remove EOS token.
+      for (size_t h = 0; h < result.hypotheses.size(); ++h) {
+        auto& sequence = result.hypotheses[h];
+        while (!sequence.empty() && sequence.back() == end_id) {
+          sequence.pop_back();
+          if (!result.topk_ids.empty()) {
+            result.topk_ids[h].pop_back();
+            result.topk_logprobs[h].pop_back();
+          }
+        }
+      }
+
+      // Forward the start token to the output if it is not the special BOS token.
+      if (!start_ids.empty() && start_ids[0] != vocabulary.bos_id()) {
+        for (auto& sequence : result.hypotheses)
+          sequence.insert(sequence.begin(), start_ids[0]);
+
+        // The start token was not predicted so it has no top-k log probabilities.
+        for (auto& topk_ids : result.topk_ids)
+          topk_ids.emplace(topk_ids.begin());
+        for (auto& topk_logprobs : result.topk_logprobs)
+          topk_logprobs.emplace(topk_logprobs.begin());
+      }
 
+      GenerationResult final_result;
+      final_result.sequences = vocabulary.to_tokens(result.hypotheses);
+      final_result.sequences_ids = std::move(result.hypotheses);
+      final_result.scores = std::move(result.scores);
+      final_result.topk_ids = std::move(result.topk_ids);
+      final_result.topk_logprobs = std::move(result.topk_logprobs);
+      final_result.average_exit_depth = result.average_exit_depth;
+      return final_result;
+    }
+
+    std::vector<GenerationResult>
+    DecoderReplica::run_generation(const std::vector<std::vector<std::string>>& start_tokens,
+                                   const GenerationOptions& options) {
+      const auto& vocabulary = _model->get_vocabulary();
+      _decoder->update_output_layer(_model->preferred_size_multiple());
 
+      const auto decoding_options = make_decoding_options(options, vocabulary);
       const auto start_ids = vocabulary.to_ids(start_tokens);
-      const auto end_id = (options.end_token.empty()
-                           ? vocabulary.eos_id()
-                           : vocabulary.to_id(options.end_token));
+      const auto end_id = get_end_id(options, vocabulary);
       layers::DecoderState state = _decoder->initial_state();
       std::vector<DecodingResult> results = decode(*_decoder,
                                                    state,
@@ -159,29 +288,134 @@ namespace ctranslate2 {
 
       std::vector<GenerationResult> final_results;
       final_results.reserve(results.size());
-      for (size_t i = 0; i < results.size(); ++i) {
-        auto& result = results[i];
+      for (size_t i = 0; i < results.size(); ++i)
+        final_results.emplace_back(make_generation_result(std::move(results[i]),
+                                                          start_ids[i],
+                                                          end_id,
+                                                          vocabulary));
+
+      return final_results;
+    }
 
-        // Remove EOS token.
-        for (auto& sequence : result.hypotheses) {
-          while (!sequence.empty() && sequence.back() == end_id)
-            sequence.pop_back();
+    GenerationResult
+    DecoderReplica::run_generation_in_session(GenerationSession& session,
+                                              const std::vector<size_t>& ids,
+                                              const GenerationOptions& options) {
+      // The beam search reorders and replicates the decoder state, so the state could not be
+      // continued from a single hypothesis.
+      if (options.beam_size != 1 || options.num_hypotheses != 1 || options.return_alternatives)
+        throw std::invalid_argument("Generation sessions only support greedy search or random "
+                                    "sampling with a single hypothesis");
+
+      const auto& vocabulary = _model->get_vocabulary();
+      const Device device = _model->device();
+      _decoder->update_output_layer(_model->preferred_size_multiple());
+
+      auto& state = session._state;
+      if (state.empty())
+        state = _decoder->initial_state();
+      else if (session.is_offloaded()) {
+        for (auto& pair : state) {
+          if (pair.second)
+            pair.second = pair.second.to(device);
         }
+      }
 
-        // Forward the start token to the output if it is not the special BOS token.
-        if (!start_ids[i].empty() && start_ids[i][0] != vocabulary.bos_id()) {
-          for (auto& sequence : result.hypotheses)
-            sequence.insert(sequence.begin(), start_ids[i][0]);
+      size_t turn_begin = 0;
+      size_t num_cached_ids = 0;
+      std::vector<size_t> start_ids;
+
+      {
+        const std::lock_guard<std::mutex> lock(session._mutex);
+        turn_begin = session._ids.size();
+        session._ids.insert(session._ids.end(), ids.begin(), ids.end());
+        session._offloaded = false;
+        num_cached_ids = session._num_cached_ids;
+        start_ids.assign(session._ids.begin() + num_cached_ids, session._ids.end());
+      }
+
+      if (start_ids.empty())
+        throw std::invalid_argument("The generation session has no start token");
+
+      // The history that is not cached is forwarded again without counting in the length
+      // constraints of this turn.
+      const size_t num_history_ids = (turn_begin > num_cached_ids + 1
+                                      ? turn_begin - num_cached_ids - 1
+                                      : 0);
+
+      auto decoding_options = make_decoding_options(options, vocabulary);
+      decoding_options.start_step = num_cached_ids;
+      decoding_options.max_length += num_history_ids;
+      decoding_options.min_length += num_history_ids;
+      const auto end_id = get_end_id(options, vocabulary);
+
+      DecodingResult result;
+      try {
+        // The session state outlives this call and is released by the replica owning the
+        // session, so it must not reference a memory plan.
+        const ScopedDeviceAllocation device_allocation;
+        result = std::move(decode(*_decoder, state, {start_ids}, end_id, decoding_options)[0]);
+      } catch (...) {
+        // The decoder state may be partially updated.
+        evict_session(session);
+        throw;
+      }
+
+      // The last token is not forwarded in the decoder so it will start the next turn.
+      const auto& hypothesis = result.hypotheses[0];
+      std::vector<size_t> sequence;
+
+      {
+        const std::lock_guard<std::mutex> lock(session._mutex);
+        if (!hypothesis.empty()) {
+          session._ids.resize(num_cached_ids + 1);
+          session._ids.insert(session._ids.end(), hypothesis.begin(), hypothesis.end());
+          session._num_cached_ids = num_cached_ids + hypothesis.size();
         }
+        session._last_use = std::chrono::steady_clock::now();
 
-        GenerationResult final_result;
-        final_result.sequences = vocabulary.to_tokens(result.hypotheses);
-        final_result.sequences_ids = std::move(result.hypotheses);
-        final_result.scores = std::move(result.scores);
-        final_results.emplace_back(std::move(final_result));
+        // Return the tokens of this turn, like the generate method returns the prompt tokens.
+        if (turn_begin == 0 && session._ids[0] == vocabulary.bos_id())
+          turn_begin = 1;
+        sequence.assign(session._ids.begin() + std::min(turn_begin, session._ids.size()),
+                        session._ids.end());
       }
 
-      return final_results;
+      // The top-k log probabilities are only defined for the tokens that were decoded.
+      std::vector<std::vector<size_t>> topk_ids;
+      std::vector<std::vector<float>> topk_logprobs;
+      if (!result.topk_ids.empty()) {
+        const size_t first_decoded = num_cached_ids + 1;
+        for (size_t i = 0; i < sequence.size(); ++i) {
+          const size_t position = turn_begin + i;
+          if (position < first_decoded) {
+            topk_ids.emplace_back();
+            topk_logprobs.emplace_back();
+          } else {
+            topk_ids.emplace_back(std::move(result.topk_ids[0][position - first_decoded]));
+            topk_logprobs.emplace_back(std::move(result.topk_logprobs[0][position - first_decoded]));
+          }
+        }
+      }
+
+      // Remove EOS token.
+      while (!sequence.empty() && sequence.back() == end_id) {
+        sequence.pop_back();
+        if (!topk_ids.empty()) {
+          topk_ids.pop_back();
+          topk_logprobs.pop_back();
+        }
+      }
+
+      GenerationResult final_result;
+      final_result.sequences = vocabulary.to_tokens({sequence});
+      final_result.sequences_ids.emplace_back(std::move(sequence));
+      final_result.scores = std::move(result.scores);
+      if (!result.topk_ids.empty()) {
+        final_result.topk_ids.emplace_back(std::move(topk_ids));
+        final_result.topk_logprobs.emplace_back(std::move(topk_logprobs));
+      }
+      return final_result;
     }
 
     StorageView DecoderReplica::forward(const StorageView& ids, const StorageView& lengths) {
@@ -206,5 +440,20 @@ namespace ctranslate2 {
       return logits;
     }
 
+    void DecoderReplica::run_warmup(size_t batch_size, size_t length, size_t beam_size) {
+      const auto& vocabulary = _model->get_vocabulary();
+
+      GenerationOptions options;
+      options.beam_size = beam_size;
+      options.min_length = length;
+      options.max_length = length;
+
+      std::vector<std::string> prompt(length, vocabulary.unk_token());
+      prompt[0] = vocabulary.bos_token();
+
+      const std::vector<std::vector<std::string>> start_tokens(batch_size, prompt);
+      generate(start_tokens, options);
+    }
+
   }
 }
@@ -1,7 +1,11 @@
 #include "ctranslate2/models/model.h"
 
+#include <cstring>
+
 #include <spdlog/spdlog.h>
 
+#include "ctranslate2/allocator.h"
+#include "ctranslate2/models/ensemble.h"
 #include "ctranslate2/models/model_factory.h"
 #include "ctranslate2/ops/ops.h"
 #include "ctranslate2/utils.h"
@@ -11,12 +15,14 @@
 #endif
 
 #include "cpu/backend.h"
+#include "cpu/gemm_tuning.h"
 
 namespace ctranslate2 {
   namespace models {
 
     static const std::string binary_file = "model.bin";
     static const std::string config_file = "config.json";
+    static const std::string pruning_file = "pruning.json";
 
     static inline void report_stream_error(const std::streampos position,
                                            const size_t read_size,
@@ -341,11 +347,12 @@ namespace ctranslate2 {
     }
 
     // This method runs some precomputations on linear weights when possible.
-    void Model::process_linear_weights() {
+    void Model::process_linear_weights(size_t num_threads) {
       if (_device != Device::CPU)
         return;  // There is currently no processing for non CPU device.
 
       const bool pack_weights = cpu::pack_gemm_weights(_effective_compute_type);
+      const bool autotune_gemm = cpu::gemm_autotuning_enabled();
       const bool transpose = true;
       const float alpha = 1;
 
@@ -369,13 +376,27 @@ namespace ctranslate2 {
           register_variable(name + "_compensation", std::move(compensation));
         }
 
+        // Select the GEMM backend for this shape. The measurements also tell whether
+        // the weight is worth packing.
+        bool pack_weight = pack_weights && is_packable(name);
+        if (autotune_gemm) {
+          const ComputeType compute_type = data_type_to_compute_type(dtype, DataType::FLOAT32);
+          const bool packable = (is_packable(name)
+                                 && cpu::get_gemm_backend(compute_type) == cpu::GemmBackend::MKL);
+          if (cpu::tune_linear_gemm(compute_type, n, k, packable, num_threads) && packable)
+            pack_weight = true;
+        }
+
         // If requested, linear weights can be packed for the Gemm call.
-        if (pack_weights && is_packable(name)) {
+        if (pack_weight) {
           StorageView packed_weight = ops::Gemm::pack_b_input(weight, transpose, k, n, alpha);
           register_variable(name + "_packed", std::move(packed_weight));
           remove_variable(name);  // The original weight is no longer needed.
         }
       }
+
+      if (autotune_gemm)
+        cpu::save_gemm_tuning_cache();
     }
 
     static DataType get_dtype_from_item_size(uint8_t item_size) {
@@ -406,18 +427,217 @@ namespace ctranslate2 {
                                  + "(Forward compatibility is not guaranteed.)");
     }
 
+    // Keeps the blocks of block_size indices listed in blocks along an axis of x.
+    static StorageView select_blocks(const StorageView& x,
+                                     const dim_t axis,
+                                     const dim_t block_size,
+                                     const std::vector<dim_t>& blocks) {
+      const dim_t dim = x.dim(axis);
+      const dim_t outer_size = x.size() / (dim * x.stride(axis));
+      const dim_t inner_size = x.stride(axis) * x.item_size();
+      const dim_t new_dim = blocks.size() * block_size;
+      const dim_t copy_size = block_size * inner_size;
+
+      Shape new_shape = x.shape();
+      new_shape[axis] = new_dim;
+      StorageView y(std::move(new_shape), x.dtype());
+
+      const auto* src = static_cast<const char*>(x.buffer());
+      auto* dst = static_cast<char*>(y.buffer());
+
+      for (dim_t i = 0; i < outer_size; ++i) {
+        for (size_t j = 0; j < blocks.size(); ++j) {
+          std::memcpy(dst + (i * new_dim + j * block_size) * inner_size,
+                      src + (i * dim + blocks[j] * block_size) * inner_size,
+                      copy_size);
+        }
+      }
+
+      return y;
+    }
+
+    // Returns the sorted indices in [0, size) that are not listed in removed.
+    static std::vector<dim_t> get_kept_indices(const nlohmann::json& removed,
+                                               const dim_t size,
+                                               const std::string& scope) {
+      std::vector<bool> is_removed(size, false);
+      for (const auto& value : removed) {
+        const dim_t index = value.get<dim_t>();
+        if (index < 0 || index >= size)
+          throw std::invalid_argument("Pruning index " + std::to_string(index)
+                                      + " is out of range for " + scope
+                                      + " which has " + std::to_string(size) + " entries");
+        if (is_removed[index])
+          throw std::invalid_argument("Pruning index " + std::to_string(index)
+                                      + " is listed more than once for " + scope);
+        is_removed[index] = true;
+      }
+
+      std::vector<dim_t> kept;
+      kept.reserve(size);
+      for (dim_t i = 0; i < size; ++i) {
+        if (!is_removed[i])
+          kept.emplace_back(i);
+      }
+
+      if (kept.empty())
+        throw std::invalid_argument("Pruning cannot remove all entries of " + scope);
+      return kept;
+    }
+
+    // Repeats the indices for each of the num_blocks fused blocks of size block_size.
+    static std::vector<dim_t> repeat_indices(const std::vector<dim_t>& indices,
+                                             const dim_t num_blocks,
+                                             const dim_t block_size) {
+      std::vector<dim_t> repeated;
+      repeated.reserve(indices.size() * num_blocks);
+      for (dim_t b = 0; b < num_blocks; ++b) {
+        for (const dim_t index : indices)
+          repeated.emplace_back(b * block_size + index);
+      }
+      return repeated;
+    }
+
+    dim_t Model::prune_variable(const std::string& name,
+                                const dim_t axis,
+                                const dim_t block_size,
+                                const std::vector<dim_t>& blocks) {
+      auto it = _variable_index.find(name);
+      if (it == _variable_index.end())
+        return 0;
+
+      StorageView& variable = *it->second;
+      if (variable.rank() <= axis)
+        return 0;
+
+      StorageView pruned = select_blocks(variable, axis, block_size, blocks);
+      const dim_t num_removed = variable.size() - pruned.size();
+      variable = std::move(pruned);
+      return num_removed;
+    }
+
+    dim_t Model::prune_linear_outputs(const std::string& scope,
+                                      const dim_t block_size,
+                                      const std::vector<dim_t>& blocks) {
+      if (!get_variable_if_exists(scope + "/weight"))
+        throw std::invalid_argument("Pruning manifest refers to a missing linear layer " + scope);
+
+      // The quantization scale is per output row, except for INT16 weights.
+      return (prune_variable(scope + "/weight", 0, block_size, blocks)
+              + prune_variable(scope + "/bias", 0, block_size, blocks)
+              + prune_variable(scope + "/weight_scale", 0, block_size, blocks));
+    }
+
+    dim_t Model::prune_linear_inputs(const std::string& scope,
+                                     const dim_t block_size,
+                                     const std::vector<dim_t>& blocks) {
+      if (!get_variable_if_exists(scope + "/weight"))
+        throw std::invalid_argument("Pruning manifest refers to a missing linear layer " + scope);
+
+      return prune_variable(scope + "/weight", 1, block_size, blocks);
+    }
+
+    dim_t Model::prune_attention_heads(const std::string& scope, const nlohmann::json& removed) {
+      if (!get_variable_if_exists(scope + "/linear_0/weight"))
+        throw std::invalid_argument("Pruning manifest refers to a missing attention layer "
+                                    + scope);
+
+      const bool self_attention = !get_variable_if_exists(scope + "/linear_2/weight");
+
+      // The number of heads is defined by the parent encoder or decoder.
+      const StorageView* num_heads_attribute = get_variable_if_exists(scope + "/num_heads");
+      for (std::string parent = scope; !num_heads_attribute && !parent.empty();) {
+        const size_t separator = parent.rfind('/');
+        parent = separator == std::string::npos ? "" : parent.substr(0, separator);
+        num_heads_attribute = get_variable_if_exists(
+          parent.empty() ? "num_heads" : parent + "/num_heads");
+      }
+
+      const dim_t num_heads = (num_heads_attribute
+                               ? num_heads_attribute->as_scalar<int32_t>()
+                               : default_num_heads());
+      if (num_heads <= 0)
+        throw std::invalid_argument("Cannot prune the attention heads of " + scope
+                                    + ": the number of heads is not saved in the model");
+      const dim_t d_model = get_variable(scope + "/linear_" + (self_attention ? "1" : "2")
+                                         + "/weight").dim(0);
+      const dim_t head_dim = d_model / num_heads;
+
+      const std::vector<dim_t> kept = get_kept_indices(removed, num_heads, scope);
+      if (static_cast<dim_t>(kept.size()) == num_heads)
+        return 0;
+
+      dim_t num_removed = 0;
+
+      if (self_attention) {
+        num_removed += prune_linear_outputs(scope + "/linear_0",
+                                            head_dim,
+                                            repeat_indices(kept, 3, num_heads));
+        num_removed += prune_linear_inputs(scope + "/linear_1", head_dim, kept);
+      } else {
+        num_removed += prune_linear_outputs(scope + "/linear_0", head_dim, kept);
+        num_removed += prune_linear_outputs(scope + "/linear_1",
+                                            head_dim,
+                                            repeat_indices(kept, 2, num_heads));
+        num_removed += prune_linear_inputs(scope + "/linear_2", head_dim, kept);
+      }
+
+      num_removed += prune_variable(scope + "/relative_attention_bias", 1, 1, kept);
+
+      _variable_index[scope + "/num_heads"] = std::make_shared<StorageView>(
+        StorageView(static_cast<int32_t>(kept.size())));
+      return num_removed;
+    }
+
+    dim_t Model::prune_ffn_channels(const std::string& scope, const nlohmann::json& removed) {
+      const StorageView* weight = get_variable_if_exists(scope + "/linear_0/weight");
+      if (!weight)
+        throw std::invalid_argument("Pruning manifest refers to a missing feed-forward "
+                                    "network " + scope);
+
+      const std::vector<dim_t> kept = get_kept_indices(removed, weight->dim(0), scope);
+      if (static_cast<dim_t>(kept.size()) == weight->dim(0))
+        return 0;
+
+      dim_t num_removed = prune_linear_outputs(scope + "/linear_0", 1, kept);
+      if (get_variable_if_exists(scope + "/linear_0_noact/weight"))
+        num_removed += prune_linear_outputs(scope + "/linear_0_noact", 1, kept);
+      num_removed += prune_linear_inputs(scope + "/linear_1", 1, kept);
+      return num_removed;
+    }
+
+    void Model::apply_pruning(const nlohmann::json& manifest) {
+      dim_t num_removed = 0;
+
+      const auto attention_heads = manifest.find("attention_heads");
+      if (attention_heads != manifest.end()) {
+        for (const auto& item : attention_heads->items())
+          num_removed += prune_attention_heads(item.key(), item.value());
+      }
+
+      const auto ffn_channels = manifest.find("ffn_channels");
+      if (ffn_channels != manifest.end()) {
+        for (const auto& item : ffn_channels->items())
+          num_removed += prune_ffn_channels(item.key(), item.value());
+      }
+
+      spdlog::info("Pruned {} parameters from the model", num_removed);
+    }
+
     std::shared_ptr<const Model> Model::load(const std::string& path,
                                              Device device,
                                              int device_index,
-                                             ComputeType compute_type) {
+                                             ComputeType compute_type,
+                                             size_t num_threads) {
       ModelFileReader model_reader(path);
-      return load(model_reader, device, device_index, compute_type);
+      return load(model_reader, device, device_index, compute_type, num_threads);
     }
 
     std::shared_ptr<const Model> Model::load(ModelReader& model_reader,
                                              Device device,
                                              int device_index,
-                                             ComputeType compute_type) {
+                                             ComputeType compute_type,
+                                             size_t num_threads) {
       {
         // Log the system configuration the first time a model is loaded.
         static std::once_flag log_once;
@@ -460,6 +680,9 @@ namespace ctranslate2 {
           model->config = nlohmann::json::parse(*config_file_ptr);
       }
 
+      // Allocate the weights and their converted or packed versions in huge pages, if enabled.
+      const ScopedHugePageAllocation scoped_huge_pages(device);
+
       // Load the variables.
       const auto num_variables = consume<uint32_t>(model_file);
       model->_variable_index.reserve(num_variables);
@@ -487,6 +710,13 @@ namespace ctranslate2 {
         model->register_variable(std::move(name), std::move(variable));
       }
 
+      // Remove the attention heads and FFN channels listed in the pruning manifest, if any.
+      {
+        std::unique_ptr<std::istream> pruning_file_ptr = model_reader.get_file(pruning_file);
+        if (pruning_file_ptr)
+          model->apply_pruning(nlohmann::json::parse(*pruning_file_ptr));
+      }
+
       // Maybe quantize/dequantize/convert the variables to match the requested compute type.
       model->set_compute_type(compute_type, device, device_index);
 
@@ -507,7 +737,7 @@ namespace ctranslate2 {
 
       // Run additional model initialization.
       const ScopedDeviceSetter scoped_device_setter(device, device_index);
-      model->process_linear_weights();
+      model->process_linear_weights(num_threads);
       model->initialize(model_reader);
       return model;
     }
@@ -553,6 +783,39 @@ namespace ctranslate2 {
     {
     }
 
+    ModelLoader::ModelLoader(const std::vector<std::string>& model_paths) {
+      if (model_paths.empty())
+        throw std::invalid_argument("At least one model path should be set");
+
+      model_reader = std::make_shared<ModelFileReader>(model_paths[0]);
+      for (size_t i = 1; i < model_paths.size(); ++i)
+        ensemble_model_readers.emplace_back(std::make_shared<ModelFileReader>(model_paths[i]));
+    }
+
+    static void log_loaded_model(const Model& model,
+                                 const std::string& model_id,
+                                 const Device device,
+                                 const int device_index) {
+      spdlog::info("Loaded model {} on device {}:{}",
+                   model_id,
+                   device_to_str(device),
+                   device_index);
+      spdlog::info(" - Binary version: {}", model.binary_version());
+      spdlog::info(" - Model specification revision: {}", model.spec_revision());
+      spdlog::info(" - Selected compute type: {}",
+                   compute_type_to_str(model.effective_compute_type()));
+
+      if (model.requested_compute_type() == ComputeType::DEFAULT
+          && model.effective_compute_type() != model.saved_compute_type())
+        spdlog::warn("The compute type inferred from the saved model is {}, "
+                     "but the target device or backend do not support efficient {} computation. "
+                     "The model weights have been automatically converted to use "
+                     "the {} compute type instead.",
+                     compute_type_to_str(model.saved_compute_type()),
+                     compute_type_to_str(model.saved_compute_type()),
+                     compute_type_to_str(model.effective_compute_type()));
+    }
+
     std::vector<std::shared_ptr<const Model>>
     ModelLoader::load() const {
       if (device_indices.empty())
@@ -563,35 +826,45 @@ namespace ctranslate2 {
                                     "for the same model");
 #endif
 
+      std::vector<std::shared_ptr<ModelReader>> model_readers;
+      model_readers.reserve(ensemble_model_readers.size() + 1);
+      model_readers.emplace_back(model_reader);
+      model_readers.insert(model_readers.end(),
+                           ensemble_model_readers.begin(),
+                           ensemble_model_readers.end());
+
       std::vector<std::shared_ptr<const Model>> models;
       models.reserve(device_indices.size() * num_replicas_per_device);
 
       for (const size_t device_index : device_indices) {
-        std::shared_ptr<const Model> model;
+        std::vector<std::shared_ptr<const Model>> members;
+        members.reserve(model_readers.size());
+
+        if (models.empty()) {
+          for (const auto& reader : model_readers)
+            members.emplace_back(Model::load(*reader,
+                                             device,
+                                             device_index,
+                                             compute_type,
+                                             num_threads_per_replica));
+        } else {
+          const auto* ensemble = dynamic_cast<const EnsembleModel*>(models.back().get());
+          if (ensemble) {
+            for (const auto& member : ensemble->members())
+              members.emplace_back(member->copy_to(device, device_index));
+          } else {
+            members.emplace_back(models.back()->copy_to(device, device_index));
+          }
+        }
 
-        if (models.empty())
-          model = Model::load(*model_reader, device, device_index, compute_type);
+        for (size_t i = 0; i < members.size(); ++i)
+          log_loaded_model(*members[i], model_readers[i]->get_model_id(), device, device_index);
+
+        std::shared_ptr<const Model> model;
+        if (members.size() == 1)
+          model = std::move(members[0]);
         else
-          model = models.back()->copy_to(device, device_index);
-
-        spdlog::info("Loaded model {} on device {}:{}",
-                     model_reader->get_model_id(),
-                     device_to_str(device),
-                     device_index);
-        spdlog::info(" - Binary version: {}", model->binary_version());
-        spdlog::info(" - Model specification revision: {}", model->spec_revision());
-        spdlog::info(" - Selected compute type: {}",
-                     compute_type_to_str(model->effective_compute_type()));
-
-        if (model->requested_compute_type() == ComputeType::DEFAULT
-            && model->effective_compute_type() != model->saved_compute_type())
-          spdlog::warn("The compute type inferred from the saved model is {}, "
-                       "but the target device or backend do not support efficient {} computation. "
-                       "The model weights have been automatically converted to use "
-                       "the {} compute type instead.",
-                       compute_type_to_str(model->saved_compute_type()),
-                       compute_type_to_str(model->saved_compute_type()),
-                       compute_type_to_str(model->effective_compute_type()));
+          model = std::make_shared<EnsembleModel>(std::move(members));
 
         for (size_t i = 0; i < num_replicas_per_device; ++i)
           models.emplace_back(model);
@@ -600,5 +873,45 @@ namespace ctranslate2 {
       return models;
     }
 
+
+    static void touch_memory_pages(const StorageView& variable) {
+      constexpr size_t page_size = 4096;
+
+      const auto* data = static_cast<const volatile char*>(variable.buffer());
+      const size_t size = variable.size() * variable.item_size();
+
+      char value = 0;
+      for (size_t offset = 0; offset < size; offset += page_size)
+        value ^= data[offset];
+      (void)value;
+    }
+
+    void ModelReplica::warmup(const WarmupOptions& options) {
+      const auto scoped_device_setter = _model->get_scoped_device_setter();
+      const Device device = _model->device();
+
+      // Weights that were never accessed since loading may not be resident yet,
+      // for example when they are backed by freshly mapped memory.
+      if (options.touch_weights && device == Device::CPU) {
+        const auto* ensemble = dynamic_cast<const EnsembleModel*>(_model.get());
+        const auto models = (ensemble
+                             ? ensemble->members()
+                             : std::vector<std::shared_ptr<const Model>>{_model});
+        for (const auto& model : models) {
+          for (const auto& pair : model->get_variables())
+            touch_memory_pages(pair.second);
+        }
+      }
+
+      for (const auto& shape : options.batch_shapes) {
+        if (shape.first == 0 || shape.second == 0)
+          throw std::invalid_argument("Warmup batch shapes should have a non zero batch size "
+                                      "and length");
+        run_warmup(shape.first, shape.second, options.beam_size);
+      }
+
+      synchronize_stream(device);
+    }
+
   }
 }
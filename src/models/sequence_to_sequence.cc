@@ -138,7 +138,15 @@ namespace ctranslate2 {
     EncoderDecoderReplica::EncoderDecoderReplica(const std::shared_ptr<const SequenceToSequenceModel>& model,
                                                  std::unique_ptr<layers::Encoder> encoder,
                                                  std::unique_ptr<layers::Decoder> decoder)
-      : SequenceToSequenceReplica(model)
+      : EncoderDecoderReplica(model, model, std::move(encoder), std::move(decoder))
+    {
+    }
+
+    EncoderDecoderReplica::EncoderDecoderReplica(const std::shared_ptr<const Model>& replica_model,
+                                                 const std::shared_ptr<const SequenceToSequenceModel>& model,
+                                                 std::unique_ptr<layers::Encoder> encoder,
+                                                 std::unique_ptr<layers::Decoder> decoder)
+      : SequenceToSequenceReplica(replica_model)
       , _model(model)
       , _encoder(std::move(encoder))
       , _decoder(std::move(decoder))
@@ -305,6 +313,16 @@ namespace ctranslate2 {
       }
     }
 
+    static void replace_unknown_tokens(const std::vector<std::string>& source,
+                                       std::vector<std::string>& hypotheses,
+                                       const std::vector<size_t>& attention_argmax,
+                                       const std::string& unk_token) {
+      for (size_t t = 0; t < hypotheses.size(); ++t) {
+        if (hypotheses[t] == unk_token && attention_argmax[t] < source.size())
+          hypotheses[t] = source[attention_argmax[t]];
+      }
+    }
+
     std::vector<TranslationResult>
     EncoderDecoderReplica::run_translation(const std::vector<std::vector<std::string>>& source,
                                            const std::vector<std::vector<std::string>>& target_prefix,
@@ -340,6 +358,13 @@ namespace ctranslate2 {
       DecodingOptions decoding_options;
       decoding_options.beam_size = options.beam_size;
       decoding_options.patience = options.patience;
+      decoding_options.beam_pruning_absolute_threshold = options.beam_pruning_absolute_threshold;
+      decoding_options.beam_pruning_relative_threshold = options.beam_pruning_relative_threshold;
+      decoding_options.beam_score_bound = options.beam_score_bound;
+      decoding_options.early_exit_threshold = options.early_exit_threshold;
+      decoding_options.early_exit_interval = options.early_exit_interval;
+      decoding_options.two_stage_candidates = options.two_stage_candidates;
+      decoding_options.two_stage_exact_log_probs = options.two_stage_exact_log_probs;
       decoding_options.length_penalty = options.length_penalty;
       decoding_options.coverage_penalty = options.coverage_penalty;
       decoding_options.repetition_penalty = options.repetition_penalty;
@@ -351,13 +376,38 @@ namespace ctranslate2 {
       decoding_options.sampling_temperature = options.sampling_temperature;
       decoding_options.num_hypotheses = options.num_hypotheses;
       decoding_options.return_scores = options.return_scores;
-      decoding_options.return_attention = options.return_attention || options.replace_unknowns;
+      decoding_options.return_attention = options.return_attention;
+      decoding_options.return_topk_logprobs = options.return_topk_logprobs;
       decoding_options.return_alternatives = options.return_alternatives;
       decoding_options.min_alternative_expansion_prob = options.min_alternative_expansion_prob;
       decoding_options.disable_sequences = target_vocabulary.to_ids(options.suppress_sequences);
+      decoding_options.stop_sequences = stop_sequences_to_ids(target_vocabulary,
+                                                            options.stop_sequences);
       if (options.disable_unk)
         decoding_options.disable_ids.push_back(target_vocabulary.unk_id());
 
+      // The unknown tokens are replaced by the source token with the highest attention.
+      // Only the best source position is kept at each step, unless the attention vectors
+      // are requested anyway.
+      if (options.replace_unknowns) {
+        if (options.return_attention || options.return_alternatives) {
+          decoding_options.return_attention = true;
+        } else {
+          decoding_options.return_attention_argmax = true;
+          decoding_options.attention_argmax_ranges.reserve(batch_size);
+
+          const dim_t begin = _model->with_source_bos() ? 1 : 0;
+          for (size_t i = 0; i < batch_size; ++i) {
+            const dim_t input_length = (source_ids[0][i].size()
+                                        - begin
+                                        - (_model->with_source_eos() ? 1 : 0));
+            const dim_t source_length = source_features[0][i].size();
+            decoding_options.attention_argmax_ranges.emplace_back(
+              begin, begin + std::min(input_length, source_length));
+          }
+        }
+      }
+
       const auto end_id = (options.end_token.empty()
                            ? target_vocabulary.eos_id()
                            : target_vocabulary.to_id(options.end_token));
@@ -381,6 +431,12 @@ namespace ctranslate2 {
             result.hypotheses[h].pop_back();
             if (!result.attention.empty())
               result.attention[h].pop_back();
+            if (!result.topk_ids.empty()) {
+              result.topk_ids[h].pop_back();
+              result.topk_logprobs[h].pop_back();
+            }
+            if (!result.attention_argmax.empty())
+              result.attention_argmax[h].pop_back();
           }
         }
 
@@ -414,11 +470,21 @@ namespace ctranslate2 {
 
           if (!options.return_attention)
             result.attention.clear();
+
+        } else if (!result.attention_argmax.empty()) {
+          for (size_t h = 0; h < result.attention_argmax.size(); ++h)
+            replace_unknown_tokens(source_features[0][i],
+                                   hypotheses[h],
+                                   result.attention_argmax[h],
+                                   target_vocabulary.unk_token());
         }
 
         final_results.emplace_back(std::move(hypotheses),
                                    std::move(result.scores),
                                    std::move(result.attention));
+        final_results.back().topk_ids = std::move(result.topk_ids);
+        final_results.back().topk_logprobs = std::move(result.topk_logprobs);
+        final_results.back().average_exit_depth = result.average_exit_depth;
       }
 
       return final_results;
@@ -457,10 +523,33 @@ namespace ctranslate2 {
           result.scores.emplace_back(0);
         if (options.return_attention)
           result.attention.emplace_back(attention);
+        if (options.return_topk_logprobs > 0) {
+          result.topk_ids.emplace_back(hypothesis.size());
+          result.topk_logprobs.emplace_back(hypothesis.size());
+        }
       }
 
       return true;
     }
 
+    void EncoderDecoderReplica::run_warmup(size_t batch_size, size_t length, size_t beam_size) {
+      std::string token;
+      for (size_t i = 0; i < _model->num_source_vocabularies(); ++i) {
+        if (i > 0)
+          token += "￨";
+        token += _model->get_source_vocabulary(i).unk_token();
+      }
+
+      TranslationOptions options;
+      options.beam_size = beam_size;
+      options.min_decoding_length = length;
+      options.max_decoding_length = length;
+
+      const std::vector<std::vector<std::string>> source(batch_size,
+                                                         std::vector<std::string>(length, token));
+      const std::vector<std::vector<std::string>> target_prefix(batch_size);
+      run_translation(source, target_prefix, options);
+    }
+
   }
 }
@@ -65,6 +65,10 @@ namespace ctranslate2 {
       SequenceToSequenceModel::register_variable(std::move(name), std::move(variable));
     }
 
+    dim_t TransformerModel::default_num_heads() const {
+      return spec_revision() < 3 ? _num_heads : 0;
+    }
+
     void TransformerModel::initialize(ModelReader& model_reader) {
       SequenceToSequenceModel::initialize(model_reader);
 
@@ -1,6 +1,7 @@
 #include "ctranslate2/models/whisper.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <map>
@@ -10,6 +11,7 @@
 #include "ctranslate2/decoding.h"
 #include "ctranslate2/models/model_factory.h"
 
+#include "cpu/backend.h"
 #include "dispatch.h"
 
 #ifdef CT2_WITH_CUDA
@@ -37,6 +39,12 @@ namespace ctranslate2 {
       _vocabulary = std::make_shared<Vocabulary>(*model_reader.get_required_file("vocabulary.txt"),
                                                  std::move(vocab_info));
 
+      if (device() == Device::CPU
+          && compute_type_to_data_type(effective_compute_type()).first == DataType::INT8) {
+        quantize_conv_weight("encoder/conv1/weight");
+        quantize_conv_weight("encoder/conv2/weight");
+      }
+
       // define alignment heads as a map from model name to byte string
       // std::map<int, const char*> alignment_heads = {
       //     {4, "ABzY8bu8Lr0{>%RKn9Fp%m@SkK7Kt=7ytkO"},
@@ -49,6 +57,43 @@ namespace ctranslate2 {
 
     
 
+    // The convolution weights are not quantized with the other weights so that the model
+    // compute type is not inferred from them. They are quantized per output channel over
+    // the flattened [in_channels * kernel_size] filters (see layers::Conv1D).
+    void WhisperModel::quantize_conv_weight(const std::string& name) {
+      const StorageView* weight = get_variable_if_exists(name);
+      if (!weight || weight->dtype() != DataType::FLOAT32)
+        return;
+
+      const dim_t out_channels = weight->dim(0);
+      const dim_t window_size = weight->size() / out_channels;
+      const Shape shape = weight->shape();
+
+      StorageView weight_2d(*weight);
+      weight_2d.reshape({out_channels, window_size});
+
+      const ops::Quantize quantize_op(ops::Quantize::ScaleType::PER_LAYER,
+                                      /*shift_to_uint8=*/false,
+                                      round_before_cast_in_quantization());
+      StorageView qweight(DataType::INT8);
+      StorageView qscale(DataType::FLOAT32);
+      quantize_op(weight_2d, qweight, qscale);
+
+      if (cpu::prefer_u8s8s32_gemm()) {
+        StorageView compensation = ops::Gemm::compensate_u8_input(qweight,
+                                                                  /*transpose=*/true,
+                                                                  window_size,
+                                                                  out_channels,
+                                                                  /*alpha=*/1);
+        register_variable(name + "_compensation", std::move(compensation));
+      }
+
+      qweight.reshape(shape);
+      remove_variable(name);
+      register_variable(name, std::move(qweight));
+      register_variable(name + "_scale", std::move(qscale));
+    }
+
     bool WhisperModel::is_quantizable(const std::string& variable_name) const {
       return (Model::is_quantizable(variable_name)
               && variable_name.find("conv") == std::string::npos);
@@ -63,6 +108,201 @@ namespace ctranslate2 {
     }
 
 
+    // The features are log10 Mel spectrograms scaled by 1/4 with a frame every 10ms.
+    constexpr float log_mel_to_db = 40;
+    constexpr float frame_duration = 0.01;
+
+    // Timestamp tokens have a resolution of 20ms.
+    constexpr dim_t frames_per_timestamp = 2;
+
+    static std::vector<SpeechRegion> detect_speech(const float* features,
+                                                   const dim_t n_mels,
+                                                   const dim_t n_frames,
+                                                   const WhisperVadOptions& options) {
+      if (n_frames == 0)
+        return {};
+
+      // Mean energy and spectral flux of each frame, in dB.
+      std::vector<float> energy(n_frames, 0.f);
+      std::vector<float> flux(n_frames, 0.f);
+
+      for (dim_t m = 0; m < n_mels; ++m) {
+        const float* row = features + m * n_frames;
+        energy[0] += row[0];
+        for (dim_t t = 1; t < n_frames; ++t) {
+          energy[t] += row[t];
+          flux[t] += std::max(row[t] - row[t - 1], 0.f);
+        }
+      }
+
+      const float scale = log_mel_to_db / n_mels;
+      for (dim_t t = 0; t < n_frames; ++t) {
+        energy[t] *= scale;
+        flux[t] *= scale;
+      }
+
+      // The noise floor of continuous speech is the speech level, so the features are
+      // kept entirely when no frame is below the absolute energy threshold.
+      if (*std::min_element(energy.begin(), energy.end()) >= options.absolute_energy_threshold)
+        return {SpeechRegion(0, n_frames)};
+
+      std::vector<float> sorted_energy(energy);
+      const auto floor_it = sorted_energy.begin() + n_frames / 10;
+      std::nth_element(sorted_energy.begin(), floor_it, sorted_energy.end());
+      const float noise_floor = *floor_it;
+      const float energy_threshold = noise_floor + options.energy_threshold;
+      const float onset_threshold = noise_floor + options.energy_threshold / 2;
+
+      const auto is_speech = [&](const dim_t t) {
+        return (energy[t] >= energy_threshold
+                || (flux[t] >= options.flux_threshold && energy[t] >= onset_threshold));
+      };
+
+      // Collect the speech frames and close the short silences.
+      std::vector<SpeechRegion> regions;
+      for (dim_t t = 0; t < n_frames; ++t) {
+        if (!is_speech(t))
+          continue;
+        if (!regions.empty() && t - regions.back().second < dim_t(options.min_silence_frames))
+          regions.back().second = t + 1;
+        else
+          regions.emplace_back(t, t + 1);
+      }
+
+      // Drop the short regions and pad the others.
+      const dim_t pad = options.speech_pad_frames;
+      std::vector<SpeechRegion> padded_regions;
+      padded_regions.reserve(regions.size());
+
+      for (const auto& region : regions) {
+        if (region.second - region.first < dim_t(options.min_speech_frames))
+          continue;
+
+        const dim_t start = std::max(region.first - pad, dim_t(0));
+        const dim_t end = std::min(region.second + pad, n_frames);
+
+        if (!padded_regions.empty() && start <= padded_regions.back().second)
+          padded_regions.back().second = end;
+        else
+          padded_regions.emplace_back(start, end);
+      }
+
+      return padded_regions;
+    }
+
+    // Returns the lowest value of the features, which is the value of the digital silence
+    // since the log-Mel spectrogram is clamped below its maximum.
+    static float get_silence_value(const float* features, const dim_t size) {
+      return size > 0 ? *std::min_element(features, features + size) : 0.f;
+    }
+
+    // Copies the speech regions of a [n_mels, n_frames] spectrogram to the start of a
+    // [n_mels, window_frames] window. The rest of the window is left unchanged.
+    static void copy_speech_regions(const float* features,
+                                    const dim_t n_mels,
+                                    const dim_t n_frames,
+                                    const std::vector<SpeechRegion>& regions,
+                                    float* window,
+                                    const dim_t window_frames) {
+      for (dim_t m = 0; m < n_mels; ++m) {
+        const float* src = features + m * n_frames;
+        float* dst = window + m * window_frames;
+        for (const auto& region : regions)
+          dst = std::copy(src + region.first, src + region.second, dst);
+      }
+    }
+
+    // Maps a frame of a window to the frame of the input features. A frame between two
+    // regions is mapped to the end of the first region if is_end is set, and to the start
+    // of the second region otherwise.
+    static dim_t to_input_frame(const std::vector<SpeechRegion>& regions,
+                                const dim_t frame,
+                                const bool is_end = false) {
+      dim_t offset = 0;
+      for (const auto& region : regions) {
+        const dim_t length = region.second - region.first;
+        if (frame < offset + length || (is_end && frame == offset + length))
+          return region.first + (frame - offset);
+        offset += length;
+      }
+
+      // The frame is after the last region.
+      return (regions.empty() ? 0 : regions.back().second) + (frame - offset);
+    }
+
+    std::vector<SpeechRegion> detect_speech(const StorageView& features,
+                                            const WhisperVadOptions& options) {
+      if (features.rank() != 2)
+        throw std::invalid_argument("detect_speech expects features with shape "
+                                    "[n_mels, n_frames], but got "
+                                    + std::to_string(features.rank()) + " dimensions");
+
+      const StorageView cpu_features = features.to(Device::CPU).to_float32();
+      return detect_speech(cpu_features.data<float>(),
+                           cpu_features.dim(0),
+                           cpu_features.dim(1),
+                           options);
+    }
+
+    WhisperSpeechWindows pack_speech(const StorageView& features,
+                                     const WhisperVadOptions& options,
+                                     dim_t window_frames) {
+      if (window_frames <= 0)
+        throw std::invalid_argument("The window size should be greater than 0");
+      if (features.rank() != 2)
+        throw std::invalid_argument("pack_speech expects features with shape "
+                                    "[n_mels, n_frames], but got "
+                                    + std::to_string(features.rank()) + " dimensions");
+
+      const StorageView cpu_features = features.to(Device::CPU).to_float32();
+      const dim_t n_mels = cpu_features.dim(0);
+      const dim_t n_frames = cpu_features.dim(1);
+      const float* data = cpu_features.data<float>();
+
+      WhisperSpeechWindows windows;
+      dim_t remaining_frames = 0;
+
+      for (auto [start, end] : detect_speech(data, n_mels, n_frames, options)) {
+        // Do not split a region that fits in a new window.
+        if (end - start > remaining_frames && end - start <= window_frames)
+          remaining_frames = 0;
+
+        while (start < end) {
+          if (remaining_frames == 0) {
+            windows.regions.emplace_back();
+            remaining_frames = window_frames;
+          }
+
+          const dim_t length = std::min(end - start, remaining_frames);
+          windows.regions.back().emplace_back(start, start + length);
+          remaining_frames -= length;
+          start += length;
+        }
+      }
+
+      // The end of the windows is filled with silence.
+      const dim_t num_windows = windows.regions.size();
+      StorageView packed_features({num_windows, n_mels, window_frames},
+                                  get_silence_value(data, cpu_features.size()));
+
+      for (dim_t w = 0; w < num_windows; ++w)
+        copy_speech_regions(data,
+                            n_mels,
+                            n_frames,
+                            windows.regions[w],
+                            packed_features.index<float>({w, 0, 0}),
+                            window_frames);
+
+      windows.features = packed_features.to(features.device());
+      return windows;
+    }
+
+    float WhisperSpeechWindows::to_input_time(size_t window, float time, bool is_end) const {
+      const dim_t frame = std::lround(time / frame_duration);
+      return to_input_frame(regions.at(window), frame, is_end) * frame_duration;
+    }
+
+
     std::unique_ptr<WhisperReplica> WhisperReplica::create_from_model(const Model& model) {
       if (!dynamic_cast<const WhisperModel*>(&model))
         throw std::invalid_argument("The model is not a Whisper model");
@@ -220,6 +460,8 @@ namespace ctranslate2 {
       PROFILE("WhisperReplica::generate");
       if (prompts.empty())
         return {};
+      if (options.vad_filter)
+        return generate_with_vad(features, prompts, options);
 
 #ifdef CT2_WITH_CUDA
       const cuda::UseTrueFp16GemmInScope use_true_fp16_gemm(false);
@@ -356,6 +598,99 @@ namespace ctranslate2 {
       return final_results;
     }
 
+    std::vector<WhisperGenerationResult>
+    WhisperReplica::generate_with_vad(const StorageView& features,
+                                      const std::vector<std::vector<size_t>>& prompts,
+                                      const WhisperOptions& options) {
+      if (features.rank() != 3)
+        throw std::invalid_argument("Expected features with shape [batch_size, n_mels, "
+                                    "n_frames], but got "
+                                    + std::to_string(features.rank()) + " dimensions");
+
+      size_t sot_index = 0;
+      size_t prompt_length = 0;
+      check_prompts(prompts, _sot_id, _no_timestamps_id, sot_index, prompt_length);
+
+      const StorageView cpu_features = features.to(Device::CPU).to_float32();
+      const dim_t batch_size = cpu_features.dim(0);
+      const dim_t n_mels = cpu_features.dim(1);
+      const dim_t n_frames = cpu_features.dim(2);
+
+      std::vector<std::vector<SpeechRegion>> speech_regions;
+      std::vector<std::vector<size_t>> speech_prompts;
+      std::vector<dim_t> speech_index;
+
+      for (dim_t b = 0; b < batch_size; ++b) {
+        auto regions = detect_speech(cpu_features.index<float>({b, 0, 0}),
+                                     n_mels,
+                                     n_frames,
+                                     options.vad_options);
+        if (regions.empty())
+          continue;
+
+        speech_regions.emplace_back(std::move(regions));
+        speech_prompts.emplace_back(prompts[b]);
+        speech_index.emplace_back(b);
+      }
+
+      // The windows without speech are not encoded.
+      std::vector<WhisperGenerationResult> final_results(batch_size);
+      for (auto& result : final_results) {
+        result.sequences.resize(options.num_hypotheses);
+        result.sequences_ids.resize(options.num_hypotheses);
+        if (options.return_scores)
+          result.scores.resize(options.num_hypotheses, 0.f);
+        if (options.return_no_speech_prob)
+          result.no_speech_prob = 1;
+      }
+
+      if (speech_index.empty())
+        return final_results;
+
+      // Move the silences to the end of each window.
+      const dim_t num_speech = speech_index.size();
+      StorageView speech_features({num_speech, n_mels, n_frames}, DataType::FLOAT32);
+      for (dim_t i = 0; i < num_speech; ++i) {
+        const float* input = cpu_features.index<float>({speech_index[i], 0, 0});
+        float* window = speech_features.index<float>({i, 0, 0});
+        std::fill(window, window + n_mels * n_frames, get_silence_value(input, n_mels * n_frames));
+        copy_speech_regions(input, n_mels, n_frames, speech_regions[i], window, n_frames);
+      }
+
+      WhisperOptions speech_options = options;
+      speech_options.vad_filter = false;
+      auto results = generate(speech_features, speech_prompts, speech_options);
+
+      const auto& vocabulary = _model->get_vocabulary();
+      const size_t timestamp_begin_id = _no_timestamps_id + 1;
+      const size_t timestamp_end_id = vocabulary.size() - 1;
+
+      for (dim_t i = 0; i < num_speech; ++i) {
+        auto& result = results[i];
+
+        // Map the timestamps back to the input features. The timestamps are pairs of
+        // segment start and end.
+        for (auto& ids : result.sequences_ids) {
+          size_t num_timestamps = 0;
+          for (auto& id : ids) {
+            if (id < timestamp_begin_id)
+              continue;
+
+            const bool is_end = num_timestamps++ % 2 == 1;
+            const dim_t frame = (id - timestamp_begin_id) * frames_per_timestamp;
+            const dim_t input_frame = to_input_frame(speech_regions[i], frame, is_end);
+            const size_t timestamp = (input_frame + frames_per_timestamp / 2) / frames_per_timestamp;
+            id = std::min(timestamp_begin_id + timestamp, timestamp_end_id);
+          }
+        }
+
+        result.sequences = vocabulary.to_tokens(result.sequences_ids);
+        final_results[speech_index[i]] = std::move(result);
+      }
+
+      return final_results;
+    }
+
     std::vector<std::vector<std::pair<std::string, float>>>
     WhisperReplica::detect_language(const StorageView& features) {
       if (!is_multilingual())
@@ -427,6 +762,22 @@ namespace ctranslate2 {
       return results;
     }
 
+    void WhisperReplica::run_warmup(size_t batch_size, size_t length, size_t beam_size) {
+      // The encoder only accepts features with a fixed number of frames,
+      // so the length is the number of decoding steps.
+      StorageView features({static_cast<dim_t>(batch_size),
+                            _encoder->input_size(),
+                            _encoder->input_time()},
+                           0.f);
+
+      WhisperOptions options;
+      options.beam_size = beam_size;
+      options.max_length = length + 2;
+
+      const std::vector<std::vector<size_t>> prompts(batch_size, {_sot_id, _no_timestamps_id});
+      generate(features, prompts, options);
+    }
+
 
     bool Whisper::is_multilingual() const {
       const auto& replica = get_first_replica();
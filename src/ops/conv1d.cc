@@ -5,10 +5,14 @@
 namespace ctranslate2 {
   namespace ops {
 
-    Conv1D::Conv1D(dim_t stride, dim_t padding, dim_t dilation)
+    Conv1D::Conv1D(dim_t stride,
+                   dim_t padding,
+                   dim_t dilation,
+                   const ActivationType* activation_type)
       : _stride(stride)
       , _padding(padding)
       , _dilation(dilation)
+      , _activation_type(activation_type)
     {
     }
 
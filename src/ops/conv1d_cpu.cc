@@ -6,6 +6,26 @@
 namespace ctranslate2 {
   namespace ops {
 
+    // Returns false if the activation has no DNNL equivalent.
+    static bool get_eltwise_algorithm(const ActivationType type, dnnl::algorithm& algorithm) {
+      switch (type) {
+      case ActivationType::ReLU:
+        algorithm = dnnl::algorithm::eltwise_relu;
+        return true;
+      case ActivationType::GELU:
+        algorithm = dnnl::algorithm::eltwise_gelu_erf;
+        return true;
+      case ActivationType::GELUTanh:
+        algorithm = dnnl::algorithm::eltwise_gelu_tanh;
+        return true;
+      case ActivationType::Swish:
+        algorithm = dnnl::algorithm::eltwise_swish;
+        return true;
+      default:
+        return false;
+      }
+    }
+
     template<>
     void Conv1D::compute<Device::CPU, float>(const StorageView& input,
                                              const StorageView& weight,
@@ -36,6 +56,20 @@ namespace ctranslate2 {
       dnnl::memory::dims dilation{_dilation > 1 ? _dilation : 0};
       dnnl::memory::dims padding{_padding};
 
+      // The activation is applied by the convolution when DNNL supports it.
+      dnnl::primitive_attr attr;
+      dnnl::algorithm eltwise_algorithm;
+      const bool fused_activation = (_activation_type
+                                     && get_eltwise_algorithm(*_activation_type,
+                                                              eltwise_algorithm));
+      if (fused_activation) {
+        dnnl::post_ops post_ops;
+        post_ops.append_eltwise(eltwise_algorithm,
+                                /*alpha=*/eltwise_algorithm == dnnl::algorithm::eltwise_swish ? 1.f : 0.f,
+                                /*beta=*/0.f);
+        attr.set_post_ops(post_ops);
+      }
+
       std::unique_ptr<dnnl::convolution_forward::primitive_desc> conv_pd;
       std::unordered_map<int, dnnl::memory> args;
       args.reserve(4);
@@ -57,7 +91,8 @@ namespace ctranslate2 {
           stride,
           dilation,
           padding,
-          padding);
+          padding,
+          attr);
 
       } else {
         conv_pd = std::make_unique<dnnl::convolution_forward::primitive_desc>(
@@ -70,7 +105,8 @@ namespace ctranslate2 {
           stride,
           dilation,
           padding,
-          padding);
+          padding,
+          attr);
       }
 
       dnnl::memory conv_input_mem = input_mem;
@@ -106,6 +142,9 @@ namespace ctranslate2 {
       }
 
       engine_stream.wait();
+
+      if (_activation_type && !fused_activation)
+        get_activation_op(*_activation_type)(output, output);
     }
 
   }
@@ -124,11 +163,32 @@ namespace ctranslate2 {
 #  endif
 
 #  include "ctranslate2/ops/transpose.h"
+#  include "ctranslate2/primitives.h"
 #  include "cpu/parallel.h"
 
 namespace ctranslate2 {
   namespace ops {
 
+    static void apply_activation(const ActivationType type, float* x, const dim_t size) {
+      switch (type) {
+      case ActivationType::ReLU:
+        primitives<Device::CPU>::relu(x, x, size);
+        break;
+      case ActivationType::GELUTanh:
+        primitives<Device::CPU>::gelu_tanh(x, x, size);
+        break;
+      case ActivationType::Swish:
+        primitives<Device::CPU>::swish(x, x, size);
+        break;
+      case ActivationType::GELU:
+        primitives<Device::CPU>::gelu(x, x, size);
+        break;
+      case ActivationType::GELUSigmoid:
+        primitives<Device::CPU>::gelu_sigmoid(x, x, size);
+        break;
+      }
+    }
+
     static void conv1d_kernel(const float* input,
                               const float* weight,
                               const float* bias,
@@ -140,7 +200,8 @@ namespace ctranslate2 {
                               dim_t out_channels,
                               dim_t kernel_size,
                               dim_t stride,
-                              dim_t padding) {
+                              dim_t padding,
+                              const ActivationType* activation_type) {
       cpu::parallel_for(0, batch_size * out_channels, 1, [&](dim_t begin, dim_t end) {
         for (dim_t i = begin; i < end; ++i) {
           const dim_t b = i / out_channels;
@@ -174,6 +235,10 @@ namespace ctranslate2 {
 
             y[c_out * output_length + t_out] = value;
           }
+
+          // Apply the activation while the output row is still in cache.
+          if (activation_type)
+            apply_activation(*activation_type, y + c_out * output_length, output_length);
         }
       });
     }
@@ -211,7 +276,8 @@ namespace ctranslate2 {
                     out_channels,
                     kernel_size,
                     _stride,
-                    _padding);
+                    _padding,
+                    _activation_type);
     }
 
   }
@@ -13,13 +13,14 @@ namespace ctranslate2 {
       const dim_t depth = input.dim(-1);
       const dim_t batch_size = input.size() / depth;
 
-      CPU_ISA_DISPATCH((cpu::softmax<ISA>(input.data<T>(),
-                                          lengths ? lengths->data<int32_t>() : nullptr,
-                                          output.data<T>(),
-                                          batch_size,
-                                          depth,
-                                          _log,
-                                          epsilon)));
+      CPU_ISA_FAST_MATH_DISPATCH((cpu::softmax<ISA, FAST_MATH>(
+                                    input.data<T>(),
+                                    lengths ? lengths->data<int32_t>() : nullptr,
+                                    output.data<T>(),
+                                    batch_size,
+                                    depth,
+                                    _log,
+                                    epsilon)));
     }
 
 #define DECLARE_IMPL(T)                                                 \
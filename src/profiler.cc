@@ -6,7 +6,7 @@
 
 namespace ctranslate2 {
 
-  void init_profiling(Device, size_t) {
+  void init_profiling(Device, size_t, bool) {
     throw std::runtime_error("CTranslate2 was not compiled with profiling support, "
                              "enable it with -DENABLE_PROFILING=ON during cmake configuration.");
   }
@@ -19,12 +19,24 @@ namespace ctranslate2 {
 #else
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iomanip>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <vector>
 #include <unordered_map>
 
+#ifdef __linux__
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
 namespace ctranslate2 {
 
   static void print_as_percentage(std::ostream& os, double ratio) {
@@ -33,16 +45,148 @@ namespace ctranslate2 {
   }
 
 
+  static constexpr size_t num_hardware_counters = std::tuple_size<HardwareCounterValues>::value;
+  static const std::array<const char*, num_hardware_counters> hardware_counter_names = {
+    "cycles",
+    "instructions",
+    "LLC-misses",
+    "dTLB-misses",
+    "branch-misses",
+  };
+
+  // Hardware counters of the calling thread. The available counters are opened in a single
+  // perf event group so that they are enabled and read together.
+  class ThreadCounters {
+  public:
+    ThreadCounters() {
+      _fds.fill(-1);
+      _errors.fill("not supported on this platform");
+
+#ifdef __linux__
+      static const std::array<std::pair<uint32_t, uint64_t>, num_hardware_counters> events = {{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HW_CACHE, (PERF_COUNT_HW_CACHE_DTLB
+                              | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                              | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      }};
+
+      for (size_t i = 0; i < num_hardware_counters; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof (attr));
+        attr.size = sizeof (attr);
+        attr.type = events[i].first;
+        attr.config = events[i].second;
+        attr.disabled = (_group_fd < 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = (PERF_FORMAT_GROUP
+                            | PERF_FORMAT_TOTAL_TIME_ENABLED
+                            | PERF_FORMAT_TOTAL_TIME_RUNNING);
+
+        const int fd = syscall(SYS_perf_event_open, &attr, 0, -1, _group_fd, 0);
+        if (fd < 0) {
+          _errors[i] = std::strerror(errno);
+          continue;
+        }
+
+        _fds[i] = fd;
+        _errors[i].clear();
+        _group_order.push_back(i);
+        if (_group_fd < 0)
+          _group_fd = fd;
+      }
+
+      if (_group_fd >= 0)
+        ioctl(_group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    ~ThreadCounters() {
+#ifdef __linux__
+      for (const int fd : _fds) {
+        if (fd >= 0)
+          close(fd);
+      }
+#endif
+    }
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+    bool available(size_t counter) const {
+      return _fds[counter] >= 0;
+    }
+
+    // Reason why the counter is not available.
+    const std::string& error(size_t counter) const {
+      return _errors[counter];
+    }
+
+    // The values are scaled when the kernel multiplexes the counters.
+    HardwareCounterValues read() const {
+      HardwareCounterValues values{};
+#ifdef __linux__
+      if (_group_fd < 0)
+        return values;
+
+      // Layout: number of events, time enabled, time running, and the event values.
+      std::array<uint64_t, 3 + num_hardware_counters> buffer{};
+      if (::read(_group_fd, buffer.data(), sizeof (buffer)) <= 0)
+        return values;
+
+      const uint64_t time_enabled = buffer[1];
+      const uint64_t time_running = buffer[2];
+      const double scale = (time_running > 0 && time_running < time_enabled
+                            ? double(time_enabled) / double(time_running)
+                            : 1.0);
+      for (size_t i = 0; i < _group_order.size(); ++i)
+        values[_group_order[i]] = static_cast<uint64_t>(buffer[3 + i] * scale);
+#endif
+      return values;
+    }
+
+  private:
+    std::array<int, num_hardware_counters> _fds;
+    std::array<std::string, num_hardware_counters> _errors;
+    std::vector<size_t> _group_order;
+    int _group_fd = -1;
+  };
+
+  // Sequential index of the current thread, used to report the counters per thread.
+  static size_t get_thread_index() {
+    static std::atomic<size_t> num_threads(0);
+    static thread_local const size_t thread_index = num_threads++;
+    return thread_index;
+  }
+
+  static ThreadCounters& get_thread_counters() {
+    static thread_local ThreadCounters counters;
+    return counters;
+  }
+
+
+  struct ThreadScopeCounters {
+    HardwareCounterValues values{};
+    // Counters that could be opened in this thread.
+    std::array<bool, num_hardware_counters> available{};
+  };
+
   class ScopeProfile {
   public:
     std::chrono::microseconds time_in_scope;
     std::chrono::microseconds time_in_scope_and_callees;
+    // Hardware events in the scope (excluding callees) per thread index.
+    std::map<size_t, ThreadScopeCounters> counters_in_scope;
   };
 
   class Profiler {
   private:
     Device _device;
     size_t _num_threads;
+    bool _count_hardware_events = false;
     std::chrono::high_resolution_clock::time_point _global_start;
     std::unordered_map<std::string, ScopeProfile> _cumulated;
     std::mutex _mutex;
@@ -55,19 +199,47 @@ namespace ctranslate2 {
     }
 
   public:
-    Profiler(Device device, size_t num_threads)
+    Profiler(Device device, size_t num_threads, bool hardware_counters)
       : _device(device)
       , _num_threads(num_threads)
       , _global_start(std::chrono::high_resolution_clock::now()) {
+      if (!hardware_counters)
+        return;
+
+      // The counters are opened again in each thread, which can fail for some of them (e.g.
+      // when reaching the file descriptor limit), so their availability is also recorded
+      // per thread with the values.
+      const auto& counters = get_thread_counters();
+      for (size_t i = 0; i < num_hardware_counters; ++i) {
+        if (counters.available(i))
+          _count_hardware_events = true;
+      }
+
+      if (!_count_hardware_events) {
+        spdlog::warn("Hardware counters are unavailable ({}), only the time is profiled",
+                     counters.error(0));
+        return;
+      }
+
+      for (size_t i = 0; i < num_hardware_counters; ++i) {
+        if (!counters.available(i))
+          spdlog::warn("Hardware counter {} is unavailable: {}",
+                       hardware_counter_names[i], counters.error(i));
+      }
     }
 
     Device device() const {
       return _device;
     }
 
+    bool count_hardware_events() const {
+      return _count_hardware_events;
+    }
+
     void add_scope_time(const std::string& name,
                         const std::chrono::microseconds& elapsed,
-                        const std::string* parent_name) {
+                        const std::string* parent_name,
+                        const HardwareCounterValues* counters = nullptr) {
       std::lock_guard<std::mutex> lock(_mutex);
       auto& scope_profile = get_scope_profile(name);
       scope_profile.time_in_scope += elapsed;
@@ -76,6 +248,24 @@ namespace ctranslate2 {
         auto& parent_scope_profile = get_scope_profile(*parent_name);
         parent_scope_profile.time_in_scope -= elapsed;
       }
+
+      if (counters) {
+        // The parent scope is always in the same thread.
+        const size_t thread_index = get_thread_index();
+        const auto& thread_counters = get_thread_counters();
+        auto& scope_counters = scope_profile.counters_in_scope[thread_index];
+        for (size_t i = 0; i < num_hardware_counters; ++i) {
+          scope_counters.values[i] += (*counters)[i];
+          scope_counters.available[i] = thread_counters.available(i);
+        }
+        if (parent_name) {
+          auto& parent_counters = get_scope_profile(*parent_name).counters_in_scope[thread_index];
+          for (size_t i = 0; i < num_hardware_counters; ++i) {
+            parent_counters.values[i] -= (*counters)[i];
+            parent_counters.available[i] = thread_counters.available(i);
+          }
+        }
+      }
     }
 
     void dump(std::ostream& os) const {
@@ -121,6 +311,46 @@ namespace ctranslate2 {
            << ' ' << (time_in_scope_us / 1000) << "ms"
            << std::endl;
       }
+
+      if (_count_hardware_events)
+        dump_counters(os, sorted_cumulated);
+    }
+
+  private:
+    void dump_counters(std::ostream& os,
+                       const std::vector<std::pair<std::string, ScopeProfile>>& scopes) const {
+      constexpr int width = 14;
+
+      os << std::endl << "Hardware counters (excluding callees):" << std::endl;
+      os << std::right << std::setw(6) << "thread";
+      for (const auto* counter_name : hardware_counter_names)
+        os << ' ' << std::setw(width) << counter_name;
+      os << ' ' << std::setw(6) << "IPC" << ' ' << "scope" << std::endl;
+
+      for (const auto& pair : scopes) {
+        for (const auto& thread_counters : pair.second.counters_in_scope) {
+          const auto& values = thread_counters.second.values;
+          const auto& available = thread_counters.second.available;
+
+          os << std::right << std::setw(6) << thread_counters.first;
+          for (size_t i = 0; i < num_hardware_counters; ++i) {
+            os << ' ' << std::setw(width);
+            // The counts excluding callees can be slightly negative due to multiplexing.
+            if (available[i])
+              os << static_cast<int64_t>(values[i]);
+            else
+              os << '-';
+          }
+
+          os << ' ' << std::setw(6);
+          if (available[0] && available[1] && values[0] > 0)
+            os << std::fixed << std::setprecision(2) << double(values[1]) / double(values[0]);
+          else
+            os << '-';
+
+          os << ' ' << pair.first << std::endl;
+        }
+      }
     }
   };
 
@@ -128,8 +358,8 @@ namespace ctranslate2 {
   static std::unique_ptr<Profiler> profiler;
 
 
-  void init_profiling(Device device, size_t num_threads) {
-    profiler = std::make_unique<Profiler>(device, num_threads);
+  void init_profiling(Device device, size_t num_threads, bool hardware_counters) {
+    profiler = std::make_unique<Profiler>(device, num_threads, hardware_counters);
   }
 
   void dump_profiling(std::ostream& os) {
@@ -148,8 +378,11 @@ namespace ctranslate2 {
       return;
     _parent = current_scope;
     _name = name;
+    _count_hardware_events = profiler->count_hardware_events();
     synchronize_stream(profiler->device());
     _start = std::chrono::high_resolution_clock::now();
+    if (_count_hardware_events)
+      _start_counters = get_thread_counters().read();
     current_scope = this;
   }
 
@@ -157,9 +390,20 @@ namespace ctranslate2 {
     if (!profiler)
       return;
     synchronize_stream(profiler->device());
+
+    HardwareCounterValues counters;
+    if (_count_hardware_events) {
+      counters = get_thread_counters().read();
+      for (size_t i = 0; i < num_hardware_counters; ++i)
+        counters[i] -= _start_counters[i];
+    }
+
     auto diff = std::chrono::high_resolution_clock::now() - _start;
     auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(diff);
-    profiler->add_scope_time(_name, elapsed, _parent ? &_parent->_name : nullptr);
+    profiler->add_scope_time(_name,
+                             elapsed,
+                             _parent ? &_parent->_name : nullptr,
+                             _count_hardware_events ? &counters : nullptr);
     current_scope = _parent;
   }
 
@@ -1,5 +1,7 @@
 #include "ctranslate2/thread_pool.h"
 
+#include <algorithm>
+
 #include "ctranslate2/utils.h"
 
 namespace ctranslate2 {
@@ -14,6 +16,14 @@ namespace ctranslate2 {
     *_counter += 1;
   }
 
+  void Job::set_worker(const Worker* worker) {
+    _worker = worker;
+  }
+
+  const Worker* Job::worker() const {
+    return _worker;
+  }
+
 
   JobQueue::JobQueue(size_t maximum_size)
     : _maximum_size(maximum_size)
@@ -30,31 +40,46 @@ namespace ctranslate2 {
     return _queue.size();
   }
 
-  bool JobQueue::can_get_job() const {
-    return !_queue.empty() || _request_end;
+  std::deque<std::unique_ptr<Job>>::iterator JobQueue::find_job(const Worker* worker) {
+    return std::find_if(_queue.begin(), _queue.end(),
+                        [worker](const std::unique_ptr<Job>& job) {
+                          return !job->worker() || !worker || job->worker() == worker;
+                        });
   }
 
   void JobQueue::put(std::unique_ptr<Job> job) {
     std::unique_lock<std::mutex> lock(_mutex);
     _can_put_job.wait(lock, [this]{ return _queue.size() < _maximum_size; });
 
-    _queue.emplace(std::move(job));
+    // A job restricted to a worker could wake up another worker, so notify all of them.
+    const bool notify_all = job->worker() != nullptr;
+    _queue.emplace_back(std::move(job));
     lock.unlock();
-    _can_get_job.notify_one();
+
+    if (notify_all)
+      _can_get_job.notify_all();
+    else
+      _can_get_job.notify_one();
   }
 
-  std::unique_ptr<Job> JobQueue::get(const std::function<void()>& before_wait) {
+  std::unique_ptr<Job> JobQueue::get(const std::function<void()>& before_wait,
+                                     const Worker* worker) {
     std::unique_lock<std::mutex> lock(_mutex);
 
-    if (!can_get_job()) {
+    auto it = find_job(worker);
+
+    if (it == _queue.end() && !_request_end) {
       if (before_wait)
         before_wait();
-      _can_get_job.wait(lock, [this]{ return can_get_job(); });
+      _can_get_job.wait(lock, [this, worker, &it]{
+        it = find_job(worker);
+        return it != _queue.end() || _request_end;
+      });
     }
 
-    if (!_queue.empty()) {
-      auto job = std::move(_queue.front());
-      _queue.pop();
+    if (it != _queue.end()) {
+      auto job = std::move(*it);
+      _queue.erase(it);
       lock.unlock();
       _can_put_job.notify_one();
       return job;
@@ -113,7 +138,7 @@ namespace ctranslate2 {
     const std::function<void()> before_wait = [this]{ return idle(); };
 
     while (true) {
-      auto job = job_queue.get(before_wait);
+      auto job = job_queue.get(before_wait, this);
       if (!job)
         break;
       job->run();
@@ -161,6 +186,11 @@ namespace ctranslate2 {
     _queue.put(std::move(job));
   }
 
+  void ThreadPool::post(std::unique_ptr<Job> job, size_t worker_index) {
+    job->set_worker(_workers.at(worker_index).get());
+    post(std::move(job));
+  }
+
   size_t ThreadPool::num_threads() const {
     return _workers.size();
   }
@@ -183,4 +213,8 @@ namespace ctranslate2 {
     return *local_worker;
   }
 
+  bool ThreadPool::is_local_worker(size_t index) const {
+    return local_worker && local_worker == _workers.at(index).get();
+  }
+
 }
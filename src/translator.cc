@@ -24,7 +24,16 @@ namespace ctranslate2 {
       batch_type,
       [options](models::SequenceToSequenceReplica& model, const Batch& batch) {
         return run_translation(model, batch, options);
-      });
+      },
+      get_translation_memory_estimator(options));
+  }
+
+  Translator::MemoryEstimateFunc
+  Translator::get_translation_memory_estimator(const TranslationOptions& options) const {
+    return get_decoding_memory_estimator(std::max(options.beam_size, options.num_hypotheses),
+                                         options.max_decoding_length,
+                                         options.max_input_length,
+                                         options.two_stage_candidates);
   }
 
   std::vector<std::future<ScoringResult>>
@@ -42,6 +51,43 @@ namespace ctranslate2 {
       });
   }
 
+  std::unique_ptr<ResultIterator<TranslationResult>>
+  Translator::translate_iterable(std::unique_ptr<BatchReader> reader,
+                                 const TranslationOptions& options,
+                                 size_t max_batch_size,
+                                 size_t read_batch_size,
+                                 BatchType batch_type,
+                                 size_t max_batches_per_replica) {
+    return post_stream<TranslationResult>(
+      std::move(reader),
+      [options](models::SequenceToSequenceReplica& model, const Batch& batch) {
+        return run_translation(model, batch, options);
+      },
+      max_batch_size,
+      read_batch_size,
+      batch_type,
+      max_batches_per_replica,
+      get_translation_memory_estimator(options));
+  }
+
+  std::unique_ptr<ResultIterator<ScoringResult>>
+  Translator::score_iterable(std::unique_ptr<BatchReader> reader,
+                             const ScoringOptions& options,
+                             size_t max_batch_size,
+                             size_t read_batch_size,
+                             BatchType batch_type,
+                             size_t max_batches_per_replica) {
+    return post_stream<ScoringResult>(
+      std::move(reader),
+      [options](models::SequenceToSequenceReplica& model, const Batch& batch) {
+        return run_scoring(model, batch, options);
+      },
+      max_batch_size,
+      read_batch_size,
+      batch_type,
+      max_batches_per_replica);
+  }
+
   std::vector<TranslationResult>
   Translator::translate_batch(const std::vector<std::vector<std::string>>& source,
                                   const TranslationOptions& options,
@@ -0,0 +1,378 @@
+#include "ctranslate2/tuning.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+namespace ctranslate2 {
+
+  TuningProfile TuningProfile::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file)
+      throw std::runtime_error("Unable to open tuning profile " + path);
+
+    const auto json = nlohmann::json::parse(file);
+
+    TuningProfile profile;
+    profile.device = str_to_device(json.value("device", device_to_str(profile.device)));
+    profile.inter_threads = json.value("inter_threads", profile.inter_threads);
+    profile.intra_threads = json.value("intra_threads", profile.intra_threads);
+    profile.max_batch_size = json.value("max_batch_size", profile.max_batch_size);
+    profile.compute_type = str_to_compute_type(
+      json.value("compute_type", compute_type_to_str(profile.compute_type)));
+    profile.concurrency = json.value("concurrency", profile.concurrency);
+    profile.examples_per_second = json.value("examples_per_second", profile.examples_per_second);
+    profile.tokens_per_second = json.value("tokens_per_second", profile.tokens_per_second);
+    profile.latency_p50_ms = json.value("latency_p50_ms", profile.latency_p50_ms);
+    profile.latency_p99_ms = json.value("latency_p99_ms", profile.latency_p99_ms);
+    return profile;
+  }
+
+  void TuningProfile::save(const std::string& path) const {
+    const nlohmann::json json = {
+      {"device", device_to_str(device)},
+      {"inter_threads", inter_threads},
+      {"intra_threads", intra_threads},
+      {"max_batch_size", max_batch_size},
+      {"compute_type", compute_type_to_str(compute_type)},
+      {"concurrency", concurrency},
+      {"examples_per_second", examples_per_second},
+      {"tokens_per_second", tokens_per_second},
+      {"latency_p50_ms", latency_p50_ms},
+      {"latency_p99_ms", latency_p99_ms},
+    };
+
+    std::ofstream file(path);
+    if (!file)
+      throw std::runtime_error("Unable to write tuning profile " + path);
+    file << json.dump(2) << std::endl;
+  }
+
+  void TuningProfile::apply(models::ModelLoader& model_loader, ReplicaPoolConfig& config) const {
+    if (model_loader.device != device)
+      throw std::invalid_argument("The tuning profile was created for the device "
+                                  + device_to_str(device)
+                                  + " but the model is loaded on the device "
+                                  + device_to_str(model_loader.device));
+
+    model_loader.num_replicas_per_device = inter_threads;
+    model_loader.compute_type = compute_type;
+    config.num_threads_per_replica = intra_threads;
+    config.max_batch_size = max_batch_size;
+  }
+
+
+  static std::vector<std::pair<size_t, size_t>>
+  get_thread_configurations(const Device device, const TuningOptions& options) {
+    const size_t num_cores = std::max(std::thread::hardware_concurrency(), 1u);
+    const auto other_threads = [num_cores](size_t threads) {
+      return std::max(num_cores / std::max(threads, size_t(1)), size_t(1));
+    };
+
+    std::vector<std::pair<size_t, size_t>> configurations;
+
+    if (device == Device::CUDA) {
+      // Replicas on GPU use a single thread.
+      for (const size_t inter : (options.inter_threads.empty()
+                                 ? std::vector<size_t>{1, 2}
+                                 : options.inter_threads))
+        configurations.emplace_back(inter, 1);
+    } else if (!options.inter_threads.empty() && !options.intra_threads.empty()) {
+      for (const size_t inter : options.inter_threads) {
+        for (const size_t intra : options.intra_threads)
+          configurations.emplace_back(inter, intra);
+      }
+    } else if (!options.inter_threads.empty()) {
+      for (const size_t inter : options.inter_threads)
+        configurations.emplace_back(inter, other_threads(inter));
+    } else if (!options.intra_threads.empty()) {
+      for (const size_t intra : options.intra_threads)
+        configurations.emplace_back(other_threads(intra), intra);
+    } else {
+      for (size_t inter = 1; inter <= num_cores; inter *= 2)
+        configurations.emplace_back(inter, other_threads(inter));
+    }
+
+    std::sort(configurations.begin(), configurations.end());
+    configurations.erase(std::unique(configurations.begin(), configurations.end()),
+                         configurations.end());
+    return configurations;
+  }
+
+  static bool is_special_token(const std::string& token) {
+    return token.size() > 2 && token.front() == '<' && token.back() == '>';
+  }
+
+  static std::vector<std::vector<std::string>>
+  make_synthetic_inputs(models::ModelReader& model_reader,
+                        const std::vector<std::string>& vocabulary_files,
+                        const TuningOptions& options) {
+    std::unique_ptr<std::istream> vocabulary_file;
+    for (const auto& filename : vocabulary_files) {
+      vocabulary_file = model_reader.get_file(filename);
+      if (vocabulary_file)
+        break;
+    }
+
+    if (!vocabulary_file)
+      throw std::invalid_argument("Unable to read the vocabulary of the model "
+                                  + model_reader.get_model_id()
+                                  + " to generate a synthetic workload. "
+                                  "Please pass the inputs to tune with.");
+
+    const Vocabulary vocabulary(*vocabulary_file);
+
+    std::vector<size_t> candidates;
+    candidates.reserve(vocabulary.size());
+    for (size_t i = 0; i < vocabulary.size(); ++i) {
+      if (!is_special_token(vocabulary.to_token(i)))
+        candidates.emplace_back(i);
+    }
+
+    if (candidates.empty())
+      throw std::invalid_argument("The vocabulary of the model has no regular tokens");
+
+    std::mt19937 generator(options.seed);
+    std::uniform_int_distribution<size_t> distribution(0, candidates.size() - 1);
+
+    std::vector<std::vector<std::string>> inputs(options.num_synthetic_examples);
+    for (auto& input : inputs) {
+      input.reserve(options.synthetic_length);
+      for (size_t t = 0; t < options.synthetic_length; ++t)
+        input.emplace_back(vocabulary.to_token(candidates[distribution(generator)]));
+    }
+
+    return inputs;
+  }
+
+  // The generation result includes the prompt, except the start token when it is the
+  // BOS token, so the prompt tokens are not counted as generated tokens.
+  static size_t count_generated_tokens(const std::vector<std::string>& prompt,
+                                       const std::vector<std::string>& sequence) {
+    size_t num_prompt_tokens = prompt.size();
+    if (num_prompt_tokens > 0 && (sequence.empty() || sequence.front() != prompt.front()))
+      --num_prompt_tokens;
+    return sequence.size() > num_prompt_tokens ? sequence.size() - num_prompt_tokens : 0;
+  }
+
+  static double get_percentile(const std::vector<double>& sorted_values, double percentile) {
+    const size_t rank = static_cast<size_t>(std::ceil(percentile * sorted_values.size()));
+    return sorted_values[std::min(std::max(rank, size_t(1)), sorted_values.size()) - 1];
+  }
+
+  // Runs the requests from concurrent clients and fills the measurements of the profile.
+  // RunRequest has the signature: size_t(Pool&, const std::vector<std::vector<std::string>>&)
+  // and returns the number of generated tokens.
+  template <typename Pool, typename RunRequest>
+  static void measure(Pool& pool,
+                      const std::vector<std::vector<std::string>>& inputs,
+                      const TuningOptions& options,
+                      const RunRequest& run_request,
+                      TuningProfile& profile) {
+    const size_t num_requests = std::max(options.num_requests, size_t(1));
+    const size_t concurrency = std::max(options.concurrency, size_t(1));
+    const size_t batch_size = std::max(profile.max_batch_size, size_t(1));
+
+    std::vector<double> latencies(num_requests);
+    std::vector<size_t> num_tokens(num_requests);
+    std::atomic<size_t> next_request(0);
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+
+    auto client = [&]() {
+      try {
+        while (true) {
+          const size_t request = next_request++;
+          if (request >= num_requests)
+            break;
+
+          std::vector<std::vector<std::string>> batch;
+          batch.reserve(batch_size);
+          for (size_t i = 0; i < batch_size; ++i)
+            batch.emplace_back(inputs[(request * batch_size + i) % inputs.size()]);
+
+          const auto start = std::chrono::steady_clock::now();
+          num_tokens[request] = run_request(pool, batch);
+          const auto end = std::chrono::steady_clock::now();
+          latencies[request] = std::chrono::duration<double, std::milli>(end - start).count();
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(exception_mutex);
+        exception = std::current_exception();
+        next_request = num_requests;
+      }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    clients.reserve(concurrency);
+    for (size_t i = 0; i < concurrency; ++i)
+      clients.emplace_back(client);
+    for (auto& thread : clients)
+      thread.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    if (exception)
+      std::rethrow_exception(exception);
+
+    const double elapsed = std::chrono::duration<double>(end - start).count();
+    size_t total_tokens = 0;
+    for (const size_t tokens : num_tokens)
+      total_tokens += tokens;
+
+    std::sort(latencies.begin(), latencies.end());
+
+    profile.concurrency = concurrency;
+    profile.examples_per_second = static_cast<double>(num_requests * batch_size) / elapsed;
+    profile.tokens_per_second = static_cast<double>(total_tokens) / elapsed;
+    profile.latency_p50_ms = get_percentile(latencies, 0.5);
+    profile.latency_p99_ms = get_percentile(latencies, 0.99);
+  }
+
+  static const TuningProfile& select_best(const std::vector<TuningProfile>& candidates,
+                                          const double max_latency_p99_ms) {
+    const TuningProfile* best = nullptr;
+
+    for (const auto& candidate : candidates) {
+      if (max_latency_p99_ms > 0 && candidate.latency_p99_ms > max_latency_p99_ms)
+        continue;
+      if (!best || candidate.tokens_per_second > best->tokens_per_second)
+        best = &candidate;
+    }
+
+    if (!best) {
+      best = &*std::min_element(candidates.begin(), candidates.end(),
+                                [](const TuningProfile& a, const TuningProfile& b) {
+                                  return a.latency_p99_ms < b.latency_p99_ms;
+                                });
+      spdlog::warn("No configuration has a p99 latency below {} ms, selecting the "
+                   "configuration with the lowest latency ({:.1f} ms)",
+                   max_latency_p99_ms,
+                   best->latency_p99_ms);
+    }
+
+    return *best;
+  }
+
+  template <typename Pool, typename RunRequest>
+  static TuningResult tune(const models::ModelLoader& model_loader,
+                           const TuningOptions& options,
+                           const std::vector<std::vector<std::string>>& inputs,
+                           const RunRequest& run_request) {
+    if (inputs.empty())
+      throw std::invalid_argument("The tuning workload is empty");
+
+    std::vector<size_t> max_batch_sizes = options.max_batch_sizes;
+    if (max_batch_sizes.empty())
+      max_batch_sizes = {1, 4, 16, 32};
+
+    std::vector<ComputeType> compute_types = options.compute_types;
+    if (compute_types.empty())
+      compute_types = {model_loader.compute_type};
+
+    TuningResult result;
+
+    for (const ComputeType compute_type : compute_types) {
+      for (const auto& [inter_threads, intra_threads]
+             : get_thread_configurations(model_loader.device, options)) {
+        TuningProfile profile;
+        profile.device = model_loader.device;
+        profile.inter_threads = inter_threads;
+        profile.intra_threads = intra_threads;
+        profile.compute_type = compute_type;
+
+        models::ModelLoader loader = model_loader;
+        ReplicaPoolConfig config;
+        profile.apply(loader, config);
+
+        std::unique_ptr<Pool> pool;
+        try {
+          pool = std::make_unique<Pool>(loader, config);
+        } catch (const std::exception& e) {
+          spdlog::warn("Skipping compute type {}: {}", compute_type_to_str(compute_type), e.what());
+          break;
+        }
+
+        pool->warmup();
+
+        for (const size_t max_batch_size : max_batch_sizes) {
+          profile.max_batch_size = max_batch_size;
+          measure(*pool, inputs, options, run_request, profile);
+
+          spdlog::info("inter_threads={} intra_threads={} max_batch_size={} compute_type={}: "
+                       "{:.1f} tokens/s, {:.1f} examples/s, p50 {:.1f} ms, p99 {:.1f} ms",
+                       profile.inter_threads,
+                       profile.intra_threads,
+                       profile.max_batch_size,
+                       compute_type_to_str(profile.compute_type),
+                       profile.tokens_per_second,
+                       profile.examples_per_second,
+                       profile.latency_p50_ms,
+                       profile.latency_p99_ms);
+
+          result.candidates.emplace_back(profile);
+        }
+      }
+    }
+
+    if (result.candidates.empty())
+      throw std::runtime_error("No configuration could be measured");
+
+    result.best = select_best(result.candidates, options.max_latency_p99_ms);
+    return result;
+  }
+
+  TuningResult tune_translator(const models::ModelLoader& model_loader,
+                               const TranslationOptions& options,
+                               const TuningOptions& tuning_options,
+                               std::vector<std::vector<std::string>> inputs) {
+    if (inputs.empty())
+      inputs = make_synthetic_inputs(*model_loader.model_reader,
+                                     {"shared_vocabulary.txt", "source_vocabulary.txt"},
+                                     tuning_options);
+
+    return tune<Translator>(
+      model_loader,
+      tuning_options,
+      inputs,
+      [&options](Translator& translator, const std::vector<std::vector<std::string>>& batch) {
+        size_t num_tokens = 0;
+        for (const auto& result : translator.translate_batch(batch, options))
+          num_tokens += result.output().size();
+        return num_tokens;
+      });
+  }
+
+  TuningResult tune_generator(const models::ModelLoader& model_loader,
+                              const GenerationOptions& options,
+                              const TuningOptions& tuning_options,
+                              std::vector<std::vector<std::string>> inputs) {
+    if (inputs.empty())
+      inputs = make_synthetic_inputs(*model_loader.model_reader,
+                                     {"vocabulary.txt"},
+                                     tuning_options);
+
+    return tune<Generator>(
+      model_loader,
+      tuning_options,
+      inputs,
+      [&options](Generator& generator, const std::vector<std::vector<std::string>>& batch) {
+        auto futures = generator.generate_batch_async(batch, options);
+        size_t num_tokens = 0;
+        for (size_t i = 0; i < futures.size(); ++i) {
+          const auto result = futures[i].get();
+          if (!result.sequences.empty())
+            num_tokens += count_generated_tokens(batch[i], result.sequences[0]);
+        }
+        return num_tokens;
+      });
+  }
+
+}
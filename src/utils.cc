@@ -34,12 +34,21 @@ namespace ctranslate2 {
                  cpu::cpu_supports_avx(),
                  cpu::cpu_supports_avx2(),
                  cpu::cpu_supports_avx512());
+    spdlog::info(" - Extensions: AVX_VNNI={}, AVX512_VNNI={}, AVX512_BF16={}, "
+                 "AMX_INT8={}, AMX_BF16={}",
+                 cpu::cpu_supports_avx_vnni(),
+                 cpu::cpu_supports_avx512_vnni(),
+                 cpu::cpu_supports_avx512_bf16(),
+                 cpu::cpu_supports_amx_int8(),
+                 cpu::cpu_supports_amx_bf16());
 #elif defined(CT2_ARM64_BUILD)
-    spdlog::info("CPU: {} (NEON={})",
+    spdlog::info("CPU: {} (NEON={}, DOTPROD={})",
                  cpu::cpu_vendor(),
-                 cpu::cpu_supports_neon());
+                 cpu::cpu_supports_neon(),
+                 cpu::cpu_supports_dotprod());
 #endif
     spdlog::info(" - Selected ISA: {}", cpu::isa_to_str(cpu::get_cpu_isa()));
+    spdlog::info(" - Fast math: {}", cpu::use_fast_math());
     spdlog::info(" - Use Intel MKL: {}", cpu::mayiuse_mkl());
     spdlog::info(" - SGEMM backend: {} (packed: {})",
                  cpu::gemm_backend_to_str(cpu::get_gemm_backend(ComputeType::FLOAT32)),
@@ -65,10 +74,26 @@ namespace ctranslate2 {
 #endif
   }
 
+  std::vector<std::string> get_cpu_features() {
+#if defined(CT2_X86_BUILD) || defined(CT2_ARM64_BUILD)
+    return cpu::cpu_features();
+#else
+    return {};
+#endif
+  }
+
   int get_gpu_count() {
     return get_device_count(Device::CUDA);
   }
 
+  void set_cpu_fast_math(bool enable) {
+    cpu::set_fast_math(enable);
+  }
+
+  bool get_cpu_fast_math() {
+    return cpu::use_fast_math();
+  }
+
 #if defined(_OPENMP) || defined(CT2_WITH_RUY)
   static inline size_t get_default_num_threads() {
     constexpr size_t default_num_threads = 4;
@@ -1,11 +1,34 @@
 #include "benchmark_utils.h"
 
+#include <cstdlib>
+#include <new>
 #include <numeric>
 
+#include "ctranslate2/allocator.h"
+#include "ctranslate2/decoding_utils.h"
+#include "ctranslate2/memory_planner.h"
 #include "ctranslate2/ops/ops.h"
 
 using namespace ctranslate2;
 
+static size_t num_heap_allocations = 0;
+
+void* operator new(size_t size) {
+  ++num_heap_allocations;
+  void* ptr = std::malloc(size);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
 void benchmark_gather(Device device) {
   StorageView data({512, 512}, DataType::FLOAT32, device);
   std::vector<int32_t> input_v(250);
@@ -53,6 +76,23 @@ void benchmark_softmax(Device device) {
   BENCHMARK(softmax_op(x, y), 10000);
 }
 
+void benchmark_log_softmax(Device device) {
+  std::vector<float> x_ = rand_vector(100 * 512);
+  StorageView x({100, 512}, x_, device);
+  StorageView y(x.device());
+  const ops::LogSoftMax log_softmax_op{};
+  BENCHMARK(log_softmax_op(x, y), 10000);
+}
+
+void benchmark_activation(Device device, const ops::UnaryOp& op) {
+  std::vector<float> x_ = rand_vector(64 * 1500);
+  for (auto& v : x_)
+    v = std::fmod(v, 16.f) - 8.f;  // Typical range of activation inputs.
+  StorageView x({64, 1500}, x_, device);
+  StorageView y(x.device());
+  BENCHMARK(op(x, y), 2000);
+}
+
 void benchmark_masked_softmax(Device device) {
   const dim_t batch_size = 32;
   const dim_t num_heads = 8;
@@ -114,6 +154,88 @@ void benchmark_conv1d(Device device) {
   BENCHMARK(conv_op(x, weight, bias, y), 100);
 }
 
+void benchmark_shape(Device device) {
+  // Shape updates made by the attention layers and the beam search in a decoding step.
+  const dim_t batch_size = 4;
+  const dim_t beam_size = 4;
+  const dim_t num_heads = 8;
+  const dim_t depth = 64;
+  StorageView x({batch_size * beam_size, 1, num_heads * depth}, DataType::FLOAT32, device);
+
+  auto update_shape = [&]() {
+    x.reshape({batch_size * beam_size, 1, num_heads, depth});
+    x.reshape({batch_size * beam_size, num_heads, depth});
+    x.expand_dims(2);
+    x.squeeze(2);
+    x.reshape({batch_size * beam_size, 1, num_heads * depth});
+    split_batch_beam(x, beam_size);
+    merge_batch_beam(x);
+  };
+
+  const size_t num_heap_allocations_before = num_heap_allocations;
+  update_shape();
+  std::cerr << "heap allocations per call: "
+            << num_heap_allocations - num_heap_allocations_before << std::endl;
+  BENCHMARK(update_shape(), 1000000);
+}
+
+void benchmark_gemv(Device device, DataType dtype) {
+  // Matrix-vector product with large weights, as in a decoding step with a small batch.
+  // The weights are allocated like the model weights: run with CT2_USE_HUGE_PAGES=1 to
+  // measure the effect of huge pages on CPU.
+  DataType output_dtype = dtype != DataType::FLOAT32 ? DataType::INT32 : dtype;
+  StorageView a({1, 4096}, dtype, device);
+  StorageView b(dtype, device);
+  {
+    const ScopedHugePageAllocation scoped_huge_pages(device);
+    b.resize({16384, 4096});
+  }
+  b.zero();  // Touch all pages.
+  StorageView c(output_dtype, device);
+  const ops::Gemm gemm_op(1, 0, false, true);
+  BENCHMARK(gemm_op(a, b, c), 200);
+}
+
+void benchmark_memory_planner(Device device) {
+  // Temporary buffers of a decoding step of a 6-layer Transformer with 16 hypotheses.
+  const dim_t num_hypotheses = 16;
+  const dim_t d_model = 512;
+  const dim_t ffn_size = 2048;
+  const dim_t num_heads = 8;
+  const dim_t length = 64;
+
+  auto run_step = [&]() {
+    for (int layer = 0; layer < 6; ++layer) {
+      StorageView qkv({num_hypotheses, 1, 3 * d_model}, DataType::FLOAT32, device);
+      StorageView scores({num_hypotheses, num_heads, 1, length}, DataType::FLOAT32, device);
+      StorageView probs({num_hypotheses, num_heads, 1, length}, DataType::FLOAT32, device);
+      StorageView context({num_hypotheses, 1, d_model}, DataType::FLOAT32, device);
+      StorageView attention_output({num_hypotheses, 1, d_model}, DataType::FLOAT32, device);
+      StorageView ffn_inner({num_hypotheses, 1, ffn_size}, DataType::FLOAT32, device);
+      StorageView ffn_output({num_hypotheses, 1, d_model}, DataType::FLOAT32, device);
+    }
+  };
+
+  MemoryPlanner planner(device);
+  auto run_planned_step = [&]() {
+    const ScopedMemoryPlan plan(planner, 0);
+    run_step();
+  };
+
+  size_t num_heap_allocations_before = num_heap_allocations;
+  run_step();
+  std::cerr << "device allocator: heap allocations per step: "
+            << num_heap_allocations - num_heap_allocations_before << std::endl;
+  BENCHMARK(run_step(), 100000);
+
+  run_planned_step();  // Record the plan.
+  num_heap_allocations_before = num_heap_allocations;
+  run_planned_step();
+  std::cerr << "memory planner: heap allocations per step: "
+            << num_heap_allocations - num_heap_allocations_before << std::endl;
+  BENCHMARK(run_planned_step(), 100000);
+}
+
 int main(int argc, char* argv[]) {
   if (argc < 3) {
     std::cerr << "usage: " << argv[0] << " op device [dtype]" << std::endl;
@@ -139,18 +261,32 @@ int main(int argc, char* argv[]) {
     benchmark_layer_norm(device);
   else if (op == "softmax")
     benchmark_softmax(device);
+  else if (op == "log_softmax")
+    benchmark_log_softmax(device);
+  else if (op == "gelu")
+    benchmark_activation(device, ops::GELU());
+  else if (op == "tanh")
+    benchmark_activation(device, ops::Tanh());
+  else if (op == "log")
+    benchmark_activation(device, ops::Log());
   else if (op == "masked_softmax")
     benchmark_masked_softmax(device);
   else if (op == "topk")
     benchmark_topk(device);
   else if (op == "gemm")
     benchmark_gemm(device, dtype);
+  else if (op == "gemv")
+    benchmark_gemv(device, dtype);
   else if (op == "quantize")
     benchmark_quantize(device, dtype);
   else if (op == "dequantize")
     benchmark_dequantize(device);
   else if (op == "conv1d")
     benchmark_conv1d(device);
+  else if (op == "shape")
+    benchmark_shape(device);
+  else if (op == "memory_planner")
+    benchmark_memory_planner(device);
 
   return 0;
 }
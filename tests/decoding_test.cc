@@ -14,3 +14,25 @@ TEST(DecodingTest, DisableTokens) {
 
   expect_storage_eq(input, expected);
 }
+
+TEST(DecodingTest, StopSequences) {
+  const StopSequences stop_sequences({{1, 2, 3}, {2, 4}, {5}});
+
+  auto match = [&stop_sequences](const std::vector<size_t>& ids) {
+    int32_t state = StopSequences::initial_state;
+    for (const size_t id : ids) {
+      state = stop_sequences.next_state(state, id);
+      if (stop_sequences.is_match(state))
+        return true;
+    }
+    return false;
+  };
+
+  EXPECT_TRUE(match({1, 2, 3}));
+  EXPECT_TRUE(match({0, 1, 1, 2, 3}));
+  EXPECT_TRUE(match({1, 2, 4}));
+  EXPECT_TRUE(match({3, 5}));
+  EXPECT_FALSE(match({1, 2}));
+  EXPECT_FALSE(match({1, 3, 2, 0, 4}));
+  EXPECT_FALSE(match({}));
+}
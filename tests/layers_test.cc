@@ -2,6 +2,8 @@
 #include "ctranslate2/layers/layers.h"
 #include "ctranslate2/padder.h"
 
+#include "cpu/backend.h"
+
 TEST(LayerTest, MakeRelativePositions1D) {
   const StorageView positions = layers::make_relative_positions(4, 2, true);
   const StorageView expected({1, 4}, std::vector<int32_t>{0, 0, 1, 2});
@@ -18,6 +20,39 @@ TEST(LayerTest, MakeRelativePositions2D) {
   expect_storage_eq(positions, expected);
 }
 
+TEST(LayerTest, RelativePositionCacheWithCache) {
+  layers::RelativePositionCache cache;
+  for (const dim_t length : {3, 1, 6, 4}) {
+    const StorageView& positions = cache.positions(length, 2, true, Device::CPU);
+    expect_storage_eq(positions, layers::make_relative_positions(length, 2, true));
+  }
+}
+
+TEST(LayerTest, RelativeAttentionBiasIncremental) {
+  const dim_t num_buckets = 8;
+  const dim_t num_heads = 2;
+  std::vector<float> weights(num_buckets * num_heads);
+  for (size_t i = 0; i < weights.size(); ++i)
+    weights[i] = i;
+  const StorageView relative_attention_bias({num_buckets, num_heads}, weights);
+
+  const dim_t length = 12;
+  layers::RelativePositionCache full_cache;
+  const StorageView full = full_cache.bias(relative_attention_bias, length, length, 6, false);
+  ASSERT_EQ(full.shape(), Shape({num_heads, length, length}));
+
+  layers::RelativePositionCache step_cache;
+  for (dim_t step = 0; step < length; ++step) {
+    const dim_t key_length = step + 1;
+    const StorageView& bias = step_cache.bias(relative_attention_bias, 1, key_length, 6, false, step);
+    ASSERT_EQ(bias.shape(), Shape({num_heads, 1, key_length}));
+    for (dim_t h = 0; h < num_heads; ++h) {
+      for (dim_t j = 0; j < key_length; ++j)
+        EXPECT_EQ(bias.at<float>({h, 0, j}), full.at<float>({h, step, j}));
+    }
+  }
+}
+
 TEST(LayerTest, Padder) {
   const StorageView lengths({3}, std::vector<int32_t>{2, 3, 1});
   const Padder padder(lengths, /*max_time=*/4);
@@ -84,3 +119,177 @@ TEST(LayerTest, PositionEncoderNoSharedState) {
     expect_storage_eq(input, expected, 1e-5);
   }
 }
+
+// Model holding a single convolution with int8 weights, as quantized at load time.
+class QuantizedConv1DModel : public models::Model {
+public:
+  QuantizedConv1DModel(const StorageView& weight, const StorageView& bias) {
+    const dim_t out_channels = weight.dim(0);
+    const dim_t window_size = weight.size() / out_channels;
+
+    StorageView weight_2d(weight);
+    weight_2d.reshape({out_channels, window_size});
+    StorageView qweight(DataType::INT8);
+    StorageView qscale(DataType::FLOAT32);
+    ops::Quantize()(weight_2d, qweight, qscale);
+
+    if (cpu::prefer_u8s8s32_gemm())
+      register_variable("conv/weight_compensation",
+                        ops::Gemm::compensate_u8_input(qweight, true, window_size, out_channels, 1));
+
+    qweight.reshape(weight.shape());
+    register_variable("conv/weight", std::move(qweight));
+    register_variable("conv/weight_scale", std::move(qscale));
+    register_variable("conv/bias", bias);
+  }
+
+protected:
+  std::unique_ptr<models::Model> clone() const override {
+    return std::make_unique<QuantizedConv1DModel>(*this);
+  }
+};
+
+TEST(LayerTest, Conv1DInt8) {
+  if (!mayiuse_int8(Device::CPU))
+    GTEST_SKIP() << "INT8 GEMM is not supported on this CPU";
+
+  const dim_t batch_size = 2;
+  const dim_t in_channels = 8;
+  const dim_t out_channels = 6;
+  const dim_t kernel_size = 3;
+  const dim_t input_length = 10;
+
+  std::vector<float> input_values(batch_size * in_channels * input_length);
+  std::vector<float> weight_values(out_channels * in_channels * kernel_size);
+  std::vector<float> bias_values(out_channels);
+  for (size_t i = 0; i < input_values.size(); ++i)
+    input_values[i] = std::sin(0.37f * i);
+  for (size_t i = 0; i < weight_values.size(); ++i)
+    weight_values[i] = 0.5f * std::cos(0.23f * i);
+  for (size_t i = 0; i < bias_values.size(); ++i)
+    bias_values[i] = 0.1f * i - 0.2f;
+
+  const StorageView input({batch_size, in_channels, input_length}, input_values);
+  const StorageView weight({out_channels, in_channels, kernel_size}, weight_values);
+  const StorageView bias({out_channels}, bias_values);
+  const ops::ActivationType activation_type = ops::ActivationType::GELU;
+
+  StorageView expected;
+  ops::Conv1D(/*stride=*/2, /*padding=*/1, /*dilation=*/1, &activation_type)(input,
+                                                                             weight,
+                                                                             bias,
+                                                                             expected);
+
+  const QuantizedConv1DModel model(weight, bias);
+  const layers::Conv1D conv(model, "conv", /*stride=*/2, /*padding=*/1, /*dilation=*/1,
+                            &activation_type);
+  EXPECT_EQ(conv.output_type(), DataType::FLOAT32);
+
+  StorageView output;
+  conv(input, output);
+  ASSERT_EQ(output.shape(), expected.shape());
+  expect_storage_eq(output, expected, 0.05);
+}
+
+TEST(LayerTest, DenseRescoreCandidates) {
+  // The second stage of the two-stage output only runs float operations.
+  const auto model = models::Model::load(default_model_dir());
+  layers::Dense dense(*model, "decoder/projection");
+
+  const dim_t batch_size = 2;
+  const dim_t input_depth = model->get_variable("decoder/projection/weight").dim(1);
+  const dim_t output_depth = dense.output_size();
+  const dim_t num_candidates = 3;
+
+  std::vector<float> input_values(batch_size * input_depth);
+  for (size_t i = 0; i < input_values.size(); ++i)
+    input_values[i] = std::sin(0.37f * i);
+  const StorageView input({batch_size, 1, input_depth}, input_values);
+
+  StorageView expected;
+  dense(input, expected);
+
+  // Approximate outputs ranking the tokens in the reverse order of the exact outputs.
+  std::vector<float> approximate_values = expected.to_vector<float>();
+  for (auto& value : approximate_values)
+    value = -value;
+
+  for (const bool exact_only : {false, true}) {
+    StorageView output({batch_size, 1, output_depth}, approximate_values);
+    dense.rescore_candidates(input, output, num_candidates, exact_only);
+    ASSERT_EQ(output.shape(), expected.shape());
+
+    for (dim_t b = 0; b < batch_size; ++b) {
+      const float* approximate_row = approximate_values.data() + b * output_depth;
+      std::vector<float> sorted(approximate_row, approximate_row + output_depth);
+      std::sort(sorted.begin(), sorted.end(), std::greater<float>());
+      const float min_candidate = sorted[num_candidates - 1];
+
+      for (dim_t i = 0; i < output_depth; ++i) {
+        const dim_t index = b * output_depth + i;
+        const float value = output.at<float>(index);
+        if (approximate_row[i] >= min_candidate)
+          EXPECT_NEAR(value, expected.at<float>(index), 1e-5);
+        else if (exact_only)
+          EXPECT_EQ(value, std::numeric_limits<float>::lowest());
+        else
+          EXPECT_EQ(value, approximate_row[i]);
+      }
+    }
+  }
+}
+
+TEST(LayerTest, DenseTwoStage) {
+  if (!mayiuse_int8(Device::CPU))
+    GTEST_SKIP() << "INT8 GEMM is not supported on this CPU";
+
+  const auto model = models::Model::load(default_model_dir());
+  layers::Dense dense(*model, "decoder/projection");
+  ASSERT_TRUE(dense.supports_two_stage());
+
+  const dim_t batch_size = 2;
+  const dim_t input_depth = model->get_variable("decoder/projection/weight").dim(1);
+  const dim_t output_depth = dense.output_size();
+  const dim_t num_candidates = 8;
+
+  std::vector<float> input_values(batch_size * input_depth);
+  for (size_t i = 0; i < input_values.size(); ++i)
+    input_values[i] = std::sin(0.37f * i);
+  const StorageView input({batch_size, 1, input_depth}, input_values);
+
+  StorageView expected;
+  dense(input, expected);
+
+  for (const bool exact_only : {false, true}) {
+    StorageView output;
+    dense.compute_two_stage(input, output, num_candidates, exact_only);
+    ASSERT_EQ(output.shape(), expected.shape());
+
+    for (dim_t b = 0; b < batch_size; ++b) {
+      const float* output_row = output.data<float>() + b * output_depth;
+      const float* expected_row = expected.data<float>() + b * output_depth;
+      dim_t num_exact = 0;
+
+      for (dim_t i = 0; i < output_depth; ++i) {
+        if (std::abs(output_row[i] - expected_row[i]) < 1e-4)
+          ++num_exact;
+        else if (exact_only)
+          EXPECT_EQ(output_row[i], std::numeric_limits<float>::lowest());
+        else
+          EXPECT_NEAR(output_row[i], expected_row[i], 0.5);
+      }
+
+      EXPECT_GE(num_exact, num_candidates);
+      EXPECT_EQ(std::max_element(output_row, output_row + output_depth) - output_row,
+                std::max_element(expected_row, expected_row + output_depth) - expected_row);
+    }
+  }
+
+  // The INT8 copy is created again after being released.
+  StorageView output;
+  dense.compute_two_stage(input, output, num_candidates, /*exact_only=*/false);
+  dense.release_two_stage();
+  StorageView output_after_release;
+  dense.compute_two_stage(input, output_after_release, num_candidates, /*exact_only=*/false);
+  expect_storage_eq(output_after_release, output);
+}
@@ -1,4 +1,5 @@
 #include <ctranslate2/models/sequence_to_sequence.h>
+#include <ctranslate2/models/whisper.h>
 
 #include <ctranslate2/decoding.h>
 
@@ -139,3 +140,68 @@ TEST(ModelTest, DecoderIterativeSequence) {
     expect_storage_eq(state_sequence[key], state_by_step[key], 1e-5);
   }
 }
+
+static StorageView get_vad_features() {
+  // Silence at -20dB with speech at +20dB in [100, 200) and [300, 350), and a short
+  // burst in [10, 15).
+  const dim_t n_mels = 4;
+  const dim_t n_frames = 400;
+  StorageView features({n_mels, n_frames}, -0.5f);
+  for (dim_t m = 0; m < n_mels; ++m) {
+    for (const auto& [start, end] : {std::make_pair(10, 15),
+                                     std::make_pair(100, 200),
+                                     std::make_pair(300, 350)}) {
+      for (dim_t t = start; t < end; ++t)
+        features.at<float>({m, t}) = 0.5f;
+    }
+  }
+  return features;
+}
+
+TEST(WhisperTest, DetectSpeech) {
+  const auto regions = models::detect_speech(get_vad_features());
+  const std::vector<models::SpeechRegion> expected_regions = {{80, 220}, {280, 370}};
+  EXPECT_EQ(regions, expected_regions);
+
+  models::WhisperVadOptions options;
+  options.min_silence_frames = 101;
+  options.speech_pad_frames = 0;
+  const std::vector<models::SpeechRegion> expected_merged_regions = {{10, 350}};
+  EXPECT_EQ(models::detect_speech(get_vad_features(), options), expected_merged_regions);
+
+  EXPECT_TRUE(models::detect_speech(StorageView({4, 400}, -0.5f)).empty());
+
+  // Continuous speech has no noise floor and is kept entirely.
+  const std::vector<models::SpeechRegion> expected_full_region = {{0, 400}};
+  EXPECT_EQ(models::detect_speech(StorageView({4, 400}, 0.5f)), expected_full_region);
+}
+
+TEST(WhisperTest, PackSpeech) {
+  const StorageView features = get_vad_features();
+  const auto windows = models::pack_speech(features, {}, /*window_frames=*/150);
+
+  // The second region does not fit after the first one and starts a new window.
+  ASSERT_EQ(windows.regions.size(), 2);
+  EXPECT_EQ(windows.features.shape(), Shape({2, 4, 150}));
+  EXPECT_EQ(windows.features.at<float>({0, 0, 19}), -0.5f);
+  EXPECT_EQ(windows.features.at<float>({0, 0, 20}), 0.5f);
+  // The end of the window is filled with the silence of the input.
+  EXPECT_EQ(windows.features.at<float>({0, 0, 140}), -0.5f);
+  EXPECT_EQ(windows.features.at<float>({1, 3, 20}), 0.5f);
+
+  EXPECT_NEAR(windows.to_input_time(0, 0.5f), 1.3f, 1e-6);
+  EXPECT_NEAR(windows.to_input_time(1, 0.5f), 3.3f, 1e-6);
+  EXPECT_NEAR(windows.to_input_time(1, 1.f), 3.8f, 1e-6);
+
+  // Regions longer than a window are split.
+  const auto split_windows = models::pack_speech(features, {}, /*window_frames=*/100);
+  const std::vector<std::vector<models::SpeechRegion>> expected_regions = {
+    {{80, 180}}, {{180, 220}}, {{280, 370}}};
+  EXPECT_EQ(split_windows.regions, expected_regions);
+
+  // A time between two regions is the end of the first region or the start of the second.
+  const auto merged_windows = models::pack_speech(features, {}, /*window_frames=*/300);
+  ASSERT_EQ(merged_windows.regions.size(), 1);
+  EXPECT_NEAR(merged_windows.to_input_time(0, 1.4f), 2.8f, 1e-6);
+  EXPECT_NEAR(merged_windows.to_input_time(0, 1.4f, /*is_end=*/true), 2.2f, 1e-6);
+}
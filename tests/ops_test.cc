@@ -938,6 +938,27 @@ TEST_P(OpDeviceFPTest, Conv1D) {
   expect_storage_eq(output.to_float32(), expected, 1e-3);
 }
 
+TEST_P(OpDeviceFPTest, Conv1DActivation) {
+  const Device device = GetParam().first;
+  if (device == Device::CUDA)
+    GUARD_CONV1D_GPU_TEST;
+  const DataType dtype = GetParam().second;
+  const ops::ActivationType activation_type = ops::ActivationType::GELU;
+  StorageView expected(dtype, device);
+  ops::Conv1D()(conv_input.to(device).to(dtype),
+                conv_weight.to(device).to(dtype),
+                conv_bias.to(device).to(dtype),
+                expected);
+  ops::GELU()(expected, expected);
+  StorageView output(dtype, device);
+  ops::Conv1D(1, 0, 1, &activation_type)(conv_input.to(device).to(dtype),
+                                         conv_weight.to(device).to(dtype),
+                                         conv_bias.to(device).to(dtype),
+                                         output);
+  EXPECT_EQ(output.dtype(), dtype);
+  expect_storage_eq(output.to_float32(), expected.to_float32(), 1e-3);
+}
+
 TEST_P(OpDeviceFPTest, Conv1DNoBias) {
   const Device device = GetParam().first;
   if (device == Device::CUDA)
@@ -1,5 +1,7 @@
 #include "test_utils.h"
+#include "ctranslate2/ops/ops.h"
 #include "ctranslate2/primitives.h"
+#include "ctranslate2/utils.h"
 #include "dispatch.h"
 
 class PrimitiveTest : public ::testing::TestWithParam<Device> {
@@ -22,6 +24,19 @@ TEST_P(PrimitiveTest, IndexedFill) {
   expect_storage_eq(x, expected);
 }
 
+TEST_P(PrimitiveTest, IndexedCopy) {
+  const Device device = GetParam();
+  StorageView x({3}, std::vector<float>{1, 2, 3}, device);
+  StorageView y({6}, float(0), device);
+  StorageView ids({3}, std::vector<int32_t>{4, 0, 2}, device);
+  StorageView expected({6}, std::vector<float>{2, 0, 3, 0, 1, 0}, device);
+  DEVICE_DISPATCH(device, primitives<D>::indexed_copy(x.data<float>(),
+                                                      y.data<float>(),
+                                                      ids.data<int32_t>(),
+                                                      3));
+  expect_storage_eq(y, expected);
+}
+
 TEST_P(PrimitiveTest, LogSumExp) {
   const Device device = GetParam();
   StorageView x({8}, std::vector<float>{0.6, 0.2, -1.2, 0.1, 0.3, 0.5, -1.3, 0.2}, device);
@@ -51,6 +66,98 @@ TEST_P(PrimitiveTest, PenalizePreviousTokens) {
   expect_storage_eq(scores, expected);
 }
 
+// Runs a CPU function with and without the fast math mode.
+template <typename Function>
+static void run_with_fast_math(const Function& func, StorageView& accurate, StorageView& fast) {
+  const bool fast_math = get_cpu_fast_math();
+  set_cpu_fast_math(false);
+  func(accurate);
+  set_cpu_fast_math(true);
+  func(fast);
+  set_cpu_fast_math(fast_math);
+}
+
+static StorageView linspace(float begin, float end, dim_t size) {
+  std::vector<float> values(size);
+  for (dim_t i = 0; i < size; ++i)
+    values[i] = begin + (end - begin) * i / (size - 1);
+  return StorageView({size}, values);
+}
+
+TEST(PrimitiveTest, FastMathExp) {
+  const StorageView x = linspace(-80, 80, 1001);
+  StorageView accurate(x.shape(), DataType::FLOAT32);
+  StorageView fast(x.shape(), DataType::FLOAT32);
+  run_with_fast_math([&x](StorageView& y) {
+    primitives<Device::CPU>::exp(x.data<float>(), y.data<float>(), x.size());
+  }, accurate, fast);
+
+  for (dim_t i = 0; i < x.size(); ++i)
+    EXPECT_NEAR(fast.data<float>()[i] / accurate.data<float>()[i], 1.f, 2e-5)
+      << "Relative difference too large for exp(" << x.data<float>()[i] << ")";
+}
+
+TEST(PrimitiveTest, FastMathLog) {
+  std::vector<float> values;
+  for (float v = 1e-30f; v < 1e30f; v *= 1.37f)
+    values.emplace_back(v);
+  const StorageView x({dim_t(values.size())}, values);
+  StorageView accurate(x.shape(), DataType::FLOAT32);
+  StorageView fast(x.shape(), DataType::FLOAT32);
+  run_with_fast_math([&x](StorageView& y) {
+    primitives<Device::CPU>::log(x.data<float>(), y.data<float>(), x.size());
+  }, accurate, fast);
+  expect_storage_eq(fast, accurate, 1e-5);
+}
+
+TEST(PrimitiveTest, FastMathActivations) {
+  using UnaryFunction = void (*)(const float*, float*, dim_t);
+  const std::vector<std::pair<std::string, UnaryFunction>> functions = {
+    {"gelu", primitives<Device::CPU>::gelu<float>},
+    {"gelu_sigmoid", primitives<Device::CPU>::gelu_sigmoid<float>},
+    {"swish", primitives<Device::CPU>::swish<float>},
+  };
+
+  const StorageView x = linspace(-10, 10, 1001);
+  for (const auto& function : functions) {
+    SCOPED_TRACE(function.first);
+    StorageView accurate(x.shape(), DataType::FLOAT32);
+    StorageView fast(x.shape(), DataType::FLOAT32);
+    run_with_fast_math([&x, &function](StorageView& y) {
+      function.second(x.data<float>(), y.data<float>(), x.size());
+    }, accurate, fast);
+    expect_storage_eq(fast, accurate, 1e-4);
+  }
+}
+
+TEST(PrimitiveTest, FastMathSoftMax) {
+  std::vector<float> values(4 * 1000);
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = 20.f * std::sin(0.37f * i);
+  const StorageView x({4, 1000}, values);
+
+  for (const bool log : {false, true}) {
+    SCOPED_TRACE(log ? "log_softmax" : "softmax");
+    StorageView accurate;
+    StorageView fast;
+    const ops::SoftMax softmax_op(log);
+    run_with_fast_math([&x, &softmax_op](StorageView& y) {
+      softmax_op(x, y);
+    }, accurate, fast);
+    expect_storage_eq(fast, accurate, 1e-5);
+  }
+
+  float accurate = 0;
+  float fast = 0;
+  const bool fast_math = get_cpu_fast_math();
+  set_cpu_fast_math(false);
+  accurate = primitives<Device::CPU>::logsumexp(x.data<float>(), x.size());
+  set_cpu_fast_math(true);
+  fast = primitives<Device::CPU>::logsumexp(x.data<float>(), x.size());
+  set_cpu_fast_math(fast_math);
+  EXPECT_NEAR(fast, accurate, 1e-5);
+}
+
 INSTANTIATE_TEST_SUITE_P(CPU, PrimitiveTest, ::testing::Values(Device::CPU));
 #ifdef CT2_WITH_CUDA
 INSTANTIATE_TEST_SUITE_P(CUDA, PrimitiveTest, ::testing::Values(Device::CUDA));
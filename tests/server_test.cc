@@ -0,0 +1,202 @@
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ctranslate2/buffered_translation_wrapper.h>
+#include <ctranslate2/translator.h>
+
+#include "serve.h"
+#include "test_utils.h"
+
+static void write_all(int fd, const std::string& data) {
+  size_t offset = 0;
+  while (offset < data.size()) {
+    const auto written = ::write(fd, data.data() + offset, data.size() - offset);
+    ASSERT_GT(written, 0);
+    offset += written;
+  }
+}
+
+static std::string read_all(int fd) {
+  std::string data;
+  char buffer[4096];
+  while (true) {
+    const auto count = ::read(fd, buffer, sizeof (buffer));
+    if (count <= 0)
+      break;
+    data.append(buffer, count);
+  }
+  return data;
+}
+
+static std::string frame_message(Format format, const std::string& message) {
+  if (format == Format::JsonLines)
+    return message + '\n';
+  const auto size = static_cast<uint32_t>(message.size());
+  std::string data;
+  data += static_cast<char>((size >> 24) & 0xff);
+  data += static_cast<char>((size >> 16) & 0xff);
+  data += static_cast<char>((size >> 8) & 0xff);
+  data += static_cast<char>(size & 0xff);
+  return data + message;
+}
+
+static std::vector<nlohmann::json> parse_responses(Format format, const std::string& data) {
+  std::vector<nlohmann::json> responses;
+  size_t offset = 0;
+  while (offset < data.size()) {
+    size_t size = 0;
+    if (format == Format::JsonLines) {
+      size = data.find('\n', offset) - offset;
+    } else {
+      const auto* bytes = reinterpret_cast<const unsigned char*>(data.data() + offset);
+      size = ((size_t(bytes[0]) << 24)
+              | (size_t(bytes[1]) << 16)
+              | (size_t(bytes[2]) << 8)
+              | size_t(bytes[3]));
+      offset += 4;
+    }
+    responses.emplace_back(nlohmann::json::parse(data.substr(offset, size)));
+    offset += size + (format == Format::JsonLines ? 1 : 0);
+  }
+  return responses;
+}
+
+// Sends all requests on one end of a socket pair and returns the responses written by serve().
+static std::vector<nlohmann::json> run_serve(const std::vector<std::string>& requests,
+                                             const ServeOptions& options) {
+  TranslationOptions translation_options;
+  translation_options.return_scores = options.with_scores;
+  BufferedTranslationWrapper wrapper(std::make_shared<Translator>(default_model_dir()),
+                                     /*max_batch_size=*/32,
+                                     /*batch_timeout_in_micros=*/1000,
+                                     translation_options);
+
+  int fds[2];
+  EXPECT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+  std::string data;
+  for (const auto& request : requests)
+    data += frame_message(options.format, request);
+
+  std::thread server([&]() {
+    serve(wrapper, fds[1], fds[1], options);
+    ::close(fds[1]);
+  });
+
+  write_all(fds[0], data);
+  ::shutdown(fds[0], SHUT_WR);
+  const auto output = read_all(fds[0]);
+  server.join();
+  ::close(fds[0]);
+
+  return parse_responses(options.format, output);
+}
+
+class ServeTest : public ::testing::TestWithParam<Format> {
+};
+
+TEST_P(ServeTest, ResponsesInRequestOrder) {
+  ServeOptions options;
+  options.format = GetParam();
+  options.max_message_size = 64;
+
+  const std::vector<std::string> requests = {
+    R"({"id": 1, "source": "آ ت ز م و ن"})",
+    R"({"id": 2, "source": )",
+    R"({"id": 3, "source": ")" + std::string(100, 'x') + R"("})",
+    R"({"id": 4, "source": ["آ", "ت", "ز", "م", "و", "ن"]})",
+  };
+
+  const auto responses = run_serve(requests, options);
+  ASSERT_EQ(responses.size(), 4);
+
+  const std::vector<std::string> expected = {"a", "t", "z", "m", "o", "n"};
+
+  EXPECT_EQ(responses[0]["id"], 1);
+  EXPECT_EQ(responses[0]["hypotheses"][0].get<std::vector<std::string>>(), expected);
+
+  // The request could not be parsed, so its id is unknown.
+  EXPECT_FALSE(responses[1].contains("id"));
+  EXPECT_EQ(responses[1]["error"].get<std::string>().rfind("Invalid request", 0), 0);
+
+  EXPECT_FALSE(responses[2].contains("id"));
+  EXPECT_NE(responses[2]["error"].get<std::string>().find("maximum size of 64 bytes"),
+            std::string::npos);
+
+  EXPECT_EQ(responses[3]["id"], 4);
+  EXPECT_EQ(responses[3]["hypotheses"][0].get<std::vector<std::string>>(), expected);
+}
+
+TEST_P(ServeTest, ScoresAndEmptyInput) {
+  ServeOptions options;
+  options.format = GetParam();
+  options.with_scores = true;
+
+  EXPECT_TRUE(run_serve({}, options).empty());
+
+  const auto responses = run_serve({R"({"source": "آ ت ز م و ن"})"}, options);
+  ASSERT_EQ(responses.size(), 1);
+  EXPECT_FALSE(responses[0].contains("id"));
+  EXPECT_EQ(responses[0]["scores"].size(), 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  TestFormats,
+  ServeTest,
+  ::testing::Values(Format::JsonLines, Format::Binary),
+  [](const ::testing::TestParamInfo<Format>& info) {
+    return info.param == Format::JsonLines ? std::string("JsonLines") : std::string("Binary");
+  });
+
+TEST(ServerTest, TruncatedBinaryMessage) {
+  ServeOptions options;
+  options.format = Format::Binary;
+
+  std::string request = R"({"id": 1, "source": "آ ت ز م و ن"})";
+  request = frame_message(Format::Binary, request).substr(0, 10);
+
+  BufferedTranslationWrapper wrapper(std::make_shared<Translator>(default_model_dir()),
+                                     /*max_batch_size=*/32,
+                                     /*batch_timeout_in_micros=*/1000);
+  int fds[2];
+  ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  write_all(fds[0], request);
+  ::shutdown(fds[0], SHUT_WR);
+  serve(wrapper, fds[1], fds[1], options);
+  ::close(fds[1]);
+
+  const auto responses = parse_responses(Format::Binary, read_all(fds[0]));
+  ::close(fds[0]);
+  ASSERT_EQ(responses.size(), 1);
+  EXPECT_EQ(responses[0]["error"], "Connection closed in the middle of a message");
+}
+
+TEST(ServerTest, SocketDoesNotReplaceRegularFile) {
+  const std::string path = ::testing::TempDir() + "ct2_server_test_file";
+  {
+    std::ofstream file(path);
+    file << "data";
+  }
+
+  ASSERT_RAISES(create_socket(path), std::invalid_argument);
+
+  std::ifstream file(path);
+  std::string content;
+  file >> content;
+  EXPECT_EQ(content, "data");
+  std::remove(path.c_str());
+}
+
+TEST(ServerTest, SocketReplacesPreviousSocket) {
+  const std::string path = ::testing::TempDir() + "ct2_server_test.sock";
+  std::remove(path.c_str());
+  ::close(create_socket(path));
+  ::close(create_socket(path));
+  std::remove(path.c_str());
+}
@@ -1,4 +1,7 @@
+#include <thread>
+
 #include "test_utils.h"
+#include "ctranslate2/memory_planner.h"
 #include "ctranslate2/storage_view.h"
 
 TEST(StorageViewTest, ZeroDim) {
@@ -61,6 +64,140 @@ TEST(StorageViewTest, ExpandDimsAndSqueeze) {
   }
 }
 
+TEST(StorageViewTest, ShapeInlineStorage) {
+  Shape shape{2, 3};
+  shape.insert(shape.begin() + 1, 4);
+  assert_vector_eq(shape, Shape{2, 4, 3});
+  shape.erase(shape.begin());
+  assert_vector_eq(shape, Shape{4, 3});
+  shape.push_back(5);
+  EXPECT_EQ(shape.back(), 5);
+  EXPECT_EQ(shape, Shape(std::vector<dim_t>{4, 3, 5}));
+  EXPECT_EQ(std::vector<dim_t>(shape), (std::vector<dim_t>{4, 3, 5}));
+
+  const std::vector<int32_t> dims{1, 2, 3, 4, 5, 6, 7, 8};
+  const Shape max_shape(dims.begin(), dims.end());
+  EXPECT_EQ(max_shape.size(), Shape::max_rank);
+  ASSERT_RAISES(Shape(max_shape).push_back(9), std::invalid_argument);
+}
+
+TEST(StorageViewTest, HugePageAllocator) {
+  Allocator& allocator = get_huge_page_allocator();
+  const size_t huge_page_size = 2 * 1024 * 1024;
+
+  // Large buffers are aligned on the huge page size.
+  const size_t size = 3 * huge_page_size + 100;
+  auto* large = static_cast<char*>(allocator.allocate(size));
+#ifdef __linux__
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % huge_page_size, 0);
+#endif
+  large[0] = 1;
+  large[size - 1] = 2;
+
+  // Small buffers use the default allocator.
+  void* small = allocator.allocate(1024);
+  EXPECT_NE(small, nullptr);
+
+  allocator.free(small);
+  allocator.free(large);
+}
+
+TEST(StorageViewTest, MemoryPlanner) {
+  MemoryPlanner planner(Device::CPU);
+  StorageView persistent;
+
+  for (int step = 0; step < 3; ++step) {
+    ScopedMemoryPlan plan(planner, 1);
+    StorageView a({16}, 1.f);
+    StorageView b({32}, 2.f);
+    StorageView c(a);
+    a.release();
+    StorageView d({16}, 3.f);
+    persistent = StorageView({8}, float(step));
+
+    EXPECT_EQ(b.to_vector<float>(), std::vector<float>(32, 2.f));
+    EXPECT_EQ(c.to_vector<float>(), std::vector<float>(16, 1.f));
+    EXPECT_EQ(d.to_vector<float>(), std::vector<float>(16, 3.f));
+  }
+
+  // The first step is recorded and the next steps serve a, b, c, and d from the arena.
+  // d reuses the memory of a which was released before.
+  EXPECT_EQ(planner.num_planned_allocations(), 2 * 4);
+  EXPECT_EQ(planner.arena_size(), (32 + 16 + 16) * sizeof (float));
+  EXPECT_EQ(persistent.to_vector<float>(), std::vector<float>(8, 2.f));
+}
+
+TEST(StorageViewTest, MemoryPlannerGrowingBuffer) {
+  MemoryPlanner planner(Device::CPU);
+
+  for (dim_t step = 1; step <= 32; ++step) {
+    ScopedMemoryPlan plan(planner, 1);
+    StorageView a({4}, 1.f);
+    StorageView b({step}, float(step));
+    StorageView c({4}, 2.f);
+    EXPECT_EQ(a.to_vector<float>(), std::vector<float>(4, 1.f));
+    EXPECT_EQ(b.to_vector<float>(), std::vector<float>(step, float(step)));
+  }
+
+  // The growing buffer is planned again with more capacity when it no longer fits.
+  EXPECT_GT(planner.num_planned_allocations(), 3 * 16);
+}
+
+TEST(StorageViewTest, MemoryPlannerLateRelease) {
+  MemoryPlanner planner(Device::CPU);
+  StorageView kept;
+
+  for (int step = 0; step < 4; ++step) {
+    ScopedMemoryPlan plan(planner, 1);
+    StorageView a({16}, 1.f);
+    if (step == 2)
+      kept = std::move(a);  // Not released before b as in the recorded step.
+    a.release();
+    StorageView b({16}, 2.f);
+    EXPECT_EQ(b.to_vector<float>(), std::vector<float>(16, 2.f));
+  }
+
+  // b does not overwrite the buffer that was not released, and the next steps are not
+  // served from the arena while this buffer is live.
+  EXPECT_EQ(kept.to_vector<float>(), std::vector<float>(16, 1.f));
+  EXPECT_EQ(planner.num_planned_allocations(), 2 + 1);
+  kept.release();
+
+  // The plan is then recorded again and replayed.
+  for (int step = 0; step < 2; ++step) {
+    ScopedMemoryPlan plan(planner, 1);
+    StorageView a({16}, 1.f);
+    a.release();
+    StorageView b({16}, 2.f);
+  }
+  EXPECT_EQ(planner.num_planned_allocations(), 2 + 1 + 2);
+}
+
+TEST(StorageViewTest, MemoryPlannerDeviceAllocation) {
+  MemoryPlannerPtr planner = make_memory_planner(Device::CPU);
+  StorageView persistent;
+  StorageView leaked;
+
+  for (int step = 0; step < 3; ++step) {
+    ScopedMemoryPlan plan(*planner, 1);
+    StorageView a({16}, 1.f);
+    {
+      const ScopedDeviceAllocation device_allocation;
+      persistent = StorageView({8}, float(step));
+    }
+    leaked = StorageView({4}, float(step));
+  }
+
+  // Only the temporary buffer is served from the arena.
+  EXPECT_EQ(planner->num_planned_allocations(), 2);
+
+  // The planner is kept alive until the last buffer referencing it is freed, which can
+  // happen on another thread.
+  planner.reset();
+  std::thread([&leaked] { leaked.release(); }).join();
+  EXPECT_EQ(persistent.to_vector<float>(), std::vector<float>(8, 2.f));
+}
+
 class StorageViewDeviceTest : public ::testing::TestWithParam<Device> {
 };
 
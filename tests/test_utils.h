@@ -60,6 +60,10 @@ void assert_vector_eq(const std::vector<T>& got, const std::vector<T>& expected)
   }
 }
 
+inline void assert_vector_eq(const Shape& got, const Shape& expected) {
+  assert_vector_eq<dim_t>(got, expected);
+}
+
 inline void expect_storage_eq(const StorageView& got,
                               const StorageView& expected,
                               float abs_diff = 0) {
@@ -1,8 +1,13 @@
 #include <ctranslate2/buffered_translation_wrapper.h>
 #include <ctranslate2/translator.h>
 #include <ctranslate2/decoding.h>
+#include <ctranslate2/tuning.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
 #include <unordered_set>
 
 #include "test_utils.h"
@@ -185,6 +190,46 @@ TEST_P(SearchVariantTest, ReturnAttention) {
   }
 }
 
+TEST_P(SearchVariantTest, ReturnTopkLogProbs) {
+  auto beam_size = GetParam();
+  Translator translator = default_translator();
+  TranslationOptions options;
+  options.beam_size = beam_size;
+  options.num_hypotheses = beam_size;
+  options.return_topk_logprobs = 3;
+  std::vector<std::string> input = {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"};
+  auto result = translator.translate_batch({input}, options)[0];
+  ASSERT_TRUE(result.has_topk_logprobs());
+  ASSERT_EQ(result.topk_ids.size(), beam_size);
+  ASSERT_EQ(result.topk_logprobs.size(), beam_size);
+  for (size_t h = 0; h < result.num_hypotheses(); ++h) {
+    ASSERT_EQ(result.topk_ids[h].size(), result.hypotheses[h].size());
+    ASSERT_EQ(result.topk_logprobs[h].size(), result.hypotheses[h].size());
+    for (const auto& logprobs : result.topk_logprobs[h]) {
+      ASSERT_EQ(logprobs.size(), 3);
+      EXPECT_LE(logprobs[0], 0);
+      EXPECT_GE(logprobs[0], logprobs[1]);
+      EXPECT_GE(logprobs[1], logprobs[2]);
+    }
+  }
+}
+
+TEST_P(SearchVariantTest, StopSequences) {
+  auto beam_size = GetParam();
+  Translator translator = default_translator();
+  TranslationOptions options;
+  options.beam_size = beam_size;
+  options.stop_sequences = {{"z", "m"}, {"x", "y"}};
+  std::vector<std::string> input = {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"};
+  std::vector<std::string> expected = {"a", "t", "z", "m"};
+  auto result = translator.translate_batch({input}, options)[0];
+  EXPECT_EQ(result.output(), expected);
+
+  // A token that is not in the vocabulary would match any unknown token.
+  options.stop_sequences = {{"z", "m"}, {"not-in-vocabulary"}};
+  EXPECT_THROW(translator.translate_batch({input}, options), std::invalid_argument);
+}
+
 TEST_P(SearchVariantTest, ReturnAttentionWithPrefix) {
   const auto beam_size = GetParam();
   Translator translator = default_translator();
@@ -279,6 +324,33 @@ TEST_P(SearchVariantTest, ReplaceUnknowns) {
   EXPECT_EQ(result.output(), expected);
 }
 
+TEST_P(SearchVariantTest, ReplaceUnknownsWithoutAttention) {
+  const auto beam_size = GetParam();
+  Translator translator = default_translator();
+  TranslationOptions options;
+  options.beam_size = beam_size;
+  options.num_hypotheses = beam_size;
+  options.replace_unknowns = true;
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"},
+    {"آ" ,"ر" ,"ب" ,"ا" ,"ك" ,"ه"},
+  };
+  const std::vector<std::vector<std::string>> prefixes = {{"<unk>", "t"}, {"a", "<unk>"}};
+
+  // The unknown tokens should be replaced like when the attention vectors are returned.
+  const auto results = translator.translate_batch(inputs, prefixes, options);
+  options.return_attention = true;
+  const auto results_with_attention = translator.translate_batch(inputs, prefixes, options);
+
+  ASSERT_EQ(results.size(), results_with_attention.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_FALSE(results[i].has_attention());
+    EXPECT_EQ(results[i].hypotheses, results_with_attention[i].hypotheses);
+    for (const auto& hypothesis : results[i].hypotheses)
+      EXPECT_EQ(std::count(hypothesis.begin(), hypothesis.end(), "<unk>"), 0);
+  }
+}
+
 TEST_P(SearchVariantTest, RepetitionPenalty) {
   const auto beam_size = GetParam();
   Translator translator = default_translator();
@@ -862,6 +934,417 @@ TEST(TranslatorTest, Patience) {
   EXPECT_EQ(result.num_hypotheses(), options.num_hypotheses);
 }
 
+TEST(TranslatorTest, BeamPruning) {
+  Translator translator = default_translator();
+  TranslationOptions options;
+  options.return_scores = true;
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"},
+    {"آ" ,"ر" ,"ب" ,"ی" ,"ن" ,"ی" ,"ا" ,"ن"},
+  };
+  options.beam_size = 1;
+  const auto greedy_results = translator.translate_batch(inputs, options);
+
+  // With a tiny threshold only the best beam is kept after the first step.
+  options.beam_size = 4;
+  options.beam_pruning_absolute_threshold = 1e-6;
+  const auto pruned_results = translator.translate_batch(inputs, options);
+
+  ASSERT_EQ(pruned_results.size(), greedy_results.size());
+  for (size_t i = 0; i < greedy_results.size(); ++i) {
+    EXPECT_EQ(pruned_results[i].output(), greedy_results[i].output());
+    EXPECT_NEAR(pruned_results[i].score(), greedy_results[i].score(), 1e-5);
+  }
+
+  // The beams are not pruned below the number of hypotheses.
+  options.beam_pruning_absolute_threshold = 0;
+  options.beam_pruning_relative_threshold = 1e-6;
+  options.num_hypotheses = 2;
+  for (const auto& result : translator.translate_batch(inputs, options))
+    EXPECT_EQ(result.num_hypotheses(), 2);
+}
+
+TEST(TranslatorTest, BeamPruningWithFinishedBatch) {
+  Translator translator = default_translator();
+  TranslationOptions options;
+  options.beam_size = 4;
+  options.length_penalty = 0;
+  options.beam_pruning_absolute_threshold = 1e-6;
+  options.stop_sequences = {{"a"}};
+  const std::vector<std::string> first_input = {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"};
+  const std::vector<std::string> second_input = {"ت" ,"ز" ,"م"};
+
+  // The first example finishes on the first step, which is also the step where the
+  // pruning reduces the beam size.
+  const auto results = translator.translate_batch({first_input, second_input}, options);
+  const auto expected = translator.translate_batch({second_input}, options)[0];
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].output(), (std::vector<std::string>{"a"}));
+  EXPECT_EQ(results[1].output(), expected.output());
+}
+
+TEST(TranslatorTest, BeamScoreBound) {
+  Translator translator = default_translator();
+  TranslationOptions options;
+  options.beam_size = 4;
+  options.num_hypotheses = 3;
+  options.length_penalty = 1;
+  options.return_scores = true;
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"},
+    {"آ" ,"ر" ,"ب" ,"ی" ,"ن" ,"ی" ,"ا" ,"ن"},
+  };
+
+  const auto expected = translator.translate_batch(inputs, options);
+  options.beam_score_bound = true;
+  const auto results = translator.translate_batch(inputs, options);
+
+  // The early stop does not change the n-best list.
+  ASSERT_EQ(results.size(), expected.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].hypotheses, expected[i].hypotheses);
+    ASSERT_EQ(results[i].scores.size(), expected[i].scores.size());
+    for (size_t h = 0; h < results[i].scores.size(); ++h)
+      EXPECT_NEAR(results[i].scores[h], expected[i].scores[h], 1e-5);
+  }
+}
+
+TEST(TranslatorTest, InvalidBeamPruningThreshold) {
+  Translator translator = default_translator();
+  TranslationOptions options;
+  options.beam_size = 4;
+  options.beam_pruning_relative_threshold = -1;
+  std::vector<std::string> input = {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"};
+  EXPECT_THROW(translator.translate_batch({input}, options), std::invalid_argument);
+}
+
+TEST(TranslatorTest, EarlyExit) {
+  Translator translator = default_translator();
+  TranslationOptions options;
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"},
+    {"آ" ,"ر" ,"ب" ,"ی" ,"ن" ,"ی" ,"ا" ,"ن"},
+  };
+
+  for (const auto& result : translator.translate_batch(inputs, options))
+    EXPECT_EQ(result.average_exit_depth, 0);
+
+  // With a tiny threshold all steps after the first exit at the first tested layer.
+  options.early_exit_threshold = 1e-6;
+  options.early_exit_interval = 1;
+  for (const size_t beam_size : {1, 2}) {
+    options.beam_size = beam_size;
+    const auto results = translator.translate_batch(inputs, options);
+    ASSERT_EQ(results.size(), inputs.size());
+    for (const auto& result : results) {
+      EXPECT_FALSE(result.output().empty());
+      EXPECT_EQ(result.average_exit_depth, 1);
+    }
+  }
+
+  options.early_exit_threshold = 2;
+  EXPECT_THROW(translator.translate_batch(inputs, options), std::invalid_argument);
+}
+
+TEST(TranslatorTest, TwoStageOutput) {
+  Translator translator = default_translator();
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"},
+    {"آ" ,"ر" ,"ب" ,"ی" ,"ن" ,"ی" ,"ا" ,"ن"},
+  };
+
+  for (const size_t beam_size : {1, 2}) {
+    TranslationOptions options;
+    options.beam_size = beam_size;
+    const auto expected = translator.translate_batch(inputs, options);
+
+    // The option is ignored when the device does not support INT8.
+    options.two_stage_candidates = 10;
+    for (const bool exact_log_probs : {false, true}) {
+      options.two_stage_exact_log_probs = exact_log_probs;
+      const auto results = translator.translate_batch(inputs, options);
+      ASSERT_EQ(results.size(), expected.size());
+      for (size_t i = 0; i < results.size(); ++i)
+        EXPECT_EQ(results[i].output(), expected[i].output());
+    }
+  }
+}
+
+TEST(TranslatorTest, Warmup) {
+  models::ModelLoader model_loader(default_model_dir());
+  model_loader.num_replicas_per_device = 2;
+  Translator translator(model_loader);
+
+  models::WarmupOptions warmup_options;
+  warmup_options.batch_shapes = {{1, 4}, {2, 8}};
+  warmup_options.beam_size = 2;
+  const auto times = translator.warmup(warmup_options);
+  ASSERT_EQ(times.size(), 2);
+  for (const double time : times)
+    EXPECT_GT(time, 0);
+
+  const std::vector<std::string> input = {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"};
+  const TranslationResult result = translator.translate_batch({input})[0];
+  EXPECT_EQ(result.output(), (std::vector<std::string>{"a", "t", "z", "m", "o", "n"}));
+}
+
+TEST(TranslatorTest, Ensemble) {
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ", "ز", "ا"},
+    {"آ", "ت", "ز", "م", "و", "ن"}};
+  TranslationOptions options;
+  options.beam_size = 2;
+  options.num_hypotheses = 2;
+  options.return_scores = true;
+  options.return_attention = true;
+
+  const auto expected = default_translator().translate_batch(inputs, options);
+
+  models::ModelLoader model_loader(std::vector<std::string>{default_model_dir(),
+                                                            default_model_dir()});
+  Translator translator(model_loader);
+  const auto results = translator.translate_batch(inputs, options);
+
+  ASSERT_EQ(results.size(), expected.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].hypotheses, expected[i].hypotheses);
+    EXPECT_EQ(results[i].attention.size(), expected[i].attention.size());
+    ASSERT_EQ(results[i].scores.size(), expected[i].scores.size());
+    for (size_t h = 0; h < results[i].scores.size(); ++h)
+      EXPECT_NEAR(results[i].scores[h], expected[i].scores[h], 1e-4);
+  }
+}
+
+TEST(TranslatorTest, EnsembleEarlyExit) {
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ", "ز", "ا"},
+    {"آ", "ت", "ز", "م", "و", "ن"}};
+
+  models::ModelLoader model_loader(std::vector<std::string>{default_model_dir(),
+                                                            default_model_dir()});
+  Translator translator(model_loader);
+
+  // The options are forwarded to each member of the ensemble.
+  TranslationOptions options;
+  options.early_exit_threshold = 1e-6;
+  options.early_exit_interval = 1;
+  options.two_stage_candidates = 10;
+  for (const auto& result : translator.translate_batch(inputs, options)) {
+    EXPECT_FALSE(result.output().empty());
+    EXPECT_EQ(result.average_exit_depth, 1);
+  }
+}
+
+TEST(TranslatorTest, Tuning) {
+  TuningOptions tuning_options;
+  tuning_options.inter_threads = {1, 2};
+  tuning_options.intra_threads = {1};
+  tuning_options.max_batch_sizes = {1, 4};
+  tuning_options.concurrency = 2;
+  tuning_options.num_requests = 4;
+  tuning_options.num_synthetic_examples = 8;
+  tuning_options.synthetic_length = 6;
+
+  TranslationOptions options;
+  options.max_decoding_length = 10;
+
+  const models::ModelLoader model_loader(default_model_dir());
+  const auto result = tune_translator(model_loader, options, tuning_options);
+  ASSERT_EQ(result.candidates.size(), 4);
+  for (const auto& candidate : result.candidates) {
+    EXPECT_GT(candidate.tokens_per_second, 0);
+    EXPECT_GT(candidate.latency_p50_ms, 0);
+    EXPECT_LE(candidate.latency_p50_ms, candidate.latency_p99_ms);
+    EXPECT_LE(candidate.tokens_per_second, result.best.tokens_per_second);
+  }
+
+  const std::string profile_path = ::testing::TempDir() + "tuning_profile.json";
+  result.best.save(profile_path);
+  const auto profile = TuningProfile::load(profile_path);
+  EXPECT_EQ(profile.inter_threads, result.best.inter_threads);
+  EXPECT_EQ(profile.intra_threads, 1);
+  EXPECT_EQ(profile.max_batch_size, result.best.max_batch_size);
+  EXPECT_EQ(profile.compute_type, result.best.compute_type);
+
+  models::ModelLoader tuned_loader(default_model_dir());
+  ReplicaPoolConfig config;
+  profile.apply(tuned_loader, config);
+  Translator translator(tuned_loader, config);
+  EXPECT_EQ(translator.num_replicas(), profile.inter_threads);
+
+  const std::vector<std::string> input = {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"};
+  const TranslationResult translation = translator.translate_batch({input})[0];
+  EXPECT_EQ(translation.output(), (std::vector<std::string>{"a", "t", "z", "m", "o", "n"}));
+}
+
+static void set_environment_variable(const char* name, const char* value) {
+#ifdef _WIN32
+  _putenv_s(name, value);
+#else
+  setenv(name, value, 1);
+#endif
+}
+
+TEST(TranslatorTest, LazyCacheReorder) {
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ", "ز", "ا"},
+    {"آ", "ت", "ز", "م", "و", "ن"},
+    {"آ", "ت", "ش", "ي"}};
+  TranslationOptions options;
+  options.beam_size = 4;
+  options.num_hypotheses = 4;
+  options.return_scores = true;
+  options.return_attention = true;
+
+  const auto expected = default_translator().translate_batch(inputs, options);
+
+  set_environment_variable("CT2_LAZY_CACHE_REORDER", "1");
+  Translator translator = default_translator();
+  set_environment_variable("CT2_LAZY_CACHE_REORDER", "0");
+  const auto results = translator.translate_batch(inputs, options);
+
+  ASSERT_EQ(results.size(), expected.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].hypotheses, expected[i].hypotheses);
+    ASSERT_EQ(results[i].scores.size(), expected[i].scores.size());
+    for (size_t h = 0; h < results[i].scores.size(); ++h)
+      EXPECT_NEAR(results[i].scores[h], expected[i].scores[h], 1e-4);
+  }
+}
+
+TEST(TranslatorTest, GemmAutotuning) {
+  const std::string cache_path = ::testing::TempDir() + "gemm_tuning.json";
+  std::remove(cache_path.c_str());
+
+  set_environment_variable("CT2_AUTOTUNE_GEMM", "1");
+  set_environment_variable("CT2_GEMM_TUNING_CACHE", cache_path.c_str());
+  Translator translator = default_translator();
+  set_environment_variable("CT2_AUTOTUNE_GEMM", "0");
+
+  const std::vector<std::string> input = {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"};
+  const TranslationResult result = translator.translate_batch({input})[0];
+  EXPECT_EQ(result.output(), (std::vector<std::string>{"a", "t", "z", "m", "o", "n"}));
+  EXPECT_TRUE(std::ifstream(cache_path).good());
+
+#ifdef _OPENMP
+  // The GEMM is measured and cached with the number of threads of the replicas.
+  ReplicaPoolConfig config;
+  config.num_threads_per_replica = 3;
+  set_environment_variable("CT2_AUTOTUNE_GEMM", "1");
+  Translator threaded_translator(default_model_dir(), Device::CPU, ComputeType::DEFAULT, {0}, config);
+  set_environment_variable("CT2_AUTOTUNE_GEMM", "0");
+
+  std::ifstream cache_file(cache_path);
+  const std::string cache((std::istreambuf_iterator<char>(cache_file)),
+                          std::istreambuf_iterator<char>());
+  EXPECT_NE(cache.find(":threads=3"), std::string::npos);
+
+  const auto threaded_result = threaded_translator.translate_batch({input})[0];
+  EXPECT_EQ(threaded_result.output(), result.output());
+#endif
+}
+
+TEST(TranslatorTest, TranslateIterable) {
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ", "ز", "ا"},
+    {"آ", "ت", "ز", "م", "و", "ن"},
+    {"آ", "ت", "ش", "ي", "س", "و", "ن"},
+    {},
+    {"آ", "ر", "ث", "ر"},
+  };
+
+  models::ModelLoader model_loader(default_model_dir());
+  model_loader.num_replicas_per_device = 2;
+  Translator translator(model_loader);
+  const auto expected = translator.translate_batch(inputs);
+
+  auto iterator = translator.translate_iterable(std::make_unique<VectorReader>(inputs),
+                                                TranslationOptions(),
+                                                /*max_batch_size=*/2,
+                                                /*read_batch_size=*/3,
+                                                BatchType::Examples,
+                                                /*max_batches_per_replica=*/1);
+
+  for (const auto& expected_result : expected) {
+    const auto result = iterator->next();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->hypotheses, expected_result.hypotheses);
+  }
+  EXPECT_FALSE(iterator->next());
+}
+
+// Counts the number of examples consumed from the wrapped reader.
+class CountingReader : public BatchReader {
+public:
+  CountingReader(std::vector<std::vector<std::string>> examples,
+                 std::shared_ptr<std::atomic<size_t>> num_read)
+    : _reader(std::move(examples))
+    , _num_read(std::move(num_read))
+  {
+  }
+
+  Example get_next_example() override {
+    auto example = _reader.get_next_example();
+    if (!example.streams.empty())
+      ++(*_num_read);
+    return example;
+  }
+
+private:
+  VectorReader _reader;
+  std::shared_ptr<std::atomic<size_t>> _num_read;
+};
+
+TEST(TranslatorTest, TranslateIterableSlowConsumer) {
+  const std::vector<std::vector<std::string>> inputs(100, {"آ", "ت", "ز", "م", "و", "ن"});
+  const size_t read_batch_size = 4;
+  auto num_read = std::make_shared<std::atomic<size_t>>(0);
+
+  Translator translator = default_translator();
+  auto iterator = translator.translate_iterable(
+    std::make_unique<CountingReader>(inputs, num_read),
+    TranslationOptions(),
+    /*max_batch_size=*/2,
+    read_batch_size);
+
+  ASSERT_TRUE(iterator->next());
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  // At most read_batch_size - 1 results were waiting when the last chunk was read,
+  // and the reader looks one example ahead.
+  EXPECT_LE(num_read->load(), 1 + 2 * read_batch_size);
+
+  size_t num_results = 1;
+  while (iterator->next())
+    ++num_results;
+  EXPECT_EQ(num_results, inputs.size());
+  EXPECT_EQ(num_read->load(), inputs.size());
+}
+
+TEST(TranslatorTest, TranslateIterableWithReadError) {
+  const std::vector<std::vector<std::string>> source = {
+    {"آ", "ز", "ا"},
+    {"آ", "ت", "ز", "م", "و", "ن"},
+    {"آ", "ر", "ث", "ر"},
+  };
+  const std::vector<std::vector<std::string>> target_prefix = {{"a"}, {"a"}};
+
+  auto reader = std::make_unique<ParallelBatchReader>();
+  reader->add(std::make_unique<VectorReader>(source));
+  reader->add(std::make_unique<VectorReader>(target_prefix));
+
+  Translator translator = default_translator();
+  auto iterator = translator.translate_iterable(std::move(reader),
+                                                TranslationOptions(),
+                                                /*max_batch_size=*/1,
+                                                /*read_batch_size=*/1);
+
+  // The reader looks one example ahead, so the second example is lost with the error.
+  EXPECT_TRUE(iterator->next());
+  EXPECT_THROW(iterator->next(), std::runtime_error);
+  EXPECT_FALSE(iterator->next());
+}
+
 TEST(TranslatorTest, IgnoreScore) {
   Translator translator = default_translator();
   TranslationOptions options;
@@ -910,6 +1393,30 @@ TEST(BufferedTranslationWrapperTest, Basic) {
             (std::vector<std::string>{"a", "t", "z", "m", "o", "n"}));
 }
 
+TEST(BufferedTranslationWrapperTest, TokenBatches) {
+  // The buffer is flushed when 10 source tokens are ready, long before the timeout.
+  BufferedTranslationWrapper wrapper(std::make_shared<Translator>(default_model_dir()),
+                                     /*max_batch_size=*/10,
+                                     /*batch_timeout_in_micros=*/60000000,
+                                     TranslationOptions(),
+                                     /*max_buffer_size=*/0,
+                                     BatchType::Tokens);
+
+  auto futures = wrapper.translate_batch_async({
+      {"آ", "ز", "ا"},
+      {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"},
+      {"آ", "ز", "ا"},
+    });
+
+  ASSERT_EQ(futures[0].wait_for(std::chrono::seconds(30)), std::future_status::ready);
+  EXPECT_EQ(futures[0].get().hypotheses[0],
+            (std::vector<std::string>{"a", "z", "z", "a"}));
+  EXPECT_EQ(futures[1].get().hypotheses[0],
+            (std::vector<std::string>{"a", "t", "z", "m", "o", "n"}));
+  EXPECT_EQ(futures[2].get().hypotheses[0],
+            (std::vector<std::string>{"a", "z", "z", "a"}));
+}
+
 TEST(TranslatorTest, Scoring) {
   const std::vector<std::vector<std::string>> source = {
     {"آ" ,"ت" ,"ز" ,"م" ,"و" ,"ن"},
@@ -954,3 +1461,178 @@ TEST(TranslatorTest, ScoringMaxInputLength) {
   EXPECT_EQ(result.tokens, (std::vector<std::string>{"a", "t", "z", "</s>"}));
   EXPECT_EQ(result.tokens_score.size(), options.max_input_length);
 }
+
+static std::shared_ptr<models::ModelReader>
+make_pruned_model_reader(const std::string& manifest) {
+  auto model_reader = std::make_shared<models::ModelMemoryReader>("pruned");
+  for (const std::string filename : {"model.bin",
+                                     "source_vocabulary.txt",
+                                     "target_vocabulary.txt"}) {
+    std::ifstream file(default_model_dir() + "/" + filename, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    model_reader->register_file(filename, std::move(content));
+  }
+  model_reader->register_file("pruning.json", manifest);
+  return model_reader;
+}
+
+TEST(TranslatorTest, StructuredPruning) {
+  const auto reference = models::Model::load(default_model_dir());
+  const auto model_reader = make_pruned_model_reader(R"({
+    "attention_heads": {
+      "encoder/layer_0/self_attention": [0, 3],
+      "decoder/layer_1/self_attention": [7],
+      "decoder/layer_1/attention": [1, 2, 5]
+    },
+    "ffn_channels": {
+      "decoder/layer_0/ffn": [0, 10, 20, 30]
+    }
+  })");
+  const auto model = models::Model::load(*model_reader);
+
+  const dim_t num_heads = 8;
+  const auto& qkv = reference->get_variable("encoder/layer_0/self_attention/linear_0/weight");
+  const dim_t head_dim = qkv.dim(0) / 3 / num_heads;
+  const auto get_dim = [&model](const std::string& name, dim_t axis) {
+    return model->get_variable(name).dim(axis);
+  };
+
+  EXPECT_EQ(model->get_attribute<int32_t>("encoder/layer_0/self_attention/num_heads"), 6);
+  EXPECT_EQ(get_dim("encoder/layer_0/self_attention/linear_0/weight", 0), 3 * 6 * head_dim);
+  EXPECT_EQ(get_dim("encoder/layer_0/self_attention/linear_0/bias", 0), 3 * 6 * head_dim);
+  EXPECT_EQ(get_dim("encoder/layer_0/self_attention/linear_1/weight", 1), 6 * head_dim);
+  EXPECT_EQ(get_dim("encoder/layer_1/self_attention/linear_0/weight", 0), 3 * 8 * head_dim);
+  EXPECT_EQ(get_dim("decoder/layer_1/attention/linear_0/weight", 0), 5 * head_dim);
+  EXPECT_EQ(get_dim("decoder/layer_1/attention/linear_1/weight", 0), 2 * 5 * head_dim);
+  EXPECT_EQ(get_dim("decoder/layer_1/attention/linear_2/weight", 1), 5 * head_dim);
+
+  const dim_t ffn_size = reference->get_variable("decoder/layer_0/ffn/linear_0/weight").dim(0);
+  EXPECT_EQ(get_dim("decoder/layer_0/ffn/linear_0/weight", 0), ffn_size - 4);
+  EXPECT_EQ(get_dim("decoder/layer_0/ffn/linear_1/weight", 1), ffn_size - 4);
+
+  // The kept rows are copied from the original weight.
+  const auto& pruned_qkv = model->get_variable("encoder/layer_0/self_attention/linear_0/weight");
+  const dim_t d_model = qkv.dim(1);
+  EXPECT_EQ(pruned_qkv.at<float>({0, 0}), qkv.at<float>({head_dim, 0}));
+  EXPECT_EQ(pruned_qkv.at<float>({6 * head_dim, d_model - 1}),
+            qkv.at<float>({(8 + 1) * head_dim, d_model - 1}));
+
+  // Run the pruned model on a padded batch with attention.
+  Translator translator{models::ModelLoader(model_reader)};
+  TranslationOptions options;
+  options.beam_size = 2;
+  options.return_attention = true;
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ", "ز", "ا"},
+    {"آ", "ت", "ز", "م", "و", "ن"}};
+  const auto results = translator.translate_batch(inputs, options);
+  ASSERT_EQ(results.size(), 2);
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_FALSE(results[i].output().empty());
+    ASSERT_EQ(results[i].attention[0].size(), results[i].output().size());
+    EXPECT_EQ(results[i].attention[0][0].size(), inputs[i].size());
+  }
+}
+
+TEST(TranslatorTest, StructuredPruningInvalidManifest) {
+  for (const std::string manifest : {
+      R"({"attention_heads": {"encoder/layer_0/self_attention": [8]}})",
+      R"({"attention_heads": {"encoder/layer_0/self_attention": [1, 1]}})",
+      R"({"attention_heads": {"encoder/layer_0/self_attention": [0, 1, 2, 3, 4, 5, 6, 7]}})",
+      R"({"attention_heads": {"encoder/layer_9/self_attention": [0]}})",
+      R"({"ffn_channels": {"encoder/layer_0/feed_forward": [0]}})"}) {
+    const auto model_reader = make_pruned_model_reader(manifest);
+    EXPECT_THROW(models::Model::load(*model_reader), std::invalid_argument);
+  }
+}
+
+TEST(TranslatorTest, EstimateDecodingMemory) {
+  const auto model = models::Model::load(default_model_dir());
+  const dim_t d_model = model->get_variable("decoder/layer_0/self_attention/layer_norm/gamma").dim(0);
+  dim_t num_layers = 0;
+  while (model->layer_exists("decoder/layer_" + std::to_string(num_layers)))
+    ++num_layers;
+
+  const dim_t batch_size = 4;
+  const dim_t input_length = 10;
+  const dim_t max_length = 20;
+  const auto estimate = estimate_decoding_memory(*model, batch_size, 1, input_length, max_length);
+
+  // Keys and values of the self-attention and encoder-decoder attention.
+  const size_t expected_cache = (2 * batch_size * (max_length + input_length) * d_model
+                                 * num_layers * sizeof (float));
+  EXPECT_EQ(estimate.cache_bytes, expected_cache);
+  EXPECT_GT(estimate.activation_bytes, 0);
+
+  const auto larger = estimate_decoding_memory(*model, batch_size, 4, input_length, max_length);
+  EXPECT_GT(larger.cache_bytes, 4 * estimate.cache_bytes);
+  EXPECT_GE(larger.activation_bytes, estimate.activation_bytes);
+
+  // The estimate follows the pruned layers.
+  const auto pruned_model = models::Model::load(*make_pruned_model_reader(R"({
+    "attention_heads": {"decoder/layer_0/self_attention": [0, 1, 2, 3]}
+  })"));
+  const auto pruned = estimate_decoding_memory(*pruned_model, batch_size, 1, input_length, max_length);
+  EXPECT_EQ(pruned.cache_bytes,
+            expected_cache - 2 * batch_size * max_length * (d_model / 2) * sizeof (float));
+
+  // Older specifications do not save the number of heads.
+  const auto v1_model = models::Model::load(get_data_dir() + "/models/v1/aren-transliteration");
+  EXPECT_EQ(v1_model->default_num_heads(), 8);
+  const auto v1_estimate = estimate_decoding_memory(*v1_model, batch_size, 1, input_length, max_length);
+  EXPECT_EQ(v1_estimate.cache_bytes, estimate.cache_bytes);
+  EXPECT_EQ(v1_estimate.activation_bytes, estimate.activation_bytes);
+
+  // The two-stage output adds the INT8 copy of the output projection.
+  EXPECT_EQ(estimate.weight_bytes, 0);
+  const auto& projection = model->get_variable("decoder/projection/weight");
+  const auto two_stage = estimate_decoding_memory(*model,
+                                                  batch_size,
+                                                  1,
+                                                  input_length,
+                                                  max_length,
+                                                  /*two_stage_candidates=*/8);
+  EXPECT_EQ(two_stage.cache_bytes, estimate.cache_bytes);
+  EXPECT_GE(two_stage.activation_bytes, estimate.activation_bytes);
+  EXPECT_EQ(two_stage.weight_bytes, projection.size() + projection.dim(0) * 8);
+  EXPECT_EQ(two_stage.total_bytes(),
+            two_stage.cache_bytes + two_stage.activation_bytes + two_stage.weight_bytes);
+}
+
+TEST(TranslatorTest, MemoryBudget) {
+  const std::vector<std::vector<std::string>> inputs = {
+    {"آ", "ز", "ا"},
+    {"آ", "ت", "ز", "م", "و", "ن"},
+    {"آ", "ت", "ز", "م"}};
+  TranslationOptions options;
+  options.max_decoding_length = 50;
+
+  const auto expected = default_translator().translate_batch(inputs, options);
+
+  // Make room for a single example in each batch.
+  models::ModelLoader model_loader(default_model_dir());
+  ReplicaPoolConfig config;
+  config.max_memory_per_replica = default_translator().estimate_decoding_memory(
+    1, options.beam_size, inputs[1].size(), options.max_decoding_length).total_bytes();
+
+  Translator translator(model_loader, config);
+  const auto results = translator.translate_batch(inputs, options);
+  ASSERT_EQ(results.size(), expected.size());
+  for (size_t i = 0; i < results.size(); ++i)
+    EXPECT_EQ(results[i].hypotheses, expected[i].hypotheses);
+
+  auto iterator = translator.translate_iterable(
+    std::make_unique<VectorReader>(load_examples({inputs})), options, /*max_batch_size=*/3);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const auto result = iterator->next();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->hypotheses, expected[i].hypotheses);
+  }
+  EXPECT_FALSE(iterator->next());
+
+  // An example that does not fit alone is rejected.
+  config.max_memory_per_replica = 1024;
+  Translator small_translator(model_loader, config);
+  EXPECT_THROW(small_translator.translate_batch(inputs, options), std::runtime_error);
+}